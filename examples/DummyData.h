@@ -101,7 +101,8 @@ static const PlaybackTrack CURRENT_TRACK{"adminid1",
                                          "adminuri1",
                                          "me",
                                          10,
-                                         false};
+                                         false,
+                                         1600000000000};
 
 static const std::vector<BaseTrack> TRACK_LIST = {
     {"id1", "title1", "album1", "artist1", 123, "uri1", "me"},
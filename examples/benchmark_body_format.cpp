@@ -0,0 +1,128 @@
+/**
+ * @file    benchmark_body_format.cpp
+ * @author  Team Server
+ * @brief   Compares the size and encode/decode time of the queue response in
+ * JSON, MessagePack and CBOR.
+ *
+ * @details For several queue sizes a `QueueStatus` is encoded the way
+ * `getCurrentQueues` does it (`SerializedQueueCache::serialize`, cached per
+ * queue version) and decoded into a `nlohmann::json` document the way a client
+ * would. For comparison the binary formats are also encoded from the document
+ * (`Serializer::serialize` + `BodyCodec::encode`), as without the cache.
+ *
+ * Usage: ./benchmark_body_format [iterations]
+ */
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "Network/SerializedQueueCache.h"
+#include "Types/Queue.h"
+#include "Utils/BodyFormat.h"
+#include "Utils/Serializer.h"
+
+using namespace std;
+using namespace std::chrono;
+using json = nlohmann::json;
+
+static mt19937 rng(4711);
+
+static string randomString(size_t len) {
+  static char const CHARS[] =
+      "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz ";
+  string result(len, ' ');
+  for (auto &c : result) {
+    c = CHARS[rng() % (sizeof(CHARS) - 1)];
+  }
+  return result;
+}
+
+static void fillTrack(BaseTrack &track) {
+  track.trackId = randomString(22);
+  track.title = randomString(25);
+  track.album = randomString(20);
+  track.artist = randomString(15);
+  track.durationMs = rng() % 600000;
+  track.iconUri = "https://i.scdn.co/image/" + randomString(40);
+  track.addedBy = randomString(10);
+}
+
+static QueueStatus generateQueueStatus(size_t nrOfTracks) {
+  QueueStatus queueStatus;
+  for (size_t i = 0; i < nrOfTracks; i++) {
+    QueuedTrack track;
+    fillTrack(track);
+    track.votes = rng() % 100;
+    track.userHasVoted = (rng() % 10 == 0);
+    track.insertedAt = i;
+    queueStatus.normalQueue.tracks.push_back(track);
+  }
+  queueStatus.normalQueue.version = nrOfTracks;
+  PlaybackTrack playback;
+  fillTrack(playback);
+  playback.progressMs = 1234;
+  playback.isPlaying = true;
+  playback.startedAtMs = 1600000000000;
+  queueStatus.currentTrack = playback;
+  return queueStatus;
+}
+
+/**
+ * @brief Returns the average run time of the given function in microseconds.
+ */
+static double measure(function<void()> const &func, int iterations) {
+  auto start = steady_clock::now();
+  for (int i = 0; i < iterations; i++) {
+    func();
+  }
+  auto elapsed = duration_cast<nanoseconds>(steady_clock::now() - start);
+  return elapsed.count() / 1e3 / iterations;
+}
+
+int main(int argc, char *argv[]) {
+  int iterations = (argc > 1) ? stoi(argv[1]) : 100;
+
+  cout << setw(8) << "tracks" << setw(10) << "format" << setw(10) << "bytes"
+       << setw(14) << "encode[us]" << setw(14) << "uncached[us]" << setw(14)
+       << "decode[us]" << endl;
+
+  for (size_t nrOfTracks : {10, 100, 1000, 5000}) {
+    auto queueStatus = generateQueueStatus(nrOfTracks);
+
+    for (auto format :
+         {BodyFormat::Json, BodyFormat::MessagePack, BodyFormat::Cbor}) {
+      string body;
+      auto encode = [&]() {
+        body = SerializedQueueCache::serialize(queueStatus, format);
+      };
+      auto encodeUncached = [&]() {
+        body = BodyCodec::encode(Serializer::serialize(queueStatus), format);
+      };
+      auto decode = [&]() {
+        json document;
+        if (format == BodyFormat::Json) {
+          document = json::parse(body);
+        } else if (format == BodyFormat::MessagePack) {
+          document = json::from_msgpack(body);
+        } else {
+          document = json::from_cbor(body);
+        }
+      };
+
+      double uncachedTime = measure(encodeUncached, iterations);
+      double encodeTime = measure(encode, iterations);
+      double decodeTime = measure(decode, iterations);
+      // strip "application/"
+      auto name = BodyCodec::mediaType(format).substr(12);
+      cout << setw(8) << nrOfTracks << setw(10) << name << setw(10)
+           << body.size() << fixed << setprecision(1) << setw(14) << encodeTime
+           << setw(14) << uncachedTime << setw(14) << decodeTime << endl;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file    benchmark_json_writer.cpp
+ * @author  Team Server
+ * @brief   Compares the serialization throughput of `Serializer::serialize`
+ * (nlohmann::json trees) with `Serializer::write` (streaming `JsonWriter`).
+ *
+ * @details For several queue sizes a `QueueStatus` is serialized repeatedly
+ * the way a response body is produced:
+ *
+ * - json:   build the tree, dump it to a string and copy it into the response
+ * - writer: write into a reused buffer and copy it into the response
+ * - owned:  write into a fresh buffer which is moved into the response
+ *
+ * Usage: ./benchmark_json_writer [seconds per measurement]
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "Types/Queue.h"
+#include "Utils/JsonWriter.h"
+#include "Utils/Serializer.h"
+
+using namespace std;
+using namespace std::chrono;
+
+static mt19937 rng(4711);
+
+static string randomString(size_t len) {
+  static char const CHARS[] =
+      "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz \"";
+  string result(len, ' ');
+  for (auto &c : result) {
+    c = CHARS[rng() % (sizeof(CHARS) - 1)];
+  }
+  return result;
+}
+
+static void fillTrack(BaseTrack &track) {
+  track.trackId = randomString(22);
+  track.title = randomString(25);
+  track.album = randomString(20);
+  track.artist = randomString(15);
+  track.durationMs = rng() % 600000;
+  track.iconUri = "https://i.scdn.co/image/" + randomString(40);
+  track.addedBy = randomString(10);
+}
+
+static QueueStatus generateQueueStatus(size_t nrOfTracks) {
+  QueueStatus queueStatus;
+  for (size_t i = 0; i < nrOfTracks; i++) {
+    QueuedTrack track;
+    fillTrack(track);
+    track.votes = rng() % 100;
+    track.userHasVoted = rng() % 2;
+    track.insertedAt = i;
+    queueStatus.normalQueue.tracks.push_back(track);
+  }
+  PlaybackTrack playback;
+  fillTrack(playback);
+  playback.progressMs = 1234;
+  playback.isPlaying = true;
+  playback.startedAtMs = 1600000000000;
+  queueStatus.currentTrack = playback;
+  return queueStatus;
+}
+
+/**
+ * @brief Runs the given function for the given time and returns the
+ * throughput in MiB/s.
+ */
+template <class F>
+static double measure(F func, int seconds) {
+  size_t bytes = 0;
+  size_t iterations = 0;
+  auto start = steady_clock::now();
+  auto end = start + seconds * 1s;
+  auto now = start;
+  while (now < end) {
+    bytes += func();
+    iterations++;
+    // checking the clock is expensive for small documents
+    if (iterations % 16 == 0) {
+      now = steady_clock::now();
+    }
+  }
+  double elapsed = duration_cast<microseconds>(now - start).count() / 1e6;
+  return bytes / elapsed / (1024 * 1024);
+}
+
+int main(int argc, char *argv[]) {
+  int seconds = (argc > 1) ? stoi(argv[1]) : 2;
+
+  cout << setw(8) << "tracks" << setw(12) << "bytes" << setw(14)
+       << "json[MiB/s]" << setw(16) << "writer[MiB/s]" << setw(15)
+       << "owned[MiB/s]" << endl;
+
+  for (size_t nrOfTracks : {1, 10, 100, 1000}) {
+    auto queueStatus = generateQueueStatus(nrOfTracks);
+
+    // the response body is copied once more by string_response
+    string response;
+    auto viaJson = [&]() {
+      string body = Serializer::serialize(queueStatus).dump();
+      response = body;
+      return response.size();
+    };
+
+    JsonWriter writer;
+    auto viaWriter = [&]() {
+      writer.clear();
+      Serializer::write(writer, queueStatus);
+      response = writer.str();
+      return response.size();
+    };
+
+    auto viaOwnedWriter = [&]() {
+      JsonWriter ownedWriter;
+      Serializer::write(ownedWriter, queueStatus);
+      response = ownedWriter.release();
+      return response.size();
+    };
+
+    size_t size = viaJson();
+    cout << setw(8) << nrOfTracks << setw(12) << size << fixed
+         << setprecision(1) << setw(14) << measure(viaJson, seconds)
+         << setw(16) << measure(viaWriter, seconds) << setw(15)
+         << measure(viaOwnedWriter, seconds) << endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file    benchmark_rest_api.cpp
+ * @author  Team Server
+ * @brief   Load generator measuring throughput and memory usage of the REST
+ * server under many concurrent clients.
+ *
+ * @details Start a server first (e.g. the `empty_network_listener` example)
+ * and pass its port and process ID to this program:
+ *
+ *     ./empty_network_listener ../jukebox_config.ini &
+ *     ./benchmark_rest_api 8888 $! [seconds]
+ *
+ * For each concurrency level (100, 1000 and 5000 clients) every client polls
+ * `getCurrentQueues` over its own keep-alive connection for the given number
+ * of seconds. The throughput, latencies as well as the peak resident memory
+ * and thread count of the server process are reported. Run it once with
+ * `threadingMode=perConnection` and once with `threadingMode=pool` to compare
+ * both threading models, and with `implementation=epoll` to compare them with
+ * the epoll based server.
+ *
+ * Set `minLogLevel=WARNING` in the configuration, since the example listener
+ * logs every request otherwise.
+ *
+ * Note: 5000 clients need an open file limit of at least ~10000 (`ulimit -n`).
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "restclient-cpp/connection.h"
+#include "restclient-cpp/restclient.h"
+
+using namespace std;
+using namespace std::chrono;
+
+struct ProcessStats {
+  long rssKb = 0;
+  long threads = 0;
+};
+
+static ProcessStats readProcessStats(int pid) {
+  ProcessStats stats;
+  ifstream status("/proc/" + to_string(pid) + "/status");
+  string line;
+  while (getline(status, line)) {
+    if (line.rfind("VmRSS:", 0) == 0) {
+      stats.rssKb = stol(line.substr(6));
+    } else if (line.rfind("Threads:", 0) == 0) {
+      stats.threads = stol(line.substr(8));
+    }
+  }
+  return stats;
+}
+
+static void runLevel(int port, int pid, int clients, int seconds) {
+  atomic<bool> running{true};
+  atomic<size_t> requests{0};
+  atomic<size_t> failures{0};
+  mutex latencyMutex;
+  vector<double> latenciesMs;
+
+  auto clientFunc = [&]() {
+    RestClient::Connection conn("http://localhost:" + to_string(port));
+    conn.SetTimeout(30);
+    vector<double> localLatencies;
+    while (running) {
+      auto start = steady_clock::now();
+      auto resp = conn.get("/api/v1/getCurrentQueues?session_id=benchmark");
+      auto end = steady_clock::now();
+      if (resp.code != 200) {
+        failures++;
+        continue;
+      }
+      requests++;
+      localLatencies.push_back(
+          duration_cast<microseconds>(end - start).count() / 1000.0);
+    }
+    lock_guard<mutex> lock(latencyMutex);
+    latenciesMs.insert(
+        latenciesMs.end(), localLatencies.begin(), localLatencies.end());
+  };
+
+  ProcessStats before = readProcessStats(pid);
+  vector<thread> threads;
+  threads.reserve(clients);
+  for (int i = 0; i < clients; i++) {
+    threads.emplace_back(clientFunc);
+  }
+
+  // sample the server process while the clients are running
+  ProcessStats peak = before;
+  auto start = steady_clock::now();
+  while (steady_clock::now() - start < seconds * 1s) {
+    this_thread::sleep_for(100ms);
+    auto current = readProcessStats(pid);
+    peak.rssKb = max(peak.rssKb, current.rssKb);
+    peak.threads = max(peak.threads, current.threads);
+  }
+  running = false;
+  for (auto &t : threads) {
+    t.join();
+  }
+  double elapsed = duration_cast<milliseconds>(steady_clock::now() - start)
+                       .count() / 1000.0;
+
+  sort(latenciesMs.begin(), latenciesMs.end());
+  auto percentile = [&](double p) {
+    if (latenciesMs.empty()) {
+      return 0.0;
+    }
+    return latenciesMs[static_cast<size_t>(p * (latenciesMs.size() - 1))];
+  };
+
+  cout << setw(8) << clients << setw(12) << fixed << setprecision(0)
+       << requests / elapsed << setw(10) << failures.load() << setw(10)
+       << setprecision(2) << percentile(0.5) << setw(10) << percentile(0.99)
+       << setw(12) << peak.rssKb / 1024.0 << setw(12)
+       << (peak.rssKb - before.rssKb) / 1024.0 << setw(10) << peak.threads
+       << endl;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    cerr << "Usage: " << string(argv[0]) << " <port> <server_pid> [seconds]"
+         << endl;
+    return 1;
+  }
+
+  int port = stoi(argv[1]);
+  int pid = stoi(argv[2]);
+  int seconds = (argc > 3) ? stoi(argv[3]) : 10;
+
+  RestClient::init();
+
+  cout << setw(8) << "clients" << setw(12) << "req/s" << setw(10) << "errors"
+       << setw(10) << "p50[ms]" << setw(10) << "p99[ms]" << setw(12)
+       << "RSS[MiB]" << setw(12) << "+RSS[MiB]" << setw(10) << "threads"
+       << endl;
+  for (int clients : {100, 1000, 5000}) {
+    runLevel(port, pid, clients, seconds);
+    // give the server some time to close idle connections
+    this_thread::sleep_for(2s);
+  }
+
+  RestClient::disable();
+  return 0;
+}
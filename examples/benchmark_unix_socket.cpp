@@ -0,0 +1,189 @@
+/**
+ * @file    benchmark_unix_socket.cpp
+ * @author  Team Server
+ * @brief   Compares the request latency of the REST server over TCP loopback
+ * and over a Unix domain socket.
+ *
+ * @details Start a server listening on both (e.g. the `empty_network_listener`
+ * example with `unixSocket=/tmp/jukebox.sock` in the configuration) and pass
+ * the port and the socket path to this program:
+ *
+ *     ./empty_network_listener ../jukebox_config.ini &
+ *     ./benchmark_unix_socket 8888 /tmp/jukebox.sock [requests]
+ *
+ * A single client sends the requests one after the other over a keep-alive
+ * connection, so the latencies contain the transport overhead of every
+ * request but no queueing. Both transports are measured for a small request
+ * (`getCurrentQueues`) and for a request with a body (`generateSession`).
+ *
+ * Set `minLogLevel=WARNING` in the configuration, since the example listener
+ * logs every request otherwise.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+static int connectTcp(int port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  int enable = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(static_cast<uint16_t>(port));
+  inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+  if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) <
+      0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static int connectUnix(string const &path) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+  if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) <
+      0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/**
+ * @brief Sends a request and reads its response, returns false on errors.
+ * @details Relies on `Content-Length`, which the server sets for all
+ * responses except event streams.
+ */
+static bool roundTrip(int fd, string const &request, string &buffer) {
+  for (size_t sent = 0; sent < request.size();) {
+    auto res = send(fd, request.data() + sent, request.size() - sent, 0);
+    if (res <= 0) {
+      return false;
+    }
+    sent += res;
+  }
+
+  buffer.clear();
+  size_t expected = string::npos;
+  char chunk[16384];
+  while (buffer.size() < expected) {
+    auto received = recv(fd, chunk, sizeof(chunk), 0);
+    if (received <= 0) {
+      return false;
+    }
+    buffer.append(chunk, received);
+    auto headEnd = buffer.find("\r\n\r\n");
+    if (expected == string::npos && headEnd != string::npos) {
+      auto lengthPos = buffer.find("Content-Length: ");
+      if (lengthPos == string::npos || lengthPos > headEnd) {
+        return false;
+      }
+      expected = headEnd + 4 + stoul(buffer.substr(lengthPos + 16));
+    }
+  }
+  return buffer.compare(9, 3, "200") == 0;
+}
+
+static void runCase(string const &transport,
+                    int fd,
+                    string const &name,
+                    string const &request,
+                    int requests) {
+  if (fd < 0) {
+    cout << setw(8) << transport << setw(18) << name << "  connect failed"
+         << endl;
+    return;
+  }
+
+  string buffer;
+  // warm up the connection and the server
+  for (int i = 0; i < requests / 10; i++) {
+    roundTrip(fd, request, buffer);
+  }
+
+  vector<double> latenciesUs;
+  latenciesUs.reserve(requests);
+  size_t failures = 0;
+  for (int i = 0; i < requests; i++) {
+    auto start = steady_clock::now();
+    bool success = roundTrip(fd, request, buffer);
+    auto end = steady_clock::now();
+    if (!success) {
+      failures++;
+      continue;
+    }
+    latenciesUs.push_back(duration_cast<nanoseconds>(end - start).count() /
+                          1000.0);
+  }
+  close(fd);
+
+  sort(latenciesUs.begin(), latenciesUs.end());
+  auto percentile = [&](double p) {
+    if (latenciesUs.empty()) {
+      return 0.0;
+    }
+    return latenciesUs[static_cast<size_t>(p * (latenciesUs.size() - 1))];
+  };
+  double mean =
+      latenciesUs.empty()
+          ? 0.0
+          : accumulate(latenciesUs.begin(), latenciesUs.end(), 0.0) /
+                latenciesUs.size();
+
+  cout << setw(8) << transport << setw(18) << name << setw(8) << failures
+       << fixed << setprecision(1) << setw(10) << mean << setw(10)
+       << percentile(0.5) << setw(10) << percentile(0.9) << setw(10)
+       << percentile(0.99) << endl;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    cerr << "Usage: " << string(argv[0])
+         << " <port> <socket path> [requests]" << endl;
+    return 1;
+  }
+
+  int port = stoi(argv[1]);
+  string socketPath = argv[2];
+  int requests = (argc > 3) ? stoi(argv[3]) : 20000;
+
+  string body = "{\"nickname\": \"benchmark\"}";
+  vector<pair<string, string>> cases = {
+      {"getCurrentQueues",
+       "GET /api/v1/getCurrentQueues?session_id=benchmark HTTP/1.1\r\n"
+       "Host: localhost\r\n\r\n"},
+      {"generateSession",
+       "POST /api/v1/generateSession HTTP/1.1\r\n"
+       "Host: localhost\r\n"
+       "Content-Type: application/json\r\n"
+       "Content-Length: " +
+           to_string(body.size()) + "\r\n\r\n" + body},
+  };
+
+  cout << setw(8) << "socket" << setw(18) << "request" << setw(8) << "errors"
+       << setw(10) << "mean[us]" << setw(10) << "p50[us]" << setw(10)
+       << "p90[us]" << setw(10) << "p99[us]" << endl;
+  for (auto const &[name, request] : cases) {
+    runCase("tcp", connectTcp(port), name, request, requests);
+    runCase("unix", connectUnix(socketPath), name, request, requests);
+  }
+  return 0;
+}
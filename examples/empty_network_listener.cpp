@@ -9,7 +9,8 @@
  * information about recognized requests.
  *
  * The listened port can be configured using a key `port` in the section
- * `RestAPI` in the INI file.
+ * `RestAPI` in the INI file, the server implementation using the key
+ * `implementation`.
  */
 
 #include <glog/logging.h>
@@ -17,7 +18,7 @@
 #include <iostream>
 
 #include "DummyData.h"
-#include "Network/RestAPI.h"
+#include "NetworkAPI.h"
 #include "Utils/ConfigHandler.h"
 #include "Utils/LoggingHandler.h"
 
@@ -59,6 +60,14 @@ class EmptyNetworkListener : public NetworkListener {
     return status;
   }
 
+  TResult<QueueStatusVersion> getCurrentQueuesVersion(
+      TSessionID const &sid) override {
+    LOG(INFO) << "Session ID: " << sid;
+
+    // the dummy data never changes
+    return QueueStatusVersion{0, 0, 0};
+  }
+
   TResultOpt addTrackToQueue(TSessionID const &sid,
                              TTrackID const &trkid,
                              QueueType type) override {
@@ -130,6 +139,10 @@ class EmptyNetworkListener : public NetworkListener {
     LOG(INFO) << "Track ID: " << trkid;
     return nullopt;
   }
+  TResultOpt authorizeAdmin(TSessionID const &sid) override {
+    LOG(INFO) << "Session ID: " << sid;
+    return nullopt;
+  }
 };
 
 int main(int argc, char *argv[]) {
@@ -140,13 +153,17 @@ int main(int argc, char *argv[]) {
   }
 
   EmptyNetworkListener listener;
-  RestAPI api;
 
   ConfigHandler::getInstance()->setConfigFilePath(argv[1]);
   initLoggingHandler(argv[0]);
 
-  api.setListener(&listener);
-  auto result = api.handleRequests();
+  auto api = NetworkAPI::create();
+  if (holds_alternative<Error>(api)) {
+    LOG(ERROR) << get<Error>(api).getErrorMessage();
+    return 1;
+  }
+  get<unique_ptr<NetworkAPI>>(api)->setListener(&listener);
+  auto result = get<unique_ptr<NetworkAPI>>(api)->handleRequests();
   if (result.has_value()) {
     LOG(ERROR) << result.value().getErrorMessage();
   }
@@ -9,6 +9,10 @@
 #ifndef _DATASTORE_H_
 #define _DATASTORE_H_
 
+#include <functional>
+#include <utility>
+#include <vector>
+
 #include "Types/GlobalTypes.h"
 #include "Types/Queue.h"
 #include "Types/Result.h"
@@ -93,6 +97,18 @@ class DataStore {
                                TTrackID const &tID,
                                TVote vote) = 0;
 
+  /**
+   * @brief    Apply several votes of the same user at once
+   * @details  Behaves like calling `voteTrack` for each vote in order, but
+   * the data is locked and the queue is sorted only once.
+   * @param    sID The ID of the User who wants to vote
+   * @param    votes The IDs of the tracks to vote for and their votes
+   * @return   One result per vote, in the same order.
+   */
+  virtual std::vector<TResultOpt> voteTracks(
+      TSessionID const &sID,
+      std::vector<std::pair<TTrackID, TVote>> const &votes) = 0;
+
   /**
    * @brief    Get entire Queue
    * @param    q Identifier for determining which Queue should be
@@ -101,12 +117,35 @@ class DataStore {
    */
   virtual TResult<Queue> getQueue(QueueType q) = 0;
 
+  /**
+   * @brief    Get a range of a Queue
+   * @details  Only the tracks of the range are copied. The returned Queue
+   * holds the size of the whole Queue as well.
+   * @param    q Identifier for determining which Queue should be
+   * returned
+   * @param    offset Position of the first track to return
+   * @param    limit Maximum number of tracks to return
+   * @return   Either the requested part of the Queue or an Error message.
+   */
+  virtual TResult<Queue> getQueueRange(QueueType q,
+                                       size_t offset,
+                                       size_t limit) = 0;
+
   /**
    * @brief    Get the currently playing track.
    * @return   Returns the currently playing track (if any) or an Error message.
    */
   virtual TResult<std::optional<QueuedTrack>> getPlayingTrack() = 0;
 
+  /**
+   * @brief    Get the version of the queues.
+   * @details  The version changes whenever a track is added, removed or
+   * voted for, or the currently playing track changes. As long as the version
+   * stays the same, the queues and the playing track are unchanged.
+   * @return   The current queue version
+   */
+  virtual uint64_t getQueueVersion() = 0;
+
   /**
    * @brief    Query the internal user list whether a certain user exists
    * @param    sID The ID of the user to check for
@@ -120,7 +159,30 @@ class DataStore {
    */
   virtual TResultOpt nextTrack() = 0;
 
+  /**
+   * @brief    Sets the function which is called whenever the queue version or
+   * the votes version of a user changes, e.g. to wake up event streams.
+   * @details  Must be set before the data store is shared among threads.
+   * @param    callback The function to call, which must not block.
+   */
+  void setChangeCallback(std::function<void()> callback) {
+    mChangeCallback = std::move(callback);
+  }
+
   static unsigned const cSessionTimeoutAfterSeconds = 3600;
+
+ protected:
+  /**
+   * @brief    Calls the change callback (if any) after a version changed.
+   */
+  void notifyChange() {
+    if (mChangeCallback) {
+      mChangeCallback();
+    }
+  }
+
+ private:
+  std::function<void()> mChangeCallback;
 };
 
 #endif /* _DATASTORE_H_ */
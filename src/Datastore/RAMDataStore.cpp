@@ -15,28 +15,62 @@
 #include "Types/GlobalTypes.h"
 #include "Types/Result.h"
 #include "Utils/LoggingHandler.h"
+#include "Utils/Metrics.h"
+#include "Utils/Tracing.h"
 
 using namespace std;
 
+/**
+ * @brief Returns `mutex` locked by a `Lock`, the wait is traced if it is held
+ * by another thread.
+ * @details The wait and hold times are recorded by the `ProfiledMutex`.
+ */
+template <template <class> class Lock, class Mutex>
+static Lock<Mutex> acquire(Mutex &mutex) {
+  Lock<Mutex> lock(mutex, try_to_lock);
+  if (!lock.owns_lock()) {
+    Tracing::Span span("RAMDataStore.lockWait");
+    lock.lock();
+  }
+  return lock;
+}
+
+static void recordUserCount(size_t count) {
+  static auto &users =
+      Metrics::gauge("jukebox_datastore_users", "Sessions in the data store");
+  users.get().set(static_cast<int64_t>(count));
+}
+
+static void recordQueueLengths(Queue const &admin, Queue const &normal) {
+  static auto &lengths = Metrics::gauge(
+      "jukebox_datastore_queue_length", "Tracks in the queues", {"queue"});
+  lengths.labels({"admin"}).set(static_cast<int64_t>(admin.tracks.size()));
+  lengths.labels({"normal"}).set(static_cast<int64_t>(normal.tracks.size()));
+}
+
 void RAMDataStore::removeVotesForTrack(TTrackID const &id) {
-  unique_lock<recursive_mutex> MyUserLock(mUserMutex);
+  Tracing::Span span("RAMDataStore.removeVotesForTrack");
+  auto MyUserLock = acquire<unique_lock>(mUserMutex);
   for (auto &&user : mUsers) {
     auto it = find(user.votes.begin(), user.votes.end(), id);
     if (it != user.votes.end()) {
       user.votes.erase(it);
+      user.votesVersion++;
     }
   }
 }
 
 TResultOpt RAMDataStore::addUser(User const &user) {
+  Tracing::Span span("RAMDataStore.addUser");
   // Exclusive Access to User List
-  unique_lock<recursive_mutex> MyLock(mUserMutex);
+  auto MyLock = acquire<unique_lock>(mUserMutex);
 
   // check for existing user
   auto it = find(mUsers.begin(), mUsers.end(), user);
   if (it == mUsers.end()) {
     // User is unique, insert it into vector
     mUsers.emplace_back(user);
+    recordUserCount(mUsers.size());
   } else {
     return Error(ErrorCode::AlreadyExists, "User already exists");
   }
@@ -44,8 +78,9 @@ TResultOpt RAMDataStore::addUser(User const &user) {
 }
 
 TResult<User> RAMDataStore::getUser(TSessionID const &ID) {
+  Tracing::Span span("RAMDataStore.getUser");
   // Exclusive Access to User List
-  unique_lock<recursive_mutex> MyLock(mUserMutex);
+  auto MyLock = acquire<unique_lock>(mUserMutex);
 
   // find user
   User user;
@@ -62,8 +97,9 @@ TResult<User> RAMDataStore::getUser(TSessionID const &ID) {
 
 // doesn't remove votes taken by this user
 TResult<User> RAMDataStore::removeUser(TSessionID const &ID) {
+  Tracing::Span span("RAMDataStore.removeUser");
   // Exclusive Access to User List
-  unique_lock<recursive_mutex> MyLock(mUserMutex);
+  auto MyLock = acquire<unique_lock>(mUserMutex);
 
   // find user
   User user;
@@ -76,14 +112,16 @@ TResult<User> RAMDataStore::removeUser(TSessionID const &ID) {
     user = *it;
     // delete User
     mUsers.erase(it);
+    recordUserCount(mUsers.size());
     return user;
   }
 }
 
 // check expired sessions
 TResult<bool> RAMDataStore::isSessionExpired(TSessionID const &ID) {
+  Tracing::Span span("RAMDataStore.isSessionExpired");
   // Exclusive Access to User List
-  unique_lock<recursive_mutex> MyLock(mUserMutex);
+  auto MyLock = acquire<unique_lock>(mUserMutex);
 
   auto retUser = getUser(ID);
   if (holds_alternative<Error>(retUser))
@@ -103,8 +141,9 @@ TResult<bool> RAMDataStore::isSessionExpired(TSessionID const &ID) {
 }
 
 TResultOpt RAMDataStore::addTrack(BaseTrack const &track, QueueType q) {
+  Tracing::Span span("RAMDataStore.addTrack");
   // Exclusive Access to Song Queue
-  unique_lock<shared_mutex> MyLock(mQueueMutex);
+  auto MyLock = acquire<unique_lock>(mQueueMutex);
 
   // Get pointers for this Queue and for other Queue
   Queue *pThisQueue = SelectQueue(q);
@@ -137,6 +176,9 @@ TResultOpt RAMDataStore::addTrack(BaseTrack const &track, QueueType q) {
     qtr.votes = 0;
     qtr.insertedAt = time(nullptr);
     pThisQueue->tracks.push_back(qtr);
+    mQueueVersion++;
+    recordQueueLengths(mAdminQueue, mNormalQueue);
+    notifyChange();
     return nullopt;
   } else {
     return Error(ErrorCode::AlreadyExists, "Track already exists");
@@ -144,12 +186,13 @@ TResultOpt RAMDataStore::addTrack(BaseTrack const &track, QueueType q) {
 }
 
 TResult<BaseTrack> RAMDataStore::removeTrack(TTrackID const &ID, QueueType q) {
+  Tracing::Span span("RAMDataStore.removeTrack");
   QueuedTrack track;
 
   // remove track from queue
   {
     // Exclusive Access to Song Queue
-    unique_lock<shared_mutex> MyLock(mQueueMutex);
+    auto MyLock = acquire<unique_lock>(mQueueMutex);
 
     Queue *pQueue = SelectQueue(q);
     if (pQueue == nullptr) {
@@ -165,17 +208,21 @@ TResult<BaseTrack> RAMDataStore::removeTrack(TTrackID const &ID, QueueType q) {
       track = *it;
       // Found track, remove it from vector
       pQueue->tracks.erase(it);
+      mQueueVersion++;
+      recordQueueLengths(mAdminQueue, mNormalQueue);
     }
   }
 
   removeVotesForTrack(track.trackId);
+  notifyChange();
 
   return track;
 }
 
 TResult<bool> RAMDataStore::hasTrack(TTrackID const &ID, QueueType q) {
+  Tracing::Span span("RAMDataStore.hasTrack");
   // Shared Access to Song Queue
-  shared_lock<shared_mutex> MyLock(mQueueMutex);
+  auto MyLock = acquire<shared_lock>(mQueueMutex);
 
   // select Queue
   Queue *pQueue = SelectQueue(q);
@@ -197,9 +244,15 @@ TResult<bool> RAMDataStore::hasTrack(TTrackID const &ID, QueueType q) {
 TResultOpt RAMDataStore::voteTrack(TSessionID const &sID,
                                    TTrackID const &tID,
                                    TVote vote) {
+  return voteTracks(sID, {{tID, vote}}).front();
+}
+
+vector<TResultOpt> RAMDataStore::voteTracks(
+    TSessionID const &sID, vector<pair<TTrackID, TVote>> const &votes) {
+  Tracing::Span span("RAMDataStore.voteTracks");
   // Exclusive Access to Song Queue and User
-  unique_lock<shared_mutex> MyLockQueue(mQueueMutex, defer_lock);
-  unique_lock<recursive_mutex> MyLockUser(mUserMutex, defer_lock);
+  unique_lock MyLockQueue(mQueueMutex, defer_lock);
+  unique_lock MyLockUser(mUserMutex, defer_lock);
   lock(MyLockQueue, MyLockUser);
 
   // find user
@@ -208,60 +261,28 @@ TResultOpt RAMDataStore::voteTrack(TSessionID const &sID,
   auto it = find(mUsers.begin(), mUsers.end(), user);
   if (it == mUsers.end()) {
     // User not found
-    return Error(ErrorCode::DoesntExist, "User doesn't exist");
-  }
-
-  // find track in Queues
-  QueuedTrack track;
-  track.trackId = tID;
-  QueuedTrack *pNormalTrack = 0;
-  auto it_normal =
-      find(mNormalQueue.tracks.begin(), mNormalQueue.tracks.end(), track);
-  if (it_normal != mNormalQueue.tracks.end()) {
-    pNormalTrack = &(*it_normal);
+    return vector<TResultOpt>(votes.size(),
+                              Error(ErrorCode::DoesntExist,
+                                    "User doesn't exist"));
   }
 
-  // User found, look for Track in vote vector
-  auto it_track = find(it->votes.begin(), it->votes.end(), tID);
-  if (it_track != it->votes.end()) {
-    // Track already found in vote vector
-    if (vote) {
-      // track already in vote vector and we want to upvote it: this is a
-      // duplicate, do nothing
-    } else {
-      // Track already in vote vector and we want to remove the upvote:
-      // we want to remove it from upvoted tracks, so remove it from vector of
-      // upvoted tracks and update vote counter in track
-      it->votes.erase(it_track);
-      // decrement its upvote counter
-      if (pNormalTrack != nullptr) {
-        pNormalTrack->votes--;
-      }
-    }
-  } else {
-    // Track not in vote vector
-    if (vote) {
-      // Track not in vote vector and we want to upvote it: add to vector and
-      // update counter
-      it->votes.emplace_back(tID);
-      // increment its upvote counter
-      if (pNormalTrack != nullptr) {
-        pNormalTrack->votes++;
-      }
-    } else {
-      // track not in vote vector and we want to remove upvote: cant remove
-      // nonexistent upvote, so do nothing
-    }
+  auto votesVersion = it->votesVersion;
+  for (auto const &[tID, vote] : votes) {
+    applyVote(*it, tID, vote);
   }
 
-  // sort Normal Queue
+  // sort Normal Queue once for all votes
   sort(mNormalQueue.tracks.begin(), mNormalQueue.tracks.end());
-  return nullopt;
+  if (it->votesVersion != votesVersion) {
+    notifyChange();
+  }
+  return vector<TResultOpt>(votes.size(), nullopt);
 }
 
 TResult<Queue> RAMDataStore::getQueue(QueueType q) {
+  Tracing::Span span("RAMDataStore.getQueue");
   // Shared Access to Song Queue
-  shared_lock<shared_mutex> MyLock(mQueueMutex);
+  auto MyLock = acquire<shared_lock>(mQueueMutex);
 
   // select Queue
   Queue *pQueue = SelectQueue(q);
@@ -269,20 +290,52 @@ TResult<Queue> RAMDataStore::getQueue(QueueType q) {
     return Error(ErrorCode::InvalidValue, "Invalid Parameter in Queue");
   }
 
-  // return read only access to Queue
-  return (const Queue)(*pQueue);
+  // return a copy, tagged with the version it was taken at
+  Queue queue = *pQueue;
+  queue.version = mQueueVersion;
+  return queue;
+}
+
+TResult<Queue> RAMDataStore::getQueueRange(QueueType q,
+                                           size_t offset,
+                                           size_t limit) {
+  Tracing::Span span("RAMDataStore.getQueueRange");
+  // Shared Access to Song Queue
+  auto MyLock = acquire<shared_lock>(mQueueMutex);
+
+  // select Queue
+  Queue *pQueue = SelectQueue(q);
+  if (pQueue == nullptr) {
+    return Error(ErrorCode::InvalidValue, "Invalid Parameter in Queue");
+  }
+
+  // copy the tracks of the range only
+  Queue queue;
+  queue.version = mQueueVersion;
+  queue.totalSize = pQueue->tracks.size();
+  queue.offset = min(offset, pQueue->tracks.size());
+  size_t count = min(limit, pQueue->tracks.size() - queue.offset);
+  auto first = pQueue->tracks.begin() + queue.offset;
+  queue.tracks.assign(first, first + count);
+  return queue;
 }
 
 TResult<optional<QueuedTrack>> RAMDataStore::getPlayingTrack() {
+  Tracing::Span span("RAMDataStore.getPlayingTrack");
   // Shared Access to Song Queue
-  shared_lock<shared_mutex> MyLock(mQueueMutex);
+  auto MyLock = acquire<shared_lock>(mQueueMutex);
 
   return mCurrentTrack;
 }
 
+uint64_t RAMDataStore::getQueueVersion() {
+  return mQueueVersion;
+}
+
 bool RAMDataStore::hasUser(TSessionID const &ID) {
+  Tracing::Span span("RAMDataStore.hasUser");
   // Shared Access to User List
-  unique_lock<recursive_mutex> MyLock(mUserMutex);
+  auto MyLock = acquire<unique_lock>(mUserMutex);
 
   // find user
   User user;
@@ -296,11 +349,12 @@ bool RAMDataStore::hasUser(TSessionID const &ID) {
 }
 
 TResultOpt RAMDataStore::nextTrack() {
+  Tracing::Span span("RAMDataStore.nextTrack");
   QueuedTrack track;
 
   {
     // Exclusive Access to Song Queue
-    unique_lock<shared_mutex> MyLock(mQueueMutex);
+    auto MyLock = acquire<unique_lock>(mQueueMutex);
 
     // If there are songs in the Admin Queue, play the first of those
     if (mAdminQueue.tracks.size()) {
@@ -321,13 +375,65 @@ TResultOpt RAMDataStore::nextTrack() {
 
     // Set Current Track
     mCurrentTrack = track;
+    mQueueVersion++;
+    recordQueueLengths(mAdminQueue, mNormalQueue);
   }
 
   removeVotesForTrack(track.trackId);
+  notifyChange();
 
   return nullopt;
 }
 
+void RAMDataStore::applyVote(User &user, TTrackID const &tID, TVote vote) {
+  // find track in Queues
+  QueuedTrack track;
+  track.trackId = tID;
+  QueuedTrack *pNormalTrack = 0;
+  auto it_normal =
+      find(mNormalQueue.tracks.begin(), mNormalQueue.tracks.end(), track);
+  if (it_normal != mNormalQueue.tracks.end()) {
+    pNormalTrack = &(*it_normal);
+  }
+
+  // look for Track in vote vector of the user
+  auto it_track = find(user.votes.begin(), user.votes.end(), tID);
+  if (it_track != user.votes.end()) {
+    // Track already found in vote vector
+    if (vote) {
+      // track already in vote vector and we want to upvote it: this is a
+      // duplicate, do nothing
+    } else {
+      // Track already in vote vector and we want to remove the upvote:
+      // we want to remove it from upvoted tracks, so remove it from vector of
+      // upvoted tracks and update vote counter in track
+      user.votes.erase(it_track);
+      user.votesVersion++;
+      // decrement its upvote counter
+      if (pNormalTrack != nullptr) {
+        pNormalTrack->votes--;
+        mQueueVersion++;
+      }
+    }
+  } else {
+    // Track not in vote vector
+    if (vote) {
+      // Track not in vote vector and we want to upvote it: add to vector and
+      // update counter
+      user.votes.emplace_back(tID);
+      user.votesVersion++;
+      // increment its upvote counter
+      if (pNormalTrack != nullptr) {
+        pNormalTrack->votes++;
+        mQueueVersion++;
+      }
+    } else {
+      // track not in vote vector and we want to remove upvote: cant remove
+      // nonexistent upvote, so do nothing
+    }
+  }
+}
+
 Queue *RAMDataStore::SelectQueue(QueueType q) {
   if (q == QueueType::Admin) {
     return &mAdminQueue;
@@ -337,3 +443,38 @@ Queue *RAMDataStore::SelectQueue(QueueType q) {
     return nullptr;
   }
 }
+
+static size_t trackHeapBytes(BaseTrack const &track) {
+  return MemoryUsage::heapBytes(track.trackId) +
+         MemoryUsage::heapBytes(track.title) +
+         MemoryUsage::heapBytes(track.album) +
+         MemoryUsage::heapBytes(track.artist) +
+         MemoryUsage::heapBytes(track.iconUri) +
+         MemoryUsage::heapBytes(track.addedBy);
+}
+
+size_t RAMDataStore::userBytes() {
+  auto MyLock = acquire<unique_lock>(mUserMutex);
+  size_t bytes = mUsers.capacity() * sizeof(User);
+  for (auto const &user : mUsers) {
+    bytes += MemoryUsage::heapBytes(user.SessionID) +
+             MemoryUsage::heapBytes(user.Name) +
+             MemoryUsage::heapBytes(user.votes);
+  }
+  return bytes;
+}
+
+size_t RAMDataStore::queueBytes() {
+  auto MyLock = acquire<shared_lock>(mQueueMutex);
+  size_t bytes = 0;
+  for (auto const *queue : {&mAdminQueue, &mNormalQueue}) {
+    bytes += queue->tracks.capacity() * sizeof(QueuedTrack);
+    for (auto const &track : queue->tracks) {
+      bytes += trackHeapBytes(track);
+    }
+  }
+  if (mCurrentTrack.has_value()) {
+    bytes += trackHeapBytes(*mCurrentTrack);
+  }
+  return bytes;
+}
@@ -9,6 +9,7 @@
 #ifndef _RAMDATASTORE_H_
 #define _RAMDATASTORE_H_
 
+#include <atomic>
 #include <mutex>
 #include <shared_mutex>
 #include <string>
@@ -21,6 +22,8 @@
 #include "Types/Result.h"
 #include "Types/Tracks.h"
 #include "Types/User.h"
+#include "Utils/MemoryUsage.h"
+#include "Utils/ProfiledMutex.h"
 
 /**
  * @brief Implements a DataStore which stores its data purly in RAM (no
@@ -38,21 +41,38 @@ class RAMDataStore : public DataStore {
   TResultOpt voteTrack(TSessionID const &sID,
                        TTrackID const &tID,
                        TVote vote) override;
+  std::vector<TResultOpt> voteTracks(
+      TSessionID const &sID,
+      std::vector<std::pair<TTrackID, TVote>> const &votes) override;
   TResult<Queue> getQueue(QueueType q) override;
+  TResult<Queue> getQueueRange(QueueType q,
+                               size_t offset,
+                               size_t limit) override;
   TResult<std::optional<QueuedTrack>> getPlayingTrack() override;
+  uint64_t getQueueVersion() override;
   bool hasUser(TSessionID const &ID) override;
   TResultOpt nextTrack() override;
 
  private:
   void removeVotesForTrack(TTrackID const &);
+  void applyVote(User &user, TTrackID const &tID, TVote vote);
   Queue *SelectQueue(QueueType q);
+  size_t userBytes();
+  size_t queueBytes();
 
   Queue mAdminQueue;
   Queue mNormalQueue;
   std::optional<QueuedTrack> mCurrentTrack = std::nullopt;
   std::vector<User> mUsers;
-  std::recursive_mutex mUserMutex;
-  std::shared_mutex mQueueMutex;
+  ProfiledMutex<std::recursive_mutex> mUserMutex{"RAMDataStore.users"};
+  ProfiledMutex<std::shared_mutex> mQueueMutex{"RAMDataStore.queues"};
+  // starts at 1, since a queue version of 0 means "unknown"
+  std::atomic<uint64_t> mQueueVersion{1};
+  // declared last, so they are unregistered before the data is destroyed
+  MemoryUsage::Registration mUserMemory{"datastore.users",
+                                        [this] { return userBytes(); }};
+  MemoryUsage::Registration mQueueMemory{"datastore.queues",
+                                         [this] { return queueBytes(); }};
 };
 
 #endif /* _RAMDATASTORE_H_ */
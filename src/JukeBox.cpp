@@ -9,24 +9,29 @@
 #include "JukeBox.h"
 
 #include <ctime>
+#include <limits>
 #include <memory>
 
 #include "Datastore/RAMDataStore.h"
-#include "Network/RestAPI.h"
+#include "Network/EventStream.h"
 #include "Spotify/SpotifyBackend.h"
 #include "Types/User.h"
 #include "Utils/ConfigHandler.h"
+#include "Utils/Deadline.h"
 #include "Utils/LoggingHandler.h"
+#include "Utils/Tracing.h"
 
 using namespace std;
 
 JukeBox::JukeBox() {
   mDataStore = new RAMDataStore();
-  mNetwork = new RestAPI();
+  mNetwork = nullptr;  // created once the configuration is loaded
   mMusicBackend = new SpotifyBackend();
   mScheduler = new SimpleScheduler(mDataStore, mMusicBackend);
 
-  mNetwork->setListener(this);
+  // open event streams wait for changes of the versions
+  mDataStore->setChangeCallback(EventStream::notifyChange);
+  mScheduler->setChangeCallback(EventStream::notifyChange);
 }
 
 JukeBox::~JukeBox() {
@@ -62,6 +67,15 @@ bool JukeBox::start(string const &exeName, string const &configFilePath) {
   LOG(INFO) << "#########################################################################";
   // clang-format on
 
+  auto network = NetworkAPI::create();
+  if (holds_alternative<Error>(network)) {
+    LOG(ERROR) << "Failed to create network API: "
+               << get<Error>(network).getErrorMessage();
+    return false;
+  }
+  mNetwork = get<unique_ptr<NetworkAPI>>(network).release();
+  mNetwork->setListener(this);
+
   ret = mMusicBackend->initBackend();
   if (ret.has_value()) {
     LOG(ERROR) << "Failed to initialize music backend ("
@@ -86,6 +100,7 @@ bool JukeBox::start(string const &exeName, string const &configFilePath) {
 
 TResult<TSessionID> JukeBox::generateSession(optional<TPassword> const &pw,
                                              optional<string> const &nickname) {
+  Tracing::Span span("JukeBox.generateSession");
   static int userID = 0;
   static mutex userIDMutex;
   User user;
@@ -129,11 +144,23 @@ TResult<TSessionID> JukeBox::generateSession(optional<TPassword> const &pw,
 
 TResult<vector<BaseTrack>> JukeBox::queryTracks(string const &searchPattern,
                                                 size_t const nrOfEntries) {
+  Tracing::Span span("JukeBox.queryTracks");
+  // the request may have waited for a thread beyond its deadline
+  if (auto expired = Deadline::check()) {
+    return expired.value();
+  }
   auto tracks = mMusicBackend->queryTracks(searchPattern, nrOfEntries);
   return tracks;
 }
 
 TResult<QueueStatus> JukeBox::getCurrentQueues(TSessionID const &sid) {
+  return getCurrentQueuesRange(sid, 0, numeric_limits<size_t>::max());
+}
+
+TResult<QueueStatus> JukeBox::getCurrentQueuesRange(TSessionID const &sid,
+                                                    size_t offset,
+                                                    size_t limit) {
+  Tracing::Span span("JukeBox.getCurrentQueuesRange");
   auto retIsExpired = mDataStore->isSessionExpired(sid);
   if (holds_alternative<Error>(retIsExpired))
     return get<Error>(retIsExpired);
@@ -152,7 +179,7 @@ TResult<QueueStatus> JukeBox::getCurrentQueues(TSessionID const &sid) {
   QueueStatus qs;
 
   /* Set flag if the user has already voted for a track */
-  auto ret = mDataStore->getQueue(QueueType::Normal);
+  auto ret = mDataStore->getQueueRange(QueueType::Normal, offset, limit);
   if (holds_alternative<Error>(ret))
     return get<Error>(ret);
   qs.normalQueue = get<Queue>(ret);
@@ -171,6 +198,36 @@ TResult<QueueStatus> JukeBox::getCurrentQueues(TSessionID const &sid) {
     return get<Error>(ret);
   qs.adminQueue = get<Queue>(ret);
 
+  auto playback = getPlayback();
+  if (holds_alternative<Error>(playback))
+    return get<Error>(playback);
+  qs.currentTrack = get<optional<PlaybackTrack>>(playback);
+
+  return qs;
+}
+
+TResult<optional<PlaybackTrack>> JukeBox::getCurrentPlayback(
+    TSessionID const &sid) {
+  Tracing::Span span("JukeBox.getCurrentPlayback");
+  auto retIsExpired = mDataStore->isSessionExpired(sid);
+  if (holds_alternative<Error>(retIsExpired))
+    return get<Error>(retIsExpired);
+
+  return getPlayback();
+}
+
+TResult<vector<TTrackID>> JukeBox::getVotedTracks(TSessionID const &sid) {
+  auto retIsExpired = mDataStore->isSessionExpired(sid);
+  if (holds_alternative<Error>(retIsExpired))
+    return get<Error>(retIsExpired);
+
+  auto retUser = mDataStore->getUser(sid);
+  if (holds_alternative<Error>(retUser))
+    return get<Error>(retUser);
+  return get<User>(retUser).votes;
+}
+
+TResult<optional<PlaybackTrack>> JukeBox::getPlayback() {
   /* Construct current PlaybackTrack through combining of information
    * in DataStore and Spotify */
 
@@ -182,8 +239,7 @@ TResult<QueueStatus> JukeBox::getCurrentQueues(TSessionID const &sid) {
   auto pbtSpotifyOpt = get<optional<PlaybackTrack>>(trackSpotify);
   if (!pbtSpotifyOpt.has_value()) {
     // TODO: should double check with data store object
-    qs.currentTrack = nullopt;
-    return qs;
+    return optional<PlaybackTrack>();
   }
   PlaybackTrack pbtSpotify = pbtSpotifyOpt.value();
 
@@ -194,8 +250,7 @@ TResult<QueueStatus> JukeBox::getCurrentQueues(TSessionID const &sid) {
 
   auto currentTrackOpt = get<optional<QueuedTrack>>(currentTrackOptRes);
   if (!currentTrackOpt.has_value()) {
-    qs.currentTrack = nullopt;
-    return qs;
+    return optional<PlaybackTrack>();
   }
   auto currentTrack = currentTrackOpt.value();
 
@@ -210,6 +265,7 @@ TResult<QueueStatus> JukeBox::getCurrentQueues(TSessionID const &sid) {
   pbt.trackId = currentTrack.trackId;
   pbt.progressMs = pbtSpotify.progressMs;
   pbt.isPlaying = pbtSpotify.isPlaying;
+  pbt.startedAtMs = pbtSpotify.startedAtMs;
 
   if (mScheduler->checkForInconsistency()) {
     if (!(pbt == pbtSpotify)) {
@@ -221,19 +277,36 @@ TResult<QueueStatus> JukeBox::getCurrentQueues(TSessionID const &sid) {
       LOG(WARNING) << msg;
       return Error(ErrorCode::InvalidValue, msg);
     }
-    qs.currentTrack = pbt;
-  } else {
-    // if nothing is queued, return track which is played on Spotify
-    pbtSpotify.addedBy = pbt.addedBy;
-    qs.currentTrack = pbtSpotify;
+    return optional<PlaybackTrack>(pbt);
   }
 
-  return qs;
+  // if nothing is queued, return track which is played on Spotify
+  pbtSpotify.addedBy = pbt.addedBy;
+  return optional<PlaybackTrack>(pbtSpotify);
+}
+
+TResult<QueueStatusVersion> JukeBox::getCurrentQueuesVersion(
+    TSessionID const &sid) {
+  Tracing::Span span("JukeBox.getCurrentQueuesVersion");
+  auto retIsExpired = mDataStore->isSessionExpired(sid);
+  if (holds_alternative<Error>(retIsExpired))
+    return get<Error>(retIsExpired);
+
+  auto retUser = mDataStore->getUser(sid);
+  if (holds_alternative<Error>(retUser))
+    return get<Error>(retUser);
+
+  QueueStatusVersion version;
+  version.queueVersion = mDataStore->getQueueVersion();
+  version.playbackVersion = mScheduler->getPlaybackVersion();
+  version.votesVersion = get<User>(retUser).votesVersion;
+  return version;
 }
 
 TResultOpt JukeBox::addTrackToQueue(TSessionID const &sid,
                                     TTrackID const &trkid,
                                     QueueType type) {
+  Tracing::Span span("JukeBox.addTrackToQueue");
   auto retIsExpired = mDataStore->isSessionExpired(sid);
   if (holds_alternative<Error>(retIsExpired))
     return get<Error>(retIsExpired);
@@ -247,6 +320,9 @@ TResultOpt JukeBox::addTrackToQueue(TSessionID const &sid,
     return Error(ErrorCode::AccessDenied, "User is not an admin.");
   }
 
+  if (auto expired = Deadline::check()) {
+    return expired.value();
+  }
   auto query = mMusicBackend->createBaseTrack(trkid);
   if (holds_alternative<Error>(query)) {
     LOG(WARNING) << "JukeBox.addTrackToQueue: Could not add track for TrackID '"
@@ -269,7 +345,18 @@ TResultOpt JukeBox::voteTrack(TSessionID const &sid,
   return mDataStore->voteTrack(sid, trkid, vote);
 }
 
+vector<TResultOpt> JukeBox::voteTracks(
+    TSessionID const &sid, vector<pair<TTrackID, TVote>> const &votes) {
+  Tracing::Span span("JukeBox.voteTracks");
+  auto retIsExpired = mDataStore->isSessionExpired(sid);
+  if (holds_alternative<Error>(retIsExpired))
+    return vector<TResultOpt>(votes.size(), get<Error>(retIsExpired));
+
+  return mDataStore->voteTracks(sid, votes);
+}
+
 TResultOpt JukeBox::removeTrack(TSessionID const &sid, TTrackID const &trkid) {
+  Tracing::Span span("JukeBox.removeTrack");
   auto retIsExpired = mDataStore->isSessionExpired(sid);
   if (holds_alternative<Error>(retIsExpired))
     return get<Error>(retIsExpired);
@@ -322,6 +409,7 @@ TResultOpt JukeBox::removeTrack(TSessionID const &sid, TTrackID const &trkid) {
 TResultOpt JukeBox::moveTrack(TSessionID const &sid,
                               TTrackID const &trkid,
                               QueueType toQueue) {
+  Tracing::Span span("JukeBox.moveTrack");
   auto retIsExpired = mDataStore->isSessionExpired(sid);
   if (holds_alternative<Error>(retIsExpired))
     return get<Error>(retIsExpired);
@@ -362,6 +450,7 @@ TResultOpt JukeBox::moveTrack(TSessionID const &sid,
 }
 
 TResultOpt JukeBox::controlPlayer(TSessionID const &sid, PlayerAction action) {
+  Tracing::Span span("JukeBox.controlPlayer");
   int const volChangePercent = 10;
 
   auto retIsExpired = mDataStore->isSessionExpired(sid);
@@ -419,3 +508,19 @@ TResultOpt JukeBox::controlPlayer(TSessionID const &sid, PlayerAction action) {
   }
   return ret;
 }
+
+TResultOpt JukeBox::authorizeAdmin(TSessionID const &sid) {
+  auto retIsExpired = mDataStore->isSessionExpired(sid);
+  if (holds_alternative<Error>(retIsExpired))
+    return get<Error>(retIsExpired);
+
+  User user = get<User>(mDataStore->getUser(sid));
+
+  if (!user.isAdmin) {
+    LOG(WARNING) << "JukeBox.authorizeAdmin: User with session ID '" << sid
+                 << "' and nickname '" << user.Name
+                 << "' is not priviledged to access an admin endpoint.";
+    return Error(ErrorCode::AccessDenied, "User is not an admin.");
+  }
+  return nullopt;
+}
@@ -56,19 +56,38 @@ class JukeBox : public NetworkListener {
   TResult<std::vector<BaseTrack>> queryTracks(
       std::string const &searchPattern, size_t const nrOfEntries) override;
   TResult<QueueStatus> getCurrentQueues(TSessionID const &sid);
+  TResult<QueueStatus> getCurrentQueuesRange(TSessionID const &sid,
+                                             size_t offset,
+                                             size_t limit) override;
+  TResult<std::optional<PlaybackTrack>> getCurrentPlayback(
+      TSessionID const &sid) override;
+  TResult<std::vector<TTrackID>> getVotedTracks(
+      TSessionID const &sid) override;
+  TResult<QueueStatusVersion> getCurrentQueuesVersion(
+      TSessionID const &sid) override;
   TResultOpt addTrackToQueue(TSessionID const &sid,
                              TTrackID const &trkid,
                              QueueType type) override;
   TResultOpt voteTrack(TSessionID const &sid,
                        TTrackID const &trkid,
                        TVote vote) override;
+  std::vector<TResultOpt> voteTracks(
+      TSessionID const &sid,
+      std::vector<std::pair<TTrackID, TVote>> const &votes) override;
   TResultOpt removeTrack(TSessionID const &sid, TTrackID const &trkid) override;
   TResultOpt moveTrack(TSessionID const &sid,
                        TTrackID const &trkid,
                        QueueType toQueue) override;
   TResultOpt controlPlayer(TSessionID const &sid, PlayerAction action) override;
+  TResultOpt authorizeAdmin(TSessionID const &sid) override;
 
  private:
+  /**
+   * @brief Combines the playback of the scheduler with the track the data
+   * store expects to be playing.
+   */
+  TResult<std::optional<PlaybackTrack>> getPlayback();
+
   DataStore *mDataStore;
   NetworkAPI *mNetwork;
   MusicBackend *mMusicBackend;
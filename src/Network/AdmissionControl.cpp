@@ -0,0 +1,157 @@
+/*****************************************************************************/
+/**
+ * @file    AdmissionControl.cpp
+ * @author  Team Server
+ * @brief   Implementation of class AdmissionControl
+ */
+/*****************************************************************************/
+
+#include "AdmissionControl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+#include "Utils/ConfigHandler.h"
+
+using namespace std;
+
+static string const CONFIG_SECTION = "RestAPI";
+static int const DEFAULT_RETRY_AFTER = 1;
+static int const DEFAULT_MAX_DEBUG = 2;
+
+static atomic<int> sInFlight{0};
+static atomic<int> sDebugInFlight{0};
+static atomic<uint64_t> sRejected{0};
+
+// budgets read by configure(), 0 = unlimited
+static atomic<int> sMaxInFlight{0};
+static atomic<int> sMaxNormal{0};
+static atomic<int> sMaxDebug{DEFAULT_MAX_DEBUG};
+static atomic<int> sRetryAfter{DEFAULT_RETRY_AFTER};
+
+static TResult<int> configValue(string const &key, int defaultValue) {
+  auto value = ConfigHandler::getInstance()->getValueInt(
+      CONFIG_SECTION, key, defaultValue);
+  if (holds_alternative<Error>(value)) {
+    return value;
+  }
+  if (get<int>(value) < 0) {
+    return Error(ErrorCode::InvalidValue,
+                 "AdmissionControl.configure: " + key +
+                     " must not be negative");
+  }
+  return value;
+}
+
+//
+// AdmissionTicket
+//
+
+AdmissionTicket::AdmissionTicket(AdmissionTicket &&other) noexcept
+    : mAdmitted(other.mAdmitted), mLane(other.mLane) {
+  other.mAdmitted = false;
+}
+
+AdmissionTicket &AdmissionTicket::operator=(AdmissionTicket &&other) noexcept {
+  if (this != &other) {
+    if (mAdmitted) {
+      AdmissionControl::release(mLane);
+    }
+    mAdmitted = other.mAdmitted;
+    mLane = other.mLane;
+    other.mAdmitted = false;
+  }
+  return *this;
+}
+
+AdmissionTicket::~AdmissionTicket() {
+  if (mAdmitted) {
+    AdmissionControl::release(mLane);
+  }
+}
+
+//
+// AdmissionControl
+//
+
+TResultOpt AdmissionControl::configure() {
+  auto maxInFlight = configValue("maxInFlightRequests", 0);
+  auto reserved = configValue("reservedControlRequests", 0);
+  auto maxDebug = configValue("maxDebugRequests", DEFAULT_MAX_DEBUG);
+  auto retryAfter =
+      configValue("overloadRetryAfterSeconds", DEFAULT_RETRY_AFTER);
+  for (auto value : {&maxInFlight, &reserved, &maxDebug, &retryAfter}) {
+    if (holds_alternative<Error>(*value)) {
+      return get<Error>(*value);
+    }
+  }
+
+  // at least one slot is left for normal requests
+  int maxAll = get<int>(maxInFlight);
+  int maxNormal = maxAll - min(get<int>(reserved), max(maxAll - 1, 0));
+  sMaxInFlight = maxAll;
+  sMaxNormal = maxNormal;
+  sMaxDebug = get<int>(maxDebug);
+  sRetryAfter = get<int>(retryAfter);
+  return nullopt;
+}
+
+size_t AdmissionControl::maxAdmitted() {
+  int maxInFlight = sMaxInFlight.load(memory_order_relaxed);
+  int maxDebug = sMaxDebug.load(memory_order_relaxed);
+  if (maxInFlight == 0 || maxDebug == 0) {
+    return 0;
+  }
+  return static_cast<size_t>(maxInFlight + maxDebug);
+}
+
+AdmissionTicket AdmissionControl::admit(RequestLane lane) {
+  if (lane == RequestLane::Debug) {
+    return admitDebug();
+  }
+
+  int limit = lane == RequestLane::Normal
+                  ? sMaxNormal.load(memory_order_relaxed)
+                  : sMaxInFlight.load(memory_order_relaxed);
+  int current = sInFlight.fetch_add(1, memory_order_relaxed) + 1;
+  if (limit == 0) {
+    return AdmissionTicket(true, lane);
+  }
+  if (current > limit) {
+    sInFlight.fetch_sub(1, memory_order_relaxed);
+    sRejected.fetch_add(1, memory_order_relaxed);
+    return AdmissionTicket(false, lane);
+  }
+  return AdmissionTicket(true, lane);
+}
+
+AdmissionTicket AdmissionControl::admitDebug() {
+  int maxDebug = sMaxDebug.load(memory_order_relaxed);
+  int current = sDebugInFlight.fetch_add(1, memory_order_relaxed) + 1;
+  if (maxDebug != 0 && current > maxDebug) {
+    sDebugInFlight.fetch_sub(1, memory_order_relaxed);
+    sRejected.fetch_add(1, memory_order_relaxed);
+    return AdmissionTicket(false, RequestLane::Debug);
+  }
+  return AdmissionTicket(true, RequestLane::Debug);
+}
+
+int AdmissionControl::configuredRetryAfter() {
+  return sRetryAfter.load(memory_order_relaxed);
+}
+
+AdmissionControl::Stats AdmissionControl::stats() {
+  return {
+      static_cast<size_t>(max(sInFlight.load(memory_order_relaxed), 0)),
+      static_cast<size_t>(max(sDebugInFlight.load(memory_order_relaxed), 0)),
+      sRejected.load(memory_order_relaxed)};
+}
+
+void AdmissionControl::release(RequestLane lane) {
+  if (lane == RequestLane::Debug) {
+    sDebugInFlight.fetch_sub(1, memory_order_relaxed);
+  } else {
+    sInFlight.fetch_sub(1, memory_order_relaxed);
+  }
+}
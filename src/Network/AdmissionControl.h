@@ -0,0 +1,116 @@
+/*****************************************************************************/
+/**
+ * @file    AdmissionControl.h
+ * @author  Team Server
+ * @brief   Definition of class AdmissionControl
+ */
+/*****************************************************************************/
+
+#ifndef _ADMISSION_CONTROL_H_
+#define _ADMISSION_CONTROL_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "RestRouter.h"
+#include "Types/Result.h"
+
+/**
+ * @class AdmissionTicket
+ * @brief Occupies a slot of the in-flight budget until it is destroyed.
+ * @details A rejected request gets an empty ticket, which converts to false.
+ */
+class AdmissionTicket {
+ public:
+  AdmissionTicket() = default;
+  AdmissionTicket(AdmissionTicket &&other) noexcept;
+  AdmissionTicket &operator=(AdmissionTicket &&other) noexcept;
+  AdmissionTicket(AdmissionTicket const &) = delete;
+  AdmissionTicket &operator=(AdmissionTicket const &) = delete;
+  ~AdmissionTicket();
+
+  explicit operator bool() const {
+    return mAdmitted;
+  }
+
+ private:
+  friend class AdmissionControl;
+  AdmissionTicket(bool admitted, RequestLane lane)
+      : mAdmitted(admitted), mLane(lane) {
+  }
+
+  bool mAdmitted = false;
+  RequestLane mLane = RequestLane::Normal;
+};
+
+/**
+ * @class AdmissionControl
+ * @brief Bounds the number of requests handled at the same time.
+ * @details Requests exceeding the budget (key `maxInFlightRequests` of section
+ * `RestAPI`, 0 = unlimited) are rejected right away instead of waiting for
+ * the listener, so a storm of votes is answered with cheap 503s while the
+ * requests already admitted finish.
+ *
+ * Part of the budget (key `reservedControlRequests`) is reserved for the
+ * `Control` lane, i.e. the endpoints controlling the player and the admin
+ * queue. Normal requests never occupy these slots, hence the player stays
+ * controllable at any load.
+ *
+ * Requests of the `Debug` lane (monitoring and profiling) are not part of
+ * this budget but have a budget of their own (key `maxDebugRequests`, 0 =
+ * unlimited), so a scraper or a running profile neither takes capacity from
+ * the other lanes nor gets rejected under load.
+ *
+ * Requests are admitted by the thread handling them, hence the budgets only
+ * hold if every admitted request has a thread of its own: the `perConnection`
+ * mode of `libhttpserver`, or the `epoll` implementation with at least
+ * `maxInFlightRequests` + `maxDebugRequests` handler threads. The budgets are
+ * read by configure() when the server starts.
+ */
+class AdmissionControl {
+ public:
+  /**
+   * @brief Counters of the admission control.
+   */
+  struct Stats {
+    size_t inFlight = 0;       ///< requests of the `Normal` and `Control` lane
+    size_t debugInFlight = 0;  ///< requests of the `Debug` lane
+    uint64_t rejected = 0;
+  };
+
+  /**
+   * @brief Reads the budgets from the configuration.
+   * @details Changes of the configuration take effect with the next call.
+   * Until the first call, the defaults of the keys apply.
+   * @return An error if a budget is not a number or negative.
+   */
+  static TResultOpt configure();
+
+  /**
+   * @brief Returns the number of requests which may be admitted at the same
+   * time over all lanes, or 0 if this is unlimited.
+   */
+  static size_t maxAdmitted();
+
+  /**
+   * @brief Admits a request of the given lane if its budget allows it.
+   * @return A ticket holding the slot of the request, or an empty ticket if
+   * the request has to be rejected.
+   */
+  static AdmissionTicket admit(RequestLane lane);
+
+  /**
+   * @brief Returns the value of the `Retry-After` header of rejected requests
+   * in seconds (key `overloadRetryAfterSeconds`).
+   */
+  static int configuredRetryAfter();
+
+  static Stats stats();
+
+ private:
+  friend class AdmissionTicket;
+  static AdmissionTicket admitDebug();
+  static void release(RequestLane lane);
+};
+
+#endif /* _ADMISSION_CONTROL_H_ */
@@ -0,0 +1,873 @@
+/*****************************************************************************/
+/**
+ * @file    EpollRestAPI.cpp
+ * @author  Team Server
+ * @brief   Implementation of class EpollRestAPI
+ */
+/*****************************************************************************/
+
+#include "EpollRestAPI.h"
+
+#include <glog/logging.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "AdmissionControl.h"
+#include "EventStream.h"
+#include "HttpParser.h"
+#include "ListenSocket.h"
+#include "RestRequestHandler.h"
+#include "Utils/ConfigHandler.h"
+
+using namespace std;
+
+static string const CONFIG_SECTION = "RestAPI";
+
+// maximum size of a request (headers and body)
+static size_t const MAX_REQUEST_SIZE = 1024 * 1024;
+
+// a connection is not read from while this many bytes wait to be sent, which
+// bounds the memory of clients pipelining requests without reading responses
+static size_t const MAX_PENDING_OUTPUT = 4 * 1024 * 1024;
+
+static size_t const RECEIVE_CHUNK_SIZE = 16 * 1024;
+static int const MAX_EVENTS = 64;
+
+/**
+ * @brief Looks up a query parameter of a parsed request.
+ */
+static optional<string> lookupArg(void const *source, string const &key) {
+  auto const &request = *static_cast<HttpRequestView const *>(source);
+  return HttpParser::findQueryParameter(request.query, key);
+}
+
+/**
+ * @brief Looks up a header field of a parsed request.
+ */
+static optional<string> lookupHeader(void const *source, string const &key) {
+  auto value = static_cast<HttpRequestView const *>(source)->header(key);
+  if (value.empty()) {
+    return nullopt;
+  }
+  return string(value);
+}
+
+//
+// HandlerPool
+//
+
+/**
+ * @brief Threads which handle the requests of all event loops.
+ * @details Jobs are run in the order they were submitted. Jobs still waiting
+ * when the pool is destroyed are dropped, running ones are finished.
+ */
+class EpollRestAPI::HandlerPool {
+ public:
+  explicit HandlerPool(int threadCount);
+  ~HandlerPool();
+
+  /**
+   * @brief Runs the job on one of the threads. Thread safe.
+   */
+  void submit(std::function<void()> job);
+
+ private:
+  void run();
+
+  std::mutex mMutex;
+  std::condition_variable mJobAdded;
+  std::deque<std::function<void()>> mJobs;
+  bool mStopped = false;
+  std::vector<std::thread> mThreads;
+};
+
+EpollRestAPI::HandlerPool::HandlerPool(int threadCount) {
+  for (int i = 0; i < threadCount; i++) {
+    mThreads.emplace_back(&HandlerPool::run, this);
+  }
+}
+
+EpollRestAPI::HandlerPool::~HandlerPool() {
+  {
+    unique_lock<mutex> lock(mMutex);
+    mStopped = true;
+  }
+  mJobAdded.notify_all();
+  for (auto &t : mThreads) {
+    t.join();
+  }
+}
+
+void EpollRestAPI::HandlerPool::submit(function<void()> job) {
+  {
+    unique_lock<mutex> lock(mMutex);
+    mJobs.push_back(move(job));
+  }
+  mJobAdded.notify_one();
+}
+
+void EpollRestAPI::HandlerPool::run() {
+  while (true) {
+    function<void()> job;
+    {
+      unique_lock<mutex> lock(mMutex);
+      mJobAdded.wait(lock, [this]() { return mStopped || !mJobs.empty(); });
+      if (mStopped) {
+        return;
+      }
+      job = move(mJobs.front());
+      mJobs.pop_front();
+    }
+    job();
+  }
+}
+
+//
+// EventLoop
+//
+
+/**
+ * @brief Accepts and serves connections of the given listening sockets.
+ * @details The sockets are not owned by the loop and may be shared with other
+ * loops.
+ */
+class EpollRestAPI::EventLoop {
+ public:
+  EventLoop(NetworkListener *listener,
+            std::vector<int> listenFds,
+            HandlerPool *handlers);
+  ~EventLoop();
+
+  /**
+   * @brief Creates the epoll instance and registers the listening sockets.
+   */
+  TResultOpt open();
+
+  /**
+   * @brief Serves connections until `stop` is called.
+   */
+  void run();
+
+  /**
+   * @brief Wakes up the loop and makes `run` return. Thread safe.
+   */
+  void stop();
+
+ private:
+  struct Connection : std::enable_shared_from_this<Connection> {
+    int fd;  ///< -1 once the connection is closed
+    uint32_t events = EPOLLIN;  ///< events the connection is registered for
+    std::string input;
+    std::string output;
+    size_t written = 0;                    ///< bytes of `output` sent already
+    std::shared_ptr<FileBody const> file;  ///< body sent after `output`
+    size_t fileOffset = 0;                 ///< bytes of `file` sent already
+    bool peerClosed = false;
+    bool closeAfterWrite = false;
+    bool deferred = false;    ///< requests wait until the output is sent
+    bool busy = false;        ///< `request` is handled by the pool
+    HttpRequestView request;  ///< reused by all requests of the connection
+    std::shared_ptr<StreamBody> stream;  ///< sent once the output is empty
+
+    size_t pendingOutput() const {
+      return output.size() - written + (file ? file->size - fileOffset : 0);
+    }
+  };
+
+  /**
+   * @brief Response of the pool to the request of a connection.
+   */
+  struct Completion {
+    std::shared_ptr<Connection> conn;
+    ResponseInformation response;
+  };
+
+  void wake();
+  void acceptConnections(int listenFd);
+  void handleEvents(Connection &conn, uint32_t events);
+  void handleCompletions();
+  void handleStreams();
+  void serve(Connection &conn);
+  bool receive(Connection &conn);
+  void processRequests(Connection &conn);
+  void submit(Connection &conn);
+  ResponseInformation dispatch(HttpRequestView const &request);
+  void writeResponse(Connection &conn,
+                     ResponseInformation &&response,
+                     bool headOnly);
+  void openStream(Connection &conn, ResponseInformation &&response);
+  void writeStream(Connection &conn);
+  bool flush(Connection &conn);
+  void updateEvents(Connection &conn);
+  void closeConnection(Connection &conn);
+
+  NetworkListener *mListener;
+  std::vector<int> mListenFds;
+  HandlerPool *mHandlers;
+  int mEpollFd = -1;
+  int mWakeFd = -1;  ///< signals completions and the stop request
+  std::atomic<bool> mStopRequested{false};
+  std::unordered_map<int, std::shared_ptr<Connection>> mConnections;
+
+  std::mutex mCompletionMutex;
+  std::vector<Completion> mCompletions;
+  std::vector<std::weak_ptr<Connection>> mReadyStreams;
+};
+
+EpollRestAPI::EventLoop::EventLoop(NetworkListener *listener,
+                                   vector<int> listenFds,
+                                   HandlerPool *handlers)
+    : mListener(listener), mListenFds(move(listenFds)), mHandlers(handlers) {
+}
+
+EpollRestAPI::EventLoop::~EventLoop() {
+  for (auto const &[fd, conn] : mConnections) {
+    // closing the stream stops its ready handler, which refers to the loop
+    conn->stream = nullptr;
+    close(fd);
+  }
+  if (mEpollFd >= 0) {
+    close(mEpollFd);
+  }
+  if (mWakeFd >= 0) {
+    close(mWakeFd);
+  }
+}
+
+TResultOpt EpollRestAPI::EventLoop::open() {
+  mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+  mWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (mEpollFd < 0 || mWakeFd < 0) {
+    return Error(ErrorCode::NotInitialized,
+                 string("EpollRestAPI: epoll failed: ") + strerror(errno));
+  }
+
+  auto fds = mListenFds;
+  fds.push_back(mWakeFd);
+  for (int fd : fds) {
+    // a connection to a shared socket wakes up only one of the loops
+    epoll_event event = {};
+    event.events = (fd == mWakeFd) ? EPOLLIN : (EPOLLIN | EPOLLEXCLUSIVE);
+    event.data.fd = fd;
+    if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+      return Error(ErrorCode::NotInitialized,
+                   string("EpollRestAPI: epoll failed: ") + strerror(errno));
+    }
+  }
+  return nullopt;
+}
+
+void EpollRestAPI::EventLoop::run() {
+  epoll_event events[MAX_EVENTS];
+  bool running = true;
+  while (running) {
+    int count = epoll_wait(mEpollFd, events, MAX_EVENTS, -1);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG(ERROR) << "EpollRestAPI: epoll_wait failed: " << strerror(errno);
+      break;
+    }
+
+    for (int i = 0; i < count; i++) {
+      int fd = events[i].data.fd;
+      if (fd == mWakeFd) {
+        uint64_t count;
+        if (read(mWakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+          LOG(ERROR) << "EpollRestAPI: Failed to read eventfd";
+        }
+        running = !mStopRequested;
+        handleCompletions();
+        handleStreams();
+      } else if (find(mListenFds.begin(), mListenFds.end(), fd) !=
+                 mListenFds.end()) {
+        acceptConnections(fd);
+      } else {
+        auto it = mConnections.find(fd);
+        if (it != mConnections.end()) {
+          handleEvents(*it->second, events[i].events);
+        }
+      }
+    }
+  }
+}
+
+void EpollRestAPI::EventLoop::stop() {
+  mStopRequested = true;
+  wake();
+}
+
+void EpollRestAPI::EventLoop::wake() {
+  uint64_t one = 1;
+  if (write(mWakeFd, &one, sizeof(one)) < 0) {
+    LOG(ERROR) << "EpollRestAPI: Failed to wake up event loop";
+  }
+}
+
+void EpollRestAPI::EventLoop::acceptConnections(int listenFd) {
+  while (true) {
+    int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        LOG(WARNING) << "EpollRestAPI: accept failed: " << strerror(errno);
+      }
+      return;
+    }
+
+    // responses are written at once, don't delay them (fails harmlessly on
+    // Unix domain sockets)
+    int enable = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+      LOG(WARNING) << "EpollRestAPI: epoll_ctl failed: " << strerror(errno);
+      close(fd);
+      continue;
+    }
+    auto conn = make_shared<Connection>();
+    conn->fd = fd;
+    mConnections.emplace(fd, move(conn));
+  }
+}
+
+void EpollRestAPI::EventLoop::handleEvents(Connection &conn, uint32_t events) {
+  // the client of a stream does not send requests anymore, reading shows
+  // whether it closed the connection
+  if (conn.stream) {
+    if ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) &&
+        (!receive(conn) || conn.peerClosed)) {
+      closeConnection(conn);
+      return;
+    }
+    conn.input.clear();
+    writeStream(conn);
+    return;
+  }
+
+  // the input is used by a handler thread, only the output is sent meanwhile
+  if (conn.busy) {
+    if ((events & (EPOLLHUP | EPOLLERR)) || !flush(conn)) {
+      closeConnection(conn);
+      return;
+    }
+    updateEvents(conn);
+    return;
+  }
+
+  if ((events & EPOLLIN) || (events & (EPOLLHUP | EPOLLERR))) {
+    if (!receive(conn)) {
+      closeConnection(conn);
+      return;
+    }
+  }
+  serve(conn);
+}
+
+void EpollRestAPI::EventLoop::handleCompletions() {
+  vector<Completion> completions;
+  {
+    unique_lock<mutex> lock(mCompletionMutex);
+    swap(completions, mCompletions);
+  }
+
+  for (auto &completion : completions) {
+    Connection &conn = *completion.conn;
+    conn.busy = false;
+    // closed while the request was handled
+    if (conn.fd < 0) {
+      continue;
+    }
+    if (completion.response.stream) {
+      openStream(conn, move(completion.response));
+      continue;
+    }
+
+    conn.closeAfterWrite = !conn.request.keepAlive;
+    bool headOnly = (conn.request.method == "HEAD");
+    conn.input.erase(0, conn.request.size);
+    writeResponse(conn, move(completion.response), headOnly);
+    serve(conn);
+  }
+}
+
+void EpollRestAPI::EventLoop::handleStreams() {
+  vector<weak_ptr<Connection>> readyStreams;
+  {
+    unique_lock<mutex> lock(mCompletionMutex);
+    swap(readyStreams, mReadyStreams);
+  }
+
+  for (auto const &weakConn : readyStreams) {
+    auto conn = weakConn.lock();
+    // closed since the stream became ready
+    if (!conn || conn->fd < 0) {
+      continue;
+    }
+    writeStream(*conn);
+  }
+}
+
+void EpollRestAPI::EventLoop::serve(Connection &conn) {
+  // also continues with requests left over while the output was full, as
+  // long as the socket takes all of it
+  do {
+    processRequests(conn);
+    if (!flush(conn)) {
+      closeConnection(conn);
+      return;
+    }
+  } while (conn.deferred && conn.pendingOutput() == 0);
+  if (conn.closeAfterWrite && conn.pendingOutput() == 0) {
+    closeConnection(conn);
+    return;
+  }
+  updateEvents(conn);
+}
+
+bool EpollRestAPI::EventLoop::receive(Connection &conn) {
+  // a single request never exceeds the limit, more is read after processing
+  while (!conn.peerClosed && conn.input.size() < MAX_REQUEST_SIZE) {
+    size_t size = conn.input.size();
+    conn.input.resize(size + RECEIVE_CHUNK_SIZE);
+    auto received = recv(conn.fd, &conn.input[size], RECEIVE_CHUNK_SIZE, 0);
+    conn.input.resize(size + max<ssize_t>(received, 0));
+
+    if (received > 0) {
+      continue;
+    }
+    if (received == 0) {
+      // answer the requests received so far before closing
+      conn.peerClosed = true;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      break;
+    } else if (errno != EINTR) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void EpollRestAPI::EventLoop::processRequests(Connection &conn) {
+  conn.deferred = false;
+  while (!conn.closeAfterWrite && !conn.busy) {
+    // the next response has to wait for a file body, which is not buffered
+    if (conn.pendingOutput() >= MAX_PENDING_OUTPUT || conn.file) {
+      conn.deferred = !conn.input.empty();
+      break;
+    }
+    auto result =
+        HttpParser::parse(conn.input, conn.request, MAX_REQUEST_SIZE);
+    if (result == HttpParseResult::Incomplete) {
+      break;
+    }
+    if (result == HttpParseResult::Complete) {
+      // the request is removed from the input once its response is back
+      submit(conn);
+      break;
+    }
+
+    int code = (result == HttpParseResult::TooLarge)         ? 413
+               : (result == HttpParseResult::NotImplemented) ? 501
+                                                             : 400;
+    conn.closeAfterWrite = true;
+    writeResponse(conn, {string(HttpParser::reasonPhrase(code)), code}, false);
+  }
+
+  if (conn.busy) {
+    return;
+  }
+  if (conn.peerClosed) {
+    conn.closeAfterWrite = true;
+  }
+  if (conn.closeAfterWrite) {
+    conn.input.clear();
+  }
+}
+
+void EpollRestAPI::EventLoop::submit(Connection &conn) {
+  conn.busy = true;
+  mHandlers->submit([this, conn = conn.shared_from_this()]() {
+    Completion completion{conn, dispatch(conn->request)};
+    bool wasEmpty;
+    {
+      unique_lock<mutex> lock(mCompletionMutex);
+      wasEmpty = mCompletions.empty();
+      mCompletions.push_back(move(completion));
+    }
+    // the loop takes all completions at once when woken up
+    if (wasEmpty) {
+      wake();
+    }
+  });
+}
+
+ResponseInformation EpollRestAPI::EventLoop::dispatch(
+    HttpRequestView const &request) {
+  // the request refers to the receive buffer, only escaped paths are copied
+  string decodedPath;
+  string_view path = request.path;
+  if (path.find('%') != string_view::npos) {
+    decodedPath = HttpParser::decode(path);
+    path = decodedPath;
+  }
+  RequestInformation infos{path,                                   //
+                           request.method,                         //
+                           request.body,                           //
+                           RequestArgs(&request, lookupArg),       //
+                           RequestHeaders(&request, lookupHeader)  //
+  };
+
+  // libhttpserver answers with its internal error resource in this case
+  try {
+    return RestRequestHandler::decodeAndDispatch(mListener, move(infos));
+  } catch (...) {
+    return RestRequestHandler::internalErrorResponse(
+        path, request.method, request.body);
+  }
+}
+
+void EpollRestAPI::EventLoop::writeResponse(Connection &conn,
+                                            ResponseInformation &&response,
+                                            bool headOnly) {
+  // responses to HEAD requests have the length of the body, but none
+  HttpParser::writeResponseHead(
+      conn.output,
+      response.code,
+      response.headers,
+      response.file ? response.file->size : response.body.size(),
+      !conn.closeAfterWrite);
+  if (!headOnly && HttpParser::allowsBody(response.code)) {
+    conn.output += response.body;
+    conn.file = move(response.file);
+  }
+}
+
+void EpollRestAPI::EventLoop::openStream(Connection &conn,
+                                         ResponseInformation &&response) {
+  // the responses to preceding requests are sent first, the stream is ended
+  // by closing the connection
+  HttpParser::writeResponseHead(
+      conn.output, response.code, response.headers, nullopt, false);
+  conn.input.clear();
+  conn.stream = move(response.stream);
+
+  // the stream is ready from another thread, which passes it to the loop
+  // like a completion
+  conn.stream->setReadyHandler(
+      [this, weakConn = weak_ptr<Connection>(conn.shared_from_this())]() {
+        bool wasEmpty;
+        {
+          unique_lock<mutex> lock(mCompletionMutex);
+          wasEmpty = mCompletions.empty() && mReadyStreams.empty();
+          mReadyStreams.push_back(weakConn);
+        }
+        if (wasEmpty) {
+          wake();
+        }
+      });
+  writeStream(conn);
+}
+
+void EpollRestAPI::EventLoop::writeStream(Connection &conn) {
+  // the next event is taken once the previous one is sent, meanwhile the
+  // stream replaces it by newer ones
+  if (!flush(conn)) {
+    closeConnection(conn);
+    return;
+  }
+  if (conn.pendingOutput() == 0 && !conn.closeAfterWrite) {
+    conn.closeAfterWrite = !conn.stream->poll(conn.output);
+    if (!flush(conn)) {
+      closeConnection(conn);
+      return;
+    }
+  }
+  if (conn.closeAfterWrite && conn.pendingOutput() == 0) {
+    closeConnection(conn);
+    return;
+  }
+  updateEvents(conn);
+}
+
+bool EpollRestAPI::EventLoop::flush(Connection &conn) {
+  while (conn.written < conn.output.size()) {
+    auto sent = send(conn.fd,
+                     conn.output.data() + conn.written,
+                     conn.output.size() - conn.written,
+                     MSG_NOSIGNAL);
+    if (sent < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    conn.written += sent;
+  }
+  conn.output.clear();
+  conn.written = 0;
+
+  // the file is sent by the kernel, without copying it into the output
+  while (conn.file && conn.fileOffset < conn.file->size) {
+    off_t offset = conn.fileOffset;
+    auto sent = sendfile(
+        conn.fd, conn.file->fd, &offset, conn.file->size - conn.fileOffset);
+    if (sent < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    if (sent == 0) {
+      // the file was truncated, the promised length can not be sent anymore
+      return false;
+    }
+    conn.fileOffset = offset;
+  }
+  conn.file = nullptr;
+  conn.fileOffset = 0;
+  return true;
+}
+
+void EpollRestAPI::EventLoop::updateEvents(Connection &conn) {
+  uint32_t events = 0;
+  if (conn.pendingOutput() > 0) {
+    events |= EPOLLOUT;
+  }
+  if (!conn.busy && !conn.closeAfterWrite &&
+      conn.pendingOutput() < MAX_PENDING_OUTPUT) {
+    events |= EPOLLIN;
+  }
+  if (events != conn.events) {
+    epoll_event event = {};
+    event.events = events;
+    event.data.fd = conn.fd;
+    epoll_ctl(mEpollFd, EPOLL_CTL_MOD, conn.fd, &event);
+    conn.events = events;
+  }
+}
+
+void EpollRestAPI::EventLoop::closeConnection(Connection &conn) {
+  // a handler may still refer to the connection, which is dropped once its
+  // response is back
+  conn.stream = nullptr;
+  int fd = conn.fd;
+  epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, nullptr);
+  close(fd);
+  conn.fd = -1;
+  mConnections.erase(fd);
+}
+
+//
+// EpollRestAPI
+//
+
+EpollRestAPI::EpollRestAPI() = default;
+
+EpollRestAPI::~EpollRestAPI() = default;
+
+TResultOpt EpollRestAPI::handleRequests() {
+  auto configHandler = ConfigHandler::getInstance();
+
+  TResult<int> configPort = configHandler->getValueInt(CONFIG_SECTION, "port");
+  if (holds_alternative<Error>(configPort)) {
+    return get<Error>(configPort);
+  }
+  int port = get<int>(configPort);
+  if (port < 0 || port > 65535) {
+    return Error(ErrorCode::InvalidValue,
+                 "EpollRestAPI.handleRequests: Port value is out of range");
+  }
+
+  auto configUnixPath = ListenSocket::configuredUnixPath();
+  if (holds_alternative<Error>(configUnixPath)) {
+    return get<Error>(configUnixPath);
+  }
+  string unixPath = get<string>(configUnixPath);
+  if (port == 0 && unixPath.empty()) {
+    return Error(ErrorCode::InvalidValue,
+                 "EpollRestAPI.handleRequests: Neither a port nor a Unix "
+                 "socket is configured");
+  }
+
+  auto configResult = RestRequestHandler::configure();
+  if (configResult.has_value()) {
+    return configResult;
+  }
+
+  auto configWorkers =
+      configHandler->getValueInt(CONFIG_SECTION, "workerThreads", 0);
+  if (holds_alternative<Error>(configWorkers)) {
+    return get<Error>(configWorkers);
+  }
+
+  // a value of 0 selects one event loop per CPU core
+  int workers = get<int>(configWorkers);
+  if (workers < 0) {
+    return Error(
+        ErrorCode::InvalidValue,
+        "EpollRestAPI.handleRequests: workerThreads must not be negative");
+  }
+  if (workers == 0) {
+    workers = max(1u, thread::hardware_concurrency());
+  }
+
+  auto configHandlers =
+      configHandler->getValueInt(CONFIG_SECTION, "handlerThreads", 0);
+  if (holds_alternative<Error>(configHandlers)) {
+    return get<Error>(configHandlers);
+  }
+
+  // handlers mostly wait for the backend, a value of 0 selects four of them
+  // per CPU core
+  int handlerCount = get<int>(configHandlers);
+  if (handlerCount < 0) {
+    return Error(
+        ErrorCode::InvalidValue,
+        "EpollRestAPI.handleRequests: handlerThreads must not be negative");
+  }
+  // requests are admitted by their handler, every admitted request needs a
+  // handler of its own, or requests of the reserved lane wait behind them
+  int admitted = static_cast<int>(AdmissionControl::maxAdmitted());
+  if (handlerCount == 0) {
+    handlerCount = max<int>(4 * max(1u, thread::hardware_concurrency()),
+                            admitted);
+  } else if (handlerCount < admitted) {
+    return Error(ErrorCode::InvalidValue,
+                 "EpollRestAPI.handleRequests: handlerThreads must be at least "
+                 "maxInFlightRequests + maxDebugRequests (" +
+                     to_string(admitted) + ")");
+  }
+
+  // the loops pass their requests to the pool, which has to outlive them
+  auto handlers = make_unique<HandlerPool>(handlerCount);
+  auto result = openListeners(port, unixPath, workers, handlers.get());
+  if (result.has_value()) {
+    closeListeners();
+    return result;
+  }
+  {
+    // stopped before the loops were running
+    unique_lock<mutex> lock(mMutex);
+    if (mStopRequested) {
+      mStopRequested = false;
+      mLoops.clear();
+      closeListeners();
+      return nullopt;
+    }
+  }
+
+  LOG(INFO) << "EpollRestAPI: Using " << workers << " event loops and "
+            << handlerCount << " handler threads";
+
+  // run in blocking mode, like RestAPI
+  vector<thread> threads;
+  for (size_t i = 1; i < mLoops.size(); i++) {
+    threads.emplace_back(&EventLoop::run, mLoops[i].get());
+  }
+  mLoops[0]->run();
+  for (auto &t : threads) {
+    t.join();
+  }
+  // running handlers pass their responses to the (stopped) loops
+  handlers = nullptr;
+
+  {
+    unique_lock<mutex> lock(mMutex);
+    mLoops.clear();
+    mStopRequested = false;
+    closeListeners();
+  }
+  // the streams were closed with the connections of the loops, but a stream
+  // opened while stopping may have started the notifier again
+  EventStream::closeAll();
+  return nullopt;
+}
+
+TResultOpt EpollRestAPI::openListeners(int port,
+                                       string const &unixPath,
+                                       int loopCount,
+                                       HandlerPool *handlers) {
+  // the Unix domain socket is shared by all loops, since the kernel does not
+  // distribute its connections among several sockets
+  if (!unixPath.empty()) {
+    auto unixFd = ListenSocket::openUnix(unixPath);
+    if (holds_alternative<Error>(unixFd)) {
+      return get<Error>(unixFd);
+    }
+    mUnixFd = get<int>(unixFd);
+    mUnixPath = unixPath;
+    LOG(INFO) << "EpollRestAPI: Listening at '" << unixPath << "'";
+  }
+
+  vector<unique_ptr<EventLoop>> loops;
+  for (int i = 0; i < loopCount; i++) {
+    vector<int> listenFds;
+    if (port > 0) {
+      auto tcpFd = ListenSocket::openTcp(port, true);
+      if (holds_alternative<Error>(tcpFd)) {
+        return get<Error>(tcpFd);
+      }
+      mTcpFds.push_back(get<int>(tcpFd));
+      listenFds.push_back(get<int>(tcpFd));
+    }
+    if (mUnixFd >= 0) {
+      listenFds.push_back(mUnixFd);
+    }
+
+    loops.push_back(
+        make_unique<EventLoop>(listener, move(listenFds), handlers));
+    auto result = loops.back()->open();
+    if (result.has_value()) {
+      return result;
+    }
+  }
+
+  unique_lock<mutex> lock(mMutex);
+  mLoops = move(loops);
+  return nullopt;
+}
+
+void EpollRestAPI::closeListeners() {
+  for (int fd : mTcpFds) {
+    close(fd);
+  }
+  mTcpFds.clear();
+  if (mUnixFd >= 0) {
+    ListenSocket::closeUnix(mUnixFd, mUnixPath);
+    mUnixFd = -1;
+  }
+}
+
+void EpollRestAPI::stopServer() {
+  // open event streams end before their connections are closed
+  EventStream::closeAll();
+
+  unique_lock<mutex> lock(mMutex);
+  mStopRequested = true;
+  for (auto const &loop : mLoops) {
+    loop->stop();
+  }
+}
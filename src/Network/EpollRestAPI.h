@@ -0,0 +1,79 @@
+/*****************************************************************************/
+/**
+ * @file    EpollRestAPI.h
+ * @author  Team Server
+ * @brief   Definition of class EpollRestAPI
+ */
+/*****************************************************************************/
+
+#ifndef _EPOLL_REST_API_H_
+#define _EPOLL_REST_API_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "NetworkAPI.h"
+
+/**
+ * @class EpollRestAPI
+ * @brief Implementation of the REST API on top of epoll, without libhttpserver.
+ * @details Runs one event loop per worker thread. Each loop has a listening
+ * socket of its own, bound to the same port with `SO_REUSEPORT`, so the kernel
+ * distributes new connections among the loops and no connection is ever
+ * touched by more than one thread.
+ *
+ * Besides the TCP port, the server can listen on a Unix domain socket (key
+ * `unixSocket`), e.g. for a reverse proxy on the same host. Its connections
+ * are accepted by whichever loop is woken up first. Setting `port` to 0
+ * disables the TCP socket.
+ *
+ * Connections are kept alive and pipelined requests are answered in order.
+ * Requests are parsed in place in the receive buffer of their connection and
+ * dispatched through `RestRequestHandler::decodeAndDispatch`, like the
+ * requests of `RestAPI`.
+ *
+ * The loops only do the I/O. Requests are handled by a pool of handler
+ * threads (key `handlerThreads`), so a slow request (e.g. a search at
+ * Spotify) does not stall the other connections of its loop. The handler
+ * passes the response back to the loop of the connection and wakes it up by
+ * its eventfd. Each connection has at most one request in the pool, which
+ * keeps the responses to pipelined requests in order and the receive buffer
+ * unchanged while the request refers to it.
+ *
+ * Streamed responses (event streams) stay in the loop of their connection.
+ * The stream tells the loop when more of it is available, which takes it
+ * once the previous part is sent. The connection is closed when the stream
+ * ends, at the latest when the server is stopped.
+ *
+ * @sa    NetworkAPI, RestAPI
+ */
+class EpollRestAPI : public NetworkAPI {
+ public:
+  EpollRestAPI();
+  ~EpollRestAPI() override;
+
+  TResultOpt handleRequests() override;
+  void stopServer() override;
+
+ private:
+  class EventLoop;
+  class HandlerPool;
+
+  TResultOpt openListeners(int port,
+                           std::string const &unixPath,
+                           int loopCount,
+                           HandlerPool *handlers);
+  void closeListeners();
+
+  std::mutex mMutex;
+  bool mStopRequested = false;
+  std::vector<std::unique_ptr<EventLoop>> mLoops;
+
+  std::vector<int> mTcpFds;  ///< one per loop
+  int mUnixFd = -1;          ///< shared by all loops
+  std::string mUnixPath;
+};
+
+#endif /* _EPOLL_REST_API_H_ */
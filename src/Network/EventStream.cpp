@@ -0,0 +1,540 @@
+/*****************************************************************************/
+/**
+ * @file    EventStream.cpp
+ * @author  Team Server
+ * @brief   Implementation of class EventStream
+ */
+/*****************************************************************************/
+
+#include "EventStream.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "SerializedQueueCache.h"
+#include "Utils/ConfigHandler.h"
+#include "Utils/JsonWriter.h"
+#include "Utils/Serializer.h"
+
+using namespace std;
+using namespace std::chrono;
+
+static string const CONFIG_SECTION = "RestAPI";
+
+// comments keep proxies from closing idle connections
+static auto const KEEP_ALIVE_EVENT =
+    make_shared<string const>(": keep-alive\n\n");
+
+/**
+ * @brief The state of a stream, shared by the stream and the notifier.
+ */
+struct EventSubscriber {
+  EventSubscriber(NetworkListener *listener,
+                  TSessionID const &sid,
+                  milliseconds retryInterval,
+                  seconds keepAliveInterval)
+      : mListener(listener),
+        mSessionId(sid),
+        mRetryInterval(retryInterval),
+        mKeepAliveInterval(keepAliveInterval),
+        mLastEvent(steady_clock::now()) {
+    assert(listener);
+  }
+
+  /**
+   * @brief Replaces the event waiting to be taken and wakes up the reader.
+   * @param version The state of the client once the event is sent.
+   */
+  void offer(shared_ptr<string const> event, QueueStatusVersion version);
+
+  /**
+   * @brief Closes the stream and wakes up the reader.
+   */
+  void close();
+
+  /**
+   * @brief Appends the event waiting to be taken (if any) to `out`.
+   * @details Must be called with `mMutex` locked.
+   * @return `false` once the stream is closed.
+   */
+  bool take(string &out);
+
+  NetworkListener *const mListener;
+  TSessionID const mSessionId;
+  milliseconds const mRetryInterval;
+  seconds const mKeepAliveInterval;
+
+  // used by the notifier only
+  steady_clock::time_point mLastEvent;
+  optional<uint64_t> mVotesVersion;  ///< version of `mVotedTracks`
+  unordered_set<TTrackID> mVotedTracks;
+
+  // shared with the reader of the stream
+  mutex mMutex;
+  condition_variable mReady;
+  bool mClosed = false;
+  optional<QueueStatusVersion> mSentVersion;  ///< state of the client
+  shared_ptr<string const> mEvent;            ///< latest event not taken yet
+  QueueStatusVersion mEventVersion = {};      ///< state after `mEvent`
+  function<void()> mReadyHandler;
+};
+
+/**
+ * @brief The queues and the current track of a version, shared by all
+ * streams.
+ * @details Used by the notifier only, which keeps the latest one. The events
+ * are built on first use.
+ */
+struct Snapshot {
+  NetworkListener *listener;
+  uint64_t queueVersion;
+  uint64_t playbackVersion;
+  QueueStatus queueStatus;
+  optional<Error> error;  ///< kept for the current round of the notifier
+  shared_ptr<string const> queuesEvent;  ///< without any vote of the user
+  shared_ptr<string const> playbackEvent;
+};
+
+// state shared by all streams
+static mutex sMutex;
+static condition_variable sChanged;  ///< wakes up the notifier
+static uint64_t sChanges = 0;
+static uint64_t sClosedGeneration = 0;
+static vector<shared_ptr<EventSubscriber>> sSubscribers;
+
+/**
+ * @brief The thread building the events of all streams.
+ * @details Is started with the first stream and stopped by `closeAll`, or at
+ * exit at the latest.
+ */
+static struct NotifierThread {
+  ~NotifierThread() {
+    EventStream::closeAll();
+  }
+
+  thread notifier;
+} sNotifier;
+
+void EventSubscriber::offer(shared_ptr<string const> event,
+                            QueueStatusVersion version) {
+  unique_lock<mutex> lock(mMutex);
+  if (mClosed) {
+    return;
+  }
+  mEvent = move(event);
+  mEventVersion = version;
+  mReady.notify_all();
+  if (mReadyHandler) {
+    mReadyHandler();
+  }
+}
+
+void EventSubscriber::close() {
+  unique_lock<mutex> lock(mMutex);
+  mClosed = true;
+  mReady.notify_all();
+  if (mReadyHandler) {
+    mReadyHandler();
+  }
+}
+
+bool EventSubscriber::take(string &out) {
+  if (mClosed) {
+    return false;
+  }
+  if (mEvent) {
+    out += *mEvent;
+    mEvent = nullptr;
+    mSentVersion = mEventVersion;
+  }
+  return true;
+}
+
+static bool sameVersion(QueueStatusVersion const &a,
+                        QueueStatusVersion const &b) {
+  return a.queueVersion == b.queueVersion &&
+         a.playbackVersion == b.playbackVersion &&
+         a.votesVersion == b.votesVersion;
+}
+
+/**
+ * @brief Returns an event with a single data line.
+ * @details The serialized JSON contains no line breaks.
+ */
+static shared_ptr<string const> makeEvent(string const &name,
+                                          string const &data) {
+  return make_shared<string const>("event: " + name + "\ndata: " + data +
+                                   "\n\n");
+}
+
+/**
+ * @brief Makes `snapshot` hold the queues and the current track of the given
+ * version.
+ * @details Collects only the current track if the queues did not change.
+ */
+static TResultOpt updateSnapshot(optional<Snapshot> &snapshot,
+                                 EventSubscriber const &subscriber,
+                                 QueueStatusVersion const &version) {
+  bool sameQueues = snapshot.has_value() &&
+                    snapshot->listener == subscriber.mListener &&
+                    snapshot->queueVersion == version.queueVersion;
+  if (sameQueues && snapshot->playbackVersion == version.playbackVersion) {
+    return snapshot->error;
+  }
+
+  if (sameQueues && !snapshot->error.has_value()) {
+    auto result = subscriber.mListener->getCurrentPlayback(
+        subscriber.mSessionId);
+    if (holds_alternative<Error>(result)) {
+      snapshot->error = get<Error>(result);
+    } else {
+      snapshot->queueStatus.currentTrack =
+          get<optional<PlaybackTrack>>(result);
+    }
+    snapshot->playbackVersion = version.playbackVersion;
+    snapshot->queuesEvent = nullptr;
+    snapshot->playbackEvent = nullptr;
+    return snapshot->error;
+  }
+
+  auto result = subscriber.mListener->getCurrentQueues(subscriber.mSessionId);
+  snapshot = Snapshot{subscriber.mListener,
+                      version.queueVersion,
+                      version.playbackVersion,
+                      {},
+                      nullopt,
+                      nullptr,
+                      nullptr};
+  if (holds_alternative<Error>(result)) {
+    snapshot->error = get<Error>(result);
+  } else {
+    snapshot->queueStatus = move(get<QueueStatus>(result));
+  }
+  return snapshot->error;
+}
+
+/**
+ * @brief Returns the event of the given version for the subscriber.
+ * @param playbackOnly Only the current track changed since the last event.
+ */
+static TResult<shared_ptr<string const>> buildEvent(
+    EventSubscriber &subscriber,
+    QueueStatusVersion const &version,
+    bool playbackOnly,
+    optional<Snapshot> &snapshot) {
+  auto err = updateSnapshot(snapshot, subscriber, version);
+  if (err.has_value()) {
+    return err.value();
+  }
+  auto const &queueStatus = snapshot->queueStatus;
+
+  if (playbackOnly) {
+    if (!snapshot->playbackEvent) {
+      JsonWriter writer;
+      writer.beginObject().key("currently_playing");
+      if (queueStatus.currentTrack.has_value()) {
+        Serializer::write(writer, queueStatus.currentTrack.value());
+      } else {
+        writer.beginObject().endObject();
+      }
+      writer.endObject();
+      snapshot->playbackEvent = makeEvent("playback", writer.release());
+    }
+    return snapshot->playbackEvent;
+  }
+
+  // the vote flags are the only part which differs between users
+  if (subscriber.mVotesVersion != version.votesVersion) {
+    auto result = subscriber.mListener->getVotedTracks(subscriber.mSessionId);
+    if (holds_alternative<Error>(result)) {
+      return get<Error>(result);
+    }
+    auto const &tracks = get<vector<TTrackID>>(result);
+    subscriber.mVotedTracks =
+        unordered_set<TTrackID>(tracks.begin(), tracks.end());
+    subscriber.mVotesVersion = version.votesVersion;
+  }
+
+  auto const &normalTracks = queueStatus.normalQueue.tracks;
+  vector<bool> votes(normalTracks.size());
+  bool hasVotes = false;
+  for (size_t i = 0; i < normalTracks.size(); i++) {
+    votes[i] = (subscriber.mVotedTracks.count(normalTracks[i].trackId) > 0);
+    hasVotes = hasVotes || votes[i];
+  }
+  if (hasVotes) {
+    return makeEvent("queues",
+                     SerializedQueueCache::serialize(queueStatus, votes));
+  }
+  if (!snapshot->queuesEvent) {
+    snapshot->queuesEvent = makeEvent(
+        "queues", SerializedQueueCache::serialize(queueStatus, votes));
+  }
+  return snapshot->queuesEvent;
+}
+
+/**
+ * @brief Offers the subscriber the event of its current version, unless its
+ * client has it already.
+ * @return The time the next keep-alive comment is due.
+ */
+static steady_clock::time_point updateSubscriber(EventSubscriber &subscriber,
+                                                 optional<Snapshot> &snapshot) {
+  {
+    unique_lock<mutex> lock(subscriber.mMutex);
+    if (subscriber.mClosed) {
+      return steady_clock::time_point::max();
+    }
+  }
+
+  auto versionResult =
+      subscriber.mListener->getCurrentQueuesVersion(subscriber.mSessionId);
+  if (holds_alternative<Error>(versionResult)) {
+    VLOG(1) << "EventStream: Closing stream: "
+            << get<Error>(versionResult).getErrorMessage();
+    subscriber.close();
+    return steady_clock::time_point::max();
+  }
+  auto version = get<QueueStatusVersion>(versionResult);
+
+  // the client has the events taken so far, newer ones include the changes
+  // of the event waiting to be taken
+  optional<QueueStatusVersion> sentVersion;
+  bool hasEvent;
+  bool hasVersion;
+  {
+    unique_lock<mutex> lock(subscriber.mMutex);
+    sentVersion = subscriber.mSentVersion;
+    hasEvent = (subscriber.mEvent != nullptr);
+    hasVersion = hasEvent && sameVersion(subscriber.mEventVersion, version);
+  }
+
+  // only the latest state is sent, intermediate states are skipped
+  optional<bool> playbackOnly;
+  if (!sentVersion.has_value()) {
+    playbackOnly = false;
+  } else if (version.queueVersion != sentVersion->queueVersion ||
+             version.votesVersion != sentVersion->votesVersion) {
+    playbackOnly = false;
+  } else if (version.playbackVersion != sentVersion->playbackVersion) {
+    playbackOnly = true;
+  }
+
+  auto now = steady_clock::now();
+  if (!playbackOnly.has_value() || hasVersion) {
+    auto keepAliveTime = subscriber.mLastEvent + subscriber.mKeepAliveInterval;
+    if (now < keepAliveTime) {
+      return keepAliveTime;
+    }
+    // a pending event shows the connection is busy already
+    if (!hasEvent) {
+      subscriber.offer(KEEP_ALIVE_EVENT, sentVersion.value());
+    }
+    subscriber.mLastEvent = now;
+    return now + subscriber.mKeepAliveInterval;
+  }
+
+  auto eventResult =
+      buildEvent(subscriber, version, playbackOnly.value(), snapshot);
+  if (holds_alternative<Error>(eventResult)) {
+    VLOG(1) << "EventStream: Closing stream: "
+            << get<Error>(eventResult).getErrorMessage();
+    subscriber.close();
+    return steady_clock::time_point::max();
+  }
+  auto event = get<shared_ptr<string const>>(eventResult);
+  if (!sentVersion.has_value()) {
+    // tell the client how long to wait before reconnecting
+    event = make_shared<string const>(
+        "retry: " + to_string(subscriber.mRetryInterval.count()) + "\n" +
+        *event);
+  }
+  subscriber.offer(move(event), version);
+  subscriber.mLastEvent = now;
+  return now + subscriber.mKeepAliveInterval;
+}
+
+/**
+ * @brief Updates all open streams whenever something changed or a keep-alive
+ * comment is due, until the streams of `generation` are closed.
+ */
+static void runNotifier(uint64_t generation) {
+  optional<Snapshot> snapshot;
+  unique_lock<mutex> lock(sMutex);
+  while (sClosedGeneration == generation) {
+    uint64_t seenChanges = sChanges;
+    auto subscribers = sSubscribers;
+    lock.unlock();
+
+    auto nextRound = steady_clock::time_point::max();
+    for (auto const &subscriber : subscribers) {
+      nextRound = min(nextRound, updateSubscriber(*subscriber, snapshot));
+    }
+    // errors are retried in the next round, and without subscribers the
+    // listener of the snapshot may be gone
+    if (subscribers.empty() ||
+        (snapshot.has_value() && snapshot->error.has_value())) {
+      snapshot = nullopt;
+    }
+    subscribers.clear();
+
+    lock.lock();
+    auto changed = [generation, seenChanges]() {
+      return sChanges != seenChanges || sClosedGeneration != generation;
+    };
+    if (nextRound == steady_clock::time_point::max()) {
+      sChanged.wait(lock, changed);
+    } else {
+      sChanged.wait_until(lock, nextRound, changed);
+    }
+  }
+}
+
+EventStream::EventStream(shared_ptr<EventSubscriber> subscriber)
+    : mSubscriber(move(subscriber)) {
+}
+
+EventStream::~EventStream() {
+  {
+    unique_lock<mutex> lock(sMutex);
+    // closed streams were removed by `closeAll` already
+    sSubscribers.erase(
+        remove(sSubscribers.begin(), sSubscribers.end(), mSubscriber),
+        sSubscribers.end());
+    VLOG(1) << "EventStream: Stream closed, " << sSubscribers.size()
+            << " subscribers left";
+  }
+
+  // the notifier may still hold the subscriber, but must not call the reader
+  // anymore
+  unique_lock<mutex> lock(mSubscriber->mMutex);
+  mSubscriber->mClosed = true;
+  mSubscriber->mReadyHandler = nullptr;
+}
+
+TResult<shared_ptr<EventStream>> EventStream::subscribe(
+    NetworkListener *listener, TSessionID const &sid) {
+  auto configHandler = ConfigHandler::getInstance();
+  auto configMaxSubscribers =
+      configHandler->getValueInt(CONFIG_SECTION, "maxEventSubscribers", 1000);
+  if (holds_alternative<Error>(configMaxSubscribers)) {
+    return get<Error>(configMaxSubscribers);
+  }
+  auto configRetryInterval =
+      configHandler->getValueInt(CONFIG_SECTION, "eventRetryMs", 1000);
+  if (holds_alternative<Error>(configRetryInterval)) {
+    return get<Error>(configRetryInterval);
+  }
+  auto configKeepAlive =
+      configHandler->getValueInt(CONFIG_SECTION, "eventKeepAliveSeconds", 15);
+  if (holds_alternative<Error>(configKeepAlive)) {
+    return get<Error>(configKeepAlive);
+  }
+  if (get<int>(configRetryInterval) <= 0 || get<int>(configKeepAlive) <= 0) {
+    return Error(ErrorCode::InvalidValue,
+                 "EventStream.subscribe: Event intervals must be positive");
+  }
+
+  // reject invalid sessions before the stream is opened
+  auto versionResult = listener->getCurrentQueuesVersion(sid);
+  if (holds_alternative<Error>(versionResult)) {
+    return get<Error>(versionResult);
+  }
+
+  auto subscriber =
+      make_shared<EventSubscriber>(listener,
+                                   sid,
+                                   milliseconds(get<int>(configRetryInterval)),
+                                   seconds(get<int>(configKeepAlive)));
+  {
+    unique_lock<mutex> lock(sMutex);
+    int maxSubscribers = get<int>(configMaxSubscribers);
+    if (maxSubscribers > 0 &&
+        sSubscribers.size() >= static_cast<size_t>(maxSubscribers)) {
+      return Error(ErrorCode::ServiceUnavailable,
+                   "Too many open event streams");
+    }
+    sSubscribers.push_back(subscriber);
+    VLOG(1) << "EventStream: Stream opened, " << sSubscribers.size()
+            << " subscribers in total";
+
+    // the current state is sent right away
+    if (!sNotifier.notifier.joinable()) {
+      sNotifier.notifier = thread(runNotifier, sClosedGeneration);
+    }
+    sChanges++;
+  }
+  sChanged.notify_all();
+
+  return shared_ptr<EventStream>(new EventStream(move(subscriber)));
+}
+
+void EventStream::notifyChange() {
+  {
+    unique_lock<mutex> lock(sMutex);
+    sChanges++;
+  }
+  sChanged.notify_all();
+}
+
+void EventStream::closeAll() {
+  vector<shared_ptr<EventSubscriber>> subscribers;
+  thread notifier;
+  {
+    unique_lock<mutex> lock(sMutex);
+    sClosedGeneration++;
+    // a notifier started afterwards does not see the closed streams
+    subscribers.swap(sSubscribers);
+    notifier = move(sNotifier.notifier);
+  }
+  sChanged.notify_all();
+
+  for (auto const &subscriber : subscribers) {
+    subscriber->close();
+  }
+  // the notifier finishes its current round before it returns
+  if (notifier.joinable()) {
+    notifier.join();
+  }
+}
+
+ssize_t EventStream::produce(char *buffer, size_t maxSize) {
+  if (mPendingOffset >= mPending.size()) {
+    mPending.clear();
+    mPendingOffset = 0;
+
+    unique_lock<mutex> lock(mSubscriber->mMutex);
+    mSubscriber->mReady.wait(lock, [this]() {
+      return mSubscriber->mClosed || mSubscriber->mEvent;
+    });
+    if (!mSubscriber->take(mPending)) {
+      return -1;
+    }
+  }
+
+  // send as much of the pending event as the connection accepts
+  size_t size = min(maxSize, mPending.size() - mPendingOffset);
+  memcpy(buffer, mPending.data() + mPendingOffset, size);
+  mPendingOffset += size;
+  return static_cast<ssize_t>(size);
+}
+
+bool EventStream::poll(string &out) {
+  unique_lock<mutex> lock(mSubscriber->mMutex);
+  return mSubscriber->take(out);
+}
+
+void EventStream::setReadyHandler(function<void()> handler) {
+  unique_lock<mutex> lock(mSubscriber->mMutex);
+  mSubscriber->mReadyHandler = move(handler);
+}
@@ -0,0 +1,89 @@
+/*****************************************************************************/
+/**
+ * @file    EventStream.h
+ * @author  Team Server
+ * @brief   Definition of class EventStream
+ */
+/*****************************************************************************/
+
+#ifndef _EVENT_STREAM_H_
+#define _EVENT_STREAM_H_
+
+#include <sys/types.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "NetworkListener.h"
+#include "RequestInformation.h"
+#include "Types/Result.h"
+
+struct EventSubscriber;
+
+/**
+ * @class EventStream
+ * @brief Server-Sent Events stream pushing queue and playback changes to a
+ * single subscriber.
+ * @details The events of all streams are built by a single notifier thread,
+ * which is woken up by `notifyChange` whenever the data store or the scheduler
+ * changes one of their versions. It collects and serializes the queues only
+ * once per version and shares them among all streams, only the vote flags of
+ * each user are inserted per stream. A playback change collects the current
+ * track only.
+ *
+ * A stream does not queue up events. It holds the latest event which was not
+ * taken yet, a newer one replaces it. Hence slow clients skip intermediate
+ * states instead of building up a backlog.
+ *
+ * The event loops of `EpollRestAPI` take the events by `poll` whenever the
+ * connection is able to send more, so open streams need no threads of their
+ * own. libhttpserver reads them by the blocking `produce`, which occupies a
+ * connection thread per stream (hence streams are rejected in its `pool`
+ * mode).
+ */
+class EventStream : public StreamBody {
+ public:
+  ~EventStream() override;
+
+  /**
+   * @brief Opens a new stream for the given user.
+   * @details The limits and intervals are read from the `RestAPI` section of
+   * the configuration.
+   *
+   * @return The new stream, or an `Error` if the session is not valid or too
+   * many streams are open.
+   */
+  static TResult<std::shared_ptr<EventStream>> subscribe(
+      NetworkListener *listener, TSessionID const &sid);
+
+  /**
+   * @brief Wakes up the notifier to check the open streams for changes.
+   * @details Cheap enough to be called on every change of a version, the
+   * versions are compared once the notifier is scheduled.
+   */
+  static void notifyChange();
+
+  /**
+   * @brief Closes all open streams and stops the notifier.
+   * @details Must be called before the server is stopped, since open streams
+   * would delay the shutdown otherwise. Once it returns, the listeners of the
+   * closed streams are not called anymore.
+   */
+  static void closeAll();
+
+  ssize_t produce(char *buffer, size_t maxSize) override;
+  bool poll(std::string &out) override;
+  void setReadyHandler(std::function<void()> handler) override;
+
+ private:
+  explicit EventStream(std::shared_ptr<EventSubscriber> subscriber);
+
+  std::shared_ptr<EventSubscriber> mSubscriber;
+
+  // the part of the last event not returned by `produce` yet
+  std::string mPending;
+  size_t mPendingOffset = 0;
+};
+
+#endif /* _EVENT_STREAM_H_ */
@@ -0,0 +1,272 @@
+/*****************************************************************************/
+/**
+ * @file    HttpParser.cpp
+ * @author  Team Server
+ * @brief   Implementation of class HttpParser
+ */
+/*****************************************************************************/
+
+#include "HttpParser.h"
+
+#include "Utils/HttpHeader.h"
+
+using namespace std;
+using namespace HttpHeader;
+
+static string_view const LINE_END = "\r\n";
+static string_view const HEAD_END = "\r\n\r\n";
+
+string_view HttpRequestView::header(string_view name) const {
+  for (auto const &[key, value] : headers) {
+    if (equalsIgnoreCase(key, name)) {
+      return value;
+    }
+  }
+  return {};
+}
+
+/**
+ * @brief Checks if a comma separated header value contains the given token.
+ */
+static bool containsToken(string_view list, string_view token) {
+  while (!list.empty()) {
+    if (equalsIgnoreCase(nextElement(list), token)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Parses a non-negative decimal number, which must not overflow.
+ */
+static bool parseLength(string_view str, size_t &length) {
+  if (str.empty() || str.size() > 18) {
+    return false;
+  }
+  length = 0;
+  for (char c : str) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    length = length * 10 + (c - '0');
+  }
+  return true;
+}
+
+HttpParseResult HttpParser::parse(string_view buffer,
+                                  HttpRequestView &request,
+                                  size_t maxSize) {
+  auto headEnd = buffer.substr(0, maxSize).find(HEAD_END);
+  if (headEnd == string_view::npos) {
+    return (buffer.size() >= maxSize) ? HttpParseResult::TooLarge
+                                      : HttpParseResult::Incomplete;
+  }
+  auto head = buffer.substr(0, headEnd + LINE_END.size());
+
+  // request line: <method> <target> <version>
+  auto lineEnd = head.find(LINE_END);
+  auto line = head.substr(0, lineEnd);
+  head.remove_prefix(lineEnd + LINE_END.size());
+  auto methodEnd = line.find(' ');
+  auto targetEnd = line.rfind(' ');
+  if (methodEnd == string_view::npos || methodEnd == 0 ||
+      targetEnd == methodEnd) {
+    return HttpParseResult::Invalid;
+  }
+  request.method = line.substr(0, methodEnd);
+  auto target = line.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+  auto version = line.substr(targetEnd + 1);
+  if (target.empty() || target[0] != '/') {
+    return HttpParseResult::Invalid;
+  }
+  if (version != "HTTP/1.1" && version != "HTTP/1.0") {
+    return HttpParseResult::NotImplemented;
+  }
+
+  auto queryStart = target.find('?');
+  request.path = target.substr(0, queryStart);
+  request.query = (queryStart == string_view::npos)
+                      ? string_view()
+                      : target.substr(queryStart + 1);
+
+  // header fields: <name>: <value>
+  request.headers.clear();
+  while (!head.empty()) {
+    lineEnd = head.find(LINE_END);
+    line = head.substr(0, lineEnd);
+    head.remove_prefix(lineEnd + LINE_END.size());
+
+    auto colon = line.find(':');
+    if (colon == string_view::npos || colon == 0 ||
+        line.find_first_of(" \t") < colon) {
+      return HttpParseResult::Invalid;
+    }
+    request.headers.emplace_back(line.substr(0, colon),
+                                 trim(line.substr(colon + 1)));
+  }
+
+  if (!request.header("Transfer-Encoding").empty()) {
+    return HttpParseResult::NotImplemented;
+  }
+  // several lengths would let a proxy in front of the server and the server
+  // disagree on where the request ends, unless they are all the same
+  optional<size_t> contentLength;
+  for (auto const &[key, value] : request.headers) {
+    if (!equalsIgnoreCase(key, "Content-Length")) {
+      continue;
+    }
+    size_t length;
+    if (!parseLength(value, length) ||
+        (contentLength.has_value() && contentLength.value() != length)) {
+      return HttpParseResult::Invalid;
+    }
+    contentLength = length;
+  }
+
+  auto bodyStart = headEnd + HEAD_END.size();
+  auto bodySize = contentLength.value_or(0);
+  if (bodySize > maxSize || bodyStart + bodySize > maxSize) {
+    return HttpParseResult::TooLarge;
+  }
+  if (buffer.size() < bodyStart + bodySize) {
+    return HttpParseResult::Incomplete;
+  }
+  request.body = buffer.substr(bodyStart, bodySize);
+  request.size = bodyStart + bodySize;
+
+  // HTTP/1.1 keeps connections open by default, HTTP/1.0 on request only
+  auto connection = request.header("Connection");
+  if (version == "HTTP/1.1") {
+    request.keepAlive = !containsToken(connection, "close");
+  } else {
+    request.keepAlive = containsToken(connection, "keep-alive");
+  }
+  return HttpParseResult::Complete;
+}
+
+string HttpParser::decode(string_view component, bool plusAsSpace) {
+  auto hexValue = [](char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  };
+
+  string result;
+  result.reserve(component.size());
+  for (size_t i = 0; i < component.size(); i++) {
+    char c = component[i];
+    if (c == '%' && i + 2 < component.size() &&
+        hexValue(component[i + 1]) >= 0 && hexValue(component[i + 2]) >= 0) {
+      result += static_cast<char>(hexValue(component[i + 1]) * 16 +
+                                  hexValue(component[i + 2]));
+      i += 2;
+    } else if (c == '+' && plusAsSpace) {
+      result += ' ';
+    } else {
+      // invalid escapes are kept as they are
+      result += c;
+    }
+  }
+  return result;
+}
+
+optional<string> HttpParser::findQueryParameter(string_view query,
+                                                string_view name) {
+  while (!query.empty()) {
+    auto end = query.find('&');
+    auto param = query.substr(0, end);
+    query = (end == string_view::npos) ? "" : query.substr(end + 1);
+
+    auto equals = param.find('=');
+    auto key = param.substr(0, equals);
+    // only escaped names need to be decoded for the comparison
+    bool matches = (key.find_first_of("%+") == string_view::npos)
+                       ? (key == name)
+                       : (decode(key, true) == name);
+    if (!param.empty() && matches) {
+      auto value = (equals == string_view::npos) ? string_view()
+                                                 : param.substr(equals + 1);
+      return decode(value, true);
+    }
+  }
+  return nullopt;
+}
+
+void HttpParser::writeResponseHead(string &out,
+                                   int code,
+                                   map<string, string> const &headers,
+                                   optional<size_t> contentLength,
+                                   bool keepAlive) {
+  out += "HTTP/1.1 ";
+  out += to_string(code);
+  out += ' ';
+  out += reasonPhrase(code);
+  out += LINE_END;
+
+  bool hasContentType = false;
+  for (auto const &[key, value] : headers) {
+    hasContentType = hasContentType || equalsIgnoreCase(key, "Content-Type");
+    out += key;
+    out += ": ";
+    out += value;
+    out += LINE_END;
+  }
+  // same default as the responses of libhttpserver
+  if (!hasContentType) {
+    out += "Content-Type: text/plain";
+    out += LINE_END;
+  }
+  if (contentLength.has_value() && allowsBody(code)) {
+    out += "Content-Length: ";
+    out += to_string(contentLength.value());
+    out += LINE_END;
+  }
+  out += keepAlive ? "Connection: keep-alive" : "Connection: close";
+  out += HEAD_END;
+}
+
+bool HttpParser::allowsBody(int code) {
+  return code >= 200 && code != 204 && code != 304;
+}
+
+string_view HttpParser::reasonPhrase(int code) {
+  switch (code) {
+    case 200:
+      return "OK";
+    case 204:
+      return "No Content";
+    case 207:
+      return "Multi-Status";
+    case 304:
+      return "Not Modified";
+    case 400:
+      return "Bad Request";
+    case 401:
+      return "Unauthorized";
+    case 403:
+      return "Forbidden";
+    case 404:
+      return "Not Found";
+    case 405:
+      return "Method Not Allowed";
+    case 413:
+      return "Payload Too Large";
+    case 422:
+      return "Unprocessable Entity";
+    case 440:
+      return "Login Time-out";
+    case 500:
+      return "Internal Server Error";
+    case 501:
+      return "Not Implemented";
+    case 502:
+      return "Bad Gateway";
+    case 503:
+      return "Service Unavailable";
+    case 504:
+      return "Gateway Timeout";
+  }
+  return "Unknown";
+}
@@ -0,0 +1,113 @@
+/*****************************************************************************/
+/**
+ * @file    HttpParser.h
+ * @author  Team Server
+ * @brief   Definition of class HttpParser
+ */
+/*****************************************************************************/
+
+#ifndef _HTTP_PARSER_H_
+#define _HTTP_PARSER_H_
+
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A HTTP/1.x request parsed in place.
+ * @details All views refer to the buffer the request was parsed from and are
+ * valid as long as it is not modified.
+ */
+struct HttpRequestView {
+  std::string_view method;
+  std::string_view path;   ///< still percent-encoded
+  std::string_view query;  ///< without the leading `?`
+  std::string_view body;
+  std::vector<std::pair<std::string_view, std::string_view>> headers;
+  bool keepAlive = true;  ///< the connection stays open after the response
+  size_t size = 0;        ///< number of bytes taken by the whole request
+
+  /**
+   * @brief Returns the value of the header with the given (case insensitive)
+   * name, or an empty view.
+   */
+  std::string_view header(std::string_view name) const;
+};
+
+/**
+ * @brief Results of parsing a request.
+ */
+enum class HttpParseResult {
+  Complete,        ///< a whole request has been parsed
+  Incomplete,      ///< more data is needed
+  Invalid,         ///< the request is malformed (400)
+  TooLarge,        ///< the request exceeds the size limit (413)
+  NotImplemented,  ///< the request uses an unsupported feature (501)
+};
+
+/**
+ * @class HttpParser
+ * @brief Minimal HTTP/1.x parser and response writer.
+ * @details Supports everything the REST API needs: request bodies with a
+ * `Content-Length`, keep-alive connections and pipelined requests. Chunked
+ * request bodies are not supported, neither are several `Content-Length`
+ * headers with different values.
+ */
+class HttpParser {
+ public:
+  /**
+   * @brief Parses the first request in `buffer` without copying it.
+   * @param request Is overwritten with the parsed request. Its header vector
+   * is reused, so keeping one object per connection avoids allocations.
+   * @param maxSize Maximum size of a request (headers and body) in bytes.
+   */
+  static HttpParseResult parse(std::string_view buffer,
+                               HttpRequestView &request,
+                               size_t maxSize);
+
+  /**
+   * @brief Decodes a percent-encoded URL component.
+   * @param plusAsSpace Decodes `+` as space, as used in query strings.
+   */
+  static std::string decode(std::string_view component,
+                            bool plusAsSpace = false);
+
+  /**
+   * @brief Looks up a parameter in a query string and decodes its value.
+   * @details Parameters without value have an empty value. The first
+   * occurrence of a parameter wins.
+   * @return The value, or `nullopt` if the query does not contain the
+   * parameter.
+   */
+  static std::optional<std::string> findQueryParameter(std::string_view query,
+                                                       std::string_view name);
+
+  /**
+   * @brief Appends the status line and headers of a response to `out`.
+   * @param contentLength Length of the body, omitted for streamed bodies
+   * (which are terminated by closing the connection) and for responses which
+   * never have a body (see `allowsBody`).
+   */
+  static void writeResponseHead(
+      std::string &out,
+      int code,
+      std::map<std::string, std::string> const &headers,
+      std::optional<size_t> contentLength,
+      bool keepAlive);
+
+  /**
+   * @brief Checks if a response with the given status code may have a body.
+   * @return `false` for informational responses, 204 and 304.
+   */
+  static bool allowsBody(int code);
+
+  /**
+   * @brief Returns the reason phrase of a status code.
+   */
+  static std::string_view reasonPhrase(int code);
+};
+
+#endif /* _HTTP_PARSER_H_ */
@@ -0,0 +1,232 @@
+/*****************************************************************************/
+/**
+ * @file    IdempotencyCache.cpp
+ * @author  Team Server
+ * @brief   Implementation of class IdempotencyCache
+ */
+/*****************************************************************************/
+
+#include "IdempotencyCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "Utils/ConfigHandler.h"
+#include "Utils/MemoryUsage.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+static string const CONFIG_SECTION = "RestAPI";
+static int const DEFAULT_CACHE_SIZE = 1024;
+static int const DEFAULT_TTL_SECONDS = 600;
+
+/**
+ * @brief A reserved key and, once its request is handled, the response.
+ */
+struct IdempotencyEntry {
+  uint64_t id;  ///< of the reservation
+  size_t fingerprint;
+  Clock::time_point expires;
+  list<string>::iterator position;
+  bool completed = false;
+  ResponseInformation response;
+};
+
+static mutex sMutex;
+static unordered_map<string, IdempotencyEntry> sEntries;
+// the keys by age, all keys have the same TTL so the oldest expire first
+static list<string> sOrder;
+static uint64_t sNextId = 1;
+
+// read by configure()
+static atomic<int> sMaxSize{DEFAULT_CACHE_SIZE};
+static atomic<int> sTtlSeconds{DEFAULT_TTL_SECONDS};
+
+static size_t cacheBytes() {
+  lock_guard<mutex> lock(sMutex);
+  // a node of the map and of the list holds its value and two pointers
+  size_t nodeBytes = sizeof(pair<string const, IdempotencyEntry>) +
+                     sizeof(string) + 4 * sizeof(void *);
+  size_t bytes = sEntries.bucket_count() * sizeof(void *) +
+                 sEntries.size() * nodeBytes;
+  for (auto const &[key, entry] : sEntries) {
+    bytes += 2 * MemoryUsage::heapBytes(key) +
+             MemoryUsage::heapBytes(entry.response.body);
+    for (auto const &[name, value] : entry.response.headers) {
+      bytes += sizeof(pair<string const, string>) + 3 * sizeof(void *) +
+               MemoryUsage::heapBytes(name) + MemoryUsage::heapBytes(value);
+    }
+  }
+  return bytes;
+}
+
+static MemoryUsage::Registration sMemory("cache.idempotency", cacheBytes);
+
+static TResult<int> configValue(string const &key, int defaultValue) {
+  auto value = ConfigHandler::getInstance()->getValueInt(
+      CONFIG_SECTION, key, defaultValue);
+  if (holds_alternative<Error>(value)) {
+    return value;
+  }
+  if (get<int>(value) < 0) {
+    return Error(ErrorCode::InvalidValue,
+                 "IdempotencyCache.configure: " + key +
+                     " must not be negative");
+  }
+  return value;
+}
+
+static void eraseEntry(unordered_map<string, IdempotencyEntry>::iterator it) {
+  sOrder.erase(it->second.position);
+  sEntries.erase(it);
+}
+
+static void evictExpired(Clock::time_point now) {
+  while (!sOrder.empty()) {
+    auto it = sEntries.find(sOrder.front());
+    if (it->second.expires > now) {
+      break;
+    }
+    eraseEntry(it);
+  }
+}
+
+//
+// IdempotencyReservation
+//
+
+IdempotencyReservation::IdempotencyReservation(
+    IdempotencyReservation &&other) noexcept
+    : mKey(move(other.mKey)), mId(other.mId) {
+  other.mKey.clear();
+}
+
+IdempotencyReservation &IdempotencyReservation::operator=(
+    IdempotencyReservation &&other) noexcept {
+  if (this != &other) {
+    if (*this) {
+      IdempotencyCache::release(*this);
+    }
+    mKey = move(other.mKey);
+    mId = other.mId;
+    other.mKey.clear();
+  }
+  return *this;
+}
+
+IdempotencyReservation::~IdempotencyReservation() {
+  if (*this) {
+    IdempotencyCache::release(*this);
+  }
+}
+
+void IdempotencyReservation::complete(ResponseInformation const &response) {
+  if (!*this) {
+    return;
+  }
+  if (response.code >= 500) {
+    IdempotencyCache::release(*this);
+  } else {
+    IdempotencyCache::complete(*this, response);
+  }
+  mKey.clear();
+}
+
+//
+// IdempotencyCache
+//
+
+TResultOpt IdempotencyCache::configure() {
+  auto maxSize = configValue("idempotencyCacheSize", DEFAULT_CACHE_SIZE);
+  if (holds_alternative<Error>(maxSize)) {
+    return get<Error>(maxSize);
+  }
+  auto ttl = configValue("idempotencyTtlSeconds", DEFAULT_TTL_SECONDS);
+  if (holds_alternative<Error>(ttl)) {
+    return get<Error>(ttl);
+  }
+  sMaxSize = get<int>(maxSize);
+  sTtlSeconds = get<int>(ttl);
+  return nullopt;
+}
+
+IdempotencyCache::Lookup IdempotencyCache::lookup(string_view scope,
+                                                  string_view key,
+                                                  string_view body) {
+  Lookup result;
+  size_t maxSize = sMaxSize.load(memory_order_relaxed);
+  if (maxSize == 0) {
+    return result;
+  }
+  auto ttl = chrono::seconds(sTtlSeconds.load(memory_order_relaxed));
+
+  string scopedKey = string(scope) + '\n' + string(key);
+  size_t fingerprint = hash<string_view>()(body);
+  auto now = Clock::now();
+
+  lock_guard<mutex> lock(sMutex);
+  evictExpired(now);
+  auto it = sEntries.find(scopedKey);
+  if (it != sEntries.end()) {
+    auto const &entry = it->second;
+    if (entry.fingerprint != fingerprint) {
+      result.result = Lookup::Result::Mismatch;
+    } else if (!entry.completed) {
+      result.result = Lookup::Result::InProgress;
+    } else {
+      result.result = Lookup::Result::Replay;
+      result.response = entry.response;
+    }
+    return result;
+  }
+
+  while (sEntries.size() >= maxSize) {
+    eraseEntry(sEntries.find(sOrder.front()));
+  }
+  uint64_t id = sNextId++;
+  sOrder.push_back(scopedKey);
+  auto &entry = sEntries[scopedKey];
+  entry.id = id;
+  entry.fingerprint = fingerprint;
+  entry.expires = now + ttl;
+  entry.position = prev(sOrder.end());
+  result.reservation = IdempotencyReservation(move(scopedKey), id);
+  return result;
+}
+
+size_t IdempotencyCache::size() {
+  lock_guard<mutex> lock(sMutex);
+  return sEntries.size();
+}
+
+void IdempotencyCache::clear() {
+  lock_guard<mutex> lock(sMutex);
+  sEntries.clear();
+  sOrder.clear();
+}
+
+void IdempotencyCache::complete(IdempotencyReservation const &reservation,
+                                ResponseInformation const &response) {
+  lock_guard<mutex> lock(sMutex);
+  // the key may have been evicted and reserved again in the meantime
+  auto it = sEntries.find(reservation.mKey);
+  if (it != sEntries.end() && it->second.id == reservation.mId) {
+    it->second.completed = true;
+    it->second.response = response;
+  }
+}
+
+void IdempotencyCache::release(IdempotencyReservation const &reservation) {
+  lock_guard<mutex> lock(sMutex);
+  auto it = sEntries.find(reservation.mKey);
+  if (it != sEntries.end() && it->second.id == reservation.mId) {
+    eraseEntry(it);
+  }
+}
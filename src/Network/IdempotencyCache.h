@@ -0,0 +1,117 @@
+/*****************************************************************************/
+/**
+ * @file    IdempotencyCache.h
+ * @author  Team Server
+ * @brief   Definition of class IdempotencyCache
+ */
+/*****************************************************************************/
+
+#ifndef _IDEMPOTENCY_CACHE_H_
+#define _IDEMPOTENCY_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "RequestInformation.h"
+#include "Types/Result.h"
+
+/**
+ * @class IdempotencyReservation
+ * @brief Reserves an idempotency key for the request handled first.
+ * @details The response of the request is stored with `complete`. A
+ * reservation destroyed without being completed releases the key, so the
+ * request may be retried.
+ */
+class IdempotencyReservation {
+ public:
+  IdempotencyReservation() = default;
+  IdempotencyReservation(IdempotencyReservation &&other) noexcept;
+  IdempotencyReservation &operator=(IdempotencyReservation &&other) noexcept;
+  IdempotencyReservation(IdempotencyReservation const &) = delete;
+  IdempotencyReservation &operator=(IdempotencyReservation const &) = delete;
+  ~IdempotencyReservation();
+
+  explicit operator bool() const {
+    return !mKey.empty();
+  }
+
+  /**
+   * @brief Stores the response for retries of the request.
+   * @details Server errors are not stored, the key is released instead.
+   */
+  void complete(ResponseInformation const &response);
+
+ private:
+  friend class IdempotencyCache;
+  IdempotencyReservation(std::string key, uint64_t id)
+      : mKey(std::move(key)), mId(id) {
+  }
+
+  std::string mKey;
+  uint64_t mId = 0;
+};
+
+/**
+ * @class IdempotencyCache
+ * @brief Responses of mutating requests by their `Idempotency-Key` header.
+ * @details Clients on a flaky network retry requests whose response got lost.
+ * With an idempotency key, a retry gets the response of the first attempt
+ * instead of being handled again (e.g. adding the same track twice).
+ *
+ * Keys are scoped by method and endpoint. A retry with a different body is
+ * rejected, as is a retry while the first attempt is still being handled.
+ *
+ * The cache holds up to `idempotencyCacheSize` keys (section `RestAPI`, 0 =
+ * disabled) for `idempotencyTtlSeconds` each, the oldest keys are evicted
+ * first. Both are read by configure() when the server starts.
+ */
+class IdempotencyCache {
+ public:
+  /**
+   * @brief Result of looking up an idempotency key.
+   */
+  struct Lookup {
+    enum class Result {
+      New,         ///< the request has to be handled, see `reservation`
+      Replay,      ///< the request was handled already, see `response`
+      InProgress,  ///< the first attempt is still being handled
+      Mismatch     ///< the key was used for a different request
+    };
+
+    Result result = Result::New;
+    IdempotencyReservation reservation;  ///< empty if the cache is disabled
+    ResponseInformation response;
+  };
+
+  /**
+   * @brief Reads the size and the TTL of the cache from the configuration.
+   * @details Changes of the configuration take effect with the next call.
+   * Until the first call, the defaults of the keys apply.
+   * @return An error if a value is not a number or negative.
+   */
+  static TResultOpt configure();
+
+  /**
+   * @brief Looks up the key of a request and reserves it if it is new.
+   * @param scope Method and endpoint of the request.
+   * @param key Value of the `Idempotency-Key` header.
+   * @param body Body of the request, which has to match on retries.
+   */
+  static Lookup lookup(std::string_view scope,
+                       std::string_view key,
+                       std::string_view body);
+
+  static size_t size();
+  static void clear();
+
+ private:
+  friend class IdempotencyReservation;
+  static void complete(IdempotencyReservation const &reservation,
+                       ResponseInformation const &response);
+  static void release(IdempotencyReservation const &reservation);
+};
+
+#endif /* _IDEMPOTENCY_CACHE_H_ */
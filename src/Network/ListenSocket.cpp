@@ -0,0 +1,119 @@
+/*****************************************************************************/
+/**
+ * @file    ListenSocket.cpp
+ * @author  Team Server
+ * @brief   Implementation of class ListenSocket
+ */
+/*****************************************************************************/
+
+#include "ListenSocket.h"
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "Utils/ConfigHandler.h"
+
+using namespace std;
+
+static Error socketError(string const &what) {
+  return Error(ErrorCode::NotInitialized,
+               "ListenSocket: " + what + ": " + strerror(errno));
+}
+
+TResult<int> ListenSocket::openTcp(int port, bool reusePort) {
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return socketError("socket failed");
+  }
+
+  int enable = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  if (reusePort &&
+      setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+    auto error = socketError("SO_REUSEPORT not supported");
+    close(fd);
+    return error;
+  }
+
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  address.sin_port = htons(static_cast<uint16_t>(port));
+  if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+      listen(fd, SOMAXCONN) < 0) {
+    close(fd);
+    return Error(ErrorCode::NotInitialized,
+                 "Port '" + to_string(port) + "' already taken");
+  }
+  return fd;
+}
+
+/**
+ * @brief Checks if a server accepts connections at the given socket address.
+ */
+static bool isInUse(sockaddr_un const &address) {
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return false;
+  }
+  bool connected = connect(fd,
+                           reinterpret_cast<sockaddr const *>(&address),
+                           sizeof(address)) == 0;
+  close(fd);
+  return connected;
+}
+
+TResult<int> ListenSocket::openUnix(string const &path) {
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+    return Error(ErrorCode::InvalidValue,
+                 "ListenSocket: Invalid socket path '" + path + "'");
+  }
+  path.copy(address.sun_path, path.size());
+
+  struct stat status;
+  if (lstat(path.c_str(), &status) == 0) {
+    if (!S_ISSOCK(status.st_mode)) {
+      return Error(ErrorCode::AlreadyExists,
+                   "ListenSocket: '" + path + "' exists and is no socket");
+    }
+    if (isInUse(address)) {
+      return Error(ErrorCode::AlreadyExists,
+                   "ListenSocket: '" + path + "' is used by another server");
+    }
+    unlink(path.c_str());
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return socketError("socket failed");
+  }
+  if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) < 0 ||
+      listen(fd, SOMAXCONN) < 0) {
+    auto error = socketError("Failed to listen at '" + path + "'");
+    close(fd);
+    return error;
+  }
+  return fd;
+}
+
+void ListenSocket::closeUnix(int fd, string const &path) {
+  close(fd);
+  removeUnix(path);
+}
+
+void ListenSocket::removeUnix(string const &path) {
+  unlink(path.c_str());
+}
+
+TResult<string> ListenSocket::configuredUnixPath() {
+  return ConfigHandler::getInstance()->getValueString(
+      "RestAPI", "unixSocket", "");
+}
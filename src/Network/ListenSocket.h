@@ -0,0 +1,56 @@
+/*****************************************************************************/
+/**
+ * @file    ListenSocket.h
+ * @author  Team Server
+ * @brief   Definition of class ListenSocket
+ */
+/*****************************************************************************/
+
+#ifndef _LISTEN_SOCKET_H_
+#define _LISTEN_SOCKET_H_
+
+#include <string>
+
+#include "Types/Result.h"
+
+/**
+ * @class ListenSocket
+ * @brief Opens the listening sockets of the `NetworkAPI` implementations.
+ * @details All sockets are non-blocking and closed on exec.
+ */
+class ListenSocket {
+ public:
+  /**
+   * @brief Opens a TCP socket listening on all interfaces.
+   * @param reusePort Allows several sockets to listen on the same port, the
+   * kernel distributes new connections among them.
+   */
+  static TResult<int> openTcp(int port, bool reusePort);
+
+  /**
+   * @brief Opens a Unix domain socket listening at the given path.
+   * @details A stale socket file left at the path (e.g. by a crashed server)
+   * is replaced, a socket still in use or any other file is an error. The
+   * access to the socket is controlled by the permissions of its directory.
+   */
+  static TResult<int> openUnix(std::string const &path);
+
+  /**
+   * @brief Closes a Unix domain socket and removes its file.
+   */
+  static void closeUnix(int fd, std::string const &path);
+
+  /**
+   * @brief Removes the file of a Unix domain socket which was closed by its
+   * owner, e.g. by libmicrohttpd when the webserver stops.
+   */
+  static void removeUnix(std::string const &path);
+
+  /**
+   * @brief Reads the Unix domain socket path from the key `unixSocket` of
+   * section `RestAPI`, an empty path disables the socket.
+   */
+  static TResult<std::string> configuredUnixPath();
+};
+
+#endif /* _LISTEN_SOCKET_H_ */
@@ -0,0 +1,493 @@
+/*****************************************************************************/
+/**
+ * @file    RequestDecoder.cpp
+ * @author  Team Server
+ * @brief   Implementation of class RequestDecoder
+ */
+/*****************************************************************************/
+
+#include "RequestDecoder.h"
+
+#include <glog/logging.h>
+
+#include <charconv>
+#include <limits>
+
+using namespace std;
+
+// nesting deeper than this is rejected to bound the recursion
+static int const MAX_DEPTH = 64;
+
+//
+// Helper functions
+//
+
+static bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+static void appendUtf8(string &out, uint32_t codePoint) {
+  if (codePoint < 0x80) {
+    out += static_cast<char>(codePoint);
+  } else if (codePoint < 0x800) {
+    out += static_cast<char>(0xC0 | (codePoint >> 6));
+    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+  } else if (codePoint < 0x10000) {
+    out += static_cast<char>(0xE0 | (codePoint >> 12));
+    out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+  } else {
+    out += static_cast<char>(0xF0 | (codePoint >> 18));
+    out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+    out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+  }
+}
+
+/**
+ * @brief Returns the length of the well-formed UTF-8 sequence at `pos`, or 0 if
+ * the sequence is ill-formed (RFC 3629).
+ */
+static size_t utf8SequenceLength(char const *pos, char const *end) {
+  auto byte = [&](size_t i) {
+    return static_cast<unsigned char>(pos[i]);
+  };
+  auto inRange = [&](size_t i, unsigned char lo, unsigned char hi) {
+    return pos + i < end && byte(i) >= lo && byte(i) <= hi;
+  };
+
+  unsigned char first = byte(0);
+  if (first >= 0xC2 && first <= 0xDF) {
+    return inRange(1, 0x80, 0xBF) ? 2 : 0;
+  }
+  if (first >= 0xE0 && first <= 0xEF) {
+    unsigned char lo = (first == 0xE0) ? 0xA0 : 0x80;
+    unsigned char hi = (first == 0xED) ? 0x9F : 0xBF;
+    return (inRange(1, lo, hi) && inRange(2, 0x80, 0xBF)) ? 3 : 0;
+  }
+  if (first >= 0xF0 && first <= 0xF4) {
+    unsigned char lo = (first == 0xF0) ? 0x90 : 0x80;
+    unsigned char hi = (first == 0xF4) ? 0x8F : 0xBF;
+    return (inRange(1, lo, hi) && inRange(2, 0x80, 0xBF) &&
+            inRange(3, 0x80, 0xBF))
+               ? 4
+               : 0;
+  }
+  return 0;
+}
+
+//
+// Bindings
+//
+
+RequestDecoder &RequestDecoder::requiredString(string_view name,
+                                               string &target) {
+  mBindings.push_back(
+      {name, FieldType::String, true, &target, FieldState::Missing});
+  return *this;
+}
+
+RequestDecoder &RequestDecoder::optionalString(string_view name,
+                                               optional<string> &target) {
+  mBindings.push_back(
+      {name, FieldType::String, false, &target, FieldState::Missing});
+  return *this;
+}
+
+RequestDecoder &RequestDecoder::requiredInt(string_view name, int &target) {
+  mBindings.push_back(
+      {name, FieldType::Int, true, &target, FieldState::Missing});
+  return *this;
+}
+
+//
+// Decoding
+//
+
+TResultOpt RequestDecoder::decode(string_view body) {
+  for (auto &binding : mBindings) {
+    binding.state = FieldState::Missing;
+  }
+
+  Cursor cur{body.data(), body.data() + body.size()};
+  skipWhitespace(cur);
+
+  // other values than objects are valid, but do not contain any fields
+  bool valid;
+  if (cur.pos < cur.end && *cur.pos == '{') {
+    valid = parseObjectMembers(cur);
+  } else {
+    valid = skipValue(cur, 0);
+  }
+  skipWhitespace(cur);
+
+  if (!valid || cur.pos != cur.end) {
+    VLOG(2) << "Failed to parse JSON body: '" << body << "'";
+    return Error(ErrorCode::InvalidFormat, "Failed to parse body");
+  }
+
+  for (auto const &binding : mBindings) {
+    string name(binding.name);
+    if (binding.state == FieldState::Missing && binding.required) {
+      return Error(ErrorCode::InvalidFormat,
+                   "Field '" + name + "' not found");
+    }
+    if (binding.state == FieldState::WrongType) {
+      return Error(ErrorCode::InvalidFormat,
+                   "Value of '" + name + "' must be " +
+                       (binding.type == FieldType::String ? "a string"
+                                                          : "an integer"));
+    }
+  }
+  return nullopt;
+}
+
+bool RequestDecoder::parseObjectMembers(Cursor &cur) {
+  // skip the opening brace
+  cur.pos++;
+  skipWhitespace(cur);
+  if (cur.pos < cur.end && *cur.pos == '}') {
+    cur.pos++;
+    return true;
+  }
+
+  string key;
+  while (true) {
+    skipWhitespace(cur);
+    if (!parseString(cur, &key)) {
+      return false;
+    }
+    skipWhitespace(cur);
+    if (cur.pos == cur.end || *cur.pos != ':') {
+      return false;
+    }
+    cur.pos++;
+    skipWhitespace(cur);
+
+    // duplicate keys overwrite previous values
+    Binding *binding = nullptr;
+    for (auto &b : mBindings) {
+      if (b.name == key) {
+        binding = &b;
+        break;
+      }
+    }
+    bool valid = binding ? parseBoundValue(cur, *binding) : skipValue(cur, 1);
+    if (!valid) {
+      return false;
+    }
+
+    skipWhitespace(cur);
+    if (cur.pos == cur.end) {
+      return false;
+    }
+    if (*cur.pos == '}') {
+      cur.pos++;
+      return true;
+    }
+    if (*cur.pos != ',') {
+      return false;
+    }
+    cur.pos++;
+  }
+}
+
+bool RequestDecoder::parseBoundValue(Cursor &cur, Binding &binding) {
+  if (cur.pos == cur.end) {
+    return false;
+  }
+
+  if (binding.type == FieldType::String && *cur.pos == '"') {
+    string *target;
+    if (binding.required) {
+      target = static_cast<string *>(binding.target);
+    } else {
+      auto &optTarget = *static_cast<optional<string> *>(binding.target);
+      optTarget.emplace();
+      target = &optTarget.value();
+    }
+    binding.state = FieldState::Found;
+    return parseString(cur, target);
+  }
+
+  if (binding.type == FieldType::Int &&
+      (*cur.pos == '-' || isDigit(*cur.pos))) {
+    char const *start = cur.pos;
+    bool isInteger;
+    if (!parseNumber(cur, &isInteger)) {
+      return false;
+    }
+
+    // values exceeding the range of int are treated as non-integers
+    long long value;
+    auto result = from_chars(start, cur.pos, value);
+    if (isInteger && result.ec == errc() &&
+        value >= numeric_limits<int>::min() &&
+        value <= numeric_limits<int>::max()) {
+      *static_cast<int *>(binding.target) = static_cast<int>(value);
+      binding.state = FieldState::Found;
+    } else {
+      binding.state = FieldState::WrongType;
+    }
+    return true;
+  }
+
+  binding.state = FieldState::WrongType;
+  return skipValue(cur, 1);
+}
+
+void RequestDecoder::skipWhitespace(Cursor &cur) {
+  while (cur.pos < cur.end && (*cur.pos == ' ' || *cur.pos == '\t' ||
+                               *cur.pos == '\n' || *cur.pos == '\r')) {
+    cur.pos++;
+  }
+}
+
+bool RequestDecoder::skipValue(Cursor &cur, int depth) {
+  if (cur.pos == cur.end || depth > MAX_DEPTH) {
+    return false;
+  }
+
+  switch (*cur.pos) {
+    case '{':
+    case '[': {
+      char close = (*cur.pos == '{') ? '}' : ']';
+      bool isObject = (close == '}');
+      cur.pos++;
+      skipWhitespace(cur);
+      if (cur.pos < cur.end && *cur.pos == close) {
+        cur.pos++;
+        return true;
+      }
+      while (true) {
+        skipWhitespace(cur);
+        if (isObject) {
+          if (!parseString(cur, nullptr)) {
+            return false;
+          }
+          skipWhitespace(cur);
+          if (cur.pos == cur.end || *cur.pos != ':') {
+            return false;
+          }
+          cur.pos++;
+          skipWhitespace(cur);
+        }
+        if (!skipValue(cur, depth + 1)) {
+          return false;
+        }
+        skipWhitespace(cur);
+        if (cur.pos == cur.end) {
+          return false;
+        }
+        if (*cur.pos == close) {
+          cur.pos++;
+          return true;
+        }
+        if (*cur.pos != ',') {
+          return false;
+        }
+        cur.pos++;
+      }
+    }
+    case '"':
+      return parseString(cur, nullptr);
+    case 't':
+      return parseLiteral(cur, "true");
+    case 'f':
+      return parseLiteral(cur, "false");
+    case 'n':
+      return parseLiteral(cur, "null");
+    default:
+      bool isInteger;
+      return parseNumber(cur, &isInteger);
+  }
+}
+
+bool RequestDecoder::parseString(Cursor &cur, string *target) {
+  if (cur.pos == cur.end || *cur.pos != '"') {
+    return false;
+  }
+  cur.pos++;
+  if (target) {
+    target->clear();
+  }
+
+  while (true) {
+    // copy runs of plain ASCII characters at once
+    char const *runStart = cur.pos;
+    while (cur.pos < cur.end) {
+      unsigned char c = static_cast<unsigned char>(*cur.pos);
+      if (c == '"' || c == '\\' || c < 0x20 || c >= 0x80) {
+        break;
+      }
+      cur.pos++;
+    }
+    if (target) {
+      target->append(runStart, cur.pos);
+    }
+    if (cur.pos == cur.end) {
+      return false;
+    }
+
+    unsigned char c = static_cast<unsigned char>(*cur.pos);
+    if (c == '"') {
+      cur.pos++;
+      return true;
+    }
+    if (c < 0x20) {
+      // control characters must be escaped
+      return false;
+    }
+    if (c >= 0x80) {
+      size_t length = utf8SequenceLength(cur.pos, cur.end);
+      if (length == 0) {
+        return false;
+      }
+      if (target) {
+        target->append(cur.pos, length);
+      }
+      cur.pos += length;
+      continue;
+    }
+
+    // escape sequence
+    cur.pos++;
+    if (cur.pos == cur.end) {
+      return false;
+    }
+    char escaped = *cur.pos++;
+    char replacement;
+    switch (escaped) {
+      case '"':
+      case '\\':
+      case '/':
+        replacement = escaped;
+        break;
+      case 'b':
+        replacement = '\b';
+        break;
+      case 'f':
+        replacement = '\f';
+        break;
+      case 'n':
+        replacement = '\n';
+        break;
+      case 'r':
+        replacement = '\r';
+        break;
+      case 't':
+        replacement = '\t';
+        break;
+      case 'u': {
+        auto parseCodeUnit = [&cur](uint32_t &codeUnit) {
+          if (cur.end - cur.pos < 4) {
+            return false;
+          }
+          codeUnit = 0;
+          for (int i = 0; i < 4; i++) {
+            int digit = hexValue(*cur.pos++);
+            if (digit < 0) {
+              return false;
+            }
+            codeUnit = (codeUnit << 4) | digit;
+          }
+          return true;
+        };
+
+        uint32_t codePoint;
+        if (!parseCodeUnit(codePoint)) {
+          return false;
+        }
+        if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+          // low surrogate without high surrogate
+          return false;
+        }
+        if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+          // a high surrogate must be followed by a low surrogate
+          uint32_t low;
+          if (cur.end - cur.pos < 2 || cur.pos[0] != '\\' ||
+              cur.pos[1] != 'u') {
+            return false;
+          }
+          cur.pos += 2;
+          if (!parseCodeUnit(low) || low < 0xDC00 || low > 0xDFFF) {
+            return false;
+          }
+          codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        }
+        if (target) {
+          appendUtf8(*target, codePoint);
+        }
+        continue;
+      }
+      default:
+        return false;
+    }
+    if (target) {
+      *target += replacement;
+    }
+  }
+}
+
+bool RequestDecoder::parseNumber(Cursor &cur, bool *isInteger) {
+  auto skipDigits = [&cur]() {
+    char const *start = cur.pos;
+    while (cur.pos < cur.end && isDigit(*cur.pos)) {
+      cur.pos++;
+    }
+    return cur.pos != start;
+  };
+
+  *isInteger = true;
+  if (cur.pos < cur.end && *cur.pos == '-') {
+    cur.pos++;
+  }
+
+  // no leading zeros
+  if (cur.pos < cur.end && *cur.pos == '0') {
+    cur.pos++;
+  } else if (!skipDigits()) {
+    return false;
+  }
+
+  if (cur.pos < cur.end && *cur.pos == '.') {
+    cur.pos++;
+    *isInteger = false;
+    if (!skipDigits()) {
+      return false;
+    }
+  }
+  if (cur.pos < cur.end && (*cur.pos == 'e' || *cur.pos == 'E')) {
+    cur.pos++;
+    *isInteger = false;
+    if (cur.pos < cur.end && (*cur.pos == '+' || *cur.pos == '-')) {
+      cur.pos++;
+    }
+    if (!skipDigits()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool RequestDecoder::parseLiteral(Cursor &cur, string_view literal) {
+  if (static_cast<size_t>(cur.end - cur.pos) < literal.size() ||
+      string_view(cur.pos, literal.size()) != literal) {
+    return false;
+  }
+  cur.pos += literal.size();
+  return true;
+}
@@ -0,0 +1,89 @@
+/*****************************************************************************/
+/**
+ * @file    RequestDecoder.h
+ * @author  Team Server
+ * @brief   Definition of class RequestDecoder
+ */
+/*****************************************************************************/
+
+#ifndef _REQUEST_DECODER_H_
+#define _REQUEST_DECODER_H_
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Types/Result.h"
+
+/**
+ * @class RequestDecoder
+ * @brief Extracts the fields of a JSON request body in a single pass.
+ * @details The expected fields are bound to their target variables first.
+ * `decode` then validates the whole body and writes the values of the bound
+ * fields directly into their targets, all other values are only validated.
+ * No intermediate document is built.
+ *
+ * The errors are the same as reported by the previous DOM based parsing:
+ * - invalid JSON: "Failed to parse body"
+ * - missing required field: "Field '<name>' not found"
+ * - wrong type: "Value of '<name>' must be a string/an integer"
+ *
+ * If several fields are erroneous, the first one in binding order is
+ * reported. A body which is valid JSON, but not an object, has no fields.
+ *
+ * @code
+ * TSessionID session_id;
+ * int vote;
+ * auto err = RequestDecoder()
+ *                .requiredString("session_id", session_id)
+ *                .requiredInt("vote", vote)
+ *                .decode(body);
+ * @endcode
+ */
+class RequestDecoder {
+ public:
+  RequestDecoder &requiredString(std::string_view name, std::string &target);
+  RequestDecoder &optionalString(std::string_view name,
+                                 std::optional<std::string> &target);
+  RequestDecoder &requiredInt(std::string_view name, int &target);
+
+  /**
+   * @brief Decodes the given body into the bound targets.
+   * @return An `Error` with code `InvalidFormat` if the body is invalid.
+   */
+  TResultOpt decode(std::string_view body);
+
+ private:
+  enum class FieldType { String, Int };
+  enum class FieldState { Missing, Found, WrongType };
+
+  struct Binding {
+    std::string_view name;
+    FieldType type;
+    bool required;
+    void *target;
+    FieldState state;
+  };
+
+  /**
+   * @brief Parser state of a single `decode` call.
+   */
+  struct Cursor {
+    char const *pos;
+    char const *end;
+  };
+
+  bool parseObjectMembers(Cursor &cur);
+  bool parseBoundValue(Cursor &cur, Binding &binding);
+
+  static void skipWhitespace(Cursor &cur);
+  static bool skipValue(Cursor &cur, int depth);
+  static bool parseString(Cursor &cur, std::string *target);
+  static bool parseNumber(Cursor &cur, bool *isInteger);
+  static bool parseLiteral(Cursor &cur, std::string_view literal);
+
+  std::vector<Binding> mBindings;
+};
+
+#endif /* _REQUEST_DECODER_H_ */
@@ -9,26 +9,152 @@
 #ifndef _REQUEST_INFORMATION_H_
 #define _REQUEST_INFORMATION_H_
 
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <functional>
 #include <httpserver.hpp>
+#include <initializer_list>
 #include <map>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
+
+/**
+ * @brief Read-only access to the query parameters or header fields of a
+ * request.
+ * @details The fields are looked up lazily in the request of the webserver,
+ * which outlives the handling of the request, hence only the fields read by a
+ * handler are ever copied. Fields set explicitly (e.g. path parameters) take
+ * precedence over the ones of the request.
+ */
+template <class Comparator>
+class RequestFields {
+ public:
+  /**
+   * @brief Looks up a field in the request of the webserver.
+   * @return The value of the field, or `nullopt` if the request does not
+   * contain it.
+   */
+  typedef std::optional<std::string> (*TLookup)(void const *source,
+                                                std::string const &key);
+
+  RequestFields() = default;
+
+  RequestFields(
+      std::initializer_list<std::pair<std::string const, std::string>> fields)
+      : mFields(fields) {
+  }
+
+  RequestFields(void const *source, TLookup lookup)
+      : mSource(source), mLookup(lookup) {
+  }
+
+  std::optional<std::string> get(std::string const &key) const {
+    auto it = mFields.find(key);
+    if (it != mFields.cend()) {
+      return it->second;
+    }
+    if (mLookup) {
+      return mLookup(mSource, key);
+    }
+    return std::nullopt;
+  }
+
+  void set(std::string const &key, std::string value) {
+    mFields[key] = std::move(value);
+  }
+
+ private:
+  void const *mSource = nullptr;
+  TLookup mLookup = nullptr;
+  std::map<std::string, std::string, Comparator> mFields;
+};
+
+typedef RequestFields<httpserver::http::arg_comparator> RequestArgs;
+typedef RequestFields<httpserver::http::header_comparator> RequestHeaders;
 
 /**
  * @brief Wraps all relevant pieces of information provided by a HTTP request.
+ * @details Refers to the request of the webserver instead of copying it, so
+ * it must not outlive the handling of the request.
  */
 struct RequestInformation {
-  std::string path;
-  std::string method;
-  std::string body;
-  std::map<std::string, std::string, httpserver::http::arg_comparator> args;
+  std::string_view path;
+  std::string_view method;
+  std::string_view body;
+  RequestArgs args;
+  RequestHeaders headers;
+  unsigned version = 1;  ///< version of the API the request was made to
+};
+
+/**
+ * @brief The body of a streamed response, which becomes available piece by
+ * piece.
+ * @details Is read either by a thread of its own, which blocks in `produce`,
+ * or by an event loop, which calls `poll` whenever it is told so by the ready
+ * handler and the connection is able to send more data.
+ */
+class StreamBody {
+ public:
+  virtual ~StreamBody() = default;
+
+  /**
+   * @brief Writes the next part of the body into the given buffer.
+   * @details Blocks until there is something to send.
+   * @return The number of bytes written, or -1 once the stream is closed.
+   */
+  virtual ssize_t produce(char *buffer, size_t maxSize) = 0;
+
+  /**
+   * @brief Appends the part of the body available so far to `out`.
+   * @details Does not block, appends nothing if there is nothing to send.
+   * @return `false` once the stream is closed.
+   */
+  virtual bool poll(std::string &out) = 0;
+
+  /**
+   * @brief Sets the function which is called whenever more of the body is
+   * available or the stream is closed.
+   * @details The handler is called by another thread while the stream is
+   * locked, hence it must neither block nor call back into the stream. Parts
+   * available before the handler is set are returned by the next `poll`.
+   */
+  virtual void setReadyHandler(std::function<void()> handler) = 0;
+};
+
+/**
+ * @brief An open file which is sent as the body of a response.
+ * @details Is shared by all responses of the same version of the file and
+ * closed with the last one. The content is sent with `sendfile`, without
+ * being copied into user space.
+ */
+struct FileBody {
+  FileBody(int fd, size_t size) : fd(fd), size(size) {
+  }
+  FileBody(FileBody const &) = delete;
+  FileBody &operator=(FileBody const &) = delete;
+  ~FileBody() {
+    close(fd);
+  }
+
+  int const fd;
+  size_t const size;
 };
 
 /**
  * @brief Wraps all needed pieces of information to form a proper HTTP response.
+ * @details If `stream` is set, the body is produced by it instead of `body`.
+ * If `file` is set, its content is the body.
  */
 struct ResponseInformation {
   std::string body;
   int code = 200;
+  std::map<std::string, std::string> headers = {};
+  std::shared_ptr<StreamBody> stream = nullptr;
+  std::shared_ptr<FileBody const> file = nullptr;
 };
 
 #endif  // _REQUEST_INFORMATION_H_
@@ -8,8 +8,13 @@
 
 #include "RestAPI.h"
 
+#include <algorithm>
 #include <sstream>
+#include <thread>
 
+#include "AdmissionControl.h"
+#include "EventStream.h"
+#include "ListenSocket.h"
 #include "RestRequestHandler.h"
 #include "Utils/ConfigHandler.h"
 
@@ -18,6 +23,114 @@ using namespace httpserver;
 
 static string const CONFIG_SECTION = "RestAPI";
 
+static string const THREADING_MODE_POOL = "pool";
+static string const THREADING_MODE_PER_CONNECTION = "perConnection";
+
+/**
+ * @brief Returns the configured threading model, `pool` or `perConnection`.
+ */
+static TResult<string> configuredThreadingMode() {
+  auto configMode = ConfigHandler::getInstance()->getValueString(
+      CONFIG_SECTION, "threadingMode", THREADING_MODE_PER_CONNECTION);
+  if (holds_alternative<Error>(configMode)) {
+    return get<Error>(configMode);
+  }
+  string mode = get<string>(configMode);
+  if (mode != THREADING_MODE_PER_CONNECTION && mode != THREADING_MODE_POOL) {
+    return Error(ErrorCode::InvalidValue,
+                 "RestAPI.handleRequests: Unknown threading mode '" + mode +
+                     "'");
+  }
+  return mode;
+}
+
+/**
+ * @brief Applies the configured threading model to the webserver parameters.
+ * @details In `perConnection` mode every client connection gets its own
+ * thread. In `pool` mode all connections are multiplexed (select/epoll) onto a
+ * fixed number of worker threads, which bounds the number of OS threads
+ * regardless of how many clients are connected.
+ */
+static TResultOpt configureThreading(create_webserver &params) {
+  auto configHandler = ConfigHandler::getInstance();
+
+  auto configMode = configuredThreadingMode();
+  if (holds_alternative<Error>(configMode)) {
+    return get<Error>(configMode);
+  }
+  auto configMaxConnections =
+      configHandler->getValueInt(CONFIG_SECTION, "maxConnections", 0);
+  if (holds_alternative<Error>(configMaxConnections)) {
+    return get<Error>(configMaxConnections);
+  }
+
+  auto configStackSize =
+      configHandler->getValueInt(CONFIG_SECTION, "threadStackSize", 0);
+  if (holds_alternative<Error>(configStackSize)) {
+    return get<Error>(configStackSize);
+  }
+
+  // small stacks allow many threads (e.g. one per open event stream)
+  int stackSize = get<int>(configStackSize);
+  if (stackSize < 0) {
+    return Error(
+        ErrorCode::InvalidValue,
+        "RestAPI.handleRequests: threadStackSize must not be negative");
+  }
+  if (stackSize > 0) {
+    params.max_thread_stack_size(stackSize * 1024);
+  }
+
+  int maxConnections = get<int>(configMaxConnections);
+  if (maxConnections < 0) {
+    return Error(ErrorCode::InvalidValue,
+                 "RestAPI.handleRequests: maxConnections must not be negative");
+  }
+  if (maxConnections > 0) {
+    params.max_connections(maxConnections);
+  }
+
+  string mode = get<string>(configMode);
+  if (mode == THREADING_MODE_PER_CONNECTION) {
+    LOG(INFO) << "RestAPI: Using one thread per connection";
+    params.start_method(http::http_utils::THREAD_PER_CONNECTION);
+    return nullopt;
+  }
+
+  auto configWorkers =
+      configHandler->getValueInt(CONFIG_SECTION, "workerThreads", 0);
+  if (holds_alternative<Error>(configWorkers)) {
+    return get<Error>(configWorkers);
+  }
+
+  // a value of 0 selects one worker thread per CPU core
+  int workers = get<int>(configWorkers);
+  if (workers < 0) {
+    return Error(ErrorCode::InvalidValue,
+                 "RestAPI.handleRequests: workerThreads must not be negative");
+  }
+  if (workers == 0) {
+    workers = max(1u, thread::hardware_concurrency());
+  }
+
+  LOG(INFO) << "RestAPI: Using a pool of " << workers << " worker threads";
+  params.start_method(http::http_utils::INTERNAL_SELECT).max_threads(workers);
+  return nullopt;
+}
+
+/**
+ * @brief Returns the parameters shared by all webservers of the REST API.
+ */
+static create_webserver createWebserverParams(int port) {
+  return create_webserver(port)
+      .not_found_resource(RestRequestHandler::NotFoundHandler)
+      .internal_error_resource(RestRequestHandler::InternalErrorHandler)
+      .no_regex_checking()
+      .single_resource()
+      .no_basic_auth()
+      .no_digest_auth();
+}
+
 TResultOpt RestAPI::handleRequests() {
   auto configHandler = ConfigHandler::getInstance();
 
@@ -33,27 +146,81 @@ TResultOpt RestAPI::handleRequests() {
                  "RestAPI.handleRequests: Port value is out of range");
   }
 
-  auto webserverParams =
-      create_webserver(port)
-          .not_found_resource(RestRequestHandler::NotFoundHandler)
-          .internal_error_resource(RestRequestHandler::InternalErrorHandler)
-          .no_regex_checking()
-          .single_resource()
-          .no_basic_auth()
-          .no_digest_auth()
-          .start_method(http::http_utils::THREAD_PER_CONNECTION);
+  auto configUnixPath = ListenSocket::configuredUnixPath();
+  if (holds_alternative<Error>(configUnixPath)) {
+    return get<Error>(configUnixPath);
+  }
+  string unixPath = get<string>(configUnixPath);
+  if (port == 0 && unixPath.empty()) {
+    return Error(ErrorCode::InvalidValue,
+                 "RestAPI.handleRequests: Neither a port nor a Unix socket is "
+                 "configured");
+  }
+
+  auto configMode = configuredThreadingMode();
+  if (holds_alternative<Error>(configMode)) {
+    return get<Error>(configMode);
+  }
+
+  auto configResult = RestRequestHandler::configure();
+  if (configResult.has_value()) {
+    return configResult;
+  }
+  // requests are admitted by the worker handling them, which blocks the other
+  // connections of this worker meanwhile
+  if (get<string>(configMode) == THREADING_MODE_POOL &&
+      AdmissionControl::maxAdmitted() > 0) {
+    LOG(WARNING) << "RestAPI: The budgets of maxInFlightRequests and "
+                    "reservedControlRequests only hold in perConnection mode";
+  }
+
+  // use a single handler sensitive on all paths, event streams block their
+  // connection thread, which only a thread of its own can afford
+  RestRequestHandler handler(
+      listener, get<string>(configMode) == THREADING_MODE_PER_CONNECTION);
+
+  // a webserver listens on a single socket, hence the Unix domain socket
+  // gets a webserver of its own, which runs in the background if the TCP
+  // port is used as well
+  if (!unixPath.empty()) {
+    auto unixFd = ListenSocket::openUnix(unixPath);
+    if (holds_alternative<Error>(unixFd)) {
+      return get<Error>(unixFd);
+    }
+    mUnixFd = get<int>(unixFd);
+    mUnixPath = unixPath;
+
+    auto unixParams = createWebserverParams(port).bind_socket(mUnixFd);
+    auto threadingResult = configureThreading(unixParams);
+    if (threadingResult.has_value()) {
+      stopServer();
+      return threadingResult;
+    }
+    wsUnix = make_unique<webserver>(unixParams);
+    wsUnix->register_resource("/", &handler, true);
+    LOG(INFO) << "RestAPI: Listening at '" << unixPath << "'";
+    wsUnix->start(port == 0);
+    if (port == 0) {
+      return nullopt;
+    }
+  }
+
+  auto webserverParams = createWebserverParams(port);
+  auto threadingResult = configureThreading(webserverParams);
+  if (threadingResult.has_value()) {
+    stopServer();
+    return threadingResult;
+  }
 
   // create the webserver
   ws = make_unique<webserver>(webserverParams);
-
-  // use a single handler sensitive on all paths
-  RestRequestHandler handler(listener);
   ws->register_resource("/", &handler, true);
 
   // run the webserver in blocking mode
   try {
     ws->start(true);
   } catch (invalid_argument const &) {
+    stopServer();
     return Error(ErrorCode::NotInitialized,
                  "Port '" + to_string(port) + "' already taken");
   }
@@ -62,8 +229,24 @@ TResultOpt RestAPI::handleRequests() {
 }
 
 void RestAPI::stopServer() {
+  // open event streams would block the shutdown
+  if ((ws && ws->is_running()) || (wsUnix && wsUnix->is_running())) {
+    EventStream::closeAll();
+  }
   if (ws && ws->is_running()) {
     ws->stop();
     ws = nullptr;
   }
+  if (wsUnix && wsUnix->is_running()) {
+    // libmicrohttpd closes the socket it was bound to, the file is left
+    wsUnix->stop();
+    wsUnix = nullptr;
+    ListenSocket::removeUnix(mUnixPath);
+    mUnixFd = -1;
+  }
+  if (mUnixFd >= 0) {
+    // the webserver was not started
+    ListenSocket::closeUnix(mUnixFd, mUnixPath);
+    mUnixFd = -1;
+  }
 }
@@ -11,21 +11,27 @@
 
 #include <httpserver.hpp>
 #include <memory>
+#include <string>
 
 #include "NetworkAPI.h"
 
 /**
  * @class RestAPI
  * @brief Implementation of the REST API.
+ * @details Listens on the TCP port (key `port`, 0 disables it) and/or a Unix
+ * domain socket (key `unixSocket`) of section `RestAPI`.
  * @sa    NetworkAPI, NetworkListener
  */
 class RestAPI : public NetworkAPI {
  public:
   TResultOpt handleRequests() override;
-  void stopServer();
+  void stopServer() override;
 
  private:
   std::unique_ptr<httpserver::webserver> ws;
+  std::unique_ptr<httpserver::webserver> wsUnix;  ///< see key `unixSocket`
+  int mUnixFd = -1;
+  std::string mUnixPath;
 };
 
 #endif /* _REST_API_H_ */
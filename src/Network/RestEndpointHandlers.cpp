@@ -8,25 +8,53 @@
 
 #include "RestEndpointHandlers.h"
 
+#include <atomic>
+#include <functional>
 #include <iostream>
-
+#include <limits>
+#include <sstream>
+
+#include "AdmissionControl.h"
+#include "EventStream.h"
+#include "RequestDecoder.h"
+#include "RestRoutes.h"
+#include "SerializedQueueCache.h"
+#include "Spotify/SpotifyCallBudget.h"
+#include "Utils/BodyFormat.h"
+#include "Utils/Compression.h"
+#include "Utils/ConfigHandler.h"
+#include "Utils/Deadline.h"
+#include "Utils/HttpHeader.h"
+#include "Utils/JsonWriter.h"
+#include "Utils/MemoryUsage.h"
+#include "Utils/Metrics.h"
+#include "Utils/ProfiledMutex.h"
+#include "Utils/Profiler.h"
 #include "Utils/Serializer.h"
+#include "Utils/Tracing.h"
+#include "Utils/TrackFields.h"
 #include "json/json.hpp"
 
 using namespace std;
 using json = nlohmann::json;
 
+static string const CONFIG_SECTION = "RestAPI";
+static int const DEFAULT_MAX_BATCH_SIZE = 32;
+
+// read by configureEndpointHandlers()
+static atomic<size_t> sMaxBatchSize{DEFAULT_MAX_BATCH_SIZE};
+
 //
 // Helper functions
 //
 
-static TResult<json const> parseJsonString(string const &str) {
-  try {
-    return json::parse(str);
-  } catch (json::parse_error const &) {
-    VLOG(2) << "Failed to parse JSON body: '" << str << "'";
-    return Error(ErrorCode::InvalidFormat, "Failed to parse body");
-  }
+static ResponseInformation const errorResponse(int statusCode,
+                                               string const &message) {
+  json responseBody = {
+      {"status", statusCode},  //
+      {"error", message}       //
+  };
+  return {responseBody.dump(), statusCode};
 }
 
 static ResponseInformation const mapErrorToResponse(Error const &err) {
@@ -49,7 +77,9 @@ static ResponseInformation const mapErrorToResponse(Error const &err) {
       {ErrorCode::SpotifyHttpTimeout, 400},   //
       {ErrorCode::SpotifyNoDevice, 404},      //
       {ErrorCode::AlreadyExists, 400},        //
-      {ErrorCode::DoesntExist, 400}           //
+      {ErrorCode::DoesntExist, 400},          //
+      {ErrorCode::ServiceUnavailable, 503},   //
+      {ErrorCode::DeadlineExceeded, 504}      //
   };
 
   int statusCode;
@@ -66,62 +96,56 @@ static ResponseInformation const mapErrorToResponse(Error const &err) {
 
   VLOG(2) << "Request lead to error: " << err.getErrorMessage();
 
-  // construct response
-  json responseBody = {
-      {"status", statusCode},           //
-      {"error", err.getErrorMessage()}  //
-  };
-  return {responseBody.dump(), statusCode};
+  return errorResponse(statusCode, err.getErrorMessage());
+}
+
+/**
+ * @brief Builds the entity tag of the `getCurrentQueues` response.
+ * @details The response contains the votes of the requesting user, therefore
+ * the session is part of the tag as well. Each range of the normal queue,
+ * selection of fields, format and encoding has its own tag.
+ */
+static string buildQueuesETag(TSessionID const &sid,
+                              QueueStatusVersion const &version,
+                              optional<int> offset,
+                              optional<int> limit,
+                              TrackFieldMask const &fields,
+                              BodyFormat format,
+                              ContentEncoding encoding) {
+  stringstream etag;
+  etag << '"' << hex << std::hash<string>{}(sid) << dec << '-'
+       << version.queueVersion << '-' << version.playbackVersion << '-'
+       << version.votesVersion;
+  if (offset.has_value() || limit.has_value()) {
+    etag << "-range" << offset.value_or(0) << '-';
+    if (limit.has_value()) {
+      etag << limit.value();
+    }
+  }
+  if (!fields.hasAll()) {
+    etag << "-f" << hex << fields.bits() << dec;
+  }
+  if (format == BodyFormat::MessagePack) {
+    etag << "-msgpack";
+  } else if (format == BodyFormat::Cbor) {
+    etag << "-cbor";
+  }
+  if (encoding != ContentEncoding::Identity) {
+    etag << '-' << Compression::name(encoding);
+  }
+  etag << '"';
+  return etag.str();
 }
 
 //
 // Helper macros
 //
 
-#define PARSE_REQUIRED_STRING_FIELD(name, body)                                \
-  do {                                                                         \
-    if (body.find(#name) == body.cend()) {                                     \
-      return mapErrorToResponse(                                               \
-          Error(ErrorCode::InvalidFormat, "Field '" #name "' not found"));     \
-    }                                                                          \
-    if (!body[#name].is_string()) {                                            \
-      return mapErrorToResponse(Error(                                         \
-          ErrorCode::InvalidFormat, "Value of '" #name "' must be a string")); \
-    }                                                                          \
-    name = body[#name].get<string>();                                          \
-  } while (0)
-
-#define PARSE_REQUIRED_INT_FIELD(name, body)                               \
-  do {                                                                     \
-    if (body.find(#name) == body.cend()) {                                 \
-      return mapErrorToResponse(                                           \
-          Error(ErrorCode::InvalidFormat, "Field '" #name "' not found")); \
-    }                                                                      \
-    if (!body[#name].is_number_integer()) {                                \
-      return mapErrorToResponse(Error(ErrorCode::InvalidFormat,            \
-                                      "Value of '" #name                   \
-                                      "' must be an integer"));            \
-    }                                                                      \
-    name = body[#name].get<int>();                                         \
-  } while (0)
-
-#define PARSE_OPTIONAL_STRING_FIELD(name, body)                   \
-  do {                                                            \
-    if (body.find(#name) != body.cend()) {                        \
-      auto nameJson = body[#name];                                \
-      if (!nameJson.is_string()) {                                \
-        return mapErrorToResponse(Error(ErrorCode::InvalidFormat, \
-                                        "Value of '" #name        \
-                                        "' must be a string"));   \
-      }                                                           \
-      name = nameJson.get<string>();                              \
-    }                                                             \
-  } while (0)
-
 #define PARSE_OPTIONAL_INT_PARAMETER(name, args)                               \
   do {                                                                         \
-    if (args.find(#name) != args.cend()) {                                     \
-      auto paramStr = args.at(#name);                                          \
+    auto paramOpt = args.get(#name);                                           \
+    if (paramOpt.has_value()) {                                                \
+      auto const &paramStr = paramOpt.value();                                 \
       int tmpValue;                                                            \
       size_t idx;                                                              \
       try {                                                                    \
@@ -130,6 +154,10 @@ static ResponseInformation const mapErrorToResponse(Error const &err) {
         return mapErrorToResponse(Error(ErrorCode::InvalidFormat,              \
                                         "Parameter '" #name                    \
                                         "' is not an integer"));               \
+      } catch (out_of_range const &) {                                         \
+        return mapErrorToResponse(Error(ErrorCode::InvalidValue,               \
+                                        "Parameter '" #name                    \
+                                        "' is out of range"));                 \
       }                                                                        \
       if (idx != paramStr.size()) {                                            \
         return mapErrorToResponse(Error(                                       \
@@ -142,13 +170,45 @@ static ResponseInformation const mapErrorToResponse(Error const &err) {
 
 #define PARSE_REQUIRED_STRING_PARAMETER(name, args)                            \
   do {                                                                         \
-    if (args.find(#name) == args.cend()) {                                     \
+    auto paramOpt = args.get(#name);                                           \
+    if (!paramOpt.has_value()) {                                               \
       return mapErrorToResponse(                                               \
           Error(ErrorCode::InvalidFormat, "Parameter '" #name "' not found")); \
     }                                                                          \
-    name = args.at(#name);                                                     \
+    name = move(paramOpt.value());                                             \
   } while (0)
 
+#define PARSE_OPTIONAL_FIELDS_PARAMETER(name, args)                            \
+  do {                                                                         \
+    auto paramOpt = args.get(#name);                                           \
+    if (paramOpt.has_value()) {                                                \
+      auto maskResult = TrackFieldMask::parse(paramOpt.value());               \
+      if (holds_alternative<Error>(maskResult)) {                              \
+        return mapErrorToResponse(get<Error>(maskResult));                     \
+      }                                                                        \
+      name = get<TrackFieldMask>(maskResult);                                  \
+    }                                                                          \
+  } while (0)
+
+//
+// CONFIGURATION
+//
+
+TResultOpt configureEndpointHandlers() {
+  auto maxBatchSize = ConfigHandler::getInstance()->getValueInt(
+      CONFIG_SECTION, "maxBatchSize", DEFAULT_MAX_BATCH_SIZE);
+  if (holds_alternative<Error>(maxBatchSize)) {
+    return get<Error>(maxBatchSize);
+  }
+  if (get<int>(maxBatchSize) < 0) {
+    return Error(ErrorCode::InvalidValue,
+                 "configureEndpointHandlers: maxBatchSize must not be "
+                 "negative");
+  }
+  sMaxBatchSize = get<int>(maxBatchSize);
+  return nullopt;
+}
+
 //
 // GENERATE SESSION
 //
@@ -157,18 +217,17 @@ ResponseInformation const generateSessionHandler(
     NetworkListener *listener, RequestInformation const &infos) {
   assert(listener);
 
-  auto parseResult = parseJsonString(infos.body);
-  if (holds_alternative<Error>(parseResult)) {
-    return mapErrorToResponse(get<Error>(parseResult));
-  }
-  json const bodyJson = get<json const>(parseResult);
-
   // parse request parameters
   optional<TPassword> password;
   optional<string> nickname;
 
-  PARSE_OPTIONAL_STRING_FIELD(password, bodyJson);
-  PARSE_OPTIONAL_STRING_FIELD(nickname, bodyJson);
+  auto decodeResult = RequestDecoder()
+                      .optionalString("password", password)
+                      .optionalString("nickname", nickname)
+                      .decode(infos.body);
+  if (decodeResult.has_value()) {
+    return mapErrorToResponse(decodeResult.value());
+  }
 
   // notify the listener about the request
   TResult<TSessionID> result = listener->generateSession(password, nickname);
@@ -195,9 +254,11 @@ ResponseInformation const queryTracksHandler(NetworkListener *listener,
   // parse request parameters
   std::string pattern;
   int max_entries = 50;
+  TrackFieldMask fields;
 
   PARSE_REQUIRED_STRING_PARAMETER(pattern, infos.args);
   PARSE_OPTIONAL_INT_PARAMETER(max_entries, infos.args);
+  PARSE_OPTIONAL_FIELDS_PARAMETER(fields, infos.args);
 
   // notify the listener about the request
   auto result = listener->queryTracks(pattern, max_entries);
@@ -206,15 +267,13 @@ ResponseInformation const queryTracksHandler(NetworkListener *listener,
   }
 
   // construct the response
-  auto queriedTracks = get<vector<BaseTrack>>(result);
-
-  json jsonTracks = json::array();
-  for (auto &&track : queriedTracks) {
-    jsonTracks.push_back(Serializer::serialize(track));
+  JsonWriter writer;
+  writer.beginObject().key("tracks").beginArray();
+  for (auto &&track : get<vector<BaseTrack>>(result)) {
+    Serializer::write(writer, track, fields);
   }
-
-  json responseBody = {{"tracks", jsonTracks}};
-  return {responseBody.dump()};
+  writer.endArray().endObject();
+  return {writer.release()};
 }
 
 //
@@ -227,34 +286,98 @@ ResponseInformation const getCurrentQueuesHandler(
 
   // parse request parameters
   TSessionID session_id;
+  optional<int> offset;
+  optional<int> limit;
+  TrackFieldMask fields;
   PARSE_REQUIRED_STRING_PARAMETER(session_id, infos.args);
+  PARSE_OPTIONAL_INT_PARAMETER(offset, infos.args);
+  PARSE_OPTIONAL_INT_PARAMETER(limit, infos.args);
+  PARSE_OPTIONAL_FIELDS_PARAMETER(fields, infos.args);
+  if (offset.value_or(0) < 0 || limit.value_or(0) < 0) {
+    return mapErrorToResponse(
+        Error(ErrorCode::InvalidValue,
+              "Parameters 'offset' and 'limit' must not be negative"));
+  }
 
-  // notify the listener about the request
-  auto result = listener->getCurrentQueues(session_id);
-  if (holds_alternative<Error>(result)) {
-    return mapErrorToResponse(get<Error>(result));
+  // The version is queried before the queues, hence a concurrent change
+  // results in an outdated ETag (which only causes an additional full
+  // response later on) but never in a wrongly confirmed cache entry.
+  auto versionResult = listener->getCurrentQueuesVersion(session_id);
+  if (holds_alternative<Error>(versionResult)) {
+    return mapErrorToResponse(get<Error>(versionResult));
   }
 
-  // construct the response
-  auto queueStatus = get<QueueStatus>(result);
+  auto format = BodyFormat::Json;
+  auto accept = infos.headers.get("Accept");
+  if (accept.has_value()) {
+    format = BodyCodec::negotiate(accept.value());
+  }
 
-  json playbackTrack = json::object();
-  json normalQueue = json::array();
-  json adminQueue = json::array();
-  if (queueStatus.currentTrack.has_value()) {
-    playbackTrack = Serializer::serialize(queueStatus.currentTrack.value());
+  // JSON is compressed with gzip only, since its segments can be shared
+  // between all users
+  auto encoding = ContentEncoding::Identity;
+  int level = Compression::configuredLevel();
+  auto acceptEncoding = infos.headers.get("Accept-Encoding");
+  if (level > 0 && acceptEncoding.has_value()) {
+    encoding = Compression::negotiate(acceptEncoding.value(),
+                                      format != BodyFormat::Json);
   }
-  for (auto &&track : queueStatus.normalQueue.tracks) {
-    normalQueue.push_back(Serializer::serialize(track));
+
+  auto etag = buildQueuesETag(session_id,
+                              get<QueueStatusVersion>(versionResult),
+                              offset,
+                              limit,
+                              fields,
+                              format,
+                              encoding);
+  map<string, string> headers = {{"ETag", etag},
+                                 {"Cache-Control", "private, no-cache"},
+                                 {"Vary", "Accept, Accept-Encoding"}};
+
+  // the client already has the current state, skip collecting the queues
+  auto ifNoneMatch = infos.headers.get("If-None-Match");
+  if (ifNoneMatch.has_value() &&
+      HttpHeader::matchesETag(ifNoneMatch.value(), etag)) {
+    VLOG(2) << "getCurrentQueues: ETag " << etag << " not modified";
+    return {"", 304, headers};
   }
-  for (auto &&track : queueStatus.adminQueue.tracks) {
-    adminQueue.push_back(Serializer::serialize(track));
+
+  // notify the listener about the request, without range the whole normal
+  // queue is returned
+  TResult<QueueStatus> result;
+  if (offset.has_value() || limit.has_value()) {
+    result = listener->getCurrentQueuesRange(
+        session_id,
+        offset.value_or(0),
+        limit.has_value() ? limit.value() : numeric_limits<size_t>::max());
+  } else {
+    result = listener->getCurrentQueues(session_id);
+  }
+  if (holds_alternative<Error>(result)) {
+    return mapErrorToResponse(get<Error>(result));
   }
 
-  json responseBody = {{"currently_playing", playbackTrack},
-                       {"normal_queue", normalQueue},
-                       {"admin_queue", adminQueue}};
-  return {responseBody.dump()};
+  // construct the response
+  auto const &queueStatus = get<QueueStatus>(result);
+  if (format != BodyFormat::Json) {
+    headers["Content-Type"] = BodyCodec::mediaType(format);
+    auto body = SerializedQueueCache::serialize(queueStatus, format, fields);
+    if (encoding != ContentEncoding::Identity) {
+      headers["Content-Encoding"] = Compression::name(encoding);
+      body = Compression::compress(body, encoding, level);
+    }
+    return {move(body), 200, headers};
+  }
+  if (encoding == ContentEncoding::Gzip) {
+    headers["Content-Encoding"] = "gzip";
+    return {SerializedQueueCache::serializeGzip(queueStatus, level, fields),
+            200,
+            headers};
+  }
+  return {
+      SerializedQueueCache::serialize(queueStatus, BodyFormat::Json, fields),
+      200,
+      headers};
 }
 
 //
@@ -265,20 +388,19 @@ ResponseInformation const addTrackToQueueHandler(
     NetworkListener *listener, RequestInformation const &infos) {
   assert(listener);
 
-  auto parseResult = parseJsonString(infos.body);
-  if (holds_alternative<Error>(parseResult)) {
-    return mapErrorToResponse(get<Error>(parseResult));
-  }
-  json const bodyJson = get<json const>(parseResult);
-
   // parse request specific JSON fields
   TSessionID session_id;
   TTrackID track_id;
   optional<string> queue_type;
 
-  PARSE_REQUIRED_STRING_FIELD(session_id, bodyJson);
-  PARSE_REQUIRED_STRING_FIELD(track_id, bodyJson);
-  PARSE_OPTIONAL_STRING_FIELD(queue_type, bodyJson);
+  auto decodeResult = RequestDecoder()
+                      .requiredString("session_id", session_id)
+                      .requiredString("track_id", track_id)
+                      .optionalString("queue_type", queue_type)
+                      .decode(infos.body);
+  if (decodeResult.has_value()) {
+    return mapErrorToResponse(decodeResult.value());
+  }
 
   QueueType queueType = QueueType::Normal;
   if (queue_type.has_value()) {
@@ -313,20 +435,19 @@ ResponseInformation const voteTrackHandler(NetworkListener *listener,
                                            RequestInformation const &infos) {
   assert(listener);
 
-  auto parseResult = parseJsonString(infos.body);
-  if (holds_alternative<Error>(parseResult)) {
-    return mapErrorToResponse(get<Error>(parseResult));
-  }
-  json const bodyJson = get<json const>(parseResult);
-
   // parse request specific JSON fields
   TSessionID session_id;
   TTrackID track_id;
   int vote;
 
-  PARSE_REQUIRED_STRING_FIELD(session_id, bodyJson);
-  PARSE_REQUIRED_STRING_FIELD(track_id, bodyJson);
-  PARSE_REQUIRED_INT_FIELD(vote, bodyJson);
+  auto decodeResult = RequestDecoder()
+                      .requiredString("session_id", session_id)
+                      .requiredString("track_id", track_id)
+                      .requiredInt("vote", vote)
+                      .decode(infos.body);
+  if (decodeResult.has_value()) {
+    return mapErrorToResponse(decodeResult.value());
+  }
 
   // notify the listener about the request
   TResultOpt result = listener->voteTrack(session_id, track_id, (vote != 0));
@@ -347,18 +468,17 @@ ResponseInformation const controlPlayerHandler(
     NetworkListener *listener, RequestInformation const &infos) {
   assert(listener);
 
-  auto parseResult = parseJsonString(infos.body);
-  if (holds_alternative<Error>(parseResult)) {
-    return mapErrorToResponse(get<Error>(parseResult));
-  }
-  json const bodyJson = get<json const>(parseResult);
-
   // parse request specific JSON fields
   TSessionID session_id;
   string player_action;
 
-  PARSE_REQUIRED_STRING_FIELD(session_id, bodyJson);
-  PARSE_REQUIRED_STRING_FIELD(player_action, bodyJson);
+  auto decodeResult = RequestDecoder()
+                      .requiredString("session_id", session_id)
+                      .requiredString("player_action", player_action)
+                      .decode(infos.body);
+  if (decodeResult.has_value()) {
+    return mapErrorToResponse(decodeResult.value());
+  }
 
   PlayerAction playerAction;
   // TODO: do deserialization using the JSON framework
@@ -399,20 +519,19 @@ ResponseInformation const moveTracksHandler(NetworkListener *listener,
                                             RequestInformation const &infos) {
   assert(listener);
 
-  auto parseResult = parseJsonString(infos.body);
-  if (holds_alternative<Error>(parseResult)) {
-    return mapErrorToResponse(get<Error>(parseResult));
-  }
-  json const bodyJson = get<json const>(parseResult);
-
   // parse request specific JSON fields
   TSessionID session_id;
   TTrackID track_id;
   optional<string> queue_type;
 
-  PARSE_REQUIRED_STRING_FIELD(session_id, bodyJson);
-  PARSE_REQUIRED_STRING_FIELD(track_id, bodyJson);
-  PARSE_OPTIONAL_STRING_FIELD(queue_type, bodyJson);
+  auto decodeResult = RequestDecoder()
+                      .requiredString("session_id", session_id)
+                      .requiredString("track_id", track_id)
+                      .optionalString("queue_type", queue_type)
+                      .decode(infos.body);
+  if (decodeResult.has_value()) {
+    return mapErrorToResponse(decodeResult.value());
+  }
 
   if (!queue_type.has_value()) {
     return mapErrorToResponse(
@@ -453,18 +572,17 @@ ResponseInformation const removeTrackHandler(NetworkListener *listener,
   // TODO: this endpoint should use query parameters since the DELETE method
   // does not support a body
 
-  auto parseResult = parseJsonString(infos.body);
-  if (holds_alternative<Error>(parseResult)) {
-    return mapErrorToResponse(get<Error>(parseResult));
-  }
-  json const bodyJson = get<json const>(parseResult);
-
   // parse request specific JSON fields
   TSessionID session_id;
   TTrackID track_id;
 
-  PARSE_REQUIRED_STRING_FIELD(session_id, bodyJson);
-  PARSE_REQUIRED_STRING_FIELD(track_id, bodyJson);
+  auto decodeResult = RequestDecoder()
+                      .requiredString("session_id", session_id)
+                      .requiredString("track_id", track_id)
+                      .decode(infos.body);
+  if (decodeResult.has_value()) {
+    return mapErrorToResponse(decodeResult.value());
+  }
 
   // notify the listener about the request
   TResultOpt result = listener->removeTrack(session_id, track_id);
@@ -476,3 +594,348 @@ ResponseInformation const removeTrackHandler(NetworkListener *listener,
   json responseBody = json::object();
   return {responseBody.dump()};
 }
+
+//
+// EVENTS
+//
+
+ResponseInformation const eventsHandler(NetworkListener *listener,
+                                        RequestInformation const &infos) {
+  assert(listener);
+
+  // parse request parameters
+  TSessionID session_id;
+  PARSE_REQUIRED_STRING_PARAMETER(session_id, infos.args);
+
+  // open the stream
+  auto result = EventStream::subscribe(listener, session_id);
+  if (holds_alternative<Error>(result)) {
+    return mapErrorToResponse(get<Error>(result));
+  }
+
+  // construct the response
+  ResponseInformation response{"",
+                               200,
+                               {{"Content-Type", "text/event-stream"},
+                                {"Cache-Control", "no-cache"}}};
+  response.stream = get<shared_ptr<EventStream>>(result);
+  return response;
+}
+
+//
+// BATCH
+//
+
+/**
+ * @brief Executes a run of consecutive vote requests of the same user.
+ * @details The votes are passed to the listener at once, so the session is
+ * validated and the queue is locked only once. The run ends at the first
+ * request which is no vote or belongs to another session.
+ * @return The index after the last request of the run.
+ */
+static size_t executeVoteRun(NetworkListener *listener,
+                             vector<RequestInformation> const &requests,
+                             vector<RouteMatch> const &routes,
+                             vector<optional<ResponseInformation>> &responses,
+                             size_t begin) {
+  optional<TSessionID> runSession;
+  vector<pair<TTrackID, TVote>> votes;
+  vector<size_t> indices;
+
+  size_t end = begin;
+  for (; end < requests.size(); end++) {
+    if (responses[end].has_value() || routes[end].handler != voteTrackHandler) {
+      break;
+    }
+
+    TSessionID session_id;
+    TTrackID track_id;
+    int vote;
+    auto decodeResult = RequestDecoder()
+                        .requiredString("session_id", session_id)
+                        .requiredString("track_id", track_id)
+                        .requiredInt("vote", vote)
+                        .decode(requests[end].body);
+    if (decodeResult.has_value()) {
+      responses[end] = mapErrorToResponse(decodeResult.value());
+      continue;
+    }
+    if (runSession.has_value() && runSession.value() != session_id) {
+      break;
+    }
+
+    runSession = session_id;
+    votes.emplace_back(track_id, (vote != 0));
+    indices.push_back(end);
+  }
+
+  if (!votes.empty()) {
+    auto results = listener->voteTracks(runSession.value(), votes);
+    assert(results.size() == votes.size());
+    for (size_t i = 0; i < indices.size(); i++) {
+      if (results[i].has_value()) {
+        responses[indices[i]] = mapErrorToResponse(results[i].value());
+      } else {
+        responses[indices[i]] = ResponseInformation{json::object().dump()};
+      }
+    }
+  }
+  return end;
+}
+
+ResponseInformation const batchHandler(NetworkListener *listener,
+                                       RequestInformation const &infos) {
+  assert(listener);
+
+  // parse the sub-requests
+  json requestBody = json::parse(infos.body, nullptr, false);
+  if (requestBody.is_discarded() || !requestBody.is_object()) {
+    return mapErrorToResponse(
+        Error(ErrorCode::InvalidFormat, "Failed to parse body"));
+  }
+  auto requestsIt = requestBody.find("requests");
+  if (requestsIt == requestBody.end()) {
+    return mapErrorToResponse(
+        Error(ErrorCode::InvalidFormat, "Field 'requests' not found"));
+  }
+  if (!requestsIt->is_array()) {
+    return mapErrorToResponse(Error(ErrorCode::InvalidFormat,
+                                    "Value of 'requests' must be an array"));
+  }
+
+  if (requestsIt->size() > sMaxBatchSize.load(memory_order_relaxed)) {
+    return mapErrorToResponse(
+        Error(ErrorCode::InvalidValue, "Too many requests in batch"));
+  }
+
+  // the sub-requests refer to the parsed body, only their bodies are dumped
+  size_t count = requestsIt->size();
+  vector<RequestInformation> requests(count);
+  vector<string> bodies(count);
+  vector<RouteMatch> routes(count);
+  vector<optional<ResponseInformation>> responses(count);
+  for (size_t i = 0; i < count; i++) {
+    auto const &item = (*requestsIt)[i];
+    auto &request = requests[i];
+    if (!item.is_object() || !item.contains("method") ||
+        !item["method"].is_string() || !item.contains("path") ||
+        !item["path"].is_string()) {
+      responses[i] = errorResponse(
+          422, "Request needs a 'method' and a 'path' of type string");
+      continue;
+    }
+    request.method = item["method"].get_ref<string const &>();
+    request.path = item["path"].get_ref<string const &>();
+    request.version = infos.version;
+    if (item.contains("body")) {
+      bodies[i] = item["body"].dump();
+      request.body = bodies[i];
+    }
+    if (item.contains("args")) {
+      if (!item["args"].is_object()) {
+        responses[i] = errorResponse(422, "Value of 'args' must be an object");
+        continue;
+      }
+      for (auto const &[key, value] : item["args"].items()) {
+        request.args.set(
+            key, value.is_string() ? value.get<string>() : value.dump());
+      }
+    }
+
+    routes[i] = matchRoute(request.path, request.version, request.method);
+    if (routes[i].result == RouteMatch::Result::NotFound) {
+      responses[i] = errorResponse(
+          404, "Endpoint '" + string(request.path) + "' was not found");
+    } else if (routes[i].result == RouteMatch::Result::MethodNotAllowed) {
+      responses[i] = errorResponse(405,
+                                   "Method '" + string(request.method) +
+                                       "' is not allowed at endpoint '" +
+                                       string(request.path) + "'");
+    } else if (routes[i].handler == batchHandler ||
+               routes[i].handler == eventsHandler) {
+      responses[i] = errorResponse(
+          422, "Endpoint '" + string(request.path) + "' can not be batched");
+    } else if (!routes[i].parameterName.empty()) {
+      request.args.set(string(routes[i].parameterName),
+                       string(routes[i].parameterValue));
+    }
+  }
+
+  // execute them in order, requests left at the deadline are skipped
+  for (size_t i = 0; i < count;) {
+    if (responses[i].has_value()) {
+      i++;
+      continue;
+    }
+    if (auto expired = Deadline::check()) {
+      responses[i] = mapErrorToResponse(expired.value());
+      i++;
+      continue;
+    }
+
+    // normal requests share the slot of the batch itself, control requests
+    // occupy a slot of their lane, as if they were sent on their own, so a
+    // batch does not bypass the budget of the control lane
+    AdmissionTicket ticket;
+    if (routes[i].lane != RequestLane::Normal) {
+      ticket = AdmissionControl::admit(routes[i].lane);
+    }
+    if (routes[i].lane != RequestLane::Normal && !ticket) {
+      responses[i] = errorResponse(503, "Server is overloaded");
+      i++;
+    } else if (routes[i].handler == voteTrackHandler) {
+      i = executeVoteRun(listener, requests, routes, responses, i);
+    } else {
+      responses[i] = routes[i].handler(listener, requests[i]);
+      i++;
+    }
+  }
+
+  // construct the response, the bodies of all handlers are JSON already
+  JsonWriter writer;
+  writer.beginObject().key("responses").beginArray();
+  for (auto const &response : responses) {
+    // responses without a body (e.g. 204) have no JSON value of their own
+    auto const &body = response.value().body;
+    writer.beginObject()
+        .key("body")
+        .rawValue(body.empty() ? "null" : string_view(body))
+        .key("status")
+        .value(response.value().code)
+        .endObject();
+  }
+  writer.endArray().endObject();
+  return {writer.release()};
+}
+
+//
+// METRICS
+//
+
+ResponseInformation const metricsHandler(NetworkListener *listener,
+                                         RequestInformation const &) {
+  assert(listener);
+
+  // sampled on each scrape instead of being updated on each request
+  static auto &inFlight =
+      Metrics::gauge("jukebox_http_requests_in_flight",
+                     "Requests admitted and not yet handled");
+  static auto &rejected =
+      Metrics::gauge("jukebox_http_requests_rejected",
+                     "Requests rejected by the admission control so far");
+  auto stats = AdmissionControl::stats();
+  inFlight.get().set(static_cast<int64_t>(stats.inFlight));
+  rejected.get().set(static_cast<int64_t>(stats.rejected));
+  MemoryUsage::updateMetrics();
+  LockProfiler::updateMetrics();
+
+  return {Metrics::serialize(),
+          200,
+          {{"Content-Type", "text/plain; version=0.0.4; charset=utf-8"},
+           {"Cache-Control", "no-cache"}}};
+}
+
+//
+// TRACE
+//
+
+ResponseInformation const traceHandler(NetworkListener *listener,
+                                       RequestInformation const &) {
+  assert(listener);
+
+  return {Tracing::chromeTrace(),
+          200,
+          {{"Content-Type", "application/json"},
+           {"Cache-Control", "no-cache"}}};
+}
+
+//
+// LOCKS
+//
+
+ResponseInformation const locksHandler(NetworkListener *listener,
+                                       RequestInformation const &) {
+  assert(listener);
+
+  return {LockProfiler::report(), 200, {{"Cache-Control", "no-cache"}}};
+}
+
+//
+// MEMORY
+//
+
+ResponseInformation const memoryHandler(NetworkListener *listener,
+                                        RequestInformation const &) {
+  assert(listener);
+
+  return {MemoryUsage::report(), 200, {{"Cache-Control", "no-cache"}}};
+}
+
+//
+// SPOTIFY CALLS
+//
+
+ResponseInformation const spotifyCallsHandler(NetworkListener *listener,
+                                              RequestInformation const &) {
+  assert(listener);
+
+  return {SpotifyApi::SpotifyCallBudget::report(),
+          200,
+          {{"Cache-Control", "no-cache"}}};
+}
+
+//
+// PROFILE
+//
+
+// duration of a profile if the request does not specify one
+static int const DEFAULT_PROFILE_SECONDS = 10;
+
+static ResponseInformation const profileHandler(
+    NetworkListener *listener,
+    RequestInformation const &infos,
+    TResult<Profiler::Profile> (*record)(chrono::seconds)) {
+  // parse request parameters
+  TSessionID session_id;
+  int seconds = DEFAULT_PROFILE_SECONDS;
+  PARSE_REQUIRED_STRING_PARAMETER(session_id, infos.args);
+  PARSE_OPTIONAL_INT_PARAMETER(seconds, infos.args);
+  int maxSeconds = Profiler::MAX_DURATION.count();
+  if (seconds < 1 || seconds > maxSeconds) {
+    return mapErrorToResponse(
+        Error(ErrorCode::InvalidValue,
+              "Parameter 'seconds' must be between 1 and " +
+                  to_string(maxSeconds)));
+  }
+
+  auto authorized = listener->authorizeAdmin(session_id);
+  if (authorized.has_value()) {
+    return mapErrorToResponse(authorized.value());
+  }
+
+  auto result = record(chrono::seconds(seconds));
+  if (holds_alternative<Error>(result)) {
+    return mapErrorToResponse(get<Error>(result));
+  }
+  auto &profile = get<Profiler::Profile>(result);
+  return {move(profile.folded),
+          200,
+          {{"Content-Type", "text/plain; charset=utf-8"},
+           {"Cache-Control", "no-cache"},
+           {"X-Profile-Samples", to_string(profile.samples)},
+           {"X-Profile-Dropped-Samples", to_string(profile.dropped)}}};
+}
+
+ResponseInformation const profileCpuHandler(NetworkListener *listener,
+                                            RequestInformation const &infos) {
+  assert(listener);
+
+  return profileHandler(listener, infos, Profiler::profileCpu);
+}
+
+ResponseInformation const profileHeapHandler(NetworkListener *listener,
+                                             RequestInformation const &infos) {
+  assert(listener);
+
+  return profileHandler(listener, infos, Profiler::profileHeap);
+}
@@ -15,6 +15,13 @@
 typedef ResponseInformation const (*TEndpointHandler)(
     NetworkListener *, RequestInformation const &);
 
+/**
+ * @brief Reads the configuration of the handlers (key `maxBatchSize` of
+ * section `RestAPI`), called when the server starts.
+ * @return An error if a value is not a number or negative.
+ */
+TResultOpt configureEndpointHandlers();
+
 ResponseInformation const generateSessionHandler(NetworkListener *,
                                                  RequestInformation const &);
 
@@ -39,4 +46,31 @@ ResponseInformation const moveTracksHandler(NetworkListener *,
 ResponseInformation const removeTrackHandler(NetworkListener *,
                                              RequestInformation const &);
 
+ResponseInformation const eventsHandler(NetworkListener *,
+                                        RequestInformation const &);
+
+ResponseInformation const batchHandler(NetworkListener *,
+                                       RequestInformation const &);
+
+ResponseInformation const metricsHandler(NetworkListener *,
+                                         RequestInformation const &);
+
+ResponseInformation const traceHandler(NetworkListener *,
+                                       RequestInformation const &);
+
+ResponseInformation const locksHandler(NetworkListener *,
+                                       RequestInformation const &);
+
+ResponseInformation const memoryHandler(NetworkListener *,
+                                        RequestInformation const &);
+
+ResponseInformation const spotifyCallsHandler(NetworkListener *,
+                                              RequestInformation const &);
+
+ResponseInformation const profileCpuHandler(NetworkListener *,
+                                            RequestInformation const &);
+
+ResponseInformation const profileHeapHandler(NetworkListener *,
+                                             RequestInformation const &);
+
 #endif  // _REST_ENDPOINT_HANDLERS_H_
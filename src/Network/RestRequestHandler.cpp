@@ -8,22 +8,33 @@
 
 #include "RestRequestHandler.h"
 
+#include <fcntl.h>
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <cassert>
+#include <charconv>
+#include <chrono>
 #include <iostream>
+#include <optional>
 #include <sstream>
 
-#include "RestEndpointHandlers.h"
+#include "AdmissionControl.h"
+#include "IdempotencyCache.h"
+#include "RestRoutes.h"
+#include "StaticFiles.h"
+#include "Utils/BodyFormat.h"
+#include "Utils/Compression.h"
+#include "Utils/Deadline.h"
 #include "Utils/LoggingHandler.h"
+#include "Utils/Metrics.h"
+#include "Utils/Tracing.h"
 #include "json/json.hpp"
 
 using namespace std;
 using namespace httpserver;
 using json = nlohmann::json;
 
-static string const API_BASE_PATH = "/api/v1";
-
 //
 // Utilities
 //
@@ -41,36 +52,253 @@ static optional<string> getCurrentExceptionMessage() {
   return nullopt;
 }
 
+/**
+ * @brief Response which takes ownership of its body.
+ * @details In contrast to `string_response` the body is not copied into the
+ * MHD response, which uses the buffer of this object instead. The object is
+ * kept alive by the webserver until the request is completed.
+ */
+class OwningStringResponse : public http_response {
+ public:
+  OwningStringResponse(string &&body, int code)
+      : http_response(code, "text/plain"), mBody(move(body)) {
+  }
+
+  MHD_Response *get_raw_response() override {
+    return MHD_create_response_from_buffer(
+        mBody.size(), mBody.data(), MHD_RESPMEM_PERSISTENT);
+  }
+
+ private:
+  string mBody;
+};
+
+/**
+ * @brief Response whose body is an open file, which MHD sends with
+ * `sendfile`.
+ * @details MHD closes the descriptor of the response, hence the file is
+ * reopened. The new descriptor has a file offset of its own, which is not
+ * shared with concurrent responses of the same file.
+ */
+class FileBodyResponse : public http_response {
+ public:
+  FileBodyResponse(shared_ptr<FileBody const> file, int code)
+      : http_response(code, "text/plain"), mFile(move(file)) {
+  }
+
+  MHD_Response *get_raw_response() override {
+    auto procPath = "/proc/self/fd/" + to_string(mFile->fd);
+    int fd = open(procPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      fd = dup(mFile->fd);
+    }
+    return MHD_create_response_from_fd(mFile->size, fd);
+  }
+
+ private:
+  shared_ptr<FileBody const> mFile;
+};
+
+static ssize_t produceStreamBody(shared_ptr<StreamBody> stream,
+                                 char *buffer,
+                                 size_t maxSize) {
+  return stream->produce(buffer, maxSize);
+}
+
+/**
+ * @brief Returns the value of a request header, or an empty string.
+ */
+static string getHeader(RequestInformation const &request,
+                        string const &name) {
+  return request.headers.get(name).value_or("");
+}
+
+/**
+ * @brief Returns whether a query string (`?k=v&k2=v2`, as rebuilt by
+ * libhttpserver from the decoded parameters) contains a parameter.
+ * @details Decoded values containing `&<key>=` are taken for the parameter,
+ * which only matters for parameters missing at the same time.
+ */
+static bool containsArg(string_view querystring, string_view key) {
+  for (size_t pos = querystring.find(key); pos != string_view::npos;
+       pos = querystring.find(key, pos + 1)) {
+    size_t end = pos + key.size();
+    bool startsParameter =
+        pos > 0 && (querystring[pos - 1] == '?' || querystring[pos - 1] == '&');
+    if (startsParameter && end < querystring.size() &&
+        querystring[end] == '=') {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Looks up a query parameter in the request of libhttpserver.
+ * @details Missing parameters are returned as empty strings by libhttpserver,
+ * which keeps the connection of the request (and hence
+ * `MHD_lookup_connection_value_n`) to itself. Empty values are told apart by
+ * the query string the request holds, instead of copying all parameters.
+ */
+static optional<string> lookupArg(void const *source, string const &key) {
+  auto const &request = *static_cast<http_request const *>(source);
+  auto value = request.get_arg(key);
+  if (value.empty() && !containsArg(request.get_querystring(), key)) {
+    return nullopt;
+  }
+  return value;
+}
+
+/**
+ * @brief Looks up a header field in the request of libhttpserver.
+ */
+static optional<string> lookupHeader(void const *source, string const &key) {
+  auto value = static_cast<http_request const *>(source)->get_header(key);
+  if (value.empty()) {
+    return nullopt;
+  }
+  return value;
+}
+
+/**
+ * @brief Adds a request header to the `Vary` header of the response.
+ */
+static void addVary(ResponseInformation &response, string const &header) {
+  auto &vary = response.headers["Vary"];
+  if (vary.empty()) {
+    vary = header;
+  } else if (vary.find(header) == string::npos) {
+    vary += ", " + header;
+  }
+}
+
+/**
+ * @brief Encodes the JSON body of the response in the format requested by the
+ * client.
+ * @details Responses which are streamed, empty or have a content type set by
+ * their handler already are left unchanged.
+ */
+static void encodeResponse(RequestInformation const &request,
+                           ResponseInformation &response) {
+  if (response.stream || response.file || response.body.empty() ||
+      response.headers.count("Content-Type") > 0 ||
+      response.headers.count("Content-Encoding") > 0) {
+    return;
+  }
+
+  addVary(response, "Accept");
+  auto format = BodyCodec::negotiate(getHeader(request, "Accept"));
+  if (format == BodyFormat::Json) {
+    return;
+  }
+  auto encoded = BodyCodec::fromJson(response.body, format);
+  if (holds_alternative<Error>(encoded)) {
+    LOG(ERROR) << "Response is no valid JSON: " << response.body;
+    return;
+  }
+  response.body = move(get<string>(encoded));
+  response.headers["Content-Type"] = BodyCodec::mediaType(format);
+}
+
+/**
+ * @brief Returns the timeout of a request, which is configured per endpoint
+ * and may be shortened by the client.
+ */
+static optional<chrono::milliseconds> requestTimeout(
+    RouteMatch const &route, RequestInformation const &request) {
+  // the key of an endpoint is its path without the leading slash
+  auto timeout = Deadline::configuredTimeout(route.pattern.substr(1));
+  auto header = request.headers.get("X-Request-Timeout-Ms");
+  auto clientTimeout =
+      header.has_value() ? Deadline::parseTimeout(header.value()) : nullopt;
+  if (!clientTimeout.has_value()) {
+    return timeout;
+  }
+  if (!timeout.has_value()) {
+    return clientTimeout;
+  }
+  return min(timeout.value(), clientTimeout.value());
+}
+
+/**
+ * @brief Compresses the body of the response if the client accepts it.
+ * @details Responses which are streamed, compressed by their handler already
+ * or too small to benefit are left unchanged, as well as files (which may be
+ * precompressed).
+ */
+static void compressResponse(RequestInformation const &request,
+                             ResponseInformation &response) {
+  if (response.stream || response.file ||
+      response.headers.count("Content-Encoding") > 0) {
+    return;
+  }
+  int level = Compression::configuredLevel();
+  if (level <= 0 || response.body.size() < Compression::configuredMinSize()) {
+    return;
+  }
+
+  addVary(response, "Accept-Encoding");
+  auto encoding =
+      Compression::negotiate(getHeader(request, "Accept-Encoding"));
+  if (encoding == ContentEncoding::Identity) {
+    return;
+  }
+  // the body is sent uncompressed if the compressor fails
+  try {
+    response.body = Compression::compress(response.body, encoding, level);
+  } catch (exception const &e) {
+    LOG(ERROR) << "Compression of response failed: " << e.what();
+    return;
+  }
+  response.headers["Content-Encoding"] = Compression::name(encoding);
+}
+
+static string notFoundMessage(string_view path, string_view method) {
+  stringstream msg;
+  msg << "Endpoint '" << path << "' was not found (method '" << method << "'!";
+  VLOG(1) << msg.str();
+  return msg.str();
+}
+
+static string notAllowedMessage(string_view path, string_view method) {
+  stringstream msg;
+  msg << "Method '" << method << "' is not allowed at endpoint '" << path
+      << "'!";
+  VLOG(1) << msg.str();
+  return msg.str();
+}
+
 //
 // Default request handlers
 //
 
 shared_ptr<http_response> const RestRequestHandler::NotFoundHandler(
     http_request const &req) {
-  stringstream msg;
-  msg << "Endpoint '" << req.get_path() << "' was not found (method '"
-      << req.get_method() << "'!";
-  VLOG(1) << msg.str();
-  return make_shared<string_response>(msg.str(), 404);
+  return make_shared<string_response>(
+      notFoundMessage(req.get_path(), req.get_method()), 404);
 }
 shared_ptr<http_response> const RestRequestHandler::NotAllowedHandler(
     http_request const &req) {
-  stringstream msg;
-  msg << "Method '" << req.get_method() << "' is not allowed at endpoint '"
-      << req.get_path() << "'!";
-  VLOG(1) << msg.str();
-  return make_shared<string_response>(msg.str(), 405);
+  return make_shared<string_response>(
+      notAllowedMessage(req.get_path(), req.get_method()), 405);
 }
 
 shared_ptr<http_response> const RestRequestHandler::InternalErrorHandler(
     http_request const &req) {
+  auto response = internalErrorResponse(
+      req.get_path(), req.get_method(), req.get_content());
+  return make_shared<string_response>(response.body, response.code);
+}
+
+ResponseInformation RestRequestHandler::internalErrorResponse(
+    string_view path, string_view method, string_view content) {
   stringstream msg;
-  msg << "The request to endpoint '" << req.get_path() << "' ";
-  msg << "with method '" << req.get_method() << "' ";
+  msg << "The request to endpoint '" << path << "' ";
+  msg << "with method '" << method << "' ";
   msg << "lead to an internal server error." << endl;
   msg << "Please contact the server team!" << endl << endl;
   msg << "Request content:" << endl;
-  msg << req.get_content() << endl;
+  msg << content << endl;
 
   auto exceptionMessageOpt = getCurrentExceptionMessage();
   if (exceptionMessageOpt.has_value()) {
@@ -79,71 +307,243 @@ shared_ptr<http_response> const RestRequestHandler::InternalErrorHandler(
     msg << exceptionMessageOpt.value();
   }
   LOG(ERROR) << msg.str();
-  return make_shared<string_response>(msg.str(), 500);
+  return {msg.str(), 500};
+}
+
+/**
+ * @brief Looks up the `Idempotency-Key` of a mutating request.
+ * @return The response to a retry (or to a misused key), or `nullopt` if the
+ * request has to be handled. Its response is stored by the reservation then.
+ */
+static optional<ResponseInformation> checkIdempotencyKey(
+    RouteMatch const &route,
+    RequestInformation const &request,
+    IdempotencyReservation &reservation) {
+  static size_t const MAX_KEY_LENGTH = 255;
+
+  auto key = request.headers.get("Idempotency-Key");
+  if (!key.has_value() || request.method == "GET") {
+    return nullopt;
+  }
+  auto errorResponse = [](int code, string const &message) {
+    json responseBody = {{"status", code}, {"error", message}};
+    return ResponseInformation{responseBody.dump(), code};
+  };
+  if (key.value().empty() || key.value().size() > MAX_KEY_LENGTH) {
+    return errorResponse(400, "Invalid value of header 'Idempotency-Key'");
+  }
+
+  string scope = string(request.method) + ' ' + string(route.pattern);
+  auto lookup = IdempotencyCache::lookup(scope, key.value(), request.body);
+  switch (lookup.result) {
+    case IdempotencyCache::Lookup::Result::New:
+      reservation = move(lookup.reservation);
+      return nullopt;
+    case IdempotencyCache::Lookup::Result::Replay:
+      VLOG(1) << "Replaying response to '" << request.path << "'";
+      lookup.response.headers["Idempotent-Replayed"] = "true";
+      encodeResponse(request, lookup.response);
+      compressResponse(request, lookup.response);
+      return move(lookup.response);
+    case IdempotencyCache::Lookup::Result::InProgress:
+      return errorResponse(409, "A request with this key is still in progress");
+    case IdempotencyCache::Lookup::Result::Mismatch:
+      break;
+  }
+  return errorResponse(422, "Key was used for a different request");
 }
 
 //
 // RestRequestHandler implementation
 //
 
-RestRequestHandler::RestRequestHandler(NetworkListener *listener)
-    : listener(listener) {
+RestRequestHandler::RestRequestHandler(NetworkListener *listener,
+                                       bool streamsAllowed)
+    : listener(listener), streamsAllowed(streamsAllowed) {
   assert(listener);
 }
 
-bool RestRequestHandler::isValidBasePath(string const &path) const {
-  // check if API_BASE_PATH is found at index 0
-  return path.rfind(API_BASE_PATH, 0) == 0;
-}
+/**
+ * @brief Implementation of `decodeAndDispatch`.
+ * @param endpoint Is set to the name of the endpoint in the metrics, if the
+ * request refers to one.
+ */
+static ResponseInformation dispatch(NetworkListener *listener,
+                                    RequestInformation &&request,
+                                    string_view &endpoint) {
+  auto route = matchRoute(request.path, request.method);
+  if (route.result == RouteMatch::Result::NotFound) {
+    route = matchServerRoute(request.path, request.method);
+  }
+  if (route.result == RouteMatch::Result::NotFound) {
+    // any other path may refer to a file of the web client
+    auto fileResponse = StaticFiles::serve(request);
+    if (fileResponse.has_value()) {
+      endpoint = "static";
+      return move(fileResponse.value());
+    }
+    return {notFoundMessage(request.path, request.method), 404};
+  }
+  endpoint = route.pattern;
+  if (route.result == RouteMatch::Result::MethodNotAllowed) {
+    return {notAllowedMessage(request.path, request.method),
+            405,
+            {{"Allow", allowedMethodsHeader(route.allowedMethods)}}};
+  }
 
-shared_ptr<http_response> const RestRequestHandler::render(
-    http_request const &req) {
-  if (!isValidBasePath(req.get_path())) {
-    return NotFoundHandler(req);
+  // retries of requests which were handled already are answered right away
+  IdempotencyReservation reservation;
+  auto idempotentResponse = checkIdempotencyKey(route, request, reservation);
+  if (idempotentResponse.has_value()) {
+    return move(idempotentResponse.value());
   }
 
-  VLOG(2) << "Path: " << req.get_path();
-  VLOG(2) << "Method: " << req.get_method();
-  VLOG(2) << "Body: " << req.get_content();
-  VLOG(2) << "Query parameters: " << req.get_querystring();
+  // overloaded servers reject requests before doing any work on them
+  auto ticket = AdmissionControl::admit(route.lane);
+  if (!ticket) {
+    VLOG(1) << "Server overloaded, rejecting '" << request.path << "'";
+    json responseBody = {
+        {"status", 503},                  //
+        {"error", "Server is overloaded"}  //
+    };
+    return {responseBody.dump(),
+            503,
+            {{"Retry-After",
+              to_string(AdmissionControl::configuredRetryAfter())}}};
+  }
+
+  // backend calls are cut short once the client has given up on the request
+  Deadline::Scope deadline(requestTimeout(route, request));
 
-  auto path = req.get_path().substr(API_BASE_PATH.size());
-  auto response = decodeAndDispatch(RequestInformation{
-      path,               //
-      req.get_method(),   //
-      req.get_content(),  //
-      req.get_args()      //
-  });
+  VLOG(2) << "Path: " << request.path;
+  VLOG(2) << "Method: " << request.method;
+  VLOG(2) << "Body: " << request.body;
 
-  if (response.has_value()) {
-    VLOG(2) << "Response: " << response.value().body;
-    return make_shared<string_response>(response.value().body,
-                                        response.value().code);
+  // handlers work on JSON only, binary bodies are converted beforehand
+  auto format = BodyCodec::parseContentType(getHeader(request, "Content-Type"));
+  TResult<string> convertedBody;
+  if (format != BodyFormat::Json) {
+    convertedBody = BodyCodec::toJson(request.body, format);
   }
 
-  return NotFoundHandler(req);
+  ResponseInformation response;
+  if (holds_alternative<Error>(convertedBody)) {
+    auto const &error = get<Error>(convertedBody);
+    VLOG(1) << "Request body: " << error.getErrorMessage();
+    json responseBody = {
+        {"status", 422},                    //
+        {"error", error.getErrorMessage()}  //
+    };
+    response = {responseBody.dump(), 422};
+  } else {
+    // path parameters are passed to the handler like query parameters
+    if (!route.parameterName.empty()) {
+      request.args.set(string(route.parameterName),
+                       string(route.parameterValue));
+    }
+    // the route path is passed on without the versioned base path
+    request.path = route.path;
+    if (format != BodyFormat::Json) {
+      request.body = get<string>(convertedBody);
+    }
+    request.version = route.version;
+    {
+      Tracing::Span span("RestRequestHandler.handle");
+      response = route.handler(listener, request);
+    }
+  }
+
+  reservation.complete(response);
+
+  VLOG(2) << "Response: " << response.body;
+  Tracing::Span span("RestRequestHandler.encode");
+  encodeResponse(request, response);
+  compressResponse(request, response);
+  return response;
 }
 
-optional<ResponseInformation> RestRequestHandler::decodeAndDispatch(
-    RequestInformation const &infos) {
-  static const map<pair<string, string>, TEndpointHandler> AVAILABLE_ENDPOINTS =
-      {
-          {{"/generateSession", "POST"}, generateSessionHandler},   //
-          {{"/queryTracks", "GET"}, queryTracksHandler},            //
-          {{"/getCurrentQueues", "GET"}, getCurrentQueuesHandler},  //
-          {{"/addTrackToQueue", "POST"}, addTrackToQueueHandler},   //
-          {{"/voteTrack", "PUT"}, voteTrackHandler},                //
-          {{"/controlPlayer", "PUT"}, controlPlayerHandler},        //
-          {{"/moveTrack", "PUT"}, moveTracksHandler},               //
-          {{"/removeTrack", "DELETE"}, removeTrackHandler}          //
-      };
+TResultOpt RestRequestHandler::configure() {
+  for (auto configure : {configureEndpointHandlers,
+                         AdmissionControl::configure,
+                         Deadline::configure,
+                         IdempotencyCache::configure,
+                         Compression::configure,
+                         StaticFiles::configure}) {
+    auto result = configure();
+    if (result.has_value()) {
+      return result;
+    }
+  }
+  return nullopt;
+}
 
-  // TODO: the Method NotAllowedHandler won't ever be called
+ResponseInformation RestRequestHandler::decodeAndDispatch(
+    NetworkListener *listener, RequestInformation &&request) {
+  assert(listener);
+  static auto &requests = Metrics::counter(
+      "jukebox_http_requests_total",
+      "Handled requests by endpoint, method and status code",
+      {"endpoint", "method", "code"});
+  static auto &durations = Metrics::histogram(
+      "jukebox_http_request_duration_seconds",
+      "Time to handle a request, without sending the response",
+      {"endpoint"});
 
-  auto handlerIt = AVAILABLE_ENDPOINTS.find({infos.path, infos.method});
-  if (handlerIt != AVAILABLE_ENDPOINTS.cend()) {
-    return handlerIt->second(listener, infos);
+  auto start = Histogram::Clock::now();
+  Tracing::Request trace;
+  // the labels only take known values, so clients cannot add series
+  string_view method = request.method;
+  if (parseHttpMethod(method) == HttpMethod::Unknown && method != "HEAD") {
+    method = "other";
   }
+  string_view endpoint = "unknown";
+  auto response = dispatch(listener, move(request), endpoint);
+  response.headers["Server-Timing"] = trace.serverTiming();
 
-  return nullopt;
+  char code[8];
+  auto end = to_chars(code, code + sizeof(code), response.code).ptr;
+  requests.labels({endpoint, method, string_view(code, end - code)}).inc();
+  durations.labels({endpoint}).observeSince(start);
+  return response;
+}
+
+shared_ptr<http_response> const RestRequestHandler::render(
+    http_request const &req) {
+  VLOG(2) << "Query parameters: " << req.get_querystring();
+
+  // the request refers to the one of libhttpserver, which outlives it
+  RequestInformation request{
+      req.get_path(),                     //
+      req.get_method(),                   //
+      req.get_content(),                  //
+      RequestArgs(&req, lookupArg),       //
+      RequestHeaders(&req, lookupHeader)  //
+  };
+  auto response = decodeAndDispatch(listener, move(request));
+
+  // a stream keeps its connection thread busy while it is open, in pool mode
+  // a few of them would stall all other requests of the workers
+  if (response.stream && !streamsAllowed) {
+    VLOG(1) << "Rejecting stream of '" << req.get_path() << "' in pool mode";
+    json responseBody = {
+        {"status", 503},                                            //
+        {"error", "Streams require threadingMode 'perConnection'"}  //
+    };
+    response = {responseBody.dump(), 503};
+  }
+
+  shared_ptr<http_response> httpResponse;
+  if (response.file) {
+    httpResponse = make_shared<FileBodyResponse>(response.file, response.code);
+  } else if (response.stream) {
+    httpResponse = make_shared<deferred_response<StreamBody>>(
+        produceStreamBody, response.stream, "", response.code);
+  } else {
+    httpResponse =
+        make_shared<OwningStringResponse>(move(response.body), response.code);
+  }
+  for (auto const &[key, value] : response.headers) {
+    httpResponse->with_header(key, value);
+  }
+  return httpResponse;
 }
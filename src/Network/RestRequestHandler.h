@@ -10,8 +10,7 @@
 #define _REST_REQUEST_HANDLER_H_
 
 #include <httpserver.hpp>
-#include <map>
-#include <optional>
+#include <string_view>
 
 #include "NetworkListener.h"
 #include "RequestInformation.h"
@@ -24,7 +23,11 @@
  */
 class RestRequestHandler : public httpserver::http_resource {
  public:
-  RestRequestHandler(NetworkListener *listener);
+  /**
+   * @param streamsAllowed Whether streamed responses (e.g. event streams) may
+   * occupy a connection thread, otherwise they are rejected with 503.
+   */
+  RestRequestHandler(NetworkListener *listener, bool streamsAllowed);
 
   static std::shared_ptr<httpserver::http_response> const NotFoundHandler(
       httpserver::http_request const &req);
@@ -33,15 +36,45 @@ class RestRequestHandler : public httpserver::http_resource {
   static std::shared_ptr<httpserver::http_response> const InternalErrorHandler(
       httpserver::http_request const &req);
 
+  /**
+   * @brief Reads the configuration of decodeAndDispatch() (e.g. the budgets
+   * of `AdmissionControl` and the timeouts of `Deadline`).
+   * @details Called by the servers when they start, so requests do not read
+   * the configuration.
+   */
+  static TResultOpt configure();
+
+  /**
+   * @brief Routes a request to its endpoint handler and encodes the response.
+   * @details Independent of the webserver, hence shared by all `NetworkAPI`
+   * implementations: unknown endpoints and methods are answered with 404 and
+   * 405, requests exceeding the budget of `AdmissionControl` with 503, binary
+   * request bodies are decoded and the response is encoded and compressed as
+   * accepted by the client.
+   *
+   * @param request The request with the full path (including the versioned
+   * base path), its query parameters and headers. Is passed on to the
+   * endpoint handler, hence the data it refers to must stay alive until the
+   * response is returned.
+   */
+  static ResponseInformation decodeAndDispatch(NetworkListener *listener,
+                                               RequestInformation &&request);
+
+  /**
+   * @brief Builds the response to a request which threw an exception.
+   * @details Must be called from within the exception handler, the message of
+   * the current exception is part of the response.
+   */
+  static ResponseInformation internalErrorResponse(std::string_view path,
+                                                   std::string_view method,
+                                                   std::string_view content);
+
  private:
   NetworkListener *listener;
+  bool streamsAllowed;
 
-  bool isValidBasePath(std::string const &path) const;
   std::shared_ptr<httpserver::http_response> const render(
       httpserver::http_request const &req) override;
-
-  std::optional<ResponseInformation> decodeAndDispatch(
-      RequestInformation const &);
 };
 
 #endif /* _REST_ENDPOINT_HANDLER_H_ */
@@ -0,0 +1,320 @@
+/*****************************************************************************/
+/**
+ * @file    RestRouter.h
+ * @author  Team Server
+ * @brief   Definition of class RestRouter
+ */
+/*****************************************************************************/
+
+#ifndef _REST_ROUTER_H_
+#define _REST_ROUTER_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "RestEndpointHandlers.h"
+
+/**
+ * @brief HTTP methods known to the router.
+ */
+enum class HttpMethod { Get, Post, Put, Delete, Patch, Unknown };
+
+/**
+ * @brief Admission lanes of the routes, see `AdmissionControl`.
+ * @details The `Control` lane has capacity reserved, which is never used by
+ * normal requests. The `Debug` lane (monitoring and profiling) has a small
+ * budget of its own, which takes no capacity from the other lanes.
+ */
+enum class RequestLane { Normal, Control, Debug };
+
+static constexpr size_t HTTP_METHOD_COUNT =
+    static_cast<size_t>(HttpMethod::Unknown);
+
+/**
+ * @brief Maps the name of a HTTP method to its enum value.
+ */
+constexpr HttpMethod parseHttpMethod(std::string_view method) {
+  switch (method.size()) {
+    case 3:
+      if (method == "GET") return HttpMethod::Get;
+      if (method == "PUT") return HttpMethod::Put;
+      break;
+    case 4:
+      if (method == "POST") return HttpMethod::Post;
+      break;
+    case 5:
+      if (method == "PATCH") return HttpMethod::Patch;
+      break;
+    case 6:
+      if (method == "DELETE") return HttpMethod::Delete;
+      break;
+  }
+  return HttpMethod::Unknown;
+}
+
+/**
+ * @brief Returns the value of an `Allow` header for the given method mask.
+ */
+inline std::string allowedMethodsHeader(uint32_t methodMask) {
+  static constexpr std::string_view NAMES[HTTP_METHOD_COUNT] = {
+      "GET", "POST", "PUT", "DELETE", "PATCH"};
+  std::string result;
+  for (size_t i = 0; i < HTTP_METHOD_COUNT; i++) {
+    if (methodMask & (1u << i)) {
+      if (!result.empty()) {
+        result += ", ";
+      }
+      result += NAMES[i];
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief A single entry of the route table.
+ * @details The path is relative to the versioned base path (`/api/v<N>`). Its
+ * last segment may be a parameter (e.g. `/tracks/{track_id}`), which matches
+ * any non-empty segment.
+ */
+struct Route {
+  std::string_view path;
+  HttpMethod method;
+  TEndpointHandler handler;
+  unsigned minVersion = 1;  ///< first API version providing the route
+  unsigned maxVersion = 1;  ///< last API version providing the route
+  RequestLane lane = RequestLane::Normal;
+};
+
+/**
+ * @brief Result of matching a request against the route table.
+ */
+struct RouteMatch {
+  enum class Result { Found, NotFound, MethodNotAllowed };
+
+  Result result = Result::NotFound;
+  TEndpointHandler handler = nullptr;
+  RequestLane lane = RequestLane::Normal;
+  unsigned version = 0;
+  std::string_view pattern;         ///< path of the matched route (or 405)
+  std::string_view path;            ///< path without the versioned base path
+  std::string_view parameterName;   ///< name of the path parameter, if any
+  std::string_view parameterValue;  ///< value of the path parameter, if any
+  uint32_t allowedMethods = 0;      ///< bit per `HttpMethod` (405 only)
+};
+
+/**
+ * @class RestRouter
+ * @brief Route table which is built at compile time.
+ * @details Paths are looked up with a perfect hash, whose seed is searched for
+ * when the table is constructed (usually in a `constexpr` context). Each slot
+ * holds the routes of one path, indexed by their method. Matching neither
+ * allocates nor copies the request path.
+ */
+template <size_t N>
+class RestRouter {
+ public:
+  static constexpr std::string_view BASE_PATH = "/api/v";
+
+  constexpr RestRouter(std::array<Route, N> const &routes)
+      : mRoutes(routes), mSeed(0), mSlots() {
+    // find a seed without collisions between different paths
+    while (!tryBuildSlots()) {
+      mSeed++;
+    }
+  }
+
+  /**
+   * @brief Matches a full request path (including the base path) and method.
+   */
+  constexpr RouteMatch match(std::string_view fullPath,
+                             std::string_view methodName) const {
+    RouteMatch result;
+
+    // split off the versioned base path
+    if (fullPath.substr(0, BASE_PATH.size()) != BASE_PATH) {
+      return result;
+    }
+    size_t pos = BASE_PATH.size();
+    unsigned version = 0;
+    size_t versionStart = pos;
+    while (pos < fullPath.size() && fullPath[pos] >= '0' &&
+           fullPath[pos] <= '9' && pos - versionStart < 6) {
+      version = version * 10 + (fullPath[pos] - '0');
+      pos++;
+    }
+    if (pos == versionStart || pos == fullPath.size() ||
+        fullPath[pos] != '/') {
+      return result;
+    }
+    return match(fullPath.substr(pos), version, methodName);
+  }
+
+  /**
+   * @brief Matches a path relative to the base path of the given API version.
+   */
+  constexpr RouteMatch match(std::string_view path,
+                             unsigned version,
+                             std::string_view methodName) const {
+    RouteMatch result;
+    if (path.empty() || path[0] != '/') {
+      return result;
+    }
+    result.version = version;
+    result.path = path;
+
+    // literal paths take precedence over parameters
+    Slot const *slot = findSlot(hashPath(path, mSeed), path, false);
+    size_t lastSlash = path.rfind('/');
+    if (!slot && lastSlash != 0 && lastSlash + 1 < path.size()) {
+      std::string_view prefix = path.substr(0, lastSlash + 1);
+      slot = findSlot(hashPath(PARAMETER_KEY, mSeed, hashPath(prefix, mSeed)),
+                      prefix,
+                      true);
+      if (slot) {
+        std::string_view pattern = mRoutes[slot->pathRoute].path;
+        result.parameterName =
+            pattern.substr(prefix.size() + 1,
+                           pattern.size() - prefix.size() - 2);
+        result.parameterValue = path.substr(lastSlash + 1);
+      }
+    }
+    if (!slot) {
+      return result;
+    }
+    result.pattern = mRoutes[slot->pathRoute].path;
+
+    // dispatch on the method
+    HttpMethod method = parseHttpMethod(methodName);
+    for (size_t i = 0; i < HTTP_METHOD_COUNT; i++) {
+      int routeIndex = slot->routes[i];
+      if (routeIndex < 0 || !supportsVersion(routeIndex, version)) {
+        continue;
+      }
+      if (static_cast<size_t>(method) == i) {
+        result.result = RouteMatch::Result::Found;
+        result.handler = mRoutes[routeIndex].handler;
+        result.lane = mRoutes[routeIndex].lane;
+        return result;
+      }
+      result.allowedMethods |= (1u << i);
+    }
+    if (result.allowedMethods != 0) {
+      result.result = RouteMatch::Result::MethodNotAllowed;
+    }
+    return result;
+  }
+
+  /**
+   * @brief Returns the seed of the perfect hash found for the table.
+   */
+  constexpr uint32_t seed() const {
+    return mSeed;
+  }
+
+ private:
+  static constexpr size_t TABLE_SIZE = [] {
+    size_t size = 4;
+    while (size < 2 * N) {
+      size *= 2;
+    }
+    return size;
+  }();
+
+  // replaces the parameter segment when hashing a route
+  static constexpr std::string_view PARAMETER_KEY = "{}";
+
+  struct Slot {
+    int pathRoute = -1;  ///< route whose path is stored in this slot
+    bool hasParameter = false;
+    int routes[HTTP_METHOD_COUNT] = {-1, -1, -1, -1, -1};
+  };
+
+  static constexpr uint32_t hashPath(std::string_view str,
+                                     uint32_t seed,
+                                     uint32_t hash = 2166136261u) {
+    // FNV-1a, mixed with the seed
+    hash ^= seed * 0x9E3779B9u;
+    for (char c : str) {
+      hash ^= static_cast<uint8_t>(c);
+      hash *= 16777619u;
+    }
+    return hash;
+  }
+
+  /**
+   * @brief Returns the part of a route path which is hashed and compared.
+   * @details For routes with a parameter this is the prefix up to the last
+   * slash (inclusive), the parameter itself is hashed as `PARAMETER_KEY`.
+   */
+  static constexpr bool splitPattern(std::string_view path,
+                                     std::string_view &prefix) {
+    size_t lastSlash = path.rfind('/');
+    if (lastSlash != std::string_view::npos && lastSlash + 2 < path.size() &&
+        path[lastSlash + 1] == '{' && path.back() == '}') {
+      prefix = path.substr(0, lastSlash + 1);
+      return true;
+    }
+    prefix = path;
+    return false;
+  }
+
+  constexpr uint32_t routeHash(size_t index) const {
+    std::string_view prefix;
+    if (splitPattern(mRoutes[index].path, prefix)) {
+      return hashPath(PARAMETER_KEY, mSeed, hashPath(prefix, mSeed));
+    }
+    return hashPath(prefix, mSeed);
+  }
+
+  constexpr bool tryBuildSlots() {
+    // reset every field explicitly, GCC does not apply the default member
+    // initializers when assigning `{}` during constant evaluation
+    for (auto &slot : mSlots) {
+      slot.pathRoute = -1;
+      slot.hasParameter = false;
+      for (auto &route : slot.routes) {
+        route = -1;
+      }
+    }
+    for (size_t i = 0; i < N; i++) {
+      std::string_view prefix;
+      bool hasParameter = splitPattern(mRoutes[i].path, prefix);
+      Slot &slot = mSlots[routeHash(i) & (TABLE_SIZE - 1)];
+      if (slot.pathRoute < 0) {
+        slot.pathRoute = static_cast<int>(i);
+        slot.hasParameter = hasParameter;
+      } else if (mRoutes[slot.pathRoute].path != mRoutes[i].path) {
+        // collision of different paths, try the next seed
+        return false;
+      }
+      auto method = static_cast<size_t>(mRoutes[i].method);
+      slot.routes[method] = static_cast<int>(i);
+    }
+    return true;
+  }
+
+  constexpr Slot const *findSlot(uint32_t hash,
+                                 std::string_view prefix,
+                                 bool hasParameter) const {
+    Slot const &slot = mSlots[hash & (TABLE_SIZE - 1)];
+    if (slot.pathRoute < 0 || slot.hasParameter != hasParameter) {
+      return nullptr;
+    }
+    std::string_view slotPrefix;
+    splitPattern(mRoutes[slot.pathRoute].path, slotPrefix);
+    return (slotPrefix == prefix) ? &slot : nullptr;
+  }
+
+  constexpr bool supportsVersion(int routeIndex, unsigned version) const {
+    return mRoutes[routeIndex].minVersion <= version &&
+           version <= mRoutes[routeIndex].maxVersion;
+  }
+
+  std::array<Route, N> mRoutes;
+  uint32_t mSeed;
+  std::array<Slot, TABLE_SIZE> mSlots;
+};
+
+#endif /* _REST_ROUTER_H_ */
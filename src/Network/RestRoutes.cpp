@@ -0,0 +1,56 @@
+/*****************************************************************************/
+/**
+ * @file    RestRoutes.cpp
+ * @author  Team Server
+ * @brief   Route table of the REST API
+ */
+/*****************************************************************************/
+
+#include "RestRoutes.h"
+
+#include "RestEndpointHandlers.h"
+
+using namespace std;
+
+// the path of a route is relative to the versioned base path `/api/v<N>`,
+// the endpoints controlling the player and the admin queue use the control
+// lane, which stays available under load
+static constexpr auto CONTROL = RequestLane::Control;
+static constexpr RestRouter ROUTER(array<Route, 10>{{
+    {"/generateSession", HttpMethod::Post, generateSessionHandler},   //
+    {"/queryTracks", HttpMethod::Get, queryTracksHandler},            //
+    {"/getCurrentQueues", HttpMethod::Get, getCurrentQueuesHandler},  //
+    {"/addTrackToQueue", HttpMethod::Post, addTrackToQueueHandler},   //
+    {"/voteTrack", HttpMethod::Put, voteTrackHandler},                //
+    {"/controlPlayer", HttpMethod::Put, controlPlayerHandler, 1, 1, CONTROL},
+    {"/moveTrack", HttpMethod::Put, moveTracksHandler, 1, 1, CONTROL},  //
+    {"/removeTrack", HttpMethod::Delete, removeTrackHandler, 1, 1, CONTROL},
+    {"/events", HttpMethod::Get, eventsHandler},  //
+    {"/batch", HttpMethod::Post, batchHandler}    //
+}});
+
+// endpoints of the server itself are located outside the versioned base path,
+// monitoring and profiling use the debug lane, whose budget of its own keeps
+// them working under load without taking capacity from the control lane
+static constexpr auto DEBUG = RequestLane::Debug;
+static constexpr RestRouter SERVER_ROUTER(array<Route, 7>{{
+    {"/metrics", HttpMethod::Get, metricsHandler, 1, 1, DEBUG},      //
+    {"/debug/trace", HttpMethod::Get, traceHandler, 1, 1, DEBUG},    //
+    {"/debug/locks", HttpMethod::Get, locksHandler, 1, 1, DEBUG},    //
+    {"/debug/memory", HttpMethod::Get, memoryHandler, 1, 1, DEBUG},  //
+    {"/debug/spotify", HttpMethod::Get, spotifyCallsHandler, 1, 1, DEBUG},
+    {"/debug/profile/cpu", HttpMethod::Get, profileCpuHandler, 1, 1, DEBUG},
+    {"/debug/profile/heap", HttpMethod::Get, profileHeapHandler, 1, 1, DEBUG}
+}});
+
+RouteMatch matchRoute(string_view fullPath, string_view method) {
+  return ROUTER.match(fullPath, method);
+}
+
+RouteMatch matchRoute(string_view path, unsigned version, string_view method) {
+  return ROUTER.match(path, version, method);
+}
+
+RouteMatch matchServerRoute(string_view path, string_view method) {
+  return SERVER_ROUTER.match(path, 1, method);
+}
@@ -0,0 +1,41 @@
+/*****************************************************************************/
+/**
+ * @file    RestRoutes.h
+ * @author  Team Server
+ * @brief   Route table of the REST API
+ */
+/*****************************************************************************/
+
+#ifndef _REST_ROUTES_H_
+#define _REST_ROUTES_H_
+
+#include <string_view>
+
+#include "RestRouter.h"
+
+/**
+ * @brief Looks up the handler of a request to the REST API.
+ * @param fullPath The request path, including the versioned base path.
+ * @param method The HTTP method of the request.
+ */
+RouteMatch matchRoute(std::string_view fullPath, std::string_view method);
+
+/**
+ * @brief Looks up the handler of a path relative to the versioned base path.
+ * @param path The request path, without the versioned base path.
+ * @param version The version of the API.
+ * @param method The HTTP method of the request.
+ */
+RouteMatch matchRoute(std::string_view path,
+                      unsigned version,
+                      std::string_view method);
+
+/**
+ * @brief Looks up the handler of a request to an endpoint of the server
+ * itself, e.g. `/metrics`, which is not part of the versioned API.
+ * @param path The request path.
+ * @param method The HTTP method of the request.
+ */
+RouteMatch matchServerRoute(std::string_view path, std::string_view method);
+
+#endif /* _REST_ROUTES_H_ */
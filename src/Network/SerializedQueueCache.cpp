@@ -0,0 +1,427 @@
+/*****************************************************************************/
+/**
+ * @file    SerializedQueueCache.cpp
+ * @author  Team Server
+ * @brief   Implementation of class SerializedQueueCache
+ */
+/*****************************************************************************/
+
+#include "SerializedQueueCache.h"
+
+#include <algorithm>
+#include <cassert>
+#include <string_view>
+
+#include "Utils/JsonWriter.h"
+#include "Utils/Serializer.h"
+#include "Utils/Tracing.h"
+
+using namespace std;
+
+// quotes inside of strings are escaped, so the key can't be found in values
+static string const VOTE_KEY = "\"current_vote\":";
+
+// number of pieces (about one track each) compressed together
+static size_t const CHUNK_PIECES = 16;
+
+// shared by the plain and the compressed serialization
+static SerializedQueueCache normalQueueCache;
+static SerializedQueueCache adminQueueCache;
+
+// the JSON object around the queues, keys in the same (sorted) order as
+// nlohmann::json would dump them
+static string const JSON_BEGIN = "{\"admin_queue\":";
+
+/**
+ * @brief Returns the JSON between the admin and the normal queue.
+ */
+static string serializeJsonMiddle(QueueStatus const &queueStatus,
+                                  TrackFieldMask const &fields) {
+  JsonWriter writer;
+  writer.beginObject()
+      .key("admin_queue_total")
+      .value(queueStatus.adminQueue.getTotalSize())
+      .key("currently_playing");
+  if (queueStatus.currentTrack.has_value()) {
+    Serializer::write(writer, queueStatus.currentTrack.value(), fields);
+  } else {
+    writer.beginObject().endObject();
+  }
+  writer.key("normal_queue");
+
+  // replace the opening brace, the object continues after the admin queue
+  string middle = writer.release();
+  middle[0] = ',';
+  return middle;
+}
+
+/**
+ * @brief Returns the JSON after the normal queue.
+ */
+static string serializeJsonEnd(QueueStatus const &queueStatus) {
+  return ",\"normal_queue_total\":" +
+         to_string(queueStatus.normalQueue.getTotalSize()) + "}";
+}
+
+/**
+ * @brief Returns the header of an array with `size` elements.
+ * @details Uses the shortest encoding, as `nlohmann::json` does.
+ */
+static string binaryArrayHeader(size_t size, BodyFormat format) {
+  string header;
+  auto appendBigEndian = [&header](uint32_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; i--) {
+      header += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+  };
+
+  if (format == BodyFormat::MessagePack) {
+    if (size <= 0x0f) {
+      header += static_cast<char>(0x90 | size);
+    } else if (size <= 0xffff) {
+      header += '\xdc';
+      appendBigEndian(size, 2);
+    } else {
+      header += '\xdd';
+      appendBigEndian(size, 4);
+    }
+  } else {
+    assert(format == BodyFormat::Cbor);
+    if (size <= 0x17) {
+      header += static_cast<char>(0x80 | size);
+    } else if (size <= 0xff) {
+      header += '\x98';
+      appendBigEndian(size, 1);
+    } else if (size <= 0xffff) {
+      header += '\x99';
+      appendBigEndian(size, 2);
+    } else {
+      header += '\x9a';
+      appendBigEndian(size, 4);
+    }
+  }
+  return header;
+}
+
+string SerializedQueueCache::serialize(QueueStatus const &queueStatus,
+                                       BodyFormat format,
+                                       TrackFieldMask const &fields) {
+  Tracing::Span span("SerializedQueueCache.serialize");
+  if (format != BodyFormat::Json) {
+    auto playbackTrack = nlohmann::json::object();
+    if (queueStatus.currentTrack.has_value()) {
+      playbackTrack =
+          Serializer::serialize(queueStatus.currentTrack.value(), fields);
+    }
+
+    // a map with five entries in sorted order, as nlohmann::json encodes it
+    string result(1, (format == BodyFormat::MessagePack) ? '\x85' : '\xa5');
+    result += BodyCodec::encode("admin_queue", format);
+    adminQueueCache.append(result, queueStatus.adminQueue, format, fields);
+    result += BodyCodec::encode("admin_queue_total", format);
+    result += BodyCodec::encode(queueStatus.adminQueue.getTotalSize(), format);
+    result += BodyCodec::encode("currently_playing", format);
+    result += BodyCodec::encode(playbackTrack, format);
+    result += BodyCodec::encode("normal_queue", format);
+    normalQueueCache.append(result, queueStatus.normalQueue, format, fields);
+    result += BodyCodec::encode("normal_queue_total", format);
+    result += BodyCodec::encode(queueStatus.normalQueue.getTotalSize(), format);
+    return result;
+  }
+
+  string result = JSON_BEGIN;
+  adminQueueCache.append(
+      result, queueStatus.adminQueue, BodyFormat::Json, fields);
+  result += serializeJsonMiddle(queueStatus, fields);
+  normalQueueCache.append(
+      result, queueStatus.normalQueue, BodyFormat::Json, fields);
+  result += serializeJsonEnd(queueStatus);
+  return result;
+}
+
+string SerializedQueueCache::serialize(QueueStatus const &queueStatus,
+                                       vector<bool> const &normalVotes) {
+  Tracing::Span span("SerializedQueueCache.serialize");
+  string result = JSON_BEGIN;
+  adminQueueCache.append(result, queueStatus.adminQueue);
+  result += serializeJsonMiddle(queueStatus, {});
+  normalQueueCache.appendWithVotes(
+      result, queueStatus.normalQueue, normalVotes, BodyFormat::Json, {});
+  result += serializeJsonEnd(queueStatus);
+  return result;
+}
+
+string SerializedQueueCache::serializeGzip(QueueStatus const &queueStatus,
+                                           int level,
+                                           TrackFieldMask const &fields) {
+  Tracing::Span span("SerializedQueueCache.serializeGzip");
+  // the parts around the queues are small, so compress them in one segment
+  GzipSegmentCompressor compressor(level);
+  GzipBuilder builder;
+  builder.append(compressor.compress(JSON_BEGIN));
+  adminQueueCache.appendGzip(builder, queueStatus.adminQueue, level, fields);
+  builder.append(compressor.compress(serializeJsonMiddle(queueStatus, fields)));
+  normalQueueCache.appendGzip(builder, queueStatus.normalQueue, level, fields);
+  builder.append(compressor.compress(serializeJsonEnd(queueStatus)));
+  return builder.finish();
+}
+
+void SerializedQueueCache::append(string &out,
+                                  Queue const &queue,
+                                  BodyFormat format,
+                                  TrackFieldMask const &fields) {
+  vector<bool> votes(queue.tracks.size());
+  for (size_t i = 0; i < queue.tracks.size(); i++) {
+    votes[i] = queue.tracks[i].userHasVoted;
+  }
+  appendWithVotes(out, queue, votes, format, fields);
+}
+
+void SerializedQueueCache::appendWithVotes(string &out,
+                                           Queue const &queue,
+                                           vector<bool> const &votes,
+                                           BodyFormat format,
+                                           TrackFieldMask const &fields) {
+  auto entry = getEntry(queue, fields);
+  auto const *pieces = &entry->pieces;
+  char voteFlags[] = {'0', '1'};
+  if (format != BodyFormat::Json) {
+    size_t index = binaryIndex(format);
+    call_once(entry->encodedOnce[index],
+              encodeEntry,
+              ref(*entry),
+              cref(queue),
+              format);
+    pieces = &entry->binaryPieces[index];
+    // both formats encode the integers 0 and 1 as a single byte
+    voteFlags[0] = '\x00';
+    voteFlags[1] = '\x01';
+  }
+
+  assert(pieces->size() == queue.tracks.size() + 1);
+  assert(votes.size() == queue.tracks.size());
+  for (size_t i = 0; i < queue.tracks.size(); i++) {
+    out += (*pieces)[i];
+    if (entry->hasVotes) {
+      out += voteFlags[votes[i] ? 1 : 0];
+    }
+  }
+  out += pieces->back();
+}
+
+void SerializedQueueCache::appendGzip(GzipBuilder &builder,
+                                      Queue const &queue,
+                                      int level,
+                                      TrackFieldMask const &fields) {
+  auto entry = getEntry(queue, fields);
+  call_once(entry->compressedOnce, compressEntry, ref(*entry), level);
+  assert(entry->pieces.size() == queue.tracks.size() + 1);
+
+  vector<bool> votes(queue.tracks.size());
+  for (size_t i = 0; i < queue.tracks.size(); i++) {
+    votes[i] = entry->hasVotes && queue.tracks[i].userHasVoted;
+  }
+
+  // a shared chunk can be used if neither it nor the previous chunk, which it
+  // may refer to, contain a vote of the user
+  unique_ptr<GzipSegmentCompressor> compressor;
+  bool previousShared = true;
+  for (size_t chunk = 0; chunk < entry->compressedChunks.size(); chunk++) {
+    size_t first = chunk * CHUNK_PIECES;
+    size_t last = min(first + CHUNK_PIECES, entry->pieces.size()) - 1;
+    bool hasVotes = false;
+    for (size_t i = (first > 0) ? first - 1 : 0; i < last; i++) {
+      hasVotes = hasVotes || votes[i];
+    }
+
+    if (!hasVotes && previousShared) {
+      builder.append(entry->compressedChunks[chunk]);
+    } else {
+      if (!compressor) {
+        compressor = make_unique<GzipSegmentCompressor>(level);
+      }
+      string dictionary =
+          (chunk > 0) ? chunkContent(*entry, chunk - 1, votes) : "";
+      builder.append(
+          compressor->compress(chunkContent(*entry, chunk, votes), dictionary));
+    }
+    previousShared = !hasVotes;
+  }
+}
+
+bool SerializedQueueCache::Entry::matches(
+    Queue const &queue, TrackFieldMask const &selectedFields) const {
+  // the same version of the queue always has the same tracks in a range
+  return version == queue.version && offset == queue.offset &&
+         pieces.size() == queue.tracks.size() + 1 && fields == selectedFields;
+}
+
+shared_ptr<SerializedQueueCache::Entry> SerializedQueueCache::getEntry(
+    Queue const &queue, TrackFieldMask const &fields) {
+  shared_ptr<Entry> entry;
+  if (queue.version != 0) {
+    unique_lock<mutex> lock(mMutex);
+    for (auto const &cached : mEntries) {
+      if (cached->matches(queue, fields)) {
+        entry = cached;
+        break;
+      }
+    }
+  }
+
+  if (!entry) {
+    // serialize without holding the lock, concurrent requests for a new
+    // version may do so in parallel, but only the newest version is kept
+    entry = createEntry(queue, fields);
+    if (queue.version != 0) {
+      unique_lock<mutex> lock(mMutex);
+      bool outdated = any_of(
+          mEntries.begin(), mEntries.end(), [&](auto const &cached) {
+            return cached->version > queue.version ||
+                   cached->matches(queue, fields);
+          });
+      if (!outdated) {
+        mEntries.erase(remove_if(mEntries.begin(),
+                                 mEntries.end(),
+                                 [&](auto const &cached) {
+                                   return cached->version < queue.version;
+                                 }),
+                       mEntries.end());
+        if (mEntries.size() == MAX_RANGES) {
+          mEntries.erase(mEntries.begin());
+        }
+        mEntries.push_back(entry);
+      }
+    }
+  }
+  return entry;
+}
+
+shared_ptr<SerializedQueueCache::Entry> SerializedQueueCache::createEntry(
+    Queue const &queue, TrackFieldMask const &fields) {
+  auto entry = make_shared<Entry>();
+  entry->version = queue.version;
+  entry->offset = queue.offset;
+  entry->fields = fields;
+  entry->hasVotes = fields.has(TrackField::CurrentVote);
+
+  JsonWriter writer;
+  string piece = "[";
+  for (size_t i = 0; i < queue.tracks.size(); i++) {
+    if (i > 0) {
+      piece += ",";
+    }
+
+    // split the track at its vote flag, which is inserted per user
+    auto track = queue.tracks[i];
+    track.userHasVoted = false;
+    writer.clear();
+    Serializer::write(writer, track, fields);
+    string_view serialized = writer.str();
+    if (!entry->hasVotes) {
+      piece += serialized;
+      entry->pieces.push_back(move(piece));
+      piece.clear();
+      continue;
+    }
+
+    auto votePos = serialized.find(VOTE_KEY);
+    assert(votePos != string::npos);
+    votePos += VOTE_KEY.size();
+
+    piece += serialized.substr(0, votePos);
+    entry->pieces.push_back(move(piece));
+    // skip the serialized flag itself
+    piece = serialized.substr(votePos + 1);
+  }
+  piece += "]";
+  entry->pieces.push_back(move(piece));
+
+  return entry;
+}
+
+size_t SerializedQueueCache::binaryIndex(BodyFormat format) {
+  assert(format != BodyFormat::Json);
+  return (format == BodyFormat::MessagePack) ? 0 : 1;
+}
+
+void SerializedQueueCache::encodeEntry(Entry &entry,
+                                       Queue const &queue,
+                                       BodyFormat format) {
+  auto &pieces = entry.binaryPieces[binaryIndex(format)];
+  string piece = binaryArrayHeader(queue.tracks.size(), format);
+  for (auto track : queue.tracks) {
+    if (!entry.hasVotes) {
+      piece += BodyCodec::encode(Serializer::serialize(track, entry.fields),
+                                 format);
+      pieces.push_back(move(piece));
+      piece.clear();
+      continue;
+    }
+
+    // the encodings with and without vote differ in the vote flag only, which
+    // is inserted per user
+    track.userHasVoted = true;
+    string withVote =
+        BodyCodec::encode(Serializer::serialize(track, entry.fields), format);
+    track.userHasVoted = false;
+    string serialized =
+        BodyCodec::encode(Serializer::serialize(track, entry.fields), format);
+    assert(withVote.size() == serialized.size());
+    size_t votePos =
+        mismatch(serialized.begin(), serialized.end(), withVote.begin()).first -
+        serialized.begin();
+    assert(votePos < serialized.size());
+
+    piece += serialized.substr(0, votePos);
+    pieces.push_back(move(piece));
+    // skip the encoded flag itself
+    piece = serialized.substr(votePos + 1);
+  }
+  pieces.push_back(move(piece));
+  entry.lazyBytes += MemoryUsage::heapBytes(pieces);
+}
+
+void SerializedQueueCache::compressEntry(Entry &entry, int level) {
+  // each chunk may refer to the previous one, which precedes it in every
+  // response without votes in these chunks
+  GzipSegmentCompressor compressor(level);
+  vector<bool> noVotes(entry.pieces.size() - 1, false);
+  string previous;
+  for (size_t first = 0; first < entry.pieces.size(); first += CHUNK_PIECES) {
+    string content = chunkContent(entry, first / CHUNK_PIECES, noVotes);
+    entry.compressedChunks.push_back(compressor.compress(content, previous));
+    previous = move(content);
+  }
+  size_t bytes = entry.compressedChunks.capacity() * sizeof(GzipSegment);
+  for (auto const &chunk : entry.compressedChunks) {
+    bytes += MemoryUsage::heapBytes(chunk.deflated);
+  }
+  entry.lazyBytes += bytes;
+}
+
+string SerializedQueueCache::chunkContent(Entry const &entry,
+                                          size_t chunk,
+                                          vector<bool> const &votes) {
+  // a chunk starts with the vote flag preceding its first piece
+  size_t first = chunk * CHUNK_PIECES;
+  size_t end = min(first + CHUNK_PIECES, entry.pieces.size());
+  string content;
+  for (size_t i = first; i < end; i++) {
+    if (i > 0 && entry.hasVotes) {
+      content += (votes[i - 1] ? '1' : '0');
+    }
+    content += entry.pieces[i];
+  }
+  return content;
+}
+
+size_t SerializedQueueCache::bytes() {
+  unique_lock<mutex> lock(mMutex);
+  size_t bytes = mEntries.capacity() * sizeof(shared_ptr<Entry>);
+  for (auto const &entry : mEntries) {
+    bytes += sizeof(Entry) + MemoryUsage::heapBytes(entry->pieces) +
+             entry->lazyBytes;
+  }
+  return bytes;
+}
@@ -0,0 +1,156 @@
+/*****************************************************************************/
+/**
+ * @file    SerializedQueueCache.h
+ * @author  Team Server
+ * @brief   Definition of class SerializedQueueCache
+ */
+/*****************************************************************************/
+
+#ifndef _SERIALIZED_QUEUE_CACHE_H_
+#define _SERIALIZED_QUEUE_CACHE_H_
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Types/Queue.h"
+#include "Utils/BodyFormat.h"
+#include "Utils/Compression.h"
+#include "Utils/MemoryUsage.h"
+#include "Utils/TrackFields.h"
+
+/**
+ * @class SerializedQueueCache
+ * @brief Caches the JSON representation of a queue per queue version.
+ * @details All users get the same serialized queue, except for the field
+ * `current_vote` of each track. Hence the serialized queue is stored as pieces
+ * between these values, and only the vote flags of the requesting user are
+ * inserted when a response is built.
+ *
+ * The binary formats are cached the same way, their pieces are encoded when a
+ * queue version is first requested in the format.
+ *
+ * Queues holding only a range of the whole queue are cached per range, up to
+ * `MAX_RANGES` ranges (or field selections) of the newest queue version are
+ * kept.
+ *
+ * Each selection of track fields is cached separately. Without the field
+ * `current_vote` the pieces are whole tracks and no flags are inserted.
+ *
+ * Queues with an unknown version (0) are serialized on every call.
+ */
+class SerializedQueueCache {
+ public:
+  /**
+   * @brief Serializes the queue status the same way `Serializer` does.
+   * @details Uses one cache for the normal and one for the admin queue.
+   * @param format The format of the result, binary formats are encoded the
+   * same way `BodyCodec::encode` does.
+   * @param fields The members of the tracks which are serialized.
+   */
+  static std::string serialize(QueueStatus const &queueStatus,
+                               BodyFormat format = BodyFormat::Json,
+                               TrackFieldMask const &fields = {});
+
+  /**
+   * @brief Serializes the queue status to JSON like `serialize`, but takes the
+   * vote flags of the normal queue from `normalVotes` instead of its tracks.
+   * @details Lets a queue status collected once be sent to every user with
+   * the votes of the user.
+   * @param normalVotes One flag per track of the normal queue.
+   */
+  static std::string serialize(QueueStatus const &queueStatus,
+                               std::vector<bool> const &normalVotes);
+
+  /**
+   * @brief Serializes the queue status like `serialize` and compresses it.
+   * @details The pieces of a queue version are compressed only once (with all
+   * vote flags set to 0) and shared by all users. Only the currently playing
+   * track and the parts around the votes of the requesting user are
+   * compressed per call.
+   * @param level Compression level between 1 (fastest) and 9 (smallest).
+   * @return The gzip compressed JSON body.
+   */
+  static std::string serializeGzip(QueueStatus const &queueStatus,
+                                   int level,
+                                   TrackFieldMask const &fields = {});
+
+  /**
+   * @brief Appends the array of the given queue in the given format to `out`.
+   */
+  void append(std::string &out,
+              Queue const &queue,
+              BodyFormat format = BodyFormat::Json,
+              TrackFieldMask const &fields = {});
+
+  /**
+   * @brief Appends the compressed JSON array of the given queue to `builder`.
+   */
+  void appendGzip(GzipBuilder &builder,
+                  Queue const &queue,
+                  int level,
+                  TrackFieldMask const &fields = {});
+
+ private:
+  // number of formats besides JSON
+  static size_t const BINARY_FORMAT_COUNT = 2;
+
+  // number of ranges and field selections of the same queue version which
+  // are kept
+  static size_t const MAX_RANGES = 4;
+
+  struct Entry {
+    uint64_t version;
+    size_t offset;
+    TrackFieldMask fields;
+    bool hasVotes;                    ///< vote flags are inserted per user
+    std::vector<std::string> pieces;  ///< one more than tracks
+
+    // pieces of the binary formats, indexed by `binaryIndex`
+    std::array<std::once_flag, BINARY_FORMAT_COUNT> encodedOnce;
+    std::array<std::vector<std::string>, BINARY_FORMAT_COUNT> binaryPieces;
+
+    // compressed once on first use, in chunks of consecutive pieces with all
+    // vote flags in between set to 0
+    std::once_flag compressedOnce;
+    std::vector<GzipSegment> compressedChunks;
+
+    // bytes of the binary pieces and compressed chunks, which are created
+    // without holding the lock of the cache
+    std::atomic<size_t> lazyBytes{0};
+
+    /**
+     * @brief Checks if the entry holds the tracks of the given queue with the
+     * given fields.
+     */
+    bool matches(Queue const &queue,
+                 TrackFieldMask const &selectedFields) const;
+  };
+
+  void appendWithVotes(std::string &out,
+                       Queue const &queue,
+                       std::vector<bool> const &votes,
+                       BodyFormat format,
+                       TrackFieldMask const &fields);
+  std::shared_ptr<Entry> getEntry(Queue const &queue,
+                                  TrackFieldMask const &fields);
+  static std::shared_ptr<Entry> createEntry(Queue const &queue,
+                                            TrackFieldMask const &fields);
+  static size_t binaryIndex(BodyFormat format);
+  static void encodeEntry(Entry &entry, Queue const &queue, BodyFormat format);
+  static void compressEntry(Entry &entry, int level);
+  static std::string chunkContent(Entry const &entry,
+                                  size_t chunk,
+                                  std::vector<bool> const &votes);
+  size_t bytes();
+
+  std::mutex mMutex;
+  std::vector<std::shared_ptr<Entry>> mEntries;  ///< oldest first
+  MemoryUsage::Registration mMemory{"cache.serializedQueues",
+                                    [this] { return bytes(); }};
+};
+
+#endif /* _SERIALIZED_QUEUE_CACHE_H_ */
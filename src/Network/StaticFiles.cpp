@@ -0,0 +1,319 @@
+/*****************************************************************************/
+/**
+ * @file    StaticFiles.cpp
+ * @author  Team Server
+ * @brief   Implementation of class StaticFiles
+ */
+/*****************************************************************************/
+
+#include "StaticFiles.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include "Utils/Compression.h"
+#include "Utils/ConfigHandler.h"
+#include "Utils/HttpHeader.h"
+#include "Utils/MemoryUsage.h"
+
+using namespace std;
+using namespace HttpHeader;
+
+static string const CONFIG_SECTION = "RestAPI";
+static int const DEFAULT_MAX_AGE = 86400;
+// bounds the number of open files, the cache is cleared when it is exceeded
+static size_t const MAX_CACHED_FILES = 256;
+
+static size_t const ENCODING_COUNT = 3;
+
+/**
+ * @brief An open file of the static directory and its precompressed variants.
+ */
+struct CachedFile {
+  struct stat status;
+  string etag;  ///< without quotes and encoding
+  array<shared_ptr<FileBody const>, ENCODING_COUNT> bodies;  ///< by encoding
+};
+
+/**
+ * @brief Settings read by StaticFiles::configure().
+ */
+struct StaticSettings {
+  string root;          ///< canonical path of the directory, empty = disabled
+  string cacheControl;  ///< of files other than HTML pages
+};
+
+// replaced as a whole, requests keep the settings they have looked up
+static shared_ptr<StaticSettings const> sSettings =
+    make_shared<StaticSettings const>();
+
+static mutex sCacheMutex;
+static unordered_map<string, shared_ptr<CachedFile const>> sCache;
+
+// the contents of the files are not held in memory, only their descriptors
+static size_t cacheBytes() {
+  lock_guard<mutex> lock(sCacheMutex);
+  size_t bytes = sCache.bucket_count() * sizeof(void *);
+  for (auto const &[path, file] : sCache) {
+    bytes += sizeof(pair<string const, shared_ptr<CachedFile const>>) +
+             sizeof(void *) + MemoryUsage::heapBytes(path) +
+             sizeof(CachedFile) + MemoryUsage::heapBytes(file->etag);
+    for (auto const &body : file->bodies) {
+      bytes += body ? sizeof(FileBody) : 0;
+    }
+  }
+  return bytes;
+}
+
+static MemoryUsage::Registration sMemory("cache.staticFiles", cacheBytes);
+
+static size_t encodingIndex(ContentEncoding encoding) {
+  return static_cast<size_t>(encoding);
+}
+
+static bool isSameFile(struct stat const &a, struct stat const &b) {
+  return a.st_dev == b.st_dev && a.st_ino == b.st_ino &&
+         a.st_size == b.st_size && a.st_mtim.tv_sec == b.st_mtim.tv_sec &&
+         a.st_mtim.tv_nsec == b.st_mtim.tv_nsec;
+}
+
+static bool isOlder(timespec const &a, timespec const &b) {
+  return a.tv_sec < b.tv_sec || (a.tv_sec == b.tv_sec && a.tv_nsec < b.tv_nsec);
+}
+
+static shared_ptr<FileBody const> openFile(string const &path,
+                                           struct stat &status) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return nullptr;
+  }
+  if (fstat(fd, &status) < 0 || !S_ISREG(status.st_mode)) {
+    close(fd);
+    return nullptr;
+  }
+  return make_shared<FileBody const>(fd, status.st_size);
+}
+
+static shared_ptr<CachedFile const> loadFile(string const &path) {
+  auto file = make_shared<CachedFile>();
+  auto body = openFile(path, file->status);
+  if (!body) {
+    return nullptr;
+  }
+  file->bodies[encodingIndex(ContentEncoding::Identity)] = body;
+
+  // variants older than the file have not been updated along with it
+  for (auto [encoding, suffix] : {pair{ContentEncoding::Gzip, ".gz"},
+                                  pair{ContentEncoding::Brotli, ".br"}}) {
+    struct stat status;
+    auto variant = openFile(path + suffix, status);
+    if (variant && !isOlder(status.st_mtim, file->status.st_mtim)) {
+      file->bodies[encodingIndex(encoding)] = variant;
+    }
+  }
+
+  stringstream etag;
+  etag << hex << file->status.st_ino << '-' << file->status.st_size << '-'
+       << file->status.st_mtim.tv_sec << '.' << file->status.st_mtim.tv_nsec;
+  file->etag = etag.str();
+  return file;
+}
+
+/**
+ * @brief Returns the cached file at the given path, which is (re)opened if it
+ * is not cached or has changed.
+ */
+static shared_ptr<CachedFile const> lookupFile(string const &path) {
+  struct stat status;
+  if (stat(path.c_str(), &status) < 0 || !S_ISREG(status.st_mode)) {
+    return nullptr;
+  }
+  {
+    lock_guard<mutex> lock(sCacheMutex);
+    auto it = sCache.find(path);
+    if (it != sCache.end() && isSameFile(it->second->status, status)) {
+      return it->second;
+    }
+  }
+
+  // opened outside of the lock, other files are served in the meantime
+  auto file = loadFile(path);
+  if (!file) {
+    return nullptr;
+  }
+  lock_guard<mutex> lock(sCacheMutex);
+  if (sCache.size() >= MAX_CACHED_FILES) {
+    sCache.clear();
+  }
+  sCache[path] = file;
+  return file;
+}
+
+/**
+ * @brief Maps a request path onto a file of the static directory.
+ * @return The path of the file, or `nullopt` if the request path refers to a
+ * hidden file or leaves the directory.
+ */
+static optional<string> resolvePath(string const &root, string_view path) {
+  if (path.empty() || path[0] != '/' || path.find('\0') != string::npos) {
+    return nullopt;
+  }
+
+  string result = root;
+  auto rest = path.substr(1);
+  while (!rest.empty()) {
+    auto end = rest.find('/');
+    auto segment = rest.substr(0, end);
+    rest = (end == string_view::npos) ? "" : rest.substr(end + 1);
+    if (segment.empty()) {
+      continue;
+    }
+    // hidden files as well as `.` and `..`
+    if (segment[0] == '.') {
+      return nullopt;
+    }
+    result += '/';
+    result += segment;
+  }
+  if (path.back() == '/') {
+    result += "/index.html";
+  }
+  return result;
+}
+
+TResultOpt StaticFiles::configure() {
+  auto configHandler = ConfigHandler::getInstance();
+  auto configRoot =
+      configHandler->getValueString(CONFIG_SECTION, "staticDirectory", "");
+  if (holds_alternative<Error>(configRoot)) {
+    return get<Error>(configRoot);
+  }
+  auto configMaxAge = configHandler->getValueInt(
+      CONFIG_SECTION, "staticMaxAgeSeconds", DEFAULT_MAX_AGE);
+  if (holds_alternative<Error>(configMaxAge)) {
+    return get<Error>(configMaxAge);
+  }
+  if (get<int>(configMaxAge) < 0) {
+    return Error(ErrorCode::InvalidValue,
+                 "StaticFiles.configure: staticMaxAgeSeconds must not be "
+                 "negative");
+  }
+
+  auto settings = make_shared<StaticSettings>();
+  settings->cacheControl =
+      "public, max-age=" + to_string(get<int>(configMaxAge));
+  string const &root = get<string>(configRoot);
+  if (!root.empty()) {
+    char resolved[PATH_MAX];
+    struct stat status;
+    if (realpath(root.c_str(), resolved) == nullptr ||
+        stat(resolved, &status) < 0 || !S_ISDIR(status.st_mode)) {
+      return Error(ErrorCode::FileNotFound,
+                   "StaticFiles.configure: staticDirectory '" + root +
+                       "' is not a directory");
+    }
+    settings->root = resolved;
+  }
+  atomic_store(&sSettings, shared_ptr<StaticSettings const>(move(settings)));
+  return nullopt;
+}
+
+optional<ResponseInformation> StaticFiles::serve(
+    RequestInformation const &request) {
+  // the REST API answers unknown endpoints on its own
+  if ((request.method != "GET" && request.method != "HEAD") ||
+      request.path.substr(0, 5) == "/api/") {
+    return nullopt;
+  }
+
+  auto settings = atomic_load(&sSettings);
+  if (settings->root.empty()) {
+    return nullopt;
+  }
+
+  auto path = resolvePath(settings->root, request.path);
+  if (!path.has_value()) {
+    return nullopt;
+  }
+  auto file = lookupFile(path.value());
+  if (!file) {
+    return nullopt;
+  }
+
+  auto const &bodies = file->bodies;
+  bool hasGzip = bodies[encodingIndex(ContentEncoding::Gzip)] != nullptr;
+  bool hasBrotli = bodies[encodingIndex(ContentEncoding::Brotli)] != nullptr;
+  auto encoding = Compression::select(
+      request.headers.get("Accept-Encoding").value_or(""), hasGzip, hasBrotli);
+
+  // the page refers to the other files, hence it is always revalidated
+  auto type = mediaType(path.value());
+  map<string, string> headers = {
+      {"Content-Type", string(type)},
+      {"Cache-Control",
+       (type.substr(0, 9) == "text/html") ? "no-cache"
+                                          : settings->cacheControl}};
+  string etag = file->etag;
+  if (encoding != ContentEncoding::Identity) {
+    etag += '-';
+    etag += Compression::name(encoding);
+    headers["Content-Encoding"] = Compression::name(encoding);
+  }
+  headers["ETag"] = '"' + etag + '"';
+  if (hasGzip || hasBrotli) {
+    headers["Vary"] = "Accept-Encoding";
+  }
+
+  auto ifNoneMatch = request.headers.get("If-None-Match");
+  if (ifNoneMatch.has_value() &&
+      matchesETag(ifNoneMatch.value(), headers["ETag"])) {
+    return ResponseInformation{"", 304, headers};
+  }
+
+  ResponseInformation response{"", 200, move(headers)};
+  response.file = bodies[encodingIndex(encoding)];
+  return response;
+}
+
+string_view StaticFiles::mediaType(string_view path) {
+  static constexpr pair<string_view, string_view> TYPES[] = {
+      {"css", "text/css; charset=utf-8"},
+      {"gif", "image/gif"},
+      {"htm", "text/html; charset=utf-8"},
+      {"html", "text/html; charset=utf-8"},
+      {"ico", "image/x-icon"},
+      {"jpeg", "image/jpeg"},
+      {"jpg", "image/jpeg"},
+      {"js", "text/javascript; charset=utf-8"},
+      {"json", "application/json"},
+      {"map", "application/json"},
+      {"mjs", "text/javascript; charset=utf-8"},
+      {"png", "image/png"},
+      {"svg", "image/svg+xml"},
+      {"txt", "text/plain; charset=utf-8"},
+      {"wasm", "application/wasm"},
+      {"webmanifest", "application/manifest+json"},
+      {"webp", "image/webp"},
+      {"woff", "font/woff"},
+      {"woff2", "font/woff2"},
+  };
+
+  auto dot = path.rfind('.');
+  if (dot != string_view::npos && path.find('/', dot) == string_view::npos) {
+    auto extension = path.substr(dot + 1);
+    for (auto const &[name, type] : TYPES) {
+      if (equalsIgnoreCase(extension, name)) {
+        return type;
+      }
+    }
+  }
+  return "application/octet-stream";
+}
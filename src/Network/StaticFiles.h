@@ -0,0 +1,63 @@
+/*****************************************************************************/
+/**
+ * @file    StaticFiles.h
+ * @author  Team Server
+ * @brief   Definition of class StaticFiles
+ */
+/*****************************************************************************/
+
+#ifndef _STATIC_FILES_H_
+#define _STATIC_FILES_H_
+
+#include <optional>
+#include <string_view>
+
+#include "RequestInformation.h"
+#include "Types/Result.h"
+
+/**
+ * @class StaticFiles
+ * @brief Serves the files of the web client from a static directory.
+ * @details The directory is configured by the key `staticDirectory` of section
+ * `RestAPI` (empty = disabled). All paths outside of the REST API refer to
+ * it, `/` and paths ending with a slash to the `index.html` of the directory.
+ * Hidden files and paths leaving the directory are never served. The
+ * directory and the `max-age` of the files (key `staticMaxAgeSeconds`) are
+ * read by configure() when the server starts.
+ *
+ * Files are opened once and kept open while they are unchanged. Responses
+ * carry the open file instead of its content, which is sent by the webserver
+ * with `sendfile`, so neither the content is copied nor a worker thread is
+ * blocked while sending it.
+ *
+ * Precompressed variants next to a file (`<file>.br` and `<file>.gz`) are
+ * sent instead of the file if the client accepts them and they are not older
+ * than the file. Each variant has a strong entity tag of its own.
+ */
+class StaticFiles {
+ public:
+  /**
+   * @brief Reads the static directory and the `max-age` of the files from the
+   * configuration.
+   * @details Changes of the configuration take effect with the next call.
+   * Until the first call, serving files is disabled.
+   * @return An error if the directory does not exist or the `max-age` is not
+   * a number or negative.
+   */
+  static TResultOpt configure();
+
+  /**
+   * @brief Answers a `GET` or `HEAD` request for a static file.
+   * @return The response, or `nullopt` if the request does not refer to an
+   * existing file (or serving files is disabled).
+   */
+  static std::optional<ResponseInformation> serve(
+      RequestInformation const &request);
+
+  /**
+   * @brief Returns the media type of a file by its extension.
+   */
+  static std::string_view mediaType(std::string_view path);
+};
+
+#endif /* _STATIC_FILES_H_ */
@@ -10,9 +10,34 @@
 
 #include <cassert>
 
+#include "Network/EpollRestAPI.h"
+#include "Network/RestAPI.h"
+#include "Utils/ConfigHandler.h"
+
+using namespace std;
+
 NetworkAPI::NetworkAPI() : listener(nullptr) {
 }
 
+TResult<unique_ptr<NetworkAPI>> NetworkAPI::create() {
+  auto configImplementation = ConfigHandler::getInstance()->getValueString(
+      "RestAPI", "implementation", "libhttpserver");
+  if (holds_alternative<Error>(configImplementation)) {
+    return get<Error>(configImplementation);
+  }
+
+  string implementation = get<string>(configImplementation);
+  if (implementation == "libhttpserver") {
+    return unique_ptr<NetworkAPI>(make_unique<RestAPI>());
+  }
+  if (implementation == "epoll") {
+    return unique_ptr<NetworkAPI>(make_unique<EpollRestAPI>());
+  }
+  return Error(ErrorCode::InvalidValue,
+               "NetworkAPI.create: Unknown implementation '" + implementation +
+                   "'");
+}
+
 void NetworkAPI::setListener(NetworkListener *listener) {
   assert(listener);
   this->listener = listener;
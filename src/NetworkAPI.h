@@ -9,6 +9,8 @@
 #ifndef _NETWORK_API_H_
 #define _NETWORK_API_H_
 
+#include <memory>
+
 #include "NetworkListener.h"
 
 /**
@@ -24,9 +26,22 @@ class NetworkAPI {
   virtual ~NetworkAPI() {
   }
 
+  /**
+   * @brief Creates the implementation selected by the key `implementation` in
+   * the section `RestAPI` of the configuration.
+   * @details `libhttpserver` (default) selects `RestAPI`, `epoll` selects
+   * `EpollRestAPI`.
+   */
+  static TResult<std::unique_ptr<NetworkAPI>> create();
+
   void setListener(NetworkListener *);
   virtual TResultOpt handleRequests() = 0;
 
+  /**
+   * @brief Stops the server, `handleRequests` returns afterwards.
+   */
+  virtual void stopServer() = 0;
+
  private:
   // dont allow copying
   NetworkAPI(NetworkAPI const &) = delete;
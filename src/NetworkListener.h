@@ -9,7 +9,10 @@
 #ifndef _NETWORKLISTENER_H_
 #define _NETWORKLISTENER_H_
 
+#include <algorithm>
+#include <optional>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -59,6 +62,105 @@ class NetworkListener {
    */
   virtual TResult<QueueStatus> getCurrentQueues(TSessionID const &sid) = 0;
 
+  /**
+   * @brief Query the content of the current queues, with a range of the normal
+   * queue only.
+   * @details Like `getCurrentQueues`, but the normal queue holds at most
+   * `limit` tracks, starting at position `offset`, along with the size of the
+   * whole queue. Since the queue is sorted, an `offset` of 0 returns the top
+   * `limit` tracks.
+   *
+   * The default implementation queries the whole queues and drops the other
+   * tracks. Implementations should override it to avoid collecting them.
+   *
+   * @param sid The session ID of the user.
+   * @param offset Position of the first track of the normal queue to return.
+   * @param limit Maximum number of tracks of the normal queue to return.
+   *
+   * @return On success the current queues and the current track are returned,
+   * an `Error` otherwise.
+   */
+  virtual TResult<QueueStatus> getCurrentQueuesRange(TSessionID const &sid,
+                                                     size_t offset,
+                                                     size_t limit) {
+    auto result = getCurrentQueues(sid);
+    if (std::holds_alternative<QueueStatus>(result)) {
+      auto &queue = std::get<QueueStatus>(result).normalQueue;
+      auto &tracks = queue.tracks;
+      queue.totalSize = tracks.size();
+      queue.offset = std::min(offset, tracks.size());
+      tracks.erase(tracks.begin(), tracks.begin() + queue.offset);
+      tracks.resize(std::min(limit, tracks.size()));
+    }
+    return result;
+  }
+
+  /**
+   * @brief Query the currently playing track only.
+   * @details Returns the `currentTrack` of `getCurrentQueues`, for clients
+   * which already know the current queues.
+   *
+   * The default implementation queries the whole queues. Implementations
+   * should override it to avoid collecting them.
+   *
+   * @param sid The session ID of the user.
+   *
+   * @return On success the current track (if any) is returned, an `Error`
+   * otherwise.
+   */
+  virtual TResult<std::optional<PlaybackTrack>> getCurrentPlayback(
+      TSessionID const &sid) {
+    auto result = getCurrentQueues(sid);
+    if (std::holds_alternative<Error>(result)) {
+      return std::get<Error>(result);
+    }
+    return std::get<QueueStatus>(result).currentTrack;
+  }
+
+  /**
+   * @brief Query the tracks the user has voted for.
+   * @details The tracks of the normal queue returned by `getCurrentQueues`
+   * have `userHasVoted` set if and only if they are in this list, which may
+   * hold tracks which are not queued anymore. Lets the queues be collected
+   * once for all users.
+   *
+   * The default implementation collects the flags of the normal queue.
+   *
+   * @param sid The session ID of the user.
+   *
+   * @return On success the IDs of the tracks are returned, an `Error`
+   * otherwise.
+   */
+  virtual TResult<std::vector<TTrackID>> getVotedTracks(
+      TSessionID const &sid) {
+    auto result = getCurrentQueues(sid);
+    if (std::holds_alternative<Error>(result)) {
+      return std::get<Error>(result);
+    }
+    std::vector<TTrackID> votedTracks;
+    for (auto const &track : std::get<QueueStatus>(result).normalQueue.tracks) {
+      if (track.userHasVoted) {
+        votedTracks.push_back(track.trackId);
+      }
+    }
+    return votedTracks;
+  }
+
+  /**
+   * @brief Query the version of the information returned by
+   * `getCurrentQueues`.
+   * @details This is a cheap way for clients to check whether the current
+   * queues have changed, without collecting the queues themselves.
+   *
+   * @param sid The session ID of the user. Since the result of
+   * `getCurrentQueues` depends on the votes of the user, the version does so as
+   * well.
+   *
+   * @return On success the current version is returned, an `Error` otherwise.
+   */
+  virtual TResult<QueueStatusVersion> getCurrentQueuesVersion(
+      TSessionID const &sid) = 0;
+
   /**
    * @brief Add a track to a given queue (normal or admin).
    * @details Depending on the value of `type` a track is added to either the
@@ -98,6 +200,28 @@ class NetworkListener {
                                TTrackID const &trkid,
                                TVote vote) = 0;
 
+  /**
+   * @brief Apply several votes of the same user at once.
+   * @details Used by batch requests. Behaves like calling `voteTrack` for each
+   * vote in order, which is what the default implementation does.
+   * Implementations may override it to validate the session only once.
+   *
+   * @param sid The session ID of the user.
+   * @param votes The IDs of the tracks to vote for and their votes.
+   *
+   * @return One result per vote, in the same order.
+   */
+  virtual std::vector<TResultOpt> voteTracks(
+      TSessionID const &sid,
+      std::vector<std::pair<TTrackID, TVote>> const &votes) {
+    std::vector<TResultOpt> results;
+    results.reserve(votes.size());
+    for (auto const &[trkid, vote] : votes) {
+      results.push_back(voteTrack(sid, trkid, vote));
+    }
+    return results;
+  }
+
   /**
    * @brief Controls the behaviour of the music player.
    * @details Allows the admin to control some behaviour of the player. This
@@ -151,6 +275,20 @@ class NetworkListener {
   virtual TResultOpt moveTrack(TSessionID const &sid,
                                TTrackID const &trkid,
                                QueueType toQueue) = 0;
+
+  /**
+   * @brief Check that a session belongs to an admin.
+   * @details Used by endpoints which are restricted to admins, but do not
+   * access the queues or the player, e.g. the profiling endpoints.
+   *
+   * @param sid The session ID of the user.
+   * @return Returns an `Error` if the session is invalid or expired, or if the
+   * user is not an admin.
+   *
+   * @note The user must have been authenticated as admin when generating the
+   * session ID!
+   */
+  virtual TResultOpt authorizeAdmin(TSessionID const &sid) = 0;
 };
 
 #endif /* _NETWORKLISTENER_H_ */
@@ -8,16 +8,73 @@
 
 #include <connection.h>
 
+#include <algorithm>
 #include <cassert>
+#include <charconv>
 #include <memory>
+#include <string_view>
+
+#include "SpotifyCallBudget.h"
+#include "Utils/Deadline.h"
+#include "Utils/Metrics.h"
+#include "Utils/Tracing.h"
 
 using namespace SpotifyApi;
 
+static MetricFamily<Counter> &callCounter() {
+  static auto &calls =
+      Metrics::counter("jukebox_spotify_requests_total",
+                       "Calls to the Spotify API by endpoint and status",
+                       {"endpoint", "status"});
+  return calls;
+}
+
+/**
+ * @brief Returns the label of an endpoint in the metrics, IDs in the path are
+ * replaced so each endpoint has a single series.
+ */
+static std::string_view endpointLabel(std::string_view endpoint) {
+  static constexpr std::string_view TRACKS = "/v1/tracks/";
+  if (endpoint.substr(0, TRACKS.size()) == TRACKS) {
+    return "/v1/tracks/{id}";
+  }
+  return endpoint;
+}
+
+/**
+ * @brief Records a finished call to Spotify in the metrics.
+ * @param code The HTTP status code, or the curl error code.
+ */
+static void recordCall(std::string_view endpoint,
+                       int code,
+                       Histogram::Clock::time_point start) {
+  static auto &durations =
+      Metrics::histogram("jukebox_spotify_request_duration_seconds",
+                         "Duration of calls to the Spotify API",
+                         {"endpoint"});
+
+  char buffer[8];
+  std::string_view status;
+  if (code == CURLE_OPERATION_TIMEDOUT) {
+    status = "timeout";
+  } else if (code < 100) {
+    status = "error";
+  } else {
+    auto end = std::to_chars(buffer, buffer + sizeof(buffer), code).ptr;
+    status = std::string_view(buffer, end - buffer);
+  }
+  endpoint = endpointLabel(endpoint);
+  callCounter().labels({endpoint, status}).inc();
+  durations.labels({endpoint}).observeSince(start);
+  SpotifyCallBudget::record(status, Histogram::Clock::now() - start);
+}
+
 TResult<Token> SpotifyAPI::getAccessToken(GrantType grantType,
                                           std::string const &code,
                                           std::string const &redirectUri,
                                           std::string const &clientID,
                                           std::string const &clientSecret) {
+  Tracing::Span span("SpotifyAPI.getAccessToken");
   (void)grantType;
   LOG(INFO) << "SpotifyAPI.getAccessToken: Function called";
 
@@ -47,7 +104,9 @@ TResult<Token> SpotifyAPI::getAccessToken(GrantType grantType,
   client->SetHeaders(headers);
 
   client->SetTimeout(cRequestTimeout);
+  auto start = Histogram::Clock::now();
   auto response = client->post("/api/token", body);
+  recordCall("/api/token", response.code, start);
   nlohmann::json tokenJson;
   try {
     tokenJson = nlohmann::json::parse(response.body);
@@ -75,6 +134,7 @@ TResult<Token> SpotifyAPI::getAccessToken(GrantType grantType,
 TResult<Token> SpotifyAPI::refreshAccessToken(std::string const &refreshToken,
                                               std::string const &clientID,
                                               std::string const &clientSecret) {
+  Tracing::Span span("SpotifyAPI.refreshAccessToken");
   auto client = std::make_unique<RestClient::Connection>(cSpotifyAuthUrl);
   LOG(INFO) << "SpotifyAPI.refreshAccessToken: Function called";
   // build body
@@ -97,7 +157,9 @@ TResult<Token> SpotifyAPI::refreshAccessToken(std::string const &refreshToken,
   client->SetHeaders(headers);
 
   client->SetTimeout(cRequestTimeout);
+  auto start = Histogram::Clock::now();
   auto response = client->post("/api/token", body);
+  recordCall("/api/token", response.code, start);
   nlohmann::json tokenJson;
   try {
     tokenJson = nlohmann::json::parse(response.body);
@@ -125,6 +187,7 @@ TResult<Token> SpotifyAPI::refreshAccessToken(std::string const &refreshToken,
 
 TResult<std::vector<Device>> SpotifyAPI::getAvailableDevices(
     std::string const &accessToken) {
+  Tracing::Span span("SpotifyAPI.getAvailableDevices");
   LOG(INFO) << "SpotifyAPI.getAvailableDevices: Function called";
 
   auto responseRet = spotifyCall(accessToken, "/v1/me/player/devices", HttpGet);
@@ -142,6 +205,7 @@ TResult<std::vector<Device>> SpotifyAPI::getAvailableDevices(
 
 TResult<std::optional<Playback>> SpotifyAPI::getCurrentPlayback(
     std::string const &accessToken, std::string const &market) {
+  Tracing::Span span("SpotifyAPI.getCurrentPlayback");
   (void)market;
 
   VLOG(100) << "SpotifyAPI.getCurrentPlayback: Function called";
@@ -172,6 +236,7 @@ TResult<SpotifyPaging> SpotifyAPI::search(std::string const &accessToken,
                                           const int limit,
                                           int const offset,
                                           const std::string &market) {
+  Tracing::Span span("SpotifyAPI.search");
   LOG(INFO) << "SpotifyAPI.search: Function called with querykey: " << queryKey;
 
   // build query
@@ -200,6 +265,7 @@ TResult<SpotifyPaging> SpotifyAPI::search(std::string const &accessToken,
 TResultOpt SpotifyAPI::setVolume(std::string const &accessToken,
                                  int volume,
                                  const SpotifyApi::Device &device) {
+  Tracing::Span span("SpotifyAPI.setVolume");
   LOG(INFO) << "SpotifyAPI.setVolume: Function called";
   // set upper and lower bounds
   volume = volume > 100 ? 100 : volume;
@@ -236,6 +302,7 @@ TResultOpt SpotifyAPI::setVolume(std::string const &accessToken,
 
 TResultOpt SpotifyAPI::pause(std::string const &accessToken,
                              const SpotifyApi::Device &device) {
+  Tracing::Span span("SpotifyAPI.pause");
   LOG(INFO) << "SpotifyAPI.pause: Function called";
   // build query
   std::stringstream queryStream;
@@ -269,6 +336,7 @@ TResultOpt SpotifyAPI::play(std::string const &accessToken,
                             std::vector<std::string> const &uris,
                             const SpotifyApi::Device &device,
                             int positionMs) {
+  Tracing::Span span("SpotifyAPI.play");
   LOG(INFO) << "SpotifyAPI.play: Function called";
 
   // build query
@@ -311,6 +379,7 @@ TResultOpt SpotifyAPI::play(std::string const &accessToken,
 TResult<Track> SpotifyAPI::getTrack(std::string const &accessToken,
                                     std::string const &spotifyID,
                                     const std::string &market) {
+  Tracing::Span span("SpotifyAPI.getTrack");
   (void)market;
 
   LOG(INFO) << "SpotifyAPI.getTrack: Function called";
@@ -337,6 +406,7 @@ TResult<Track> SpotifyAPI::getTrack(std::string const &accessToken,
 TResultOpt SpotifyAPI::transferUsersPlayback(std::string const &accessToken,
                                              std::vector<Device> const &devices,
                                              bool play) {
+  Tracing::Span span("SpotifyAPI.transferUsersPlayback");
   LOG(INFO) << "SpotifyAPI.transferUsersPlayback: Function called";
 
   // build body
@@ -382,6 +452,12 @@ TResult<RestClient::Response> SpotifyAPI::spotifyCall(
     return Error(ErrorCode::SpotifyAccessDenied, "Invalid access token");
   }
 
+  // don't call spotify for requests the client has given up on already
+  if (auto expired = Deadline::check()) {
+    callCounter().labels({endpointLabel(endpoint), "deadline"}).inc();
+    return expired.value();
+  }
+
   // create standard headers for spotify api communication
   RestClient::HeaderFields headers;
   headers.insert({"Accept", "application/json"});
@@ -390,9 +466,20 @@ TResult<RestClient::Response> SpotifyAPI::spotifyCall(
 
   auto client = std::make_unique<RestClient::Connection>(cSpotifyAPIUrl);
   client->SetHeaders(headers);
-  client->SetTimeout(cRequestTimeout);
+
+  // the timeout is capped to the time left for the request, in whole seconds
+  // as supported by the client (0 would disable it)
+  int timeout = static_cast<int>(cRequestTimeout);
+  auto remaining = Deadline::remaining();
+  if (remaining.has_value()) {
+    int remainingSeconds =
+        static_cast<int>((remaining.value().count() + 999) / 1000);
+    timeout = std::min(timeout, std::max(remainingSeconds, 1));
+  }
+  client->SetTimeout(timeout);
 
   RestClient::Response response;
+  auto start = Histogram::Clock::now();
 
   switch (method) {
     case HttpGet: {
@@ -409,10 +496,14 @@ TResult<RestClient::Response> SpotifyAPI::spotifyCall(
     default:
       return Error(ErrorCode::SpotifyAPIError, "Invalid Http method");
   }
+  recordCall(endpoint, response.code, start);
 
   // check for curl errors and restclient error
   if (response.code == CURLE_OPERATION_TIMEDOUT ||
       response.code == cHTTPTimeout) {
+    if (auto expired = Deadline::check()) {
+      return expired.value();
+    }
     return Error(ErrorCode::SpotifyHttpTimeout, "Timeout on Spotify request");
   } else if (response.code == CURLE_SSL_CERTPROBLEM) {
     return Error(ErrorCode::SpotifyAPIError, response.body);
@@ -9,6 +9,7 @@
 #include <chrono>
 #include <memory>
 
+#include "SpotifyCallBudget.h"
 #include "Types/Result.h"
 #include "Utils/ConfigHandler.h"
 #include "Utils/LoggingHandler.h"
@@ -72,6 +73,7 @@ TResultOpt SpotifyAuthorization::refreshAccessToken() {
     return std::nullopt;
   }
 
+  SpotifyCallBudget::CallerScope caller(SpotifyCaller::TokenRefresh);
   SpotifyAPI api;
   auto ret = api.refreshAccessToken(
       mToken.getRefreshToken(), mClientID, mClientSecret);
@@ -13,6 +13,7 @@
 #include "SpotifyAPI.h"
 #include "SpotifyAPITypes.h"
 #include "Types/Result.h"
+#include "Utils/ProfiledMutex.h"
 #include "httpserver.hpp"
 
 namespace SpotifyApi {
@@ -89,7 +90,7 @@ class SpotifyAuthorization : public httpserver::http_resource {
   std::string const cRedirectUriKey = "redirectUri";
   std::string const cScopesKey = "scopes";
   std::unique_ptr<httpserver::webserver> mWebserver;
-  std::mutex mMutex;
+  ProfiledMutex<std::mutex> mMutex{"SpotifyAuthorization"};
 
   const std::shared_ptr<httpserver::http_response> render(
       httpserver::http_request const &request);
@@ -10,8 +10,11 @@
 
 #include <vector>
 
+#include "SpotifyCallBudget.h"
 #include "Utils/ConfigHandler.h"
+#include "Utils/Deadline.h"
 #include "Utils/LoggingHandler.h"
+#include "Utils/Tracing.h"
 
 using namespace SpotifyApi;
 
@@ -54,6 +57,11 @@ using namespace SpotifyApi;
   }
 
 TResultOpt SpotifyBackend::initBackend() {
+  auto budgetRet = SpotifyCallBudget::configure();
+  if (budgetRet.has_value()) {
+    return budgetRet;
+  }
+
   // start server for authentication
   auto startServerRet = mSpotifyAuth.startServer();
 
@@ -62,6 +70,8 @@ TResultOpt SpotifyBackend::initBackend() {
 
 TResult<std::vector<BaseTrack>> SpotifyBackend::queryTracks(
     std::string const &pattern, size_t const num) {
+  Tracing::Span span("SpotifyBackend.queryTracks");
+  SpotifyCallBudget::CallerScope caller(SpotifyCaller::Search);
   std::string token = mSpotifyAuth.getAccessToken();
 
   TResult<SpotifyPaging> retVal;
@@ -103,7 +113,9 @@ TResult<std::vector<BaseTrack>> SpotifyBackend::queryTracks(
 }
 
 TResultOpt SpotifyBackend::setPlayback(BaseTrack const &track) {
-  std::unique_lock<std::mutex> myLock(mPlayPauseMtx);
+  Tracing::Span span("SpotifyBackend.setPlayback");
+  SpotifyCallBudget::CallerScope caller(SpotifyCaller::SetPlayback);
+  std::unique_lock myLock(mPlayPauseMtx);
   std::string token = mSpotifyAuth.getAccessToken();
 
   // check if playing devices are available
@@ -164,6 +176,9 @@ TResultOpt SpotifyBackend::setPlayback(BaseTrack const &track) {
 }
 
 TResult<std::optional<PlaybackTrack>> SpotifyBackend::getCurrentPlayback() {
+  Tracing::Span span("SpotifyBackend.getCurrentPlayback");
+  // the playback is polled by the scheduler only
+  SpotifyCallBudget::CallerScope caller(SpotifyCaller::SchedulerPoll);
   std::string token = mSpotifyAuth.getAccessToken();
 
   TResult<std::optional<Playback>> playbackRes;
@@ -213,7 +228,14 @@ TResult<std::optional<PlaybackTrack>> SpotifyBackend::getCurrentPlayback() {
 }
 
 TResultOpt SpotifyBackend::pause() {
-  std::unique_lock<std::mutex> myLock(mPlayPauseMtx);
+  Tracing::Span span("SpotifyBackend.pause");
+  SpotifyCallBudget::CallerScope caller(SpotifyCaller::PlayPause);
+  std::unique_lock myLock(mPlayPauseMtx);
+
+  // the deadline of the request may have passed while waiting for the lock
+  if (auto expired = Deadline::check()) {
+    return expired.value();
+  }
   std::string token = mSpotifyAuth.getAccessToken();
 
   auto playbackRes = getCurrentPlayback();
@@ -236,7 +258,14 @@ TResultOpt SpotifyBackend::pause() {
 }
 
 TResultOpt SpotifyBackend::play() {
-  std::unique_lock<std::mutex> myLock(mPlayPauseMtx);
+  Tracing::Span span("SpotifyBackend.play");
+  SpotifyCallBudget::CallerScope caller(SpotifyCaller::PlayPause);
+  std::unique_lock myLock(mPlayPauseMtx);
+
+  // the deadline of the request may have passed while waiting for the lock
+  if (auto expired = Deadline::check()) {
+    return expired.value();
+  }
 
   auto playbackRes = getCurrentPlayback();
   if (auto error = std::get_if<Error>(&playbackRes)) {
@@ -261,7 +290,14 @@ TResultOpt SpotifyBackend::play() {
 }
 
 TResult<size_t> SpotifyBackend::getVolume() {
-  std::unique_lock<std::mutex> myLock(mVolumeMtx);
+  Tracing::Span span("SpotifyBackend.getVolume");
+  SpotifyCallBudget::CallerScope caller(SpotifyCaller::Volume);
+  std::unique_lock myLock(mVolumeMtx);
+
+  // the deadline of the request may have passed while waiting for the lock
+  if (auto expired = Deadline::check()) {
+    return expired.value();
+  }
   std::string token = mSpotifyAuth.getAccessToken();
 
   TResult<std::optional<Playback>> playbackRes;
@@ -282,7 +318,14 @@ TResult<size_t> SpotifyBackend::getVolume() {
 }
 
 TResultOpt SpotifyBackend::setVolume(size_t const percent) {
-  std::unique_lock<std::mutex> myLock(mVolumeMtx);
+  Tracing::Span span("SpotifyBackend.setVolume");
+  SpotifyCallBudget::CallerScope caller(SpotifyCaller::Volume);
+  std::unique_lock myLock(mVolumeMtx);
+
+  // the deadline of the request may have passed while waiting for the lock
+  if (auto expired = Deadline::check()) {
+    return expired.value();
+  }
   std::string token = mSpotifyAuth.getAccessToken();
 
   // check if playing devices are available
@@ -320,6 +363,8 @@ TResultOpt SpotifyBackend::setVolume(size_t const percent) {
 }
 
 TResult<BaseTrack> SpotifyBackend::createBaseTrack(TTrackID const &trackID) {
+  Tracing::Span span("SpotifyBackend.createBaseTrack");
+  SpotifyCallBudget::CallerScope caller(SpotifyCaller::TrackLookup);
   std::string token = mSpotifyAuth.getAccessToken();
 
   // remove spotify uri header (spotify:track: )
@@ -17,6 +17,7 @@
 #include "Types/GlobalTypes.h"
 #include "Types/Queue.h"
 #include "Types/Result.h"
+#include "Utils/ProfiledMutex.h"
 
 /**
  * @brief spotify music backend class which handles api calls and starts the
@@ -68,8 +69,8 @@ class SpotifyBackend : public MusicBackend {
   SpotifyApi::SpotifyAPI mSpotifyAPI;
   SpotifyApi::SpotifyAuthorization mSpotifyAuth;
 
-  std::mutex mPlayPauseMtx;
-  std::mutex mVolumeMtx;
+  ProfiledMutex<std::mutex> mPlayPauseMtx{"SpotifyBackend.playPause"};
+  ProfiledMutex<std::mutex> mVolumeMtx{"SpotifyBackend.volume"};
 };
 
 #endif /* _SPOTIFYBACKEND_H_ */
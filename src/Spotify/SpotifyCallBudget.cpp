@@ -0,0 +1,239 @@
+/**
+ * @file    SpotifyCallBudget.cpp
+ * @author  Team Server
+ * @brief   Class SpotifyCallBudget implementation
+ */
+
+#include "SpotifyCallBudget.h"
+
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+#include "Utils/ConfigHandler.h"
+#include "Utils/JsonWriter.h"
+#include "Utils/LoggingHandler.h"
+#include "Utils/Metrics.h"
+
+using namespace SpotifyApi;
+
+static std::string const cSectionKey = "Spotify";
+static std::string const cBudgetKey = "callBudgetPerMinute";
+
+static constexpr size_t cCallerCount =
+    static_cast<size_t>(SpotifyCaller::TokenRefresh) + 1;
+
+namespace {
+
+struct CallerStats {
+  // calls per minute, the slot of a minute is `minute % WINDOW_MINUTES`
+  std::array<int64_t, SpotifyCallBudget::WINDOW_MINUTES> minutes{};
+  std::array<uint64_t, SpotifyCallBudget::WINDOW_MINUTES> counts{};
+  std::map<std::string, uint64_t> statuses;
+  uint64_t total = 0;
+  std::unique_ptr<Histogram> latencies = std::make_unique<Histogram>();
+};
+
+struct BudgetState {
+  std::mutex mutex;
+  std::array<CallerStats, cCallerCount> callers;
+  int64_t warnedMinute = -1;
+  int budget = 0;  // read by `configure`, 0 = none
+};
+
+BudgetState &state() {
+  static BudgetState instance;
+  return instance;
+}
+
+}  // namespace
+
+static thread_local SpotifyCaller tCaller = SpotifyCaller::Other;
+
+static int64_t currentMinute() {
+  return std::chrono::duration_cast<std::chrono::minutes>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+static uint64_t callsInMinute(CallerStats const &stats, int64_t minute) {
+  size_t slot = minute % SpotifyCallBudget::WINDOW_MINUTES;
+  return stats.minutes[slot] == minute ? stats.counts[slot] : 0;
+}
+
+SpotifyCallBudget::CallerScope::CallerScope(SpotifyCaller caller)
+    : mOuter(tCaller) {
+  tCaller = caller;
+}
+
+SpotifyCallBudget::CallerScope::~CallerScope() {
+  tCaller = mOuter;
+}
+
+TResultOpt SpotifyCallBudget::configure() {
+  auto budget =
+      ConfigHandler::getInstance()->getValueInt(cSectionKey, cBudgetKey, 0);
+  if (std::holds_alternative<Error>(budget)) {
+    return std::get<Error>(budget);
+  }
+  if (std::get<int>(budget) < 0) {
+    return Error(ErrorCode::InvalidValue,
+                 "SpotifyCallBudget.configure: " + cBudgetKey +
+                     " must not be negative");
+  }
+
+  auto &budgetState = state();
+  std::lock_guard<std::mutex> lock(budgetState.mutex);
+  budgetState.budget = std::get<int>(budget);
+  return std::nullopt;
+}
+
+SpotifyCaller SpotifyCallBudget::currentCaller() {
+  return tCaller;
+}
+
+char const *SpotifyCallBudget::callerName(SpotifyCaller caller) {
+  switch (caller) {
+    case SpotifyCaller::SchedulerPoll:
+      return "schedulerPoll";
+    case SpotifyCaller::Search:
+      return "search";
+    case SpotifyCaller::SetPlayback:
+      return "setPlayback";
+    case SpotifyCaller::PlayPause:
+      return "playPause";
+    case SpotifyCaller::Volume:
+      return "volume";
+    case SpotifyCaller::TrackLookup:
+      return "trackLookup";
+    case SpotifyCaller::TokenRefresh:
+      return "tokenRefresh";
+    case SpotifyCaller::Other:
+      break;
+  }
+  return "other";
+}
+
+void SpotifyCallBudget::record(std::string_view status,
+                               std::chrono::steady_clock::duration latency) {
+  static auto &calls = Metrics::counter(
+      "jukebox_spotify_calls_total",
+      "Calls to the Spotify API by calling code path and status",
+      {"caller", "status"});
+  static auto &durations =
+      Metrics::histogram("jukebox_spotify_call_duration_seconds",
+                         "Duration of calls to the Spotify API by calling "
+                         "code path",
+                         {"caller"});
+
+  auto caller = tCaller;
+  auto name = callerName(caller);
+  auto micros =
+      std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+  calls.labels({name, status}).inc();
+  durations.labels({name}).observe(micros);
+
+  int64_t minute = currentMinute();
+  auto &budgetState = state();
+  std::lock_guard<std::mutex> lock(budgetState.mutex);
+
+  auto &stats = budgetState.callers[static_cast<size_t>(caller)];
+  size_t slot = minute % WINDOW_MINUTES;
+  if (stats.minutes[slot] != minute) {
+    stats.minutes[slot] = minute;
+    stats.counts[slot] = 0;
+  }
+  stats.counts[slot]++;
+  stats.statuses[std::string(status)]++;
+  stats.total++;
+  stats.latencies->observe(micros);
+
+  int budget = budgetState.budget;
+  if (budget <= 0 || budgetState.warnedMinute == minute) {
+    return;
+  }
+  uint64_t total = 0;
+  for (auto const &callerStats : budgetState.callers) {
+    total += callsInMinute(callerStats, minute);
+  }
+  if (total < static_cast<uint64_t>(budget)) {
+    return;
+  }
+  budgetState.warnedMinute = minute;
+
+  std::stringstream callers;
+  for (size_t i = 0; i < cCallerCount; i++) {
+    auto count = callsInMinute(budgetState.callers[i], minute);
+    if (count > 0) {
+      callers << " " << callerName(static_cast<SpotifyCaller>(i)) << "="
+              << count;
+    }
+  }
+  LOG(WARNING) << "SpotifyCallBudget: " << total
+               << " calls to spotify this minute reached the budget of "
+               << budget << " calls per minute, by caller:" << callers.str();
+}
+
+size_t SpotifyCallBudget::callsThisMinute() {
+  int64_t minute = currentMinute();
+  auto &budgetState = state();
+  std::lock_guard<std::mutex> lock(budgetState.mutex);
+  size_t total = 0;
+  for (auto const &stats : budgetState.callers) {
+    total += callsInMinute(stats, minute);
+  }
+  return total;
+}
+
+std::string SpotifyCallBudget::report() {
+  int64_t minute = currentMinute();
+  auto &budgetState = state();
+  std::lock_guard<std::mutex> lock(budgetState.mutex);
+
+  uint64_t callsThisMinute = 0;
+  JsonWriter writer;
+  writer.beginObject();
+  writer.key("budget_per_minute").value(budgetState.budget);
+  writer.key("callers").beginArray();
+  for (size_t i = 0; i < cCallerCount; i++) {
+    auto const &stats = budgetState.callers[i];
+    callsThisMinute += callsInMinute(stats, minute);
+
+    writer.beginObject();
+    writer.key("calls_current_minute").value(callsInMinute(stats, minute));
+    // the current minute comes last
+    writer.key("calls_per_minute").beginArray();
+    for (size_t age = WINDOW_MINUTES; age-- > 0;) {
+      writer.value(callsInMinute(stats, minute - static_cast<int64_t>(age)));
+    }
+    writer.endArray();
+    writer.key("latency_us").beginObject();
+    writer.key("p50").value(stats.latencies->quantile(0.5));
+    writer.key("p90").value(stats.latencies->quantile(0.9));
+    writer.key("p99").value(stats.latencies->quantile(0.99));
+    writer.endObject();
+    writer.key("name").value(callerName(static_cast<SpotifyCaller>(i)));
+    writer.key("statuses").beginObject();
+    for (auto const &[status, count] : stats.statuses) {
+      writer.key(status).value(count);
+    }
+    writer.endObject();
+    writer.key("total").value(stats.total);
+    writer.endObject();
+  }
+  writer.endArray();
+  writer.key("calls_current_minute").value(callsThisMinute);
+  writer.endObject();
+  return writer.release();
+}
+
+void SpotifyCallBudget::reset() {
+  auto &budgetState = state();
+  std::lock_guard<std::mutex> lock(budgetState.mutex);
+  for (auto &stats : budgetState.callers) {
+    stats = CallerStats();
+  }
+  budgetState.warnedMinute = -1;
+}
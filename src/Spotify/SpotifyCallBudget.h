@@ -0,0 +1,108 @@
+/**
+ * @file    SpotifyCallBudget.h
+ * @author  Team Server
+ * @brief   Class SpotifyCallBudget definition
+ */
+
+#ifndef SPOTIFYCALLBUDGET_H_INCLUDED
+#define SPOTIFYCALLBUDGET_H_INCLUDED
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "Types/Result.h"
+
+namespace SpotifyApi {
+
+/**
+ * @brief code paths calling the spotify web api
+ */
+enum class SpotifyCaller {
+  Other,
+  SchedulerPoll,
+  Search,
+  SetPlayback,
+  PlayPause,
+  Volume,
+  TrackLookup,
+  TokenRefresh
+};
+
+/**
+ * @brief accounts the calls to the spotify web api per caller
+ * @details The calls are counted in per-minute windows (of the last
+ * `WINDOW_MINUTES` minutes), together with their status and latency. A
+ * warning is logged once per minute if all callers together exceed the soft
+ * budget `callBudgetPerMinute` of section `Spotify` (0 = none), which should
+ * be set below the rate limit of spotify. The budget is read by `configure`
+ * when the backend is initialized.
+ *
+ * The caller is set by the code path issuing the calls with a
+ * `SpotifyCallBudget::CallerScope`, the innermost scope of a thread wins.
+ */
+class SpotifyCallBudget {
+ public:
+  static constexpr size_t WINDOW_MINUTES = 60;
+
+  /**
+   * @brief sets the caller of the current thread until it is destroyed
+   */
+  class CallerScope {
+   public:
+    explicit CallerScope(SpotifyCaller caller);
+    ~CallerScope();
+    CallerScope(CallerScope const &) = delete;
+    CallerScope &operator=(CallerScope const &) = delete;
+
+   private:
+    SpotifyCaller mOuter;
+  };
+
+  /**
+   * @brief reads the budget from the configuration
+   * @details changes of the configuration take effect with the next call,
+   * there is no budget until the first call
+   * @return an error if the budget is not a number or negative
+   */
+  static TResultOpt configure();
+
+  /**
+   * @brief returns the caller of the current thread
+   */
+  static SpotifyCaller currentCaller();
+
+  /**
+   * @brief returns the name of a caller in the report, e.g. `schedulerPoll`
+   */
+  static char const *callerName(SpotifyCaller caller);
+
+  /**
+   * @brief records a finished call of the current caller
+   * @param status HTTP status code, `timeout` or `error`
+   * @param latency duration of the call
+   */
+  static void record(std::string_view status,
+                     std::chrono::steady_clock::duration latency);
+
+  /**
+   * @brief returns the number of calls of the current minute (all callers)
+   */
+  static size_t callsThisMinute();
+
+  /**
+   * @brief returns the statistics of all callers as JSON, see
+   * `/debug/spotify`
+   */
+  static std::string report();
+
+  /**
+   * @brief discards all recorded calls
+   */
+  static void reset();
+};
+
+}  // namespace SpotifyApi
+
+#endif /* SPOTIFYCALLBUDGET_H_INCLUDED */
@@ -9,6 +9,7 @@
 #ifndef _QUEUE_H_
 #define _QUEUE_H_
 
+#include <cstdint>
 #include <optional>
 #include <vector>
 
@@ -16,9 +17,22 @@
 
 /**
  * @brief Respresents a queue which is returned to the clients.
+ * @details May hold only a range of the whole queue, starting at `offset`.
  */
 struct Queue {
   std::vector<QueuedTrack> tracks;
+  uint64_t version = 0;  ///< version of the queue, 0 if unknown
+  size_t offset = 0;     ///< position of the first track in the whole queue
+
+  /// size of the whole queue, unknown if `tracks` holds the whole queue
+  std::optional<size_t> totalSize = std::nullopt;
+
+  /**
+   * @brief Returns the size of the whole queue.
+   */
+  size_t getTotalSize() const {
+    return totalSize.value_or(offset + tracks.size());
+  }
 };
 
 /**
@@ -32,4 +46,16 @@ struct QueueStatus {
   std::optional<PlaybackTrack> currentTrack;
 };
 
+/**
+ * @brief Identifies the state of the information returned if a client requests
+ * the current queue status.
+ * @details As long as all versions are equal, the queue status returned to the
+ * same user does not change.
+ */
+struct QueueStatusVersion {
+  uint64_t queueVersion;     ///< changes with the queues and current track
+  uint64_t playbackVersion;  ///< changes with the playback of the player
+  uint64_t votesVersion;     ///< changes with the votes of the user
+};
+
 #endif /* _QUEUE_H_ */
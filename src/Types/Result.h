@@ -39,7 +39,9 @@ enum class ErrorCode {
   SpotifyNoDevice,
   AlreadyExists,
   DoesntExist,
-  WrongPassword
+  WrongPassword,
+  ServiceUnavailable,
+  DeadlineExceeded
 };
 
 /**
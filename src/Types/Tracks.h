@@ -50,6 +50,8 @@ struct QueuedTrack : public BaseTrack {
 struct PlaybackTrack : public BaseTrack {
   int progressMs;
   bool isPlaying;
+  int64_t startedAtMs;  ///< time the track would have started at if it was
+                        ///< never paused, in ms since the Unix epoch
 };
 
 #endif /* _TRACKS_H_ */
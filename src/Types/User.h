@@ -7,6 +7,7 @@
 #ifndef _USER_H_
 #define _USER_H_
 
+#include <cstdint>
 #include <ctime>
 #include <vector>
 
@@ -19,6 +20,7 @@ class User {
   std::string Name;
   bool isAdmin;
   std::vector<TTrackID> votes;
+  uint64_t votesVersion = 0;
   bool operator==(const User user) {
     return SessionID == user.SessionID;
   }
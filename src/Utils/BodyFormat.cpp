@@ -0,0 +1,219 @@
+/*****************************************************************************/
+/**
+ * @file    BodyFormat.cpp
+ * @author  Team Server
+ * @brief   Implementation of the binary body encoding helpers
+ */
+/*****************************************************************************/
+
+#include "Utils/BodyFormat.h"
+
+#include <cassert>
+
+#include "Utils/HttpHeader.h"
+
+using namespace std;
+using json = nlohmann::json;
+
+static string_view const MEDIA_TYPE_JSON = "application/json";
+static string_view const MEDIA_TYPE_MSGPACK = "application/msgpack";
+static string_view const MEDIA_TYPE_CBOR = "application/cbor";
+
+// same limit as for JSON request bodies, see RequestDecoder
+static size_t const MAX_DEPTH = 64;
+
+/**
+ * @brief SAX consumer which builds the document like `json::from_msgpack`,
+ * but rejects bodies nested deeper than `MAX_DEPTH`.
+ * @details The binary readers recurse for every nesting level, so a small
+ * body could otherwise exhaust the stack.
+ */
+class DepthLimitedSax {
+ public:
+  explicit DepthLimitedSax(json &document) : mParser(document, false) {
+  }
+
+  bool null() {
+    return mParser.null();
+  }
+  bool boolean(bool val) {
+    return mParser.boolean(val);
+  }
+  bool number_integer(json::number_integer_t val) {
+    return mParser.number_integer(val);
+  }
+  bool number_unsigned(json::number_unsigned_t val) {
+    return mParser.number_unsigned(val);
+  }
+  bool number_float(json::number_float_t val, json::string_t const &s) {
+    return mParser.number_float(val, s);
+  }
+  bool string(json::string_t &val) {
+    return mParser.string(val);
+  }
+  bool start_object(size_t elements) {
+    return ++mDepth <= MAX_DEPTH && mParser.start_object(elements);
+  }
+  bool key(json::string_t &val) {
+    return mParser.key(val);
+  }
+  bool end_object() {
+    mDepth--;
+    return mParser.end_object();
+  }
+  bool start_array(size_t elements) {
+    return ++mDepth <= MAX_DEPTH && mParser.start_array(elements);
+  }
+  bool end_array() {
+    mDepth--;
+    return mParser.end_array();
+  }
+  bool parse_error(size_t position,
+                   std::string const &token,
+                   nlohmann::detail::exception const &ex) {
+    return mParser.parse_error(position, token, ex);
+  }
+
+ private:
+  nlohmann::detail::json_sax_dom_parser<json> mParser;
+  size_t mDepth = 0;
+};
+
+/**
+ * @brief Maps a media type (without parameters) to a format.
+ * @return `false` if the media type is no known format.
+ */
+static bool mapMediaType(string_view mediaType, BodyFormat &format) {
+  if (HttpHeader::equalsIgnoreCase(mediaType, MEDIA_TYPE_JSON)) {
+    format = BodyFormat::Json;
+  } else if (HttpHeader::equalsIgnoreCase(mediaType, MEDIA_TYPE_MSGPACK) ||
+             HttpHeader::equalsIgnoreCase(mediaType,
+                                          "application/x-msgpack") ||
+             HttpHeader::equalsIgnoreCase(mediaType,
+                                          "application/vnd.msgpack")) {
+    format = BodyFormat::MessagePack;
+  } else if (HttpHeader::equalsIgnoreCase(mediaType, MEDIA_TYPE_CBOR)) {
+    format = BodyFormat::Cbor;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+BodyFormat BodyCodec::negotiate(string_view accept) {
+  // -1: not listed
+  int jsonQuality = -1;
+  int msgpackQuality = -1;
+  int cborQuality = -1;
+  int wildcardQuality = -1;
+  while (!accept.empty()) {
+    auto entry = HttpHeader::nextElement(accept);
+    auto paramsBegin = entry.find(';');
+    auto mediaRange = HttpHeader::trim(entry.substr(0, paramsBegin));
+    int quality = 1000;
+    if (paramsBegin != string_view::npos) {
+      quality = HttpHeader::parseQuality(entry.substr(paramsBegin + 1));
+    }
+
+    BodyFormat format;
+    if (mediaRange == "*/*" ||
+        HttpHeader::equalsIgnoreCase(mediaRange, "application/*")) {
+      wildcardQuality = max(wildcardQuality, quality);
+    } else if (!mapMediaType(mediaRange, format)) {
+      continue;
+    } else if (format == BodyFormat::Json) {
+      jsonQuality = quality;
+    } else if (format == BodyFormat::MessagePack) {
+      msgpackQuality = quality;
+    } else {
+      cborQuality = quality;
+    }
+  }
+
+  // binary formats are never sent unless listed explicitly, but win a tie
+  // against JSON since they are smaller
+  if (jsonQuality < 0) {
+    jsonQuality = max(wildcardQuality, 0);
+  }
+  if (msgpackQuality > 0 && msgpackQuality >= cborQuality &&
+      msgpackQuality >= jsonQuality) {
+    return BodyFormat::MessagePack;
+  }
+  if (cborQuality > 0 && cborQuality >= jsonQuality) {
+    return BodyFormat::Cbor;
+  }
+  return BodyFormat::Json;
+}
+
+BodyFormat BodyCodec::parseContentType(string_view contentType) {
+  auto mediaType =
+      HttpHeader::trim(contentType.substr(0, contentType.find(';')));
+  BodyFormat format;
+  if (!mapMediaType(mediaType, format)) {
+    return BodyFormat::Json;
+  }
+  return format;
+}
+
+string_view BodyCodec::mediaType(BodyFormat format) {
+  switch (format) {
+    case BodyFormat::MessagePack:
+      return MEDIA_TYPE_MSGPACK;
+    case BodyFormat::Cbor:
+      return MEDIA_TYPE_CBOR;
+    case BodyFormat::Json:
+      break;
+  }
+  return MEDIA_TYPE_JSON;
+}
+
+string BodyCodec::encode(json const &document, BodyFormat format) {
+  string result;
+  switch (format) {
+    case BodyFormat::MessagePack:
+      json::to_msgpack(document, result);
+      break;
+    case BodyFormat::Cbor:
+      json::to_cbor(document, result);
+      break;
+    case BodyFormat::Json:
+      result = document.dump();
+      break;
+  }
+  return result;
+}
+
+TResult<string> BodyCodec::fromJson(string_view text, BodyFormat format) {
+  if (format == BodyFormat::Json) {
+    return string(text);
+  }
+  json document = json::parse(text.begin(), text.end(), nullptr, false);
+  if (document.is_discarded()) {
+    return Error(ErrorCode::InvalidFormat, "Failed to parse body");
+  }
+  return encode(document, format);
+}
+
+TResult<string> BodyCodec::toJson(string_view body, BodyFormat format) {
+  if (format == BodyFormat::Json || body.empty()) {
+    return string(body);
+  }
+
+  assert(format == BodyFormat::MessagePack || format == BodyFormat::Cbor);
+  auto inputFormat = (format == BodyFormat::MessagePack)
+                         ? json::input_format_t::msgpack
+                         : json::input_format_t::cbor;
+  json document;
+  DepthLimitedSax sax(document);
+  nlohmann::detail::input_adapter input(body.begin(), body.end());
+  if (!json::sax_parse(move(input), &sax, inputFormat)) {
+    return Error(ErrorCode::InvalidFormat, "Failed to parse body");
+  }
+
+  // the binary formats do not validate the encoding of their strings
+  try {
+    return document.dump();
+  } catch (json::type_error const &) {
+    return Error(ErrorCode::InvalidFormat, "Body contains invalid UTF-8");
+  }
+}
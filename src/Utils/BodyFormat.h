@@ -0,0 +1,74 @@
+/*****************************************************************************/
+/**
+ * @file    BodyFormat.h
+ * @author  Team Server
+ * @brief   Definition of the binary body encoding helpers
+ */
+/*****************************************************************************/
+
+#ifndef _BODY_FORMAT_H_
+#define _BODY_FORMAT_H_
+
+#include <string>
+#include <string_view>
+
+#include "Types/Result.h"
+#include "json/json.hpp"
+
+/**
+ * @brief Formats a request or response body can be encoded with.
+ * @details The binary formats carry the same document as the JSON body, only
+ * encoded more compactly.
+ */
+enum class BodyFormat { Json, MessagePack, Cbor };
+
+/**
+ * @class BodyCodec
+ * @brief Negotiates the body format and converts bodies between JSON and the
+ * binary formats.
+ */
+class BodyCodec {
+ public:
+  /**
+   * @brief Selects the format preferred by the client.
+   * @param accept The value of the `Accept` request header.
+   * @return A binary format if the client lists it explicitly with a quality
+   * value not lower than the one of JSON, `Json` otherwise.
+   */
+  static BodyFormat negotiate(std::string_view accept);
+
+  /**
+   * @brief Returns the format of a request body.
+   * @param contentType The value of the `Content-Type` request header. Unknown
+   * types are treated as JSON.
+   */
+  static BodyFormat parseContentType(std::string_view contentType);
+
+  /**
+   * @brief Returns the media type of the format, as used in HTTP headers.
+   */
+  static std::string_view mediaType(BodyFormat format);
+
+  /**
+   * @brief Encodes a JSON document in the given format.
+   */
+  static std::string encode(nlohmann::json const &document, BodyFormat format);
+
+  /**
+   * @brief Converts a JSON text into the given format.
+   * @return The encoded body or an error if `text` is no valid JSON.
+   */
+  static TResult<std::string> fromJson(std::string_view text,
+                                       BodyFormat format);
+
+  /**
+   * @brief Converts a body of the given format into a JSON text.
+   * @details An empty body stays empty, as requests without body are valid in
+   * any format.
+   * @return The JSON text or an error if the body is malformed, nested deeper
+   * than 64 levels or contains strings which are no valid UTF-8.
+   */
+  static TResult<std::string> toJson(std::string_view body, BodyFormat format);
+};
+
+#endif /* _BODY_FORMAT_H_ */
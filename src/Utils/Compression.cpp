@@ -0,0 +1,304 @@
+/*****************************************************************************/
+/**
+ * @file    Compression.cpp
+ * @author  Team Server
+ * @brief   Implementation of the response compression helpers
+ */
+/*****************************************************************************/
+
+#include "Utils/Compression.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <limits>
+#include <new>
+#include <stdexcept>
+
+#ifdef HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+#include "Utils/ConfigHandler.h"
+#include "Utils/HttpHeader.h"
+
+using namespace std;
+using namespace HttpHeader;
+
+static string const CONFIG_SECTION = "RestAPI";
+static int const DEFAULT_LEVEL = 6;
+// smaller bodies hardly shrink, but still cost a compressor setup
+static int const DEFAULT_MIN_SIZE = 1024;
+
+// read by Compression::configure()
+static atomic<int> sLevel{DEFAULT_LEVEL};
+static atomic<size_t> sMinSize{DEFAULT_MIN_SIZE};
+
+// window of raw deflate streams, negative to omit the zlib header
+static int const DEFLATE_WINDOW_BITS = -15;
+static size_t const DEFLATE_WINDOW_SIZE = 32768;
+
+// header of a gzip file without file name, time stamp and flags (OS: unix)
+static char const GZIP_HEADER[] = {
+    '\x1f', '\x8b', '\x08', '\x00', '\x00', '\x00', '\x00', '\x00', '\x00',
+    '\x03'};
+
+// a final, empty deflate block with fixed Huffman codes
+static char const DEFLATE_FINAL_BLOCK[] = {'\x03', '\x00'};
+
+ContentEncoding Compression::negotiate(string_view acceptEncoding,
+                                       bool allowBrotli) {
+#ifndef HAVE_BROTLI
+  allowBrotli = false;
+#endif
+  return select(acceptEncoding, true, allowBrotli);
+}
+
+ContentEncoding Compression::select(string_view acceptEncoding,
+                                    bool gzipAvailable,
+                                    bool brotliAvailable) {
+  // -1: not listed
+  int gzipQuality = -1;
+  int brotliQuality = -1;
+  int wildcardQuality = -1;
+  while (!acceptEncoding.empty()) {
+    auto entry = nextElement(acceptEncoding);
+    auto paramsBegin = entry.find(';');
+    auto coding = trim(entry.substr(0, paramsBegin));
+    int quality = (paramsBegin == string_view::npos)
+                      ? 1000
+                      : parseQuality(entry.substr(paramsBegin + 1));
+    if (equalsIgnoreCase(coding, "gzip") ||
+        equalsIgnoreCase(coding, "x-gzip")) {
+      gzipQuality = quality;
+    } else if (equalsIgnoreCase(coding, "br")) {
+      brotliQuality = quality;
+    } else if (coding == "*") {
+      wildcardQuality = quality;
+    }
+  }
+
+  if (gzipQuality < 0) {
+    gzipQuality = max(wildcardQuality, 0);
+  }
+  if (brotliQuality < 0) {
+    brotliQuality = max(wildcardQuality, 0);
+  }
+  if (!gzipAvailable) {
+    gzipQuality = 0;
+  }
+  if (!brotliAvailable) {
+    brotliQuality = 0;
+  }
+
+  if (brotliQuality > 0 && brotliQuality >= gzipQuality) {
+    return ContentEncoding::Brotli;
+  }
+  if (gzipQuality > 0) {
+    return ContentEncoding::Gzip;
+  }
+  return ContentEncoding::Identity;
+}
+
+string_view Compression::name(ContentEncoding encoding) {
+  switch (encoding) {
+    case ContentEncoding::Gzip:
+      return "gzip";
+    case ContentEncoding::Brotli:
+      return "br";
+    case ContentEncoding::Identity:
+      break;
+  }
+  return "identity";
+}
+
+string Compression::compress(string_view data,
+                             ContentEncoding encoding,
+                             int level) {
+  level = clamp(level, 1, 9);
+
+  if (encoding == ContentEncoding::Gzip) {
+    return GzipBuilder()
+        .append(GzipSegmentCompressor(level).compress(data))
+        .finish();
+  }
+
+#ifdef HAVE_BROTLI
+  if (encoding == ContentEncoding::Brotli) {
+    // brotli qualities range from 0 to 11, map the zlib levels onto them
+    int quality = level + 1;
+    size_t size = BrotliEncoderMaxCompressedSize(data.size());
+    string result(size, '\0');
+    if (BrotliEncoderCompress(quality,
+                              BROTLI_DEFAULT_WINDOW,
+                              BROTLI_MODE_TEXT,
+                              data.size(),
+                              reinterpret_cast<uint8_t const *>(data.data()),
+                              &size,
+                              reinterpret_cast<uint8_t *>(result.data())) ==
+        BROTLI_FALSE) {
+      throw runtime_error("BrotliEncoderCompress failed");
+    }
+    result.resize(size);
+    return result;
+  }
+#endif
+
+  assert(encoding == ContentEncoding::Identity);
+  return string(data);
+}
+
+TResultOpt Compression::configure() {
+  auto configHandler = ConfigHandler::getInstance();
+  auto level = configHandler->getValueInt(
+      CONFIG_SECTION, "compressionLevel", DEFAULT_LEVEL);
+  if (holds_alternative<Error>(level)) {
+    return get<Error>(level);
+  }
+  if (get<int>(level) < 0 || get<int>(level) > 9) {
+    return Error(ErrorCode::InvalidValue,
+                 "Compression.configure: compressionLevel must be between 0 "
+                 "and 9");
+  }
+
+  auto minSize = configHandler->getValueInt(
+      CONFIG_SECTION, "compressionMinSize", DEFAULT_MIN_SIZE);
+  if (holds_alternative<Error>(minSize)) {
+    return get<Error>(minSize);
+  }
+  if (get<int>(minSize) < 0) {
+    return Error(ErrorCode::InvalidValue,
+                 "Compression.configure: compressionMinSize must not be "
+                 "negative");
+  }
+
+  sLevel = get<int>(level);
+  sMinSize = get<int>(minSize);
+  return nullopt;
+}
+
+int Compression::configuredLevel() {
+  return sLevel.load(memory_order_relaxed);
+}
+
+size_t Compression::configuredMinSize() {
+  return sMinSize.load(memory_order_relaxed);
+}
+
+//
+// GzipSegmentCompressor
+//
+
+/**
+ * @brief Throws if a zlib function did not succeed.
+ */
+static void checkZlib(int ret, z_stream const *stream, char const *function) {
+  if (ret == Z_OK) {
+    return;
+  }
+  if (ret == Z_MEM_ERROR) {
+    throw bad_alloc();
+  }
+  string msg = string(function) + " failed with " + to_string(ret);
+  if (stream->msg != nullptr) {
+    msg += ": " + string(stream->msg);
+  }
+  throw runtime_error(msg);
+}
+
+GzipSegmentCompressor::GzipSegmentCompressor(int level)
+    : mStream(make_unique<z_stream>()) {
+  int ret = deflateInit2(mStream.get(),
+                         clamp(level, 1, 9),
+                         Z_DEFLATED,
+                         DEFLATE_WINDOW_BITS,
+                         8,
+                         Z_DEFAULT_STRATEGY);
+  checkZlib(ret, mStream.get(), "deflateInit2");
+}
+
+GzipSegmentCompressor::~GzipSegmentCompressor() {
+  deflateEnd(mStream.get());
+}
+
+GzipSegment GzipSegmentCompressor::compress(string_view data,
+                                            string_view dictionary) {
+  // zlib counts the input in 32 bits
+  if (data.size() > numeric_limits<uInt>::max()) {
+    throw length_error("GzipSegmentCompressor: data too large");
+  }
+
+  GzipSegment segment;
+  segment.size = data.size();
+  segment.crc = crc32(0L,
+                      reinterpret_cast<Bytef const *>(data.data()),
+                      static_cast<uInt>(data.size()));
+
+  z_stream *stream = mStream.get();
+  checkZlib(deflateReset(stream), stream, "deflateReset");
+
+  if (dictionary.size() > DEFLATE_WINDOW_SIZE) {
+    dictionary = dictionary.substr(dictionary.size() - DEFLATE_WINDOW_SIZE);
+  }
+  if (!dictionary.empty()) {
+    checkZlib(deflateSetDictionary(
+                  stream,
+                  reinterpret_cast<Bytef const *>(dictionary.data()),
+                  static_cast<uInt>(dictionary.size())),
+              stream,
+              "deflateSetDictionary");
+  }
+
+  // a sync flush ends the segment on a byte boundary without a final block
+  stream->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+  stream->avail_in = static_cast<uInt>(data.size());
+  size_t written = 0;
+  segment.deflated.resize(deflateBound(stream, data.size()) + 16);
+  do {
+    if (written == segment.deflated.size()) {
+      segment.deflated.resize(2 * segment.deflated.size());
+    }
+    stream->next_out =
+        reinterpret_cast<Bytef *>(segment.deflated.data() + written);
+    stream->avail_out = static_cast<uInt>(segment.deflated.size() - written);
+    int ret = deflate(stream, Z_SYNC_FLUSH);
+    // no progress is possible if the output was flushed exactly before
+    if (ret != Z_BUF_ERROR) {
+      checkZlib(ret, stream, "deflate");
+    }
+    written = segment.deflated.size() - stream->avail_out;
+  } while (stream->avail_out == 0);
+  segment.deflated.resize(written);
+
+  return segment;
+}
+
+//
+// GzipBuilder
+//
+
+GzipBuilder::GzipBuilder()
+    : mOutput(GZIP_HEADER, sizeof(GZIP_HEADER)), mCrc(0), mSize(0) {
+}
+
+GzipBuilder &GzipBuilder::append(GzipSegment const &segment) {
+  mOutput += segment.deflated;
+  mCrc = crc32_combine(mCrc, segment.crc, static_cast<z_off_t>(segment.size));
+  mSize += segment.size;
+  return *this;
+}
+
+string GzipBuilder::finish() {
+  mOutput.append(DEFLATE_FINAL_BLOCK, sizeof(DEFLATE_FINAL_BLOCK));
+
+  // trailer: CRC-32 and size modulo 2^32, both little endian
+  uint32_t size = static_cast<uint32_t>(mSize);
+  for (uint32_t value : {mCrc, size}) {
+    for (int i = 0; i < 4; i++) {
+      mOutput += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+  }
+  return move(mOutput);
+}
@@ -0,0 +1,167 @@
+/*****************************************************************************/
+/**
+ * @file    Compression.h
+ * @author  Team Server
+ * @brief   Definition of the response compression helpers
+ */
+/*****************************************************************************/
+
+#ifndef _COMPRESSION_H_
+#define _COMPRESSION_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "Types/Result.h"
+
+struct z_stream_s;
+
+/**
+ * @brief Encodings a response body can be sent with.
+ */
+enum class ContentEncoding { Identity, Gzip, Brotli };
+
+/**
+ * @class Compression
+ * @brief Negotiates and applies the content encoding of response bodies.
+ * @details Brotli is only available if the server was built with it
+ * (`HAVE_BROTLI`), gzip is always available.
+ */
+class Compression {
+ public:
+  /**
+   * @brief Selects the encoding preferred by the client.
+   * @param acceptEncoding The value of the `Accept-Encoding` request header.
+   * @param allowBrotli If `false`, brotli is never selected.
+   * @return The encoding with the highest quality value, brotli wins over gzip
+   * on equal values. `Identity` if the client accepts neither.
+   */
+  static ContentEncoding negotiate(std::string_view acceptEncoding,
+                                   bool allowBrotli = true);
+
+  /**
+   * @brief Selects the encoding preferred by the client among the available
+   * ones, e.g. the precompressed variants of a file.
+   * @details Unlike `negotiate`, brotli is selected even if the server was
+   * built without it.
+   */
+  static ContentEncoding select(std::string_view acceptEncoding,
+                                bool gzipAvailable,
+                                bool brotliAvailable);
+
+  /**
+   * @brief Returns the name of the encoding as used in HTTP headers.
+   */
+  static std::string_view name(ContentEncoding encoding);
+
+  /**
+   * @brief Compresses the given data as a whole.
+   * @param level Compression level between 1 (fastest) and 9 (smallest).
+   * @throws std::runtime_error If the compressor fails.
+   */
+  static std::string compress(std::string_view data,
+                              ContentEncoding encoding,
+                              int level);
+
+  /**
+   * @brief Reads the compression level and the minimum size of compressed
+   * responses from the configuration.
+   * @details Called when the server starts, changes of the configuration
+   * take effect with the next call. Until the first call, the defaults of
+   * the keys apply.
+   * @return An error if a value is not a number or out of range.
+   */
+  static TResultOpt configure();
+
+  /**
+   * @brief Returns the configured compression level of responses.
+   * @details Key `compressionLevel` of section `RestAPI`, 0 disables the
+   * compression.
+   */
+  static int configuredLevel();
+
+  /**
+   * @brief Returns the configured minimum size of compressed responses.
+   * @details Key `compressionMinSize` of section `RestAPI`. Applies to
+   * responses which are compressed per request only.
+   */
+  static size_t configuredMinSize();
+};
+
+/**
+ * @brief Independently compressed part of a gzip file.
+ * @details Consists of non-final deflate blocks which end on a byte boundary,
+ * so segments can be concatenated in any order.
+ */
+struct GzipSegment {
+  std::string deflated;
+  uint32_t crc = 0;  ///< CRC-32 of the uncompressed data
+  size_t size = 0;   ///< size of the uncompressed data
+};
+
+/**
+ * @class GzipSegmentCompressor
+ * @brief Compresses data into `GzipSegment`s.
+ * @details The deflate state is reused between calls, which avoids allocating
+ * it for every (small) segment.
+ */
+class GzipSegmentCompressor {
+ public:
+  /**
+   * @param level Compression level between 1 (fastest) and 9 (smallest).
+   * @throws std::runtime_error If zlib cannot be initialized.
+   */
+  explicit GzipSegmentCompressor(int level);
+  ~GzipSegmentCompressor();
+
+  GzipSegmentCompressor(GzipSegmentCompressor const &) = delete;
+  GzipSegmentCompressor &operator=(GzipSegmentCompressor const &) = delete;
+
+  /**
+   * @brief Compresses `data` into a segment.
+   * @param dictionary Data which directly precedes the segment in every file
+   * it is appended to. The segment may refer to it, which improves the
+   * compression of small segments.
+   * @throws std::runtime_error If zlib fails, `std::length_error` if `data`
+   * exceeds 4 GiB.
+   */
+  GzipSegment compress(std::string_view data,
+                       std::string_view dictionary = {});
+
+ private:
+  std::unique_ptr<z_stream_s> mStream;
+};
+
+/**
+ * @class GzipBuilder
+ * @brief Assembles a gzip file from independently compressed segments.
+ * @details Allows to compress the parts of a body which are shared between
+ * responses only once.
+ *
+ * @code
+ * GzipSegmentCompressor compressor(6);
+ * auto hello = compressor.compress("Hello ");
+ * auto world = compressor.compress("World");
+ * std::string body = GzipBuilder().append(hello).append(world).finish();
+ * @endcode
+ */
+class GzipBuilder {
+ public:
+  GzipBuilder();
+
+  GzipBuilder &append(GzipSegment const &segment);
+
+  /**
+   * @brief Terminates the deflate stream and returns the gzip file.
+   */
+  std::string finish();
+
+ private:
+  std::string mOutput;
+  uint32_t mCrc;
+  size_t mSize;
+};
+
+#endif /* _COMPRESSION_H_ */
@@ -27,6 +27,8 @@ shared_ptr<ConfigHandler> const ConfigHandler::getInstance() {
 TResultOpt ConfigHandler::setConfigFilePath(string const& filepath) {
   mConfigFilePath = filepath;
 
+  // drop the values of a previously loaded file and their overrides
+  mIni.Reset();
   mIni.SetUnicode(false);    // use OS native encoding
   mIni.SetMultiKey(false);   // don't support duplicated keys
   mIni.SetMultiLine(false);  // don't support multiline values for a key
@@ -98,6 +100,59 @@ TResult<int> ConfigHandler::getValueInt(string const& section,
   return valInt;
 }
 
+/** @brief Returns value of a key as a string, or the given default value if
+ * the key does not exist.
+ */
+TResult<string> ConfigHandler::getValueString(string const& section,
+                                              string const& key,
+                                              string const& defaultValue) {
+  auto valObj = getValueString(section, key);
+  if (auto error = get_if<Error>(&valObj)) {
+    if (error->getErrorCode() == ErrorCode::KeyNotFound)
+      return defaultValue;
+  }
+  return valObj;
+}
+
+/** @brief Returns value of a key as integer, or the given default value if the
+ * key does not exist.
+ * @details A key which exists but has an invalid format is still reported as
+ * an error.
+ */
+TResult<int> ConfigHandler::getValueInt(string const& section,
+                                        string const& key,
+                                        int defaultValue) {
+  auto valObj = getValueInt(section, key);
+  if (auto error = get_if<Error>(&valObj)) {
+    if (error->getErrorCode() == ErrorCode::KeyNotFound)
+      return defaultValue;
+  }
+  return valObj;
+}
+
+/** @brief Overrides the value of a key, which is created if it does not exist
+ */
+void ConfigHandler::setValue(string const& section,
+                             string const& key,
+                             string const& value) {
+  mIni.SetValue(section.c_str(), key.c_str(), value.c_str());
+}
+
+/** @brief Returns the keys of a section, including overridden ones, or an
+ * empty list if the section does not exist.
+ */
+vector<string> ConfigHandler::getKeys(string const& section) {
+  CSimpleIniA::TNamesDepend names;
+  mIni.GetAllKeys(section.c_str(), names);
+  names.sort(CSimpleIniA::Entry::LoadOrder());
+
+  vector<string> keys;
+  for (auto const& name : names) {
+    keys.emplace_back(name.pItem);
+  }
+  return keys;
+}
+
 bool ConfigHandler::isInitialized() {
   return mIsInitialized;
 }
@@ -13,6 +13,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "../lib/SimpleIni/SimpleIni.h"
 #include "Types/Result.h"
@@ -30,6 +31,25 @@ class ConfigHandler {
   TResult<std::string> getValueString(std::string const& section,
                                       std::string const& key);
   TResult<int> getValueInt(std::string const& section, std::string const& key);
+
+  /* Variants for optional keys, which return the given default value if the
+   * key is not found in the configuration file. */
+  TResult<std::string> getValueString(std::string const& section,
+                                      std::string const& key,
+                                      std::string const& defaultValue);
+  TResult<int> getValueInt(std::string const& section,
+                           std::string const& key,
+                           int defaultValue);
+
+  /* Overrides the value of a key until the configuration file is loaded
+   * again, e.g. to run the tests with several configurations. */
+  void setValue(std::string const& section,
+                std::string const& key,
+                std::string const& value);
+
+  /* Returns the keys of a section, e.g. to read sections with a key per
+   * endpoint. */
+  std::vector<std::string> getKeys(std::string const& section);
   bool isInitialized();
 
  private:
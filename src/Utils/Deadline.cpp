@@ -0,0 +1,110 @@
+/*****************************************************************************/
+/**
+ * @file    Deadline.cpp
+ * @author  Team Server
+ * @brief   Implementation of class Deadline
+ */
+/*****************************************************************************/
+
+#include "Deadline.h"
+
+#include <algorithm>
+#include <charconv>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "ConfigHandler.h"
+
+using namespace std;
+using namespace std::chrono;
+
+static string const CONFIG_SECTION = "RequestTimeouts";
+static int const DEFAULT_TIMEOUT_MS = 10000;
+// timeouts of clients only shorten the configured ones, this avoids overflows
+static long long const MAX_TIMEOUT_MS = 24 * 60 * 60 * 1000;
+
+static thread_local optional<Deadline::Clock::time_point> tDeadline;
+
+/**
+ * @brief Timeouts read by Deadline::configure(), in milliseconds.
+ */
+struct Timeouts {
+  int defaultMs = DEFAULT_TIMEOUT_MS;
+  map<string, int, less<>> endpointMs;
+};
+
+// replaced as a whole, requests keep the timeouts they have looked up
+static shared_ptr<Timeouts const> sTimeouts = make_shared<Timeouts const>();
+
+Deadline::Scope::Scope(optional<milliseconds> timeout) : mOuter(tDeadline) {
+  if (timeout.has_value()) {
+    auto deadline = Clock::now() + timeout.value();
+    tDeadline = mOuter.has_value() ? min(mOuter.value(), deadline) : deadline;
+  }
+}
+
+Deadline::Scope::~Scope() {
+  tDeadline = mOuter;
+}
+
+optional<milliseconds> Deadline::remaining() {
+  if (!tDeadline.has_value()) {
+    return nullopt;
+  }
+  auto left = duration_cast<milliseconds>(tDeadline.value() - Clock::now());
+  return max(left, milliseconds(0));
+}
+
+bool Deadline::isExpired() {
+  return tDeadline.has_value() && Clock::now() >= tDeadline.value();
+}
+
+TResultOpt Deadline::check() {
+  if (isExpired()) {
+    return Error(ErrorCode::DeadlineExceeded,
+                 "The request could not be handled in time");
+  }
+  return nullopt;
+}
+
+TResultOpt Deadline::configure() {
+  auto configHandler = ConfigHandler::getInstance();
+  auto timeouts = make_shared<Timeouts>();
+  for (auto const &key : configHandler->getKeys(CONFIG_SECTION)) {
+    auto value = configHandler->getValueInt(CONFIG_SECTION, key);
+    if (holds_alternative<Error>(value)) {
+      return get<Error>(value);
+    }
+    if (key == "default") {
+      timeouts->defaultMs = get<int>(value);
+    } else {
+      timeouts->endpointMs[key] = get<int>(value);
+    }
+  }
+  atomic_store(&sTimeouts, shared_ptr<Timeouts const>(move(timeouts)));
+  return nullopt;
+}
+
+optional<milliseconds> Deadline::configuredTimeout(string_view endpoint) {
+  auto timeouts = atomic_load(&sTimeouts);
+  int timeout = timeouts->defaultMs;
+  auto it = timeouts->endpointMs.find(endpoint);
+  if (it != timeouts->endpointMs.end()) {
+    timeout = it->second;
+  }
+  if (timeout <= 0) {
+    return nullopt;
+  }
+  return milliseconds(timeout);
+}
+
+optional<milliseconds> Deadline::parseTimeout(string_view value) {
+  long long timeout = 0;
+  auto end = value.data() + value.size();
+  auto [ptr, ec] = from_chars(value.data(), end, timeout);
+  if (ec != errc() || ptr != end || timeout <= 0) {
+    return nullopt;
+  }
+  return milliseconds(min(timeout, MAX_TIMEOUT_MS));
+}
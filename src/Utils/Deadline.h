@@ -0,0 +1,93 @@
+/*****************************************************************************/
+/**
+ * @file    Deadline.h
+ * @author  Team Server
+ * @brief   Definition of class Deadline
+ */
+/*****************************************************************************/
+
+#ifndef _DEADLINE_H_
+#define _DEADLINE_H_
+
+#include <chrono>
+#include <optional>
+#include <string_view>
+
+#include "Types/Result.h"
+
+/**
+ * @class Deadline
+ * @brief Deadline of the request handled by the current thread.
+ * @details The REST API sets the deadline of each request for the time it is
+ * dispatched, so the JukeBox, the music backend and the Spotify API can stop
+ * working on requests the client has given up on already. Threads without a
+ * deadline (e.g. the scheduler) are never limited.
+ *
+ * Timeouts are configured per endpoint in section `RequestTimeouts`, in
+ * milliseconds (key `default` for endpoints without a key of their own, 0 =
+ * none). They are read by configure() when the server starts. Clients may
+ * shorten them with the header `X-Request-Timeout-Ms`.
+ */
+class Deadline {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+   * @class Deadline::Scope
+   * @brief Sets the deadline of the current thread until it is destroyed.
+   * @details Scopes may be nested, the deadline of an inner scope never
+   * exceeds the one of the outer scope.
+   */
+  class Scope {
+   public:
+    /**
+     * @param timeout Time from now on, or `nullopt` to keep the deadline of
+     * the outer scope.
+     */
+    explicit Scope(std::optional<std::chrono::milliseconds> timeout);
+    ~Scope();
+    Scope(Scope const &) = delete;
+    Scope &operator=(Scope const &) = delete;
+
+   private:
+    std::optional<Clock::time_point> mOuter;
+  };
+
+  /**
+   * @brief Returns the time left until the deadline (at least 0), or
+   * `nullopt` if there is none.
+   */
+  static std::optional<std::chrono::milliseconds> remaining();
+
+  static bool isExpired();
+
+  /**
+   * @brief Returns an error of code `DeadlineExceeded` if the deadline has
+   * passed.
+   */
+  static TResultOpt check();
+
+  /**
+   * @brief Reads the timeouts of section `RequestTimeouts`.
+   * @details Changes of the configuration take effect with the next call.
+   * Until the first call, all endpoints have the default timeout of 10s.
+   * @return An error if a timeout is not a number.
+   */
+  static TResultOpt configure();
+
+  /**
+   * @brief Returns the configured timeout of an endpoint (e.g. `queryTracks`),
+   * or `nullopt` if its requests have no deadline.
+   */
+  static std::optional<std::chrono::milliseconds> configuredTimeout(
+      std::string_view endpoint);
+
+  /**
+   * @brief Parses the value of a `X-Request-Timeout-Ms` header.
+   * @return The timeout, or `nullopt` if the value is not a positive number.
+   */
+  static std::optional<std::chrono::milliseconds> parseTimeout(
+      std::string_view value);
+};
+
+#endif /* _DEADLINE_H_ */
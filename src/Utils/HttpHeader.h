@@ -0,0 +1,106 @@
+/*****************************************************************************/
+/**
+ * @file    HttpHeader.h
+ * @author  Team Server
+ * @brief   Helpers for parsing the values of HTTP headers
+ */
+/*****************************************************************************/
+
+#ifndef _HTTP_HEADER_H_
+#define _HTTP_HEADER_H_
+
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+namespace HttpHeader {
+
+/**
+ * @brief Removes leading and trailing whitespace.
+ */
+inline std::string_view trim(std::string_view str) {
+  auto begin = str.find_first_not_of(" \t");
+  if (begin == std::string_view::npos) {
+    return {};
+  }
+  auto end = str.find_last_not_of(" \t");
+  return str.substr(begin, end - begin + 1);
+}
+
+inline bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+  return a.size() == b.size() &&
+         std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+           return std::tolower(static_cast<unsigned char>(x)) ==
+                  std::tolower(static_cast<unsigned char>(y));
+         });
+}
+
+/**
+ * @brief Splits off the first element of a comma separated header value.
+ * @return The element (trimmed), `list` is advanced behind it.
+ */
+inline std::string_view nextElement(std::string_view &list) {
+  auto end = list.find(',');
+  auto element = list.substr(0, end);
+  list = (end == std::string_view::npos) ? "" : list.substr(end + 1);
+  return trim(element);
+}
+
+/**
+ * @brief Parses the quality value of an element of an `Accept*` header.
+ * @param params The parameters of the element, i.e. everything after the
+ * first `;`.
+ * @return The quality in thousandths. Only the parameter `q` is considered,
+ * invalid values count as 0 and a missing one as 1000.
+ */
+inline int parseQuality(std::string_view params) {
+  int quality = 1000;
+  while (!params.empty()) {
+    auto end = params.find(';');
+    auto param = trim(params.substr(0, end));
+    params = (end == std::string_view::npos) ? "" : params.substr(end + 1);
+
+    if (param.size() < 2 || (param[0] != 'q' && param[0] != 'Q') ||
+        param[1] != '=') {
+      continue;
+    }
+    auto value = param.substr(2);
+    quality = 0;
+    if (!value.empty() && value[0] == '1') {
+      quality = 1000;
+    } else if (value.size() > 1 && value[0] == '0' && value[1] == '.') {
+      int factor = 100;
+      for (char c : value.substr(2, 3)) {
+        if (c < '0' || c > '9') {
+          break;
+        }
+        quality += (c - '0') * factor;
+        factor /= 10;
+      }
+    }
+  }
+  return quality;
+}
+
+/**
+ * @brief Checks if the value of an `If-None-Match` header matches the given
+ * entity tag.
+ * @details The header may contain a comma separated list of (weak) tags or
+ * `*`. Weak comparison is sufficient for `If-None-Match`.
+ */
+inline bool matchesETag(std::string_view ifNoneMatch, std::string_view etag) {
+  while (!ifNoneMatch.empty()) {
+    auto tag = nextElement(ifNoneMatch);
+    if (tag.substr(0, 2) == "W/") {
+      tag.remove_prefix(2);
+    }
+    if (tag == "*" || tag == etag) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace HttpHeader
+
+#endif /* _HTTP_HEADER_H_ */
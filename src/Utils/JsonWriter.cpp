@@ -0,0 +1,157 @@
+/*****************************************************************************/
+/**
+ * @file    JsonWriter.cpp
+ * @author  Team Server
+ * @brief   Implementation of class JsonWriter
+ */
+/*****************************************************************************/
+
+#include "Utils/JsonWriter.h"
+
+#include <cassert>
+
+using namespace std;
+
+JsonWriter::JsonWriter(string buffer) : mOut(move(buffer)) {
+  mOut.clear();
+}
+
+JsonWriter &JsonWriter::beginObject() {
+  separate();
+  mOut += '{';
+  mHasMembers.push_back(false);
+  return *this;
+}
+
+JsonWriter &JsonWriter::endObject() {
+  assert(!mHasMembers.empty() && !mAfterKey);
+  mHasMembers.pop_back();
+  mOut += '}';
+  return *this;
+}
+
+JsonWriter &JsonWriter::beginArray() {
+  separate();
+  mOut += '[';
+  mHasMembers.push_back(false);
+  return *this;
+}
+
+JsonWriter &JsonWriter::endArray() {
+  assert(!mHasMembers.empty() && !mAfterKey);
+  mHasMembers.pop_back();
+  mOut += ']';
+  return *this;
+}
+
+JsonWriter &JsonWriter::key(string_view name) {
+  separate();
+  appendString(name);
+  mOut += ':';
+  mAfterKey = true;
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(string_view str) {
+  separate();
+  appendString(str);
+  return *this;
+}
+
+JsonWriter &JsonWriter::value(char const *str) {
+  return value(string_view(str));
+}
+
+JsonWriter &JsonWriter::value(bool b) {
+  separate();
+  mOut += (b ? "true" : "false");
+  return *this;
+}
+
+JsonWriter &JsonWriter::rawValue(string_view json) {
+  separate();
+  mOut += json;
+  return *this;
+}
+
+string const &JsonWriter::str() const {
+  return mOut;
+}
+
+string JsonWriter::release() {
+  string result = move(mOut);
+  mOut = string();
+  mHasMembers.clear();
+  mAfterKey = false;
+  return result;
+}
+
+void JsonWriter::clear() {
+  mOut.clear();
+  mHasMembers.clear();
+  mAfterKey = false;
+}
+
+void JsonWriter::separate() {
+  // values directly follow their key
+  if (mAfterKey) {
+    mAfterKey = false;
+    return;
+  }
+  if (!mHasMembers.empty()) {
+    if (mHasMembers.back()) {
+      mOut += ',';
+    } else {
+      mHasMembers.back() = true;
+    }
+  }
+}
+
+void JsonWriter::appendString(string_view str) {
+  static char const HEX_DIGITS[] = "0123456789abcdef";
+
+  mOut += '"';
+
+  // copy unescaped runs at once, escape the same way as nlohmann::json
+  size_t runStart = 0;
+  for (size_t i = 0; i < str.size(); i++) {
+    unsigned char c = static_cast<unsigned char>(str[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') {
+      continue;
+    }
+
+    mOut.append(str.data() + runStart, i - runStart);
+    runStart = i + 1;
+    switch (c) {
+      case '"':
+        mOut += "\\\"";
+        break;
+      case '\\':
+        mOut += "\\\\";
+        break;
+      case '\b':
+        mOut += "\\b";
+        break;
+      case '\f':
+        mOut += "\\f";
+        break;
+      case '\n':
+        mOut += "\\n";
+        break;
+      case '\r':
+        mOut += "\\r";
+        break;
+      case '\t':
+        mOut += "\\t";
+        break;
+      default:
+        mOut += "\\u00";
+        mOut += HEX_DIGITS[c >> 4];
+        mOut += HEX_DIGITS[c & 0xf];
+        break;
+    }
+  }
+  mOut.append(str.data() + runStart, str.size() - runStart);
+
+  mOut += '"';
+}
@@ -0,0 +1,93 @@
+/*****************************************************************************/
+/**
+ * @file    JsonWriter.h
+ * @author  Team Server
+ * @brief   Definition of class JsonWriter
+ */
+/*****************************************************************************/
+
+#ifndef _JSON_WRITER_H_
+#define _JSON_WRITER_H_
+
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @class JsonWriter
+ * @brief Writes compact JSON directly into a string buffer.
+ * @details In contrast to `nlohmann::json` no intermediate tree is built.
+ * Commas are inserted automatically, the caller is responsible for a proper
+ * nesting of objects and arrays. Keys are written in the given order, so
+ * writing them sorted results in the same output as `nlohmann::json::dump`.
+ *
+ * The buffer can be reused for several documents to avoid allocations, and
+ * moved out of the writer once the document is complete.
+ */
+class JsonWriter {
+ public:
+  JsonWriter() = default;
+
+  /**
+   * @brief Creates a writer reusing the memory of the given buffer.
+   * @details The content of the buffer is discarded.
+   */
+  explicit JsonWriter(std::string buffer);
+
+  JsonWriter &beginObject();
+  JsonWriter &endObject();
+  JsonWriter &beginArray();
+  JsonWriter &endArray();
+
+  /**
+   * @brief Writes the key of the next object member.
+   */
+  JsonWriter &key(std::string_view name);
+
+  JsonWriter &value(std::string_view str);
+  JsonWriter &value(char const *str);
+  JsonWriter &value(bool b);
+
+  template <class T,
+            std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>,
+                             int> = 0>
+  JsonWriter &value(T number) {
+    separate();
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    mOut.append(digits, result.ptr);
+    return *this;
+  }
+
+  /**
+   * @brief Writes an already serialized JSON value as it is.
+   */
+  JsonWriter &rawValue(std::string_view json);
+
+  /**
+   * @brief Returns the document written so far.
+   */
+  std::string const &str() const;
+
+  /**
+   * @brief Moves the document out of the writer and resets the writer.
+   */
+  std::string release();
+
+  /**
+   * @brief Discards the document, but keeps the allocated memory.
+   */
+  void clear();
+
+ private:
+  void separate();
+  void appendString(std::string_view str);
+
+  std::string mOut;
+  std::vector<bool> mHasMembers;  ///< one entry per open object/array
+  bool mAfterKey = false;
+};
+
+#endif /* _JSON_WRITER_H_ */
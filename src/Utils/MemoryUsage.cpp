@@ -0,0 +1,126 @@
+/*****************************************************************************/
+/**
+ * @file    MemoryUsage.cpp
+ * @author  Team Server
+ * @brief   Implementation of class MemoryUsage
+ */
+/*****************************************************************************/
+
+#include "MemoryUsage.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#include "JsonWriter.h"
+#include "Metrics.h"
+
+using namespace std;
+
+namespace {
+
+struct Registry {
+  mutex mtx;
+  vector<pair<string, MemoryUsage::TReporter const *>> reporters;
+};
+
+Registry &registry() {
+  static Registry instance;
+  return instance;
+}
+
+}  // namespace
+
+MemoryUsage::Registration::Registration(string name, TReporter reporter)
+    : mName(move(name)), mReporter(move(reporter)) {
+  auto &reg = registry();
+  lock_guard<mutex> lock(reg.mtx);
+  reg.reporters.emplace_back(mName, &mReporter);
+}
+
+MemoryUsage::Registration::~Registration() {
+  auto &reg = registry();
+  lock_guard<mutex> lock(reg.mtx);
+  auto &reporters = reg.reporters;
+  reporters.erase(remove_if(reporters.begin(),
+                            reporters.end(),
+                            [this](auto const &entry) {
+                              return entry.second == &mReporter;
+                            }),
+                  reporters.end());
+}
+
+size_t MemoryUsage::heapBytes(string const &str) {
+  // short strings are stored inside the object
+  if (str.capacity() < sizeof(string)) {
+    return 0;
+  }
+  return str.capacity() + 1;
+}
+
+size_t MemoryUsage::heapBytes(vector<string> const &strings) {
+  size_t bytes = strings.capacity() * sizeof(string);
+  for (auto const &str : strings) {
+    bytes += heapBytes(str);
+  }
+  return bytes;
+}
+
+vector<pair<string, size_t>> MemoryUsage::subsystems() {
+  map<string, size_t> usage;
+  auto &reg = registry();
+  // the reporters lock their subsystems, which never query the usage
+  // themselves, so holding the registry lock does not deadlock
+  lock_guard<mutex> lock(reg.mtx);
+  for (auto const &[name, reporter] : reg.reporters) {
+    usage[name] += (*reporter)();
+  }
+  return {usage.begin(), usage.end()};
+}
+
+size_t MemoryUsage::residentBytes() {
+  ifstream statm("/proc/self/statm");
+  size_t pages = 0;
+  size_t residentPages = 0;
+  if (!(statm >> pages >> residentPages)) {
+    return 0;
+  }
+  return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+string MemoryUsage::report() {
+  size_t total = 0;
+  JsonWriter writer;
+  writer.beginObject();
+  writer.key("process_resident_bytes").value(residentBytes());
+  writer.key("subsystems").beginArray();
+  for (auto const &[name, bytes] : subsystems()) {
+    total += bytes;
+    writer.beginObject();
+    writer.key("bytes").value(bytes);
+    writer.key("name").value(name);
+    writer.endObject();
+  }
+  writer.endArray();
+  writer.key("total_bytes").value(total);
+  writer.endObject();
+  return writer.release();
+}
+
+void MemoryUsage::updateMetrics() {
+  static auto &subsystemBytes =
+      Metrics::gauge("jukebox_memory_bytes",
+                     "Approximate memory usage of the subsystems in bytes",
+                     {"subsystem"});
+  static auto &residentGauge =
+      Metrics::gauge("jukebox_process_resident_bytes",
+                     "Resident memory of the process in bytes");
+
+  for (auto const &[name, bytes] : subsystems()) {
+    subsystemBytes.labels({name}).set(static_cast<int64_t>(bytes));
+  }
+  residentGauge.get().set(static_cast<int64_t>(residentBytes()));
+}
@@ -0,0 +1,91 @@
+/*****************************************************************************/
+/**
+ * @file    MemoryUsage.h
+ * @author  Team Server
+ * @brief   Definition of class MemoryUsage
+ */
+/*****************************************************************************/
+
+#ifndef _MEMORY_USAGE_H_
+#define _MEMORY_USAGE_H_
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class MemoryUsage
+ * @brief Approximate memory usage of the subsystems of the server.
+ * @details Subsystems (the data store, the caches, ...) register a function
+ * which estimates their current usage in bytes: the capacity of their
+ * containers plus the heap memory of their strings. The functions are called
+ * when the usage is queried only, at `/debug/memory` and `/metrics`, so the
+ * accounting costs nothing while handling requests.
+ *
+ * Allocator overhead and memory freed but kept by the allocator are not
+ * included, the sum of all subsystems is therefore lower than the resident
+ * memory of the process.
+ */
+class MemoryUsage {
+ public:
+  typedef std::function<size_t()> TReporter;
+
+  /**
+   * @class MemoryUsage::Registration
+   * @brief Reports the usage of a subsystem for as long as it exists.
+   * @details Several registrations may use the same name, their usages are
+   * summed up, e.g. for several instances of the same class.
+   */
+  class Registration {
+   public:
+    /**
+     * @param name Name of the subsystem, e.g. `datastore.users`.
+     * @param reporter Returns the current usage in bytes, it may be called by
+     * any thread.
+     */
+    Registration(std::string name, TReporter reporter);
+    ~Registration();
+    Registration(Registration const &) = delete;
+    Registration &operator=(Registration const &) = delete;
+
+   private:
+    std::string mName;
+    TReporter mReporter;
+  };
+
+  /**
+   * @brief Returns the heap memory of a string, which is 0 for short strings
+   * stored inline.
+   */
+  static size_t heapBytes(std::string const &str);
+
+  /**
+   * @brief Returns the heap memory of a vector of strings, including the
+   * strings themselves.
+   */
+  static size_t heapBytes(std::vector<std::string> const &strings);
+
+  /**
+   * @brief Returns the usage of each subsystem in bytes, sorted by name.
+   */
+  static std::vector<std::pair<std::string, size_t>> subsystems();
+
+  /**
+   * @brief Returns the resident memory of the process in bytes, or 0 if it
+   * is unknown.
+   */
+  static size_t residentBytes();
+
+  /**
+   * @brief Returns the usage as JSON, see `/debug/memory`.
+   */
+  static std::string report();
+
+  /**
+   * @brief Sets the gauges of the memory usage in the metrics.
+   */
+  static void updateMetrics();
+};
+
+#endif /* _MEMORY_USAGE_H_ */
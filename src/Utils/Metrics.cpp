@@ -0,0 +1,255 @@
+/*****************************************************************************/
+/**
+ * @file    Metrics.cpp
+ * @author  Team Server
+ * @brief   Implementation of the metrics registry
+ */
+/*****************************************************************************/
+
+#include "Metrics.h"
+
+#include <cassert>
+#include <cstdio>
+
+using namespace std;
+
+// buckets exported in the Prometheus format: 2^3 µs (8 µs) to 2^25 µs (34 s)
+static unsigned const FIRST_EXPORTED_EXPONENT = 3;
+static unsigned const LAST_EXPORTED_EXPONENT = 25;
+
+static void appendNumber(string &out, double value) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.9g", value);
+  out += buffer;
+}
+
+/**
+ * @brief Appends a series name with the given labels and an additional one.
+ */
+static void appendSeries(string &out,
+                         string_view name,
+                         string const &labels,
+                         string_view extraLabel = "") {
+  out += name;
+  if (!labels.empty() || !extraLabel.empty()) {
+    out += '{';
+    out += labels;
+    if (!labels.empty() && !extraLabel.empty()) {
+      out += ',';
+    }
+    out += extraLabel;
+    out += '}';
+  }
+  out += ' ';
+}
+
+//
+// Counter / Histogram
+//
+
+uint64_t Counter::value() const {
+  uint64_t sum = 0;
+  for (auto const &shard : mShards) {
+    sum += shard.value.load(memory_order_relaxed);
+  }
+  return sum;
+}
+
+uint64_t Histogram::count() const {
+  uint64_t sum = 0;
+  for (auto const &bucket : mBuckets) {
+    sum += bucket.load(memory_order_relaxed);
+  }
+  return sum;
+}
+
+uint64_t Histogram::quantile(double q) const {
+  array<uint64_t, BUCKETS> counts;
+  uint64_t total = 0;
+  for (size_t i = 0; i < BUCKETS; i++) {
+    counts[i] = mBuckets[i].load(memory_order_relaxed);
+    total += counts[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  // rank of the value, starting at 1
+  auto rank = static_cast<uint64_t>(q * total + 0.5);
+  rank = min(max(rank, uint64_t(1)), total);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BUCKETS; i++) {
+    seen += counts[i];
+    if (seen >= rank) {
+      return bucketLimit(i) - 1;
+    }
+  }
+  return bucketLimit(BUCKETS - 1) - 1;
+}
+
+uint64_t Histogram::countBelowPowerOfTwo(unsigned exponent) const {
+  uint64_t limit = uint64_t(1) << exponent;
+  uint64_t sum = 0;
+  for (size_t i = 0; i < BUCKETS && bucketLimit(i) <= limit; i++) {
+    sum += mBuckets[i].load(memory_order_relaxed);
+  }
+  return sum;
+}
+
+//
+// Prometheus text format
+//
+
+void writeMetric(string &out,
+                 string_view name,
+                 string const &labels,
+                 Counter const &metric) {
+  appendSeries(out, name, labels);
+  out += to_string(metric.value());
+  out += '\n';
+}
+
+void writeMetric(string &out,
+                 string_view name,
+                 string const &labels,
+                 Gauge const &metric) {
+  appendSeries(out, name, labels);
+  out += to_string(metric.value());
+  out += '\n';
+}
+
+void writeMetric(string &out,
+                 string_view name,
+                 string const &labels,
+                 Histogram const &metric) {
+  string bucketName = string(name) + "_bucket";
+  for (unsigned exponent = FIRST_EXPORTED_EXPONENT;
+       exponent <= LAST_EXPORTED_EXPONENT;
+       exponent++) {
+    string le = "le=\"";
+    appendNumber(le, static_cast<double>(uint64_t(1) << exponent) / 1e6);
+    le += '"';
+    appendSeries(out, bucketName, labels, le);
+    out += to_string(metric.countBelowPowerOfTwo(exponent));
+    out += '\n';
+  }
+  // the total is read once, so `+Inf` and `_count` agree
+  uint64_t count = metric.count();
+  appendSeries(out, bucketName, labels, "le=\"+Inf\"");
+  out += to_string(count);
+  out += '\n';
+  appendSeries(out, string(name) + "_sum", labels);
+  appendNumber(out, static_cast<double>(metric.sum()) / 1e6);
+  out += '\n';
+  appendSeries(out, string(name) + "_count", labels);
+  out += to_string(count);
+  out += '\n';
+}
+
+//
+// MetricFamilyBase
+//
+
+uint64_t MetricFamilyBase::hashValues(
+    initializer_list<string_view> values) {
+  // FNV-1a, values are terminated by a zero byte
+  uint64_t hash = 14695981039346656037ull;
+  for (auto value : values) {
+    for (char c : value) {
+      hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+string MetricFamilyBase::labelsText(vector<string> const &values) const {
+  string text;
+  for (size_t i = 0; i < values.size() && i < mLabelNames.size(); i++) {
+    if (i > 0) {
+      text += ',';
+    }
+    text += mLabelNames[i];
+    text += "=\"";
+    for (char c : values[i]) {
+      if (c == '\\' || c == '"') {
+        text += '\\';
+        text += c;
+      } else if (c == '\n') {
+        text += "\\n";
+      } else {
+        text += c;
+      }
+    }
+    text += '"';
+  }
+  return text;
+}
+
+void MetricFamilyBase::writeHeader(string &out, string_view type) const {
+  out += "# HELP ";
+  out += mName;
+  out += ' ';
+  out += mHelp;
+  out += "\n# TYPE ";
+  out += mName;
+  out += ' ';
+  out += type;
+  out += '\n';
+}
+
+//
+// Metrics
+//
+
+static mutex sRegistryMutex;
+
+static vector<unique_ptr<MetricFamilyBase>> &families() {
+  static vector<unique_ptr<MetricFamilyBase>> registered;
+  return registered;
+}
+
+template <class T>
+static MetricFamily<T> &registerFamily(string const &name,
+                                       string const &help,
+                                       vector<string> const &labelNames) {
+  lock_guard<mutex> lock(sRegistryMutex);
+  for (auto const &family : families()) {
+    if (family->name() == name) {
+      auto typed = dynamic_cast<MetricFamily<T> *>(family.get());
+      assert(typed && "metric registered with another type");
+      if (typed) {
+        return *typed;
+      }
+    }
+  }
+  families().push_back(make_unique<MetricFamily<T>>(name, help, labelNames));
+  return static_cast<MetricFamily<T> &>(*families().back());
+}
+
+MetricFamily<Counter> &Metrics::counter(string const &name,
+                                        string const &help,
+                                        vector<string> const &labelNames) {
+  return registerFamily<Counter>(name, help, labelNames);
+}
+
+MetricFamily<Gauge> &Metrics::gauge(string const &name,
+                                    string const &help,
+                                    vector<string> const &labelNames) {
+  return registerFamily<Gauge>(name, help, labelNames);
+}
+
+MetricFamily<Histogram> &Metrics::histogram(string const &name,
+                                            string const &help,
+                                            vector<string> const &labelNames) {
+  return registerFamily<Histogram>(name, help, labelNames);
+}
+
+string Metrics::serialize() {
+  string out;
+  lock_guard<mutex> lock(sRegistryMutex);
+  for (auto const &family : families()) {
+    family->serialize(out);
+  }
+  return out;
+}
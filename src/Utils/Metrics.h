@@ -0,0 +1,365 @@
+/*****************************************************************************/
+/**
+ * @file    Metrics.h
+ * @author  Team Server
+ * @brief   Definition of the metrics registry
+ */
+/*****************************************************************************/
+
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static constexpr size_t METRIC_SHARDS = 8;
+
+/**
+ * @brief Returns the shard of the calling thread, threads are assigned to the
+ * shards round robin.
+ */
+inline size_t metricShard() {
+  static std::atomic<size_t> nextShard{0};
+  thread_local size_t shard =
+      nextShard.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARDS;
+  return shard;
+}
+
+/**
+ * @class Counter
+ * @brief Monotonic counter, sharded by thread to avoid contention.
+ */
+class Counter {
+ public:
+  void inc(uint64_t value = 1) {
+    mShards[metricShard()].value.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  uint64_t value() const;
+
+ private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> value{0};
+  };
+  std::array<Shard, METRIC_SHARDS> mShards;
+};
+
+/**
+ * @class Gauge
+ * @brief Value which may go up and down, e.g. the size of a container.
+ */
+class Gauge {
+ public:
+  void set(int64_t value) {
+    mValue.store(value, std::memory_order_relaxed);
+  }
+
+  void add(int64_t value) {
+    mValue.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  int64_t value() const {
+    return mValue.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<int64_t> mValue{0};
+};
+
+/**
+ * @class Histogram
+ * @brief Distribution of durations in microseconds.
+ * @details Buckets are log-linear like the ones of a HDR histogram: each power
+ * of two is split into 4 buckets, so any quantile is accurate to 25%. Values
+ * of 2^40 µs and more fall into the last bucket.
+ *
+ * The Prometheus format exports the buckets at the powers of two only.
+ */
+class Histogram {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  static constexpr unsigned SUB_BUCKET_BITS = 2;
+  static constexpr unsigned SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+  static constexpr unsigned MAX_EXPONENT = 40;
+  static constexpr size_t BUCKETS =
+      (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  void observe(uint64_t micros) {
+    mBuckets[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    mSum.fetch_add(micros, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Observes the time passed since `start`.
+   */
+  void observeSince(Clock::time_point start) {
+    observe(std::chrono::duration_cast<std::chrono::microseconds>(
+                Clock::now() - start)
+                .count());
+  }
+
+  uint64_t count() const;
+  uint64_t sum() const {
+    return mSum.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Returns the upper bound of the bucket holding the quantile `q`
+   * (0..1) in microseconds, or 0 if nothing was observed.
+   */
+  uint64_t quantile(double q) const;
+
+  /**
+   * @brief Returns the number of values below `2^exponent` µs.
+   */
+  uint64_t countBelowPowerOfTwo(unsigned exponent) const;
+
+  static constexpr size_t bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+      return value;
+    }
+    unsigned exponent = 63 - __builtin_clzll(value);
+    if (exponent >= MAX_EXPONENT) {
+      return BUCKETS - 1;
+    }
+    unsigned sub = (value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+  }
+
+  /**
+   * @brief Returns the smallest value of the next bucket.
+   */
+  static constexpr uint64_t bucketLimit(size_t index) {
+    if (index < SUB_BUCKETS) {
+      return index + 1;
+    }
+    unsigned exponent = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t sub = index % SUB_BUCKETS;
+    return (SUB_BUCKETS + sub + 1) << (exponent - SUB_BUCKET_BITS);
+  }
+
+ private:
+  std::array<std::atomic<uint64_t>, BUCKETS> mBuckets{};
+  std::atomic<uint64_t> mSum{0};
+};
+
+/*
+ * Writing a single series in the Prometheus text format, for each type of
+ * metric.
+ */
+void writeMetric(std::string &out,
+                 std::string_view name,
+                 std::string const &labels,
+                 Counter const &metric);
+void writeMetric(std::string &out,
+                 std::string_view name,
+                 std::string const &labels,
+                 Gauge const &metric);
+void writeMetric(std::string &out,
+                 std::string_view name,
+                 std::string const &labels,
+                 Histogram const &metric);
+
+inline char const *metricType(Counter const *) {
+  return "counter";
+}
+inline char const *metricType(Gauge const *) {
+  return "gauge";
+}
+inline char const *metricType(Histogram const *) {
+  return "histogram";
+}
+
+/**
+ * @class MetricFamilyBase
+ * @brief Name, help text and label names of a metric family.
+ */
+class MetricFamilyBase {
+ public:
+  MetricFamilyBase(std::string name,
+                   std::string help,
+                   std::vector<std::string> labelNames)
+      : mName(std::move(name)),
+        mHelp(std::move(help)),
+        mLabelNames(std::move(labelNames)) {
+  }
+  virtual ~MetricFamilyBase() = default;
+
+  std::string const &name() const {
+    return mName;
+  }
+
+  /**
+   * @brief Appends all series in the Prometheus text format.
+   */
+  virtual void serialize(std::string &out) const = 0;
+
+ protected:
+  static uint64_t hashValues(std::initializer_list<std::string_view> values);
+  std::string labelsText(std::vector<std::string> const &values) const;
+  void writeHeader(std::string &out, std::string_view type) const;
+
+  std::string const mName;
+  std::string const mHelp;
+  std::vector<std::string> const mLabelNames;
+};
+
+/**
+ * @class MetricFamily
+ * @brief Metrics of the same name, one per combination of label values.
+ * @details Looking up the metric of existing label values neither locks nor
+ * allocates: the series are kept in an insert-only hash table, whose slots
+ * are published atomically. Label values beyond the capacity of the table
+ * share a single series labelled `overflow`.
+ */
+template <class T>
+class MetricFamily : public MetricFamilyBase {
+ public:
+  using MetricFamilyBase::MetricFamilyBase;
+
+  /**
+   * @brief Returns the metric of the given label values (in the order of the
+   * label names), which is created on first use.
+   */
+  T &labels(std::initializer_list<std::string_view> values) {
+    uint64_t hash = hashValues(values);
+    for (size_t i = 0; i < CAPACITY; i++) {
+      Series *series =
+          mSlots[(hash + i) % CAPACITY].load(std::memory_order_acquire);
+      if (series == nullptr) {
+        return insert(values, hash);
+      }
+      if (series->hash == hash && matches(*series, values)) {
+        return series->metric;
+      }
+    }
+    std::lock_guard<std::mutex> lock(mInsertMutex);
+    return overflow();
+  }
+
+  /**
+   * @brief Returns the metric of a family without labels.
+   */
+  T &get() {
+    return labels({});
+  }
+
+  void serialize(std::string &out) const override {
+    writeHeader(out, metricType(static_cast<T const *>(nullptr)));
+    std::lock_guard<std::mutex> lock(mInsertMutex);
+    for (auto const &series : mSeries) {
+      writeMetric(out, mName, labelsText(series->values), series->metric);
+    }
+  }
+
+ private:
+  static constexpr size_t CAPACITY = 512;
+
+  struct Series {
+    uint64_t hash = 0;
+    std::vector<std::string> values;
+    T metric;
+  };
+
+  static bool matches(Series const &series,
+                      std::initializer_list<std::string_view> values) {
+    if (series.values.size() != values.size()) {
+      return false;
+    }
+    auto it = series.values.begin();
+    for (auto value : values) {
+      if (*it++ != value) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @brief Looks up the label values again with the insert lock held, and
+   * inserts them if they are still missing.
+   */
+  T &insert(std::initializer_list<std::string_view> values, uint64_t hash) {
+    std::lock_guard<std::mutex> lock(mInsertMutex);
+    for (size_t i = 0; i < CAPACITY; i++) {
+      auto &slot = mSlots[(hash + i) % CAPACITY];
+      Series *series = slot.load(std::memory_order_relaxed);
+      if (series == nullptr) {
+        auto created = std::make_unique<Series>();
+        created->hash = hash;
+        created->values.assign(values.begin(), values.end());
+        slot.store(created.get(), std::memory_order_release);
+        mSeries.push_back(std::move(created));
+        return mSeries.back()->metric;
+      }
+      if (series->hash == hash && matches(*series, values)) {
+        return series->metric;
+      }
+    }
+    return overflow();
+  }
+
+  /**
+   * @brief Returns the series shared by all label values beyond the capacity
+   * (with the insert lock held).
+   */
+  T &overflow() {
+    if (!mOverflow) {
+      auto series = std::make_unique<Series>();
+      series->values.assign(mLabelNames.size(), "overflow");
+      mOverflow = series.get();
+      mSeries.push_back(std::move(series));
+    }
+    return mOverflow->metric;
+  }
+
+  std::array<std::atomic<Series *>, CAPACITY> mSlots{};
+  mutable std::mutex mInsertMutex;
+  std::vector<std::unique_ptr<Series>> mSeries;  ///< in order of creation
+  Series *mOverflow = nullptr;
+};
+
+/**
+ * @class Metrics
+ * @brief Registry of all metric families of the server.
+ * @details Families are registered once, usually into a static reference at
+ * the place they are recorded:
+ *
+ *     static auto &requests = Metrics::counter(
+ *         "jukebox_http_requests_total", "Handled requests", {"endpoint"});
+ *     requests.labels({endpoint}).inc();
+ *
+ * Registering a name again returns the family registered first. All metrics
+ * are exposed at `/metrics` in the Prometheus text format.
+ */
+class Metrics {
+ public:
+  static MetricFamily<Counter> &counter(
+      std::string const &name,
+      std::string const &help,
+      std::vector<std::string> const &labelNames = {});
+  static MetricFamily<Gauge> &gauge(
+      std::string const &name,
+      std::string const &help,
+      std::vector<std::string> const &labelNames = {});
+  static MetricFamily<Histogram> &histogram(
+      std::string const &name,
+      std::string const &help,
+      std::vector<std::string> const &labelNames = {});
+
+  /**
+   * @brief Returns all metrics in the Prometheus text format.
+   */
+  static std::string serialize();
+};
+
+#endif /* _METRICS_H_ */
@@ -0,0 +1,139 @@
+/*****************************************************************************/
+/**
+ * @file    ProfiledMutex.cpp
+ * @author  Team Server
+ * @brief   Implementation of class LockProfiler
+ */
+/*****************************************************************************/
+
+#include "ProfiledMutex.h"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "JsonWriter.h"
+#include "Metrics.h"
+
+using namespace std;
+using namespace std::chrono;
+
+static mutex sRegistryMutex;
+
+// a deque keeps the references to its elements valid when growing
+static deque<LockStats> &registeredStats() {
+  static deque<LockStats> stats;
+  return stats;
+}
+
+static void updateMax(atomic<uint64_t> &max, uint64_t value) {
+  uint64_t current = max.load(memory_order_relaxed);
+  while (current < value &&
+         !max.compare_exchange_weak(current, value, memory_order_relaxed)) {
+  }
+}
+
+static uint64_t elapsedNs(LockProfiler::Clock::time_point start) {
+  return duration_cast<nanoseconds>(LockProfiler::Clock::now() - start)
+      .count();
+}
+
+LockStats &LockProfiler::stats(string const &name) {
+  lock_guard<mutex> lock(sRegistryMutex);
+  auto &stats = registeredStats();
+  auto it = find_if(stats.begin(), stats.end(), [&name](auto const &entry) {
+    return entry.name == name;
+  });
+  if (it != stats.end()) {
+    return *it;
+  }
+  stats.emplace_back();
+  stats.back().name = name;
+  return stats.back();
+}
+
+void LockProfiler::recordWait(LockStats &stats, Clock::time_point start) {
+  auto waited = elapsedNs(start);
+  stats.contentions.fetch_add(1, memory_order_relaxed);
+  stats.waitNs.fetch_add(waited, memory_order_relaxed);
+  updateMax(stats.maxWaitNs, waited);
+}
+
+void LockProfiler::recordHold(LockStats &stats, Clock::time_point start) {
+  auto held = elapsedNs(start);
+  stats.holdSamples.fetch_add(1, memory_order_relaxed);
+  stats.holdNs.fetch_add(held, memory_order_relaxed);
+  updateMax(stats.maxHoldNs, held);
+}
+
+string LockProfiler::report() {
+  auto toUs = [](uint64_t ns) { return ns / 1000; };
+
+  JsonWriter writer;
+  writer.beginObject().key("locks").beginArray();
+  lock_guard<mutex> lock(sRegistryMutex);
+
+  // the locks waited for the longest come first
+  vector<LockStats const *> sorted;
+  for (auto const &stats : registeredStats()) {
+    sorted.push_back(&stats);
+  }
+  stable_sort(sorted.begin(), sorted.end(), [](auto a, auto b) {
+    return a->waitNs.load(memory_order_relaxed) >
+           b->waitNs.load(memory_order_relaxed);
+  });
+
+  for (auto const *entry : sorted) {
+    auto const &stats = *entry;
+    auto acquisitions = stats.acquisitions.load(memory_order_relaxed);
+    auto contentions = stats.contentions.load(memory_order_relaxed);
+    auto waitNs = stats.waitNs.load(memory_order_relaxed);
+    auto holdSamples = stats.holdSamples.load(memory_order_relaxed);
+    auto holdNs = stats.holdNs.load(memory_order_relaxed);
+
+    writer.beginObject();
+    writer.key("acquisitions").value(acquisitions);
+    writer.key("contentions").value(contentions);
+    writer.key("hold_mean_us")
+        .value(holdSamples > 0 ? toUs(holdNs / holdSamples) : 0);
+    writer.key("hold_max_us")
+        .value(toUs(stats.maxHoldNs.load(memory_order_relaxed)));
+    writer.key("name").value(stats.name);
+    writer.key("wait_max_us")
+        .value(toUs(stats.maxWaitNs.load(memory_order_relaxed)));
+    writer.key("wait_mean_us")
+        .value(contentions > 0 ? toUs(waitNs / contentions) : 0);
+    writer.key("wait_total_us").value(toUs(waitNs));
+    writer.endObject();
+  }
+  writer.endArray().endObject();
+  return writer.release();
+}
+
+void LockProfiler::updateMetrics() {
+  static auto &acquisitions =
+      Metrics::gauge("jukebox_lock_acquisitions",
+                     "Acquisitions of the locks so far",
+                     {"lock"});
+  static auto &contentions =
+      Metrics::gauge("jukebox_lock_contentions",
+                     "Acquisitions of the locks which had to wait so far",
+                     {"lock"});
+  static auto &waits = Metrics::gauge(
+      "jukebox_lock_wait_microseconds",
+      "Time waited for locks held by other threads so far in microseconds",
+      {"lock"});
+
+  lock_guard<mutex> lock(sRegistryMutex);
+  for (auto const &stats : registeredStats()) {
+    auto waitNs = stats.waitNs.load(memory_order_relaxed);
+    acquisitions.labels({stats.name})
+        .set(static_cast<int64_t>(
+            stats.acquisitions.load(memory_order_relaxed)));
+    contentions.labels({stats.name})
+        .set(static_cast<int64_t>(
+            stats.contentions.load(memory_order_relaxed)));
+    waits.labels({stats.name}).set(static_cast<int64_t>(waitNs / 1000));
+  }
+}
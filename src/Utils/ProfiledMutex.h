@@ -0,0 +1,157 @@
+/*****************************************************************************/
+/**
+ * @file    ProfiledMutex.h
+ * @author  Team Server
+ * @brief   Definition of class ProfiledMutex
+ */
+/*****************************************************************************/
+
+#ifndef _PROFILED_MUTEX_H_
+#define _PROFILED_MUTEX_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+/**
+ * @brief Contention statistics of all mutexes of the same name.
+ */
+struct LockStats {
+  std::string name;
+  std::atomic<uint64_t> acquisitions{0};  ///< exclusive and shared
+  std::atomic<uint64_t> contentions{0};   ///< acquisitions which had to wait
+  std::atomic<uint64_t> waitNs{0};
+  std::atomic<uint64_t> maxWaitNs{0};
+  std::atomic<uint64_t> holdSamples{0};  ///< sampled exclusive acquisitions
+  std::atomic<uint64_t> holdNs{0};
+  std::atomic<uint64_t> maxHoldNs{0};
+};
+
+/**
+ * @class LockProfiler
+ * @brief Registry of the statistics of all profiled mutexes.
+ */
+class LockProfiler {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  // the hold time is measured for every n-th exclusive acquisition only
+  static constexpr uint64_t HOLD_SAMPLE_INTERVAL = 16;
+
+  /**
+   * @brief Returns the statistics of the given name, which are created on
+   * first use and shared by all mutexes of that name.
+   */
+  static LockStats &stats(std::string const &name);
+
+  /**
+   * @brief Returns the statistics of all mutexes as JSON, see
+   * `/debug/locks`.
+   */
+  static std::string report();
+
+  /**
+   * @brief Sets the gauges of the lock statistics in the metrics.
+   */
+  static void updateMetrics();
+
+  static void recordWait(LockStats &stats, Clock::time_point start);
+  static void recordHold(LockStats &stats, Clock::time_point start);
+};
+
+/**
+ * @class ProfiledMutex
+ * @brief Drop-in replacement of a standard mutex which records how long its
+ * users wait for it and hold it.
+ * @details Acquisitions without contention cost a `try_lock` and a counter
+ * increment only, the clock is read when the mutex has to be waited for and
+ * for every `HOLD_SAMPLE_INTERVAL`-th exclusive acquisition. Hold times are
+ * measured for exclusive acquisitions only (the outermost one of a recursive
+ * mutex).
+ *
+ * The shared functions are available if `Mutex` provides them.
+ */
+template <class Mutex>
+class ProfiledMutex {
+ public:
+  /**
+   * @param name Name of the lock site in the statistics, e.g.
+   * `RAMDataStore.users`.
+   */
+  explicit ProfiledMutex(std::string const &name)
+      : mStats(LockProfiler::stats(name)) {
+  }
+  ProfiledMutex(ProfiledMutex const &) = delete;
+  ProfiledMutex &operator=(ProfiledMutex const &) = delete;
+
+  void lock() {
+    if (!mMutex.try_lock()) {
+      auto start = LockProfiler::Clock::now();
+      mMutex.lock();
+      LockProfiler::recordWait(mStats, start);
+    }
+    acquired();
+  }
+
+  bool try_lock() {
+    if (!mMutex.try_lock()) {
+      return false;
+    }
+    acquired();
+    return true;
+  }
+
+  void unlock() {
+    std::optional<LockProfiler::Clock::time_point> holdStart;
+    if (--mDepth == 0) {
+      holdStart = mHoldStart;
+      mHoldStart.reset();
+    }
+    mMutex.unlock();
+    if (holdStart.has_value()) {
+      LockProfiler::recordHold(mStats, holdStart.value());
+    }
+  }
+
+  void lock_shared() {
+    if (!mMutex.try_lock_shared()) {
+      auto start = LockProfiler::Clock::now();
+      mMutex.lock_shared();
+      LockProfiler::recordWait(mStats, start);
+    }
+    mStats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  bool try_lock_shared() {
+    if (!mMutex.try_lock_shared()) {
+      return false;
+    }
+    mStats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  void unlock_shared() {
+    mMutex.unlock_shared();
+  }
+
+ private:
+  /**
+   * @brief Bookkeeping of an exclusive acquisition, with the mutex held.
+   */
+  void acquired() {
+    auto count = mStats.acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (mDepth++ == 0 && count % LockProfiler::HOLD_SAMPLE_INTERVAL == 0) {
+      mHoldStart = LockProfiler::Clock::now();
+    }
+  }
+
+  Mutex mMutex;
+  LockStats &mStats;
+  // only accessed by the thread holding the mutex exclusively
+  unsigned mDepth = 0;
+  std::optional<LockProfiler::Clock::time_point> mHoldStart;
+};
+
+#endif /* _PROFILED_MUTEX_H_ */
@@ -0,0 +1,258 @@
+/*****************************************************************************/
+/**
+ * @file    Profiler.cpp
+ * @author  Team Server
+ * @brief   Implementation of class Profiler
+ */
+/*****************************************************************************/
+
+#include "Profiler.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <new>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Deadline.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+
+enum class Mode { Off, Cpu, Heap };
+
+struct Sample {
+  uint64_t weight;
+  int depth;
+  array<void *, Profiler::MAX_FRAMES> frames;
+};
+
+}  // namespace
+
+// The samples are written by signal handlers and allocating threads, hence
+// without locks: a writer claims a slot with `sNextSample`, and `sWriters`
+// tells the profiling thread when all writers have left after it has set the
+// mode back to `Off`.
+static atomic<Mode> sMode{Mode::Off};
+static atomic<unsigned> sWriters{0};
+static atomic<size_t> sNextSample{0};
+static Sample *sSamples = nullptr;  ///< set before the mode
+static atomic<bool> sBusy{false};   ///< a profile is being recorded
+
+static thread_local int64_t tUntilHeapSample = Profiler::HEAP_SAMPLE_BYTES;
+
+/**
+ * @brief Records the stack of the current thread if `mode` is recorded.
+ * @details Always inlined, so the number of frames to skip (the signal
+ * handler or `operator new`) does not depend on the optimization.
+ * @param skip Innermost frames which belong to the profiler.
+ */
+__attribute__((always_inline)) static inline void recordSample(
+    Mode mode, uint64_t weight, int skip) {
+  sWriters.fetch_add(1);
+  if (sMode.load() == mode) {
+    size_t index = sNextSample.fetch_add(1);
+    if (index < Profiler::MAX_SAMPLES) {
+      void *frames[Profiler::MAX_FRAMES + 4];
+      int depth = backtrace(frames, Profiler::MAX_FRAMES + skip);
+      auto &sample = sSamples[index];
+      sample.weight = weight;
+      sample.depth = max(depth - skip, 0);
+      copy(frames + skip, frames + skip + sample.depth, sample.frames.begin());
+    }
+  }
+  sWriters.fetch_sub(1);
+}
+
+static void onProfilingSignal(int) {
+  int savedErrno = errno;
+  // skips the handler and the signal trampoline
+  recordSample(Mode::Cpu, 1, 2);
+  errno = savedErrno;
+}
+
+/**
+ * @brief Replaces the global `operator new` to sample allocations, all other
+ * variants of `new` call it.
+ */
+void *operator new(size_t size) {
+  if (sMode.load(memory_order_relaxed) == Mode::Heap) {
+    tUntilHeapSample -= static_cast<int64_t>(size);
+    if (tUntilHeapSample < 0) {
+      uint64_t allocated = Profiler::HEAP_SAMPLE_BYTES - tUntilHeapSample;
+      tUntilHeapSample = Profiler::HEAP_SAMPLE_BYTES;
+      // skips this operator
+      recordSample(Mode::Heap, allocated, 1);
+    }
+  }
+
+  if (size == 0) {
+    size = 1;
+  }
+  while (true) {
+    void *memory = malloc(size);
+    if (memory) {
+      return memory;
+    }
+    auto handler = get_new_handler();
+    if (!handler) {
+      throw bad_alloc();
+    }
+    handler();
+  }
+}
+
+/**
+ * @brief Returns the name of the function containing a return address.
+ */
+static string frameName(void *address) {
+  // a return address points behind the call, which may be the start of the
+  // next function already
+  auto callSite = static_cast<char *>(address) - 1;
+  Dl_info info;
+  if (dladdr(callSite, &info) == 0) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%p", address);
+    return buffer;
+  }
+  if (info.dli_sname) {
+    int status = 0;
+    unique_ptr<char, decltype(&free)> demangled(
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), free);
+    string name = (status == 0) ? demangled.get() : info.dli_sname;
+    // `;` separates the frames of a folded stack
+    replace(name.begin(), name.end(), ';', ':');
+    return name;
+  }
+  string module = info.dli_fname ? info.dli_fname : "?";
+  module = module.substr(module.rfind('/') + 1);
+  char offset[32];
+  snprintf(offset,
+           sizeof(offset),
+           "+0x%zx",
+           static_cast<size_t>(callSite - static_cast<char *>(info.dli_fbase)));
+  return module + offset;
+}
+
+/**
+ * @brief Aggregates the samples by the names of the frames of their stacks.
+ */
+static string foldStacks(vector<Sample> const &samples, size_t count) {
+  unordered_map<void *, string> names;
+  map<string, uint64_t> stacks;
+  string stack;
+  for (size_t i = 0; i < count; i++) {
+    auto const &sample = samples[i];
+    stack.clear();
+    // outermost frame first
+    for (int frame = sample.depth - 1; frame >= 0; frame--) {
+      void *address = sample.frames[frame];
+      auto name = names.find(address);
+      if (name == names.end()) {
+        name = names.emplace(address, frameName(address)).first;
+      }
+      stack += name->second;
+      if (frame > 0) {
+        stack += ';';
+      }
+    }
+    stacks[stack] += sample.weight;
+  }
+
+  string folded;
+  for (auto const &[frames, weight] : stacks) {
+    folded += frames;
+    folded += ' ';
+    folded += to_string(weight);
+    folded += '\n';
+  }
+  return folded;
+}
+
+/**
+ * @brief Records samples of the given mode for the given duration.
+ */
+static TResult<Profiler::Profile> record(Mode mode, seconds duration) {
+  if (sBusy.exchange(true)) {
+    return Error(ErrorCode::ServiceUnavailable,
+                 "Another profile is being recorded");
+  }
+
+  // the first backtrace loads the unwinder, which allocates memory and must
+  // not happen in a signal handler
+  void *warmUp[1];
+  backtrace(warmUp, 1);
+
+  vector<Sample> samples(Profiler::MAX_SAMPLES);
+  sSamples = samples.data();
+  sNextSample = 0;
+
+  timeval interval{
+      0, static_cast<suseconds_t>(Profiler::CPU_SAMPLE_INTERVAL.count())};
+  itimerval timer{interval, interval};
+  itimerval stopped{};
+  if (mode == Mode::Cpu) {
+    // the handler stays installed, so signals still pending after the timer
+    // is stopped are ignored instead of terminating the process
+    static bool const installed = [] {
+      struct sigaction action {};
+      action.sa_handler = onProfilingSignal;
+      action.sa_flags = SA_RESTART;
+      sigemptyset(&action.sa_mask);
+      return sigaction(SIGPROF, &action, nullptr) == 0;
+    }();
+    if (!installed || setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+      sBusy = false;
+      return Error(ErrorCode::NotInitialized,
+                   "The profiling timer could not be started");
+    }
+  }
+  sMode = mode;
+
+  auto end = Deadline::Clock::now() + min(duration, Profiler::MAX_DURATION);
+  auto remaining = Deadline::remaining();
+  if (remaining.has_value()) {
+    end = min(end, Deadline::Clock::now() + remaining.value());
+  }
+  this_thread::sleep_until(end);
+
+  sMode = Mode::Off;
+  if (mode == Mode::Cpu) {
+    setitimer(ITIMER_PROF, &stopped, nullptr);
+  }
+  while (sWriters.load() != 0) {
+    this_thread::yield();
+  }
+  sSamples = nullptr;
+
+  size_t recorded = sNextSample.load();
+  Profiler::Profile profile;
+  profile.samples = min(recorded, Profiler::MAX_SAMPLES);
+  profile.dropped = recorded - profile.samples;
+  profile.folded = foldStacks(samples, profile.samples);
+  sBusy = false;
+  return profile;
+}
+
+TResult<Profiler::Profile> Profiler::profileCpu(seconds duration) {
+  return record(Mode::Cpu, duration);
+}
+
+TResult<Profiler::Profile> Profiler::profileHeap(seconds duration) {
+  return record(Mode::Heap, duration);
+}
@@ -0,0 +1,79 @@
+/*****************************************************************************/
+/**
+ * @file    Profiler.h
+ * @author  Team Server
+ * @brief   Definition of class Profiler
+ */
+/*****************************************************************************/
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "Types/Result.h"
+
+/**
+ * @class Profiler
+ * @brief Sampling profiler of the running server.
+ * @details The profiler records stack traces for a given duration and returns
+ * them as folded stacks, one line per distinct stack with the frames from the
+ * outermost to the innermost separated by `;`, followed by the weight of the
+ * stack. The result can be turned into a flame graph offline, e.g. with
+ * `flamegraph.pl`.
+ *
+ * Frames are named by the exported symbols of the process, the executable is
+ * linked with `-rdynamic` for this. Frames without a symbol are named by
+ * their module and offset, which can be resolved with `addr2line`.
+ *
+ * Only one profile is recorded at a time.
+ */
+class Profiler {
+ public:
+  // longest profile
+  static constexpr std::chrono::seconds MAX_DURATION{60};
+  // innermost frames of a stack which are kept
+  static constexpr size_t MAX_FRAMES = 64;
+  // samples of a profile, further samples are dropped
+  static constexpr size_t MAX_SAMPLES = 16384;
+  // interval of the CPU samples in CPU time of the process
+  static constexpr std::chrono::microseconds CPU_SAMPLE_INTERVAL{10000};
+  // mean number of allocated bytes between two heap samples of a thread
+  static constexpr size_t HEAP_SAMPLE_BYTES = 512 * 1024;
+
+  /**
+   * @brief A recorded profile.
+   */
+  struct Profile {
+    std::string folded;  ///< folded stacks
+    size_t samples = 0;  ///< recorded samples
+    size_t dropped = 0;  ///< samples dropped beyond `MAX_SAMPLES`
+  };
+
+  /**
+   * @brief Records where the process spends CPU time.
+   * @details A `SIGPROF` timer interrupts the thread running on the CPU every
+   * `CPU_SAMPLE_INTERVAL` of CPU time used by the process, and the stack of
+   * the interrupted thread is recorded. The weight of a stack is its number
+   * of samples. The calling thread blocks for the given duration, which is
+   * shortened to the deadline of the current request.
+   * @return The profile, or an `Error` if another profile is being recorded.
+   */
+  static TResult<Profile> profileCpu(std::chrono::seconds duration);
+
+  /**
+   * @brief Records where the process allocates memory.
+   * @details While the profile is recorded, each thread records the stack of
+   * the allocation crossing each `HEAP_SAMPLE_BYTES` bytes allocated by it
+   * with `new`. The weight of a stack is the number of bytes allocated by the
+   * thread since its previous sample, so the weights sum up to about the
+   * bytes allocated during the profile. Memory released again is not
+   * subtracted. Outside of a profile an allocation checks a flag only.
+   * @return The profile, or an `Error` if another profile is being recorded.
+   */
+  static TResult<Profile> profileHeap(std::chrono::seconds duration);
+};
+
+#endif /* _PROFILER_H_ */
@@ -13,31 +13,171 @@
 
 using json = nlohmann::json;
 
+/**
+ * @brief Sets a member of a serialized track, if it is selected.
+ */
+template <class V>
+static void setField(json &result,
+                     TrackFieldMask const &fields,
+                     TrackField field,
+                     V const &value) {
+  if (fields.has(field)) {
+    result[std::string(TrackFieldMask::name(field))] = value;
+  }
+}
+
+/**
+ * @brief Writes a member of a serialized track, if it is selected.
+ */
+template <class V>
+static void writeField(JsonWriter &writer,
+                       TrackFieldMask const &fields,
+                       TrackField field,
+                       V const &value) {
+  if (fields.has(field)) {
+    writer.key(TrackFieldMask::name(field)).value(value);
+  }
+}
+
+template <>
+json Serializer::serialize<BaseTrack>(BaseTrack const &track,
+                                      TrackFieldMask const &fields) {
+  json result = json::object();
+  setField(result, fields, TrackField::TrackId, track.trackId);
+  setField(result, fields, TrackField::Title, track.title);
+  setField(result, fields, TrackField::Album, track.album);
+  setField(result, fields, TrackField::Artist, track.artist);
+  setField(result, fields, TrackField::Duration, track.durationMs);
+  setField(result, fields, TrackField::IconUri, track.iconUri);
+  // TODO: move to QueuedTrack!
+  setField(result, fields, TrackField::AddedBy, track.addedBy);
+  return result;
+}
+
 template <>
-json Serializer::serialize<BaseTrack>(BaseTrack const &track) {
-  json result;
-  result["track_id"] = track.trackId;
-  result["title"] = track.title;
-  result["album"] = track.album;
-  result["artist"] = track.artist;
-  result["duration"] = track.durationMs;
-  result["icon_uri"] = track.iconUri;
-  result["added_by"] = track.addedBy;  // TODO: move to QueuedTrack!
+json Serializer::serialize<QueuedTrack>(QueuedTrack const &track,
+                                        TrackFieldMask const &fields) {
+  json result = Serializer::serialize<BaseTrack>(track, fields);
+  setField(result, fields, TrackField::Votes, track.votes);
+  setField(
+      result, fields, TrackField::CurrentVote, (track.userHasVoted ? 1 : 0));
   return result;
 }
 
 template <>
-json Serializer::serialize<QueuedTrack>(QueuedTrack const &track) {
-  json result = Serializer::serialize<BaseTrack>(track);
-  result["votes"] = track.votes;
-  result["current_vote"] = (track.userHasVoted ? 1 : 0);
+json Serializer::serialize<PlaybackTrack>(PlaybackTrack const &track,
+                                          TrackFieldMask const &fields) {
+  json result = Serializer::serialize<BaseTrack>(track, fields);
+  setField(result, fields, TrackField::Playing, track.isPlaying);
+  setField(result, fields, TrackField::PlayingFor, track.progressMs);
+  setField(result, fields, TrackField::StartedAt, track.startedAtMs);
   return result;
 }
 
 template <>
-json Serializer::serialize<PlaybackTrack>(PlaybackTrack const &track) {
-  json result = Serializer::serialize<BaseTrack>(track);
-  result["playing"] = track.isPlaying;
-  result["playing_for"] = track.progressMs;
+json Serializer::serialize<QueueStatus>(QueueStatus const &queueStatus,
+                                        TrackFieldMask const &fields) {
+  json playbackTrack = json::object();
+  json normalQueue = json::array();
+  json adminQueue = json::array();
+  if (queueStatus.currentTrack.has_value()) {
+    playbackTrack =
+        Serializer::serialize(queueStatus.currentTrack.value(), fields);
+  }
+  for (auto &&track : queueStatus.normalQueue.tracks) {
+    normalQueue.push_back(Serializer::serialize(track, fields));
+  }
+  for (auto &&track : queueStatus.adminQueue.tracks) {
+    adminQueue.push_back(Serializer::serialize(track, fields));
+  }
+
+  json result = {
+      {"currently_playing", playbackTrack},
+      {"normal_queue", normalQueue},
+      {"normal_queue_total", queueStatus.normalQueue.getTotalSize()},
+      {"admin_queue", adminQueue},
+      {"admin_queue_total", queueStatus.adminQueue.getTotalSize()}};
   return result;
 }
+
+//
+// Streaming serialization (keys in sorted order, same as nlohmann::json)
+//
+
+template <>
+void Serializer::write<BaseTrack>(JsonWriter &writer,
+                                  BaseTrack const &track,
+                                  TrackFieldMask const &fields) {
+  writer.beginObject();
+  writeField(writer, fields, TrackField::AddedBy, track.addedBy);
+  writeField(writer, fields, TrackField::Album, track.album);
+  writeField(writer, fields, TrackField::Artist, track.artist);
+  writeField(writer, fields, TrackField::Duration, track.durationMs);
+  writeField(writer, fields, TrackField::IconUri, track.iconUri);
+  writeField(writer, fields, TrackField::Title, track.title);
+  writeField(writer, fields, TrackField::TrackId, track.trackId);
+  writer.endObject();
+}
+
+template <>
+void Serializer::write<QueuedTrack>(JsonWriter &writer,
+                                    QueuedTrack const &track,
+                                    TrackFieldMask const &fields) {
+  writer.beginObject();
+  writeField(writer, fields, TrackField::AddedBy, track.addedBy);
+  writeField(writer, fields, TrackField::Album, track.album);
+  writeField(writer, fields, TrackField::Artist, track.artist);
+  writeField(
+      writer, fields, TrackField::CurrentVote, (track.userHasVoted ? 1 : 0));
+  writeField(writer, fields, TrackField::Duration, track.durationMs);
+  writeField(writer, fields, TrackField::IconUri, track.iconUri);
+  writeField(writer, fields, TrackField::Title, track.title);
+  writeField(writer, fields, TrackField::TrackId, track.trackId);
+  writeField(writer, fields, TrackField::Votes, track.votes);
+  writer.endObject();
+}
+
+template <>
+void Serializer::write<PlaybackTrack>(JsonWriter &writer,
+                                      PlaybackTrack const &track,
+                                      TrackFieldMask const &fields) {
+  writer.beginObject();
+  writeField(writer, fields, TrackField::AddedBy, track.addedBy);
+  writeField(writer, fields, TrackField::Album, track.album);
+  writeField(writer, fields, TrackField::Artist, track.artist);
+  writeField(writer, fields, TrackField::Duration, track.durationMs);
+  writeField(writer, fields, TrackField::IconUri, track.iconUri);
+  writeField(writer, fields, TrackField::Playing, track.isPlaying);
+  writeField(writer, fields, TrackField::PlayingFor, track.progressMs);
+  writeField(writer, fields, TrackField::StartedAt, track.startedAtMs);
+  writeField(writer, fields, TrackField::Title, track.title);
+  writeField(writer, fields, TrackField::TrackId, track.trackId);
+  writer.endObject();
+}
+
+template <>
+void Serializer::write<QueueStatus>(JsonWriter &writer,
+                                    QueueStatus const &queueStatus,
+                                    TrackFieldMask const &fields) {
+  writer.beginObject().key("admin_queue").beginArray();
+  for (auto &&track : queueStatus.adminQueue.tracks) {
+    Serializer::write(writer, track, fields);
+  }
+  writer.endArray()
+      .key("admin_queue_total")
+      .value(queueStatus.adminQueue.getTotalSize())
+      .key("currently_playing");
+  if (queueStatus.currentTrack.has_value()) {
+    Serializer::write(writer, queueStatus.currentTrack.value(), fields);
+  } else {
+    writer.beginObject().endObject();
+  }
+  writer.key("normal_queue").beginArray();
+  for (auto &&track : queueStatus.normalQueue.tracks) {
+    Serializer::write(writer, track, fields);
+  }
+  writer.endArray()
+      .key("normal_queue_total")
+      .value(queueStatus.normalQueue.getTotalSize())
+      .endObject();
+}
@@ -8,16 +8,29 @@
 #ifndef _SERIALIZER_H_
 #define _SERIALIZER_H_
 
+#include "Utils/JsonWriter.h"
+#include "Utils/TrackFields.h"
 #include "json/json.hpp"
 
 /**
  * @brief Template class which can be used as a central class for serialization
  * routines for different data types.
+ * @details `write` produces the same output as dumping the result of
+ * `serialize`, but writes it directly into a `JsonWriter`.
+ *
+ * Tracks (also those inside of other types) are serialized with the members
+ * selected by `fields` only.
  */
 class Serializer {
  public:
   template <class T>
-  static nlohmann::json serialize(T const &);
+  static nlohmann::json serialize(T const &,
+                                  TrackFieldMask const &fields = {});
+
+  template <class T>
+  static void write(JsonWriter &,
+                    T const &,
+                    TrackFieldMask const &fields = {});
 };
 
 #endif /* _SERIALIZER_H_ */
@@ -9,9 +9,50 @@
 #include "SimpleScheduler.h"
 
 #include "Types/GlobalTypes.h"
+#include "Utils/Metrics.h"
+#include "Utils/Tracing.h"
 
 using namespace std;
 
+// names of the scheduler states in the metrics, in the order of the enum
+static char const *const STATE_NAMES[] = {
+    "idle", "play_next_song", "check_playing", "playing"};
+
+/**
+ * @brief Sets the gauge of the current state to 1, the others to 0.
+ */
+static void recordState(size_t state) {
+  static auto &states = Metrics::gauge(
+      "jukebox_scheduler_state", "Current state of the scheduler", {"state"});
+  for (size_t i = 0; i < size(STATE_NAMES); i++) {
+    states.labels({STATE_NAMES[i]}).set(i == state ? 1 : 0);
+  }
+}
+
+static bool isSamePlayback(TResult<optional<PlaybackTrack>> const &a,
+                           TResult<optional<PlaybackTrack>> const &b) {
+  if (a.index() != b.index()) {
+    return false;
+  }
+
+  if (auto errorA = get_if<Error>(&a)) {
+    auto const &errorB = get<Error>(b);
+    return errorA->getErrorCode() == errorB.getErrorCode() &&
+           errorA->getErrorMessage() == errorB.getErrorMessage();
+  }
+
+  // the progress advances on every poll while a track plays, it is not part
+  // of the version, so clients polling with an ETag get 304 until the track
+  // changes or is paused (they compute the progress from `startedAtMs`)
+  auto const &trackA = get<optional<PlaybackTrack>>(a);
+  auto const &trackB = get<optional<PlaybackTrack>>(b);
+  if (!trackA.has_value() || !trackB.has_value()) {
+    return trackA.has_value() == trackB.has_value();
+  }
+  return trackA->trackId == trackB->trackId &&
+         trackA->isPlaying == trackB->isPlaying;
+}
+
 SimpleScheduler::SimpleScheduler(DataStore *const datastore,
                                  MusicBackend *const musicbackend) {
   if (datastore == nullptr)
@@ -40,15 +81,47 @@ void SimpleScheduler::start() {
 }
 
 void SimpleScheduler::threadFunc() {
+  static auto &iterations =
+      Metrics::counter("jukebox_scheduler_iterations_total",
+                       "Iterations of the scheduler by result",
+                       {"result"});
   while (!mCloseThread) {
     auto ret = doSchedule();
     if (ret.has_value()) {
       LOG(ERROR) << "SimpleScheduler.doSchedule: "
                  << ret.value().getErrorMessage();
+      iterations.labels({"error"}).inc();
+    } else {
+      iterations.labels({"ok"}).inc();
     }
+    updatePlaybackVersion();
   }
 }
 
+void SimpleScheduler::updatePlaybackVersion() {
+  std::shared_lock lockPlayback(mMtxPlayback);
+  std::shared_lock lockSchedulerState(mMtxModifySchedulerState);
+  recordState(static_cast<size_t>(mSchedulerState));
+
+  if (mSchedulerState != mVersionedSchedulerState ||
+      !isSamePlayback(mLastPlaybackTrack, mVersionedPlaybackTrack)) {
+    mVersionedSchedulerState = mSchedulerState;
+    mVersionedPlaybackTrack = mLastPlaybackTrack;
+    mPlaybackVersion++;
+    if (mChangeCallback) {
+      mChangeCallback();
+    }
+  }
+}
+
+uint64_t SimpleScheduler::getPlaybackVersion() {
+  return mPlaybackVersion;
+}
+
+void SimpleScheduler::setChangeCallback(std::function<void()> callback) {
+  mChangeCallback = std::move(callback);
+}
+
 TResult<std::optional<PlaybackTrack>> const &
 SimpleScheduler::getLastPlayback() {
   std::shared_lock lock(mMtxPlayback);
@@ -67,10 +140,15 @@ TResultOpt SimpleScheduler::nextTrack() {
   // then
   auto ret = mMusicBackend->pause();
   mSchedulerState = SchedulerState::Idle;
+  mPlaybackVersion++;
+  if (mChangeCallback) {
+    mChangeCallback();
+  }
   return ret;
 }
 
 bool SimpleScheduler::checkForInconsistency() {
+  Tracing::Span span("SimpleScheduler.checkForInconsistency");
   std::shared_lock lockPlayback(mMtxPlayback);
   std::shared_lock lockSchedulerState(mMtxModifySchedulerState);
 
@@ -100,6 +178,15 @@ TResultOpt SimpleScheduler::doSchedule() {
 
   TResult<std::optional<PlaybackTrack>> playbackTrackRet;
   playbackTrackRet = mMusicBackend->getCurrentPlayback();
+  if (auto playbackTrackOpt =
+          std::get_if<std::optional<PlaybackTrack>>(&playbackTrackRet)) {
+    if (playbackTrackOpt->has_value()) {
+      auto now = chrono::duration_cast<chrono::milliseconds>(
+          chrono::system_clock::now().time_since_epoch());
+      auto &track = playbackTrackOpt->value();
+      track.startedAtMs = now.count() - track.progressMs;
+    }
+  }
   std::unique_lock lockPlayback(mMtxPlayback);
   std::unique_lock lockSchedulerState(mMtxModifySchedulerState);
 
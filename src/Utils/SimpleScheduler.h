@@ -9,6 +9,8 @@
 #ifndef SIMPLE_SCHEDULER_H_INCLUDED
 #define SIMPLE_SCHEDULER_H_INCLUDED
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <shared_mutex>
 #include <string>
@@ -17,6 +19,7 @@
 #include "DataStore.h"
 #include "MusicBackend.h"
 #include "Types/Result.h"
+#include "Utils/ProfiledMutex.h"
 
 /**
  * @brief A simple track scheduler (for presentation purposes).
@@ -50,6 +53,23 @@ class SimpleScheduler {
    */
   bool checkForInconsistency();
 
+  /**
+   * @brief returns the version of the playback status
+   * @details the version changes whenever the polled track, whether it is
+   * playing or the state of the scheduler changes, but not with the progress
+   * of the track
+   * @return current playback version
+   */
+  uint64_t getPlaybackVersion();
+
+  /**
+   * @brief sets the function which is called whenever the playback version
+   * changes, e.g. to wake up event streams
+   * @details must be set before the scheduler is started
+   * @param callback function to call, which must not block
+   */
+  void setChangeCallback(std::function<void()> callback);
+
   /* TODO: functions below */
   /* enable() */
   /* disable() */
@@ -73,6 +93,12 @@ class SimpleScheduler {
    */
   void threadFunc();
 
+  /**
+   * @brief increments the playback version if the polled playback or the
+   * scheduler state changed since the last call
+   */
+  void updatePlaybackVersion();
+
   TResult<bool> areQueuesEmpty();
   TResult<bool> isTrackPlaying(std::optional<PlaybackTrack> const& currentOpt);
   TResult<bool> isTrackFinished(std::optional<PlaybackTrack> const& currentOpt);
@@ -84,10 +110,16 @@ class SimpleScheduler {
 
   int const cScheduleIntervalTimeMs = 1000;
 
+  std::atomic<uint64_t> mPlaybackVersion{0};
+  TResult<std::optional<PlaybackTrack>> mVersionedPlaybackTrack;
+  SchedulerState mVersionedSchedulerState = SchedulerState::Idle;
+  std::function<void()> mChangeCallback;
+
   std::thread mThread;
   bool mCloseThread = false;
-  std::shared_mutex mMtxPlayback;
-  std::shared_mutex mMtxModifySchedulerState;
+  ProfiledMutex<std::shared_mutex> mMtxPlayback{"SimpleScheduler.playback"};
+  ProfiledMutex<std::shared_mutex> mMtxModifySchedulerState{
+      "SimpleScheduler.schedulerState"};
 };
 
 #endif /* SIMPLE_SCHEDULER_H_INCLUDED */
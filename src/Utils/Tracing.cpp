@@ -0,0 +1,321 @@
+/*****************************************************************************/
+/**
+ * @file    Tracing.cpp
+ * @author  Team Server
+ * @brief   Implementation of class Tracing
+ */
+/*****************************************************************************/
+
+#include "Tracing.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "JsonWriter.h"
+#include "MemoryUsage.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// buffers of exited threads which are kept, the oldest ones are dropped
+static size_t const MAX_RETIRED_BUFFERS = 32;
+
+// spans a buffer has room for until it grows for the first time
+static size_t const INITIAL_CAPACITY = 32;
+
+// timestamps of the trace are relative to the start of the process
+static Tracing::Clock::time_point const sEpoch = Tracing::Clock::now();
+
+namespace {
+
+struct Event {
+  char const *name;
+  int64_t startNs;
+  int64_t durationNs;
+};
+
+/**
+ * @brief Slot of a ring buffer, which may be read while it is overwritten.
+ */
+struct Slot {
+  atomic<char const *> name{nullptr};
+  atomic<int64_t> startNs{0};
+  atomic<int64_t> durationNs{0};
+};
+
+/**
+ * @brief Ring buffer of the spans of one thread.
+ * @details It is written by its thread only, without locking. The n-th span
+ * goes into slot `n % capacity`: `claimed` is incremented before the slot is
+ * written and `written` after, so a reader can drop the slots which were
+ * overwritten while it copied them. The buffer starts small and doubles up
+ * to `Tracing::BUFFER_CAPACITY` when it is full, the mutex is only taken to
+ * swap the slots while no reader copies them.
+ */
+struct ThreadBuffer {
+  mutex mtx;
+  unique_ptr<Slot[]> slots = make_unique<Slot[]>(INITIAL_CAPACITY);
+  size_t capacity = INITIAL_CAPACITY;
+  atomic<uint64_t> claimed{0};
+  atomic<uint64_t> written{0};
+  // spans before are discarded by `Tracing::clear()`
+  atomic<uint64_t> clearedAt{0};
+  uint32_t threadId = 0;
+};
+
+struct Registry {
+  mutex mtx;
+  uint32_t nextThreadId = 1;
+  vector<shared_ptr<ThreadBuffer>> live;
+  deque<shared_ptr<ThreadBuffer>> retired;
+};
+
+Registry &registry() {
+  static Registry instance;
+  return instance;
+}
+
+/**
+ * @brief Registers the buffer of a thread on its first span, and retires it
+ * when the thread exits.
+ */
+struct BufferHolder {
+  BufferHolder() : buffer(make_shared<ThreadBuffer>()) {
+    auto &reg = registry();
+    lock_guard<mutex> lock(reg.mtx);
+    buffer->threadId = reg.nextThreadId++;
+    reg.live.push_back(buffer);
+  }
+
+  ~BufferHolder() {
+    auto &reg = registry();
+    lock_guard<mutex> lock(reg.mtx);
+    reg.live.erase(remove(reg.live.begin(), reg.live.end(), buffer),
+                   reg.live.end());
+    reg.retired.push_back(move(buffer));
+    if (reg.retired.size() > MAX_RETIRED_BUFFERS) {
+      reg.retired.pop_front();
+    }
+  }
+
+  shared_ptr<ThreadBuffer> buffer;
+};
+
+}  // namespace
+
+static size_t bufferBytes() {
+  auto &reg = registry();
+  lock_guard<mutex> lock(reg.mtx);
+  size_t bytes = 0;
+  auto add = [&bytes](ThreadBuffer &buffer) {
+    lock_guard<mutex> bufferLock(buffer.mtx);
+    bytes += sizeof(ThreadBuffer) + buffer.capacity * sizeof(Slot);
+  };
+  for (auto const &buffer : reg.retired) {
+    add(*buffer);
+  }
+  for (auto const &buffer : reg.live) {
+    add(*buffer);
+  }
+  return bytes;
+}
+
+static MemoryUsage::Registration sMemory("tracing.buffers", bufferBytes);
+
+static thread_local Tracing::Request *tRequest = nullptr;
+
+static ThreadBuffer &threadBuffer() {
+  static thread_local BufferHolder holder;
+  return *holder.buffer;
+}
+
+/**
+ * @brief Appends a number with three decimals.
+ */
+static void appendFixed(string &out, double value) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.3f", value);
+  out += buffer;
+}
+
+//
+// Span
+//
+
+Tracing::Span::Span(char const *name) : mName(name), mStart(Clock::now()) {
+}
+
+Tracing::Span::~Span() {
+  auto duration = Clock::now() - mStart;
+
+  auto &buffer = threadBuffer();
+  auto n = buffer.written.load(memory_order_relaxed);
+  if (n == buffer.capacity && buffer.capacity < BUFFER_CAPACITY) {
+    // the slots hold the spans 0 to n - 1, so they keep their indices
+    auto slots = make_unique<Slot[]>(buffer.capacity * 2);
+    for (size_t i = 0; i < buffer.capacity; i++) {
+      slots[i].name.store(buffer.slots[i].name.load(memory_order_relaxed),
+                          memory_order_relaxed);
+      slots[i].startNs.store(
+          buffer.slots[i].startNs.load(memory_order_relaxed),
+          memory_order_relaxed);
+      slots[i].durationNs.store(
+          buffer.slots[i].durationNs.load(memory_order_relaxed),
+          memory_order_relaxed);
+    }
+    lock_guard<mutex> lock(buffer.mtx);
+    buffer.slots = move(slots);
+    buffer.capacity *= 2;
+  }
+
+  auto &slot = buffer.slots[n % buffer.capacity];
+  buffer.claimed.store(n + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  slot.name.store(mName, memory_order_relaxed);
+  slot.startNs.store(duration_cast<nanoseconds>(mStart - sEpoch).count(),
+                     memory_order_relaxed);
+  slot.durationNs.store(duration_cast<nanoseconds>(duration).count(),
+                        memory_order_relaxed);
+  buffer.written.store(n + 1, memory_order_release);
+
+  if (tRequest) {
+    tRequest->add(mName, duration);
+  }
+}
+
+//
+// Request
+//
+
+Tracing::Request::Request() : mOuter(tRequest), mStart(Clock::now()) {
+  tRequest = this;
+}
+
+Tracing::Request::~Request() {
+  tRequest = mOuter;
+}
+
+void Tracing::Request::add(char const *name, Clock::duration duration) {
+  for (size_t i = 0; i < mEntryCount; i++) {
+    if (mEntries[i].name == name ||
+        string_view(mEntries[i].name) == string_view(name)) {
+      mEntries[i].duration += duration;
+      return;
+    }
+  }
+  // further names are dropped, the header is meant to stay short
+  if (mEntryCount < MAX_ENTRIES) {
+    mEntries[mEntryCount++] = {name, duration};
+  }
+}
+
+string Tracing::Request::serverTiming() const {
+  auto toMs = [](Clock::duration duration) {
+    return duration_cast<nanoseconds>(duration).count() / 1e6;
+  };
+
+  string header;
+  for (size_t i = 0; i < mEntryCount; i++) {
+    header += mEntries[i].name;
+    header += ";dur=";
+    appendFixed(header, toMs(mEntries[i].duration));
+    header += ", ";
+  }
+  header += "total;dur=";
+  appendFixed(header, toMs(Clock::now() - mStart));
+  return header;
+}
+
+//
+// Tracing
+//
+
+string Tracing::chromeTrace() {
+  // the buffers are copied, so threads are blocked for a short time only
+  struct ThreadEvents {
+    uint32_t threadId;
+    vector<Event> events;
+  };
+  vector<ThreadEvents> threads;
+  {
+    auto &reg = registry();
+    lock_guard<mutex> lock(reg.mtx);
+    auto collect = [&threads](ThreadBuffer &buffer) {
+      lock_guard<mutex> bufferLock(buffer.mtx);
+      uint64_t capacity = buffer.capacity;
+      auto written = buffer.written.load(memory_order_acquire);
+      auto first = max(written > capacity ? written - capacity : 0,
+                       buffer.clearedAt.load(memory_order_relaxed));
+      ThreadEvents copy{buffer.threadId, {}};
+      for (auto n = first; n < written; n++) {
+        auto const &slot = buffer.slots[n % capacity];
+        copy.events.push_back({slot.name.load(memory_order_relaxed),
+                               slot.startNs.load(memory_order_relaxed),
+                               slot.durationNs.load(memory_order_relaxed)});
+      }
+      // the spans whose slots were claimed again meanwhile may be torn
+      atomic_thread_fence(memory_order_acquire);
+      auto claimed = buffer.claimed.load(memory_order_relaxed);
+      if (claimed > first + capacity) {
+        auto torn = min<uint64_t>(claimed - first - capacity,
+                                  copy.events.size());
+        copy.events.erase(copy.events.begin(), copy.events.begin() + torn);
+      }
+      threads.push_back(move(copy));
+    };
+    for (auto const &buffer : reg.retired) {
+      collect(*buffer);
+    }
+    for (auto const &buffer : reg.live) {
+      collect(*buffer);
+    }
+  }
+
+  auto pid = static_cast<int>(getpid());
+  JsonWriter writer;
+  writer.beginObject().key("traceEvents").beginArray();
+  string number;
+  for (auto const &thread : threads) {
+    for (auto const &event : thread.events) {
+      // the category is the class of the span, e.g. `RAMDataStore`
+      string_view name = event.name;
+      string_view category = name.substr(0, name.find('.'));
+
+      writer.beginObject();
+      writer.key("cat").value(category);
+      number.clear();
+      appendFixed(number, event.durationNs / 1e3);
+      writer.key("dur").rawValue(number);
+      writer.key("name").value(name);
+      writer.key("ph").value("X");
+      writer.key("pid").value(pid);
+      writer.key("tid").value(thread.threadId);
+      number.clear();
+      appendFixed(number, event.startNs / 1e3);
+      writer.key("ts").rawValue(number);
+      writer.endObject();
+    }
+  }
+  writer.endArray();
+  writer.key("displayTimeUnit").value("ms");
+  writer.endObject();
+  return writer.release();
+}
+
+void Tracing::clear() {
+  auto &reg = registry();
+  lock_guard<mutex> lock(reg.mtx);
+  reg.retired.clear();
+  for (auto const &buffer : reg.live) {
+    buffer->clearedAt.store(buffer->written.load(memory_order_acquire),
+                            memory_order_relaxed);
+  }
+}
@@ -0,0 +1,103 @@
+/*****************************************************************************/
+/**
+ * @file    Tracing.h
+ * @author  Team Server
+ * @brief   Definition of class Tracing
+ */
+/*****************************************************************************/
+
+#ifndef _TRACING_H_
+#define _TRACING_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @class Tracing
+ * @brief Scoped spans which record where the time of a request goes.
+ * @details Each thread records its finished spans into a ring buffer of its
+ * own, which keeps the latest `BUFFER_CAPACITY` spans. A buffer is allocated
+ * on the first span of a thread and starts small, it grows to at most
+ * `BUFFER_CAPACITY` spans of 24 bytes, i.e. 12 KiB. The buffers of all
+ * threads can be dumped as Chrome trace events (see `chrome://tracing` or
+ * Perfetto) at `/debug/trace`. Buffers of exited threads are kept for a
+ * while, so traces of short-lived connection threads are not lost.
+ *
+ * While a `Tracing::Request` exists on a thread, the durations of its spans
+ * are summed up per name in addition, for the `Server-Timing` header.
+ *
+ * Span names have to be string literals (or outlive the process otherwise),
+ * since only the pointer is recorded.
+ */
+class Tracing {
+ public:
+  typedef std::chrono::steady_clock Clock;
+
+  static constexpr size_t BUFFER_CAPACITY = 512;
+
+  /**
+   * @class Tracing::Span
+   * @brief Records the time from its construction until its destruction.
+   */
+  class Span {
+   public:
+    explicit Span(char const *name);
+    ~Span();
+    Span(Span const &) = delete;
+    Span &operator=(Span const &) = delete;
+
+   private:
+    char const *mName;
+    Clock::time_point mStart;
+  };
+
+  /**
+   * @class Tracing::Request
+   * @brief Sums up the spans of the request handled by the current thread.
+   */
+  class Request {
+   public:
+    Request();
+    ~Request();
+    Request(Request const &) = delete;
+    Request &operator=(Request const &) = delete;
+
+    /**
+     * @brief Returns the value of the `Server-Timing` header, i.e. the time
+     * spent in the spans so far and the total time of the request in
+     * milliseconds.
+     */
+    std::string serverTiming() const;
+
+   private:
+    friend class Span;
+    static constexpr size_t MAX_ENTRIES = 16;
+
+    struct Entry {
+      char const *name = nullptr;
+      Clock::duration duration{0};
+    };
+
+    void add(char const *name, Clock::duration duration);
+
+    Request *mOuter;
+    Clock::time_point mStart;
+    std::array<Entry, MAX_ENTRIES> mEntries;
+    size_t mEntryCount = 0;
+  };
+
+  /**
+   * @brief Returns the spans of all threads as Chrome trace events in the
+   * JSON object format.
+   */
+  static std::string chromeTrace();
+
+  /**
+   * @brief Discards the recorded spans of all threads.
+   */
+  static void clear();
+};
+
+#endif /* _TRACING_H_ */
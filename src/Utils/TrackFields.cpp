@@ -0,0 +1,61 @@
+/*****************************************************************************/
+/**
+ * @file    TrackFields.cpp
+ * @author  Team Server
+ * @brief   Implementation of class TrackFieldMask
+ */
+/*****************************************************************************/
+
+#include "Utils/TrackFields.h"
+
+#include "Utils/HttpHeader.h"
+
+using namespace std;
+
+static string_view const FIELD_NAMES[] = {"added_by",
+                                          "album",
+                                          "artist",
+                                          "current_vote",
+                                          "duration",
+                                          "icon_uri",
+                                          "playing",
+                                          "playing_for",
+                                          "started_at",
+                                          "title",
+                                          "track_id",
+                                          "votes"};
+
+static_assert(sizeof(FIELD_NAMES) / sizeof(FIELD_NAMES[0]) ==
+                  static_cast<size_t>(TrackField::Count),
+              "every field needs a name");
+
+TResult<TrackFieldMask> TrackFieldMask::parse(string_view list) {
+  TrackFieldMask mask;
+  mask.mBits = 0;
+  while (!list.empty()) {
+    auto name = HttpHeader::nextElement(list);
+    if (name.empty()) {
+      continue;
+    }
+
+    size_t index = 0;
+    while (index < static_cast<size_t>(TrackField::Count) &&
+           FIELD_NAMES[index] != name) {
+      index++;
+    }
+    if (index == static_cast<size_t>(TrackField::Count)) {
+      return Error(ErrorCode::InvalidValue,
+                   "Unknown field '" + string(name) + "'");
+    }
+    mask.mBits |= bit(static_cast<TrackField>(index));
+  }
+
+  if (mask.mBits == 0) {
+    return Error(ErrorCode::InvalidValue, "No fields selected");
+  }
+  return mask;
+}
+
+string_view TrackFieldMask::name(TrackField field) {
+  return FIELD_NAMES[static_cast<size_t>(field)];
+}
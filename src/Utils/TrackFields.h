@@ -0,0 +1,88 @@
+/*****************************************************************************/
+/**
+ * @file    TrackFields.h
+ * @author  Team Server
+ * @brief   Definition of class TrackFieldMask
+ */
+/*****************************************************************************/
+
+#ifndef _TRACK_FIELDS_H_
+#define _TRACK_FIELDS_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "Types/Result.h"
+
+/**
+ * @brief Members of serialized tracks.
+ * @details Sorted by their names, which is the order they are serialized in.
+ */
+enum class TrackField {
+  AddedBy,
+  Album,
+  Artist,
+  CurrentVote,
+  Duration,
+  IconUri,
+  Playing,
+  PlayingFor,
+  StartedAt,
+  Title,
+  TrackId,
+  Votes,
+  Count
+};
+
+/**
+ * @class TrackFieldMask
+ * @brief Selects the members which are serialized of each track.
+ * @details Fields which a track type does not have (e.g. `votes` of a
+ * `PlaybackTrack`) are ignored. By default all fields are selected.
+ */
+class TrackFieldMask {
+ public:
+  constexpr TrackFieldMask() : mBits(ALL_FIELDS) {
+  }
+
+  /**
+   * @brief Parses a comma separated list of field names (e.g. `title,votes`).
+   * @return The mask or an error if the list is empty or contains an unknown
+   * field.
+   */
+  static TResult<TrackFieldMask> parse(std::string_view list);
+
+  /**
+   * @brief Returns the name of the field as used in the serialized track.
+   */
+  static std::string_view name(TrackField field);
+
+  constexpr bool has(TrackField field) const {
+    return (mBits & bit(field)) != 0;
+  }
+
+  constexpr bool hasAll() const {
+    return mBits == ALL_FIELDS;
+  }
+
+  constexpr uint32_t bits() const {
+    return mBits;
+  }
+
+  constexpr bool operator==(TrackFieldMask const &other) const {
+    return mBits == other.mBits;
+  }
+
+ private:
+  static constexpr uint32_t bit(TrackField field) {
+    return 1u << static_cast<uint32_t>(field);
+  }
+
+  static constexpr uint32_t ALL_FIELDS =
+      (1u << static_cast<uint32_t>(TrackField::Count)) - 1;
+
+  uint32_t mBits;
+};
+
+#endif /* _TRACK_FIELDS_H_ */
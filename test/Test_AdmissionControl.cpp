@@ -0,0 +1,185 @@
+/*****************************************************************************/
+/**
+ * @file    Test_AdmissionControl.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class AdmissionControl
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "DispatchFixture.h"
+#include "Network/AdmissionControl.h"
+#include "Utils/ConfigHandler.h"
+#include "json/json.hpp"
+
+using namespace std;
+using namespace literals::chrono_literals;
+using json = nlohmann::json;
+
+class AdmissionControlFixture : public DispatchFixture<> {
+ protected:
+  /**
+   * @brief Occupies the budget of normal requests (3 of 4 slots).
+   */
+  vector<AdmissionTicket> occupyNormalLane() {
+    vector<AdmissionTicket> tickets;
+    for (int i = 0; i < 3; i++) {
+      tickets.push_back(AdmissionControl::admit(RequestLane::Normal));
+      EXPECT_TRUE(tickets.back());
+    }
+    return tickets;
+  }
+};
+
+TEST_F(AdmissionControlFixture, Lanes) {
+  auto tickets = occupyNormalLane();
+  EXPECT_EQ(AdmissionControl::stats().inFlight, 3);
+  auto rejected = AdmissionControl::stats().rejected;
+
+  // the reserved slot is left for control requests only
+  EXPECT_FALSE(AdmissionControl::admit(RequestLane::Normal));
+  auto control = AdmissionControl::admit(RequestLane::Control);
+  EXPECT_TRUE(control);
+  EXPECT_FALSE(AdmissionControl::admit(RequestLane::Control));
+  EXPECT_EQ(AdmissionControl::stats().rejected, rejected + 2);
+
+  // control requests count towards the budget of normal requests as well
+  tickets.pop_back();
+  EXPECT_FALSE(AdmissionControl::admit(RequestLane::Normal));
+
+  // finished requests free their slots
+  control = AdmissionTicket();
+  EXPECT_TRUE(AdmissionControl::admit(RequestLane::Normal));
+  EXPECT_EQ(AdmissionControl::stats().inFlight, 2);
+  tickets.clear();
+  EXPECT_EQ(AdmissionControl::stats().inFlight, 0);
+}
+
+TEST_F(AdmissionControlFixture, DebugLane) {
+  auto tickets = occupyNormalLane();
+  auto control = AdmissionControl::admit(RequestLane::Control);
+  ASSERT_TRUE(control);
+
+  // monitoring has a budget of its own (1 in the test configuration)
+  auto debug = AdmissionControl::admit(RequestLane::Debug);
+  EXPECT_TRUE(debug);
+  EXPECT_FALSE(AdmissionControl::admit(RequestLane::Debug));
+  EXPECT_EQ(AdmissionControl::stats().inFlight, 4);
+  EXPECT_EQ(AdmissionControl::stats().debugInFlight, 1);
+
+  debug = AdmissionTicket();
+  EXPECT_EQ(AdmissionControl::stats().debugInFlight, 0);
+  EXPECT_EQ(AdmissionControl::stats().inFlight, 4);
+}
+
+TEST_F(AdmissionControlFixture, Configure) {
+  auto config = ConfigHandler::getInstance();
+  EXPECT_EQ(AdmissionControl::maxAdmitted(), 5);
+  EXPECT_EQ(AdmissionControl::configuredRetryAfter(), 2);
+
+  // the budgets are read when the server starts, not by each request
+  config->setValue("RestAPI", "maxInFlightRequests", "0");
+  config->setValue("RestAPI", "overloadRetryAfterSeconds", "7");
+  auto tickets = occupyNormalLane();
+  EXPECT_FALSE(AdmissionControl::admit(RequestLane::Normal));
+  EXPECT_EQ(AdmissionControl::configuredRetryAfter(), 2);
+
+  ASSERT_FALSE(AdmissionControl::configure().has_value());
+  EXPECT_TRUE(AdmissionControl::admit(RequestLane::Normal));
+  EXPECT_EQ(AdmissionControl::maxAdmitted(), 0);
+  EXPECT_EQ(AdmissionControl::configuredRetryAfter(), 7);
+
+  config->setValue("RestAPI", "maxDebugRequests", "-1");
+  auto error = AdmissionControl::configure();
+  ASSERT_TRUE(error.has_value());
+  EXPECT_EQ(error.value().getErrorCode(), ErrorCode::InvalidValue);
+}
+
+TEST_F(AdmissionControlFixture, Dispatch) {
+  auto tickets = occupyNormalLane();
+
+  // votes are rejected right away
+  string voteBody =
+      json({{"session_id", "s"}, {"track_id", "1"}, {"vote", 1}}).dump();
+  RequestInformation vote{"/api/v1/voteTrack", "PUT", voteBody, {}, {}};
+  auto response = dispatch(move(vote));
+  EXPECT_EQ(response.code, 503);
+  EXPECT_EQ(response.headers["Retry-After"], "2");
+  EXPECT_EQ(json::parse(response.body)["status"], 503);
+  EXPECT_EQ(listener.getCountVoteTrack(), 0);
+
+  // the player stays controllable
+  string controlBody =
+      json({{"session_id", "s"}, {"player_action", "pause"}}).dump();
+  RequestInformation control{
+      "/api/v1/controlPlayer", "PUT", controlBody, {}, {}};
+  response = dispatch(move(control));
+  EXPECT_EQ(response.code, 200);
+  EXPECT_EQ(listener.getCountControlPlayer(), 1);
+  EXPECT_EQ(AdmissionControl::stats().inFlight, 3);
+}
+
+TEST_F(AdmissionControlFixture, Batch) {
+  // leaves a single normal slot, which the batch itself occupies
+  auto tickets = occupyNormalLane();
+  tickets.pop_back();
+
+  // normal requests of a batch share its slot, control requests occupy slots
+  // of their own lane
+  json requestBody = {
+      {"requests",
+       {{{"method", "PUT"},
+         {"path", "/controlPlayer"},
+         {"body", {{"session_id", "s"}, {"player_action", "pause"}}}},
+        {{"method", "PUT"},
+         {"path", "/voteTrack"},
+         {"body", {{"session_id", "s"}, {"track_id", "1"}, {"vote", 1}}}},
+        {{"method", "GET"},
+         {"path", "/queryTracks"},
+         {"args", {{"pattern", "a"}}}}}}};
+  // the request refers to its body
+  string batchBody = requestBody.dump();
+  RequestInformation batch{"/api/v1/batch", "POST", batchBody, {}, {}};
+  auto response = dispatch(move(batch));
+  ASSERT_EQ(response.code, 200);
+  auto responses = json::parse(response.body)["responses"];
+  EXPECT_EQ(responses[0]["status"], 200);
+  EXPECT_EQ(responses[1]["status"], 200);
+  EXPECT_EQ(responses[2]["status"], 200);
+  EXPECT_EQ(listener.getCountControlPlayer(), 1);
+  EXPECT_EQ(listener.getCountVoteTrack(), 1);
+  EXPECT_EQ(AdmissionControl::stats().inFlight, 2);
+}
+
+TEST_F(AdmissionControlFixture, Profile) {
+  auto tickets = occupyNormalLane();
+
+  // a running profile does not occupy the reserved control slot
+  listener.setResponseAuthorizeAdmin(nullopt);
+  thread profile([this]() {
+    auto response = dispatch({"/debug/profile/heap",
+                              "GET",
+                              "",
+                              {{"session_id", "admin"}, {"seconds", "1"}},
+                              {}});
+    EXPECT_EQ(response.code, 200);
+  });
+  this_thread::sleep_for(200ms);
+  EXPECT_EQ(AdmissionControl::stats().debugInFlight, 1);
+
+  string controlBody =
+      json({{"session_id", "s"}, {"player_action", "pause"}}).dump();
+  RequestInformation control{
+      "/api/v1/controlPlayer", "PUT", controlBody, {}, {}};
+  auto response = dispatch(move(control));
+  EXPECT_EQ(response.code, 200);
+  EXPECT_EQ(listener.getCountControlPlayer(), 1);
+
+  profile.join();
+  EXPECT_EQ(AdmissionControl::stats().debugInFlight, 0);
+}
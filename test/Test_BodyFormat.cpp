@@ -0,0 +1,122 @@
+/*****************************************************************************/
+/**
+ * @file    Test_BodyFormat.cpp
+ * @author  Team Server
+ * @brief   Test implementation of the binary body encoding helpers
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "Utils/BodyFormat.h"
+
+using namespace std;
+using json = nlohmann::json;
+
+TEST(BodyFormat, Negotiate) {
+  auto jsonFormat = BodyFormat::Json;
+  auto msgpack = BodyFormat::MessagePack;
+  auto cbor = BodyFormat::Cbor;
+
+  for (auto [header, expected] : {
+           pair{"", jsonFormat},
+           pair{"*/*", jsonFormat},
+           pair{"application/*", jsonFormat},
+           pair{"text/html,application/xhtml+xml,*/*;q=0.8", jsonFormat},
+           pair{"application/json", jsonFormat},
+           pair{"application/msgpack", msgpack},
+           pair{"Application/MsgPack", msgpack},
+           pair{"application/x-msgpack", msgpack},
+           pair{"application/vnd.msgpack", msgpack},
+           pair{"application/cbor", cbor},
+           pair{"application/msgpack, */*;q=0.5", msgpack},
+           pair{"application/msgpack, application/json", msgpack},
+           pair{"application/msgpack;q=0.5, application/json", jsonFormat},
+           pair{"application/msgpack;q=0", jsonFormat},
+           pair{"application/cbor, application/msgpack;q=0.9", cbor},
+           pair{"application/cbor, application/msgpack", msgpack},
+       }) {
+    EXPECT_EQ(BodyCodec::negotiate(header), expected) << header;
+  }
+}
+
+TEST(BodyFormat, ParseContentType) {
+  EXPECT_EQ(BodyCodec::parseContentType(""), BodyFormat::Json);
+  EXPECT_EQ(BodyCodec::parseContentType("text/plain"), BodyFormat::Json);
+  EXPECT_EQ(BodyCodec::parseContentType("application/json; charset=utf-8"),
+            BodyFormat::Json);
+  EXPECT_EQ(BodyCodec::parseContentType("application/msgpack"),
+            BodyFormat::MessagePack);
+  EXPECT_EQ(BodyCodec::parseContentType(" application/cbor ;x=y"),
+            BodyFormat::Cbor);
+}
+
+TEST(BodyFormat, RoundTrip) {
+  json document = {{"session_id", "4711"},
+                   {"tracks", {{{"votes", 3}, {"has_user_voted", true}}}},
+                   {"ratio", 0.5},
+                   {"none", nullptr}};
+  auto text = document.dump();
+
+  for (auto format :
+       {BodyFormat::Json, BodyFormat::MessagePack, BodyFormat::Cbor}) {
+    auto encoded = BodyCodec::fromJson(text, format);
+    ASSERT_TRUE(holds_alternative<string>(encoded));
+    EXPECT_EQ(get<string>(encoded), BodyCodec::encode(document, format));
+
+    auto decoded = BodyCodec::toJson(get<string>(encoded), format);
+    ASSERT_TRUE(holds_alternative<string>(decoded));
+    EXPECT_EQ(json::parse(get<string>(decoded)), document);
+  }
+
+  // the binary formats are smaller
+  EXPECT_LT(BodyCodec::encode(document, BodyFormat::MessagePack).size(),
+            text.size());
+  EXPECT_LT(BodyCodec::encode(document, BodyFormat::Cbor).size(),
+            text.size());
+}
+
+TEST(BodyFormat, Malformed) {
+  EXPECT_TRUE(holds_alternative<Error>(
+      BodyCodec::fromJson("{\"a\":", BodyFormat::MessagePack)));
+
+  for (auto format : {BodyFormat::MessagePack, BodyFormat::Cbor}) {
+    auto encoded = BodyCodec::encode({{"key", "value"}}, format);
+    // truncated body
+    EXPECT_TRUE(holds_alternative<Error>(
+        BodyCodec::toJson(encoded.substr(0, encoded.size() - 1), format)));
+    // trailing data
+    EXPECT_TRUE(holds_alternative<Error>(
+        BodyCodec::toJson(encoded + encoded, format)));
+  }
+
+  for (auto format : {BodyFormat::MessagePack, BodyFormat::Cbor}) {
+    // nested arrays, 64 levels are accepted, more are rejected without
+    // recursing through all of them
+    json nested = json::array();
+    for (int i = 1; i < 64; i++) {
+      nested = json::array({nested});
+    }
+    auto decoded = BodyCodec::toJson(BodyCodec::encode(nested, format), format);
+    ASSERT_TRUE(holds_alternative<string>(decoded));
+    EXPECT_EQ(json::parse(get<string>(decoded)), nested);
+
+    // an array of one element is 0x91 (MessagePack) or 0x81 (CBOR)
+    char arrayOfOne = (format == BodyFormat::MessagePack) ? '\x91' : '\x81';
+    string deep(100000, arrayOfOne);
+    auto result = BodyCodec::toJson(deep, format);
+    ASSERT_TRUE(holds_alternative<Error>(result));
+    EXPECT_EQ(get<Error>(result).getErrorCode(), ErrorCode::InvalidFormat);
+
+    // a string which is no valid UTF-8
+    auto invalid = BodyCodec::encode({{"key", "\xff\xfe"}}, format);
+    result = BodyCodec::toJson(invalid, format);
+    ASSERT_TRUE(holds_alternative<Error>(result));
+    EXPECT_EQ(get<Error>(result).getErrorCode(), ErrorCode::InvalidFormat);
+  }
+
+  // requests without body stay without body
+  auto empty = BodyCodec::toJson("", BodyFormat::MessagePack);
+  ASSERT_TRUE(holds_alternative<string>(empty));
+  EXPECT_TRUE(get<string>(empty).empty());
+}
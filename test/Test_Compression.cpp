@@ -0,0 +1,152 @@
+/*****************************************************************************/
+/**
+ * @file    Test_Compression.cpp
+ * @author  Team Server
+ * @brief   Test implementation of the response compression helpers
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#ifdef HAVE_BROTLI
+#include <brotli/decode.h>
+#endif
+
+#include "Gunzip.h"
+#include "Utils/Compression.h"
+#include "Utils/ConfigHandler.h"
+
+using namespace std;
+
+TEST(Compression, Negotiate) {
+  auto gzip = ContentEncoding::Gzip;
+  auto identity = ContentEncoding::Identity;
+
+  // without brotli
+  for (auto [header, expected] : {
+           pair{"", identity},
+           pair{"identity", identity},
+           pair{"gzip", gzip},
+           pair{"GZIP", gzip},
+           pair{"x-gzip", gzip},
+           pair{"deflate, gzip;q=1.0, *;q=0.5", gzip},
+           pair{"gzip;q=0", identity},
+           pair{"gzip; q=0.000", identity},
+           pair{"gzip;q=0.001", gzip},
+           pair{"*", gzip},
+           pair{"*;q=0", identity},
+           pair{"gzip;q=0, *", identity},
+           pair{"br", identity},
+           pair{"br, gzip;q=0.5", gzip},
+       }) {
+    EXPECT_EQ(Compression::negotiate(header, false), expected) << header;
+  }
+
+#ifdef HAVE_BROTLI
+  auto brotli = ContentEncoding::Brotli;
+  EXPECT_EQ(Compression::negotiate("gzip, deflate, br"), brotli);
+  EXPECT_EQ(Compression::negotiate("br;q=0.5, gzip"), gzip);
+  EXPECT_EQ(Compression::negotiate("br;q=0, *"), gzip);
+#else
+  EXPECT_EQ(Compression::negotiate("gzip, deflate, br"), gzip);
+#endif
+}
+
+TEST(Compression, Select) {
+  auto gzip = ContentEncoding::Gzip;
+  auto brotli = ContentEncoding::Brotli;
+  auto identity = ContentEncoding::Identity;
+
+  // brotli does not depend on the build, only on the available encodings
+  EXPECT_EQ(Compression::select("gzip, br", true, true), brotli);
+  EXPECT_EQ(Compression::select("gzip, br", true, false), gzip);
+  EXPECT_EQ(Compression::select("gzip, br", false, true), brotli);
+  EXPECT_EQ(Compression::select("gzip", false, true), identity);
+  EXPECT_EQ(Compression::select("gzip, br", false, false), identity);
+}
+
+TEST(Compression, Gzip) {
+  string data;
+  for (int i = 0; i < 1000; i++) {
+    data += "{\"track_id\":\"" + to_string(i) + "\"},";
+  }
+
+  for (string input : {string(), string("a"), data}) {
+    auto compressed = Compression::compress(input, ContentEncoding::Gzip, 6);
+    ASSERT_EQ(gunzip(compressed), input);
+  }
+  auto compressed = Compression::compress(data, ContentEncoding::Gzip, 9);
+  ASSERT_LT(compressed.size(), data.size() / 4);
+
+  // identity is returned unchanged
+  ASSERT_EQ(Compression::compress(data, ContentEncoding::Identity, 6), data);
+}
+
+TEST(Compression, GzipSegments) {
+  GzipSegmentCompressor compressor(6);
+  string first = "{\"title\":\"first\",\"current_vote\":";
+  string second = ",\"title\":\"second\",\"current_vote\":";
+  auto firstSegment = compressor.compress(first);
+  auto voteSegment = compressor.compress("1");
+  // may refer to the first segment, which precedes it
+  auto secondSegment = compressor.compress("0" + second, first);
+  auto emptySegment = compressor.compress("");
+
+  auto compressed = GzipBuilder()
+                        .append(firstSegment)
+                        .append(voteSegment)
+                        .append(emptySegment)
+                        .append(firstSegment)
+                        .append(secondSegment)
+                        .finish();
+  ASSERT_EQ(gunzip(compressed), first + "1" + first + "0" + second);
+
+  ASSERT_EQ(gunzip(GzipBuilder().finish()), "");
+}
+
+#ifdef HAVE_BROTLI
+TEST(Compression, Brotli) {
+  string data;
+  for (int i = 0; i < 1000; i++) {
+    data += "{\"track_id\":\"" + to_string(i) + "\"},";
+  }
+
+  auto compressed = Compression::compress(data, ContentEncoding::Brotli, 6);
+  ASSERT_LT(compressed.size(), data.size() / 4);
+  string decompressed(data.size(), '\0');
+  size_t size = decompressed.size();
+  ASSERT_EQ(BrotliDecoderDecompress(
+                compressed.size(),
+                reinterpret_cast<uint8_t const *>(compressed.data()),
+                &size,
+                reinterpret_cast<uint8_t *>(decompressed.data())),
+            BROTLI_DECODER_RESULT_SUCCESS);
+  decompressed.resize(size);
+  ASSERT_EQ(decompressed, data);
+}
+#endif
+
+TEST(Compression, Configure) {
+  auto config = ConfigHandler::getInstance();
+  ASSERT_FALSE(config->setConfigFilePath("../test/test_config.ini"));
+  config->setValue("RestAPI", "compressionLevel", "3");
+  config->setValue("RestAPI", "compressionMinSize", "100");
+  ASSERT_FALSE(Compression::configure().has_value());
+  EXPECT_EQ(Compression::configuredLevel(), 3);
+  EXPECT_EQ(Compression::configuredMinSize(), 100);
+
+  // invalid values keep the previous configuration
+  for (auto [key, value] : {pair{"compressionLevel", "10"},
+                            pair{"compressionLevel", "-1"},
+                            pair{"compressionLevel", "fast"},
+                            pair{"compressionMinSize", "-1"}}) {
+    ASSERT_FALSE(config->setConfigFilePath("../test/test_config.ini"));
+    config->setValue("RestAPI", key, value);
+    EXPECT_TRUE(Compression::configure().has_value()) << key << "=" << value;
+  }
+  EXPECT_EQ(Compression::configuredLevel(), 3);
+
+  ASSERT_FALSE(config->setConfigFilePath("../test/test_config.ini"));
+  ASSERT_FALSE(Compression::configure().has_value());
+  EXPECT_EQ(Compression::configuredLevel(), 6);
+}
@@ -105,3 +105,69 @@ TEST(ConfigHandler, getValueString_KeyNotFound) {
   ASSERT_EQ(checkAlternativeError(ret), true);
   EXPECT_EQ(get<Error>(ret).getErrorCode(), ErrorCode::KeyNotFound);
 }
+
+TEST(ConfigHandler, getValueWithDefault) {
+  string const configFilePath = "../test/test_config.ini";
+  string const section = "MainParams";
+
+  shared_ptr<ConfigHandler> conf = ConfigHandler::getInstance();
+  auto setfile = conf->setConfigFilePath(configFilePath);
+  ASSERT_EQ(checkOptionalError(setfile), false);
+
+  // existing keys ignore the default value
+  TResult<int> retInt = conf->getValueInt(section, "port", 1234);
+  ASSERT_EQ(checkAlternativeError(retInt), false);
+  EXPECT_EQ(get<int>(retInt), 4711);
+
+  // missing keys return the default value
+  retInt = conf->getValueInt(section, "this_key_does_not_exist", 1234);
+  ASSERT_EQ(checkAlternativeError(retInt), false);
+  EXPECT_EQ(get<int>(retInt), 1234);
+
+  TResult<string> retStr =
+      conf->getValueString(section, "this_key_does_not_exist", "default");
+  ASSERT_EQ(checkAlternativeError(retStr), false);
+  EXPECT_EQ(get<string>(retStr), "default");
+
+  // invalid formats are still reported
+  retInt = conf->getValueInt(section, "wrongFormat", 1234);
+  ASSERT_EQ(checkAlternativeError(retInt), true);
+  EXPECT_EQ(get<Error>(retInt).getErrorCode(), ErrorCode::InvalidFormat);
+}
+
+TEST(ConfigHandler, setValue) {
+  string const configFilePath = "../test/test_config.ini";
+  string const section = "MainParams";
+
+  shared_ptr<ConfigHandler> conf = ConfigHandler::getInstance();
+  auto setfile = conf->setConfigFilePath(configFilePath);
+  ASSERT_EQ(checkOptionalError(setfile), false);
+
+  conf->setValue(section, "port", "1234");
+  conf->setValue(section, "this_key_does_not_exist", "value");
+  EXPECT_EQ(get<int>(conf->getValueInt(section, "port")), 1234);
+  EXPECT_EQ(
+      get<string>(conf->getValueString(section, "this_key_does_not_exist")),
+      "value");
+
+  // loading the file again drops the overrides
+  setfile = conf->setConfigFilePath(configFilePath);
+  ASSERT_EQ(checkOptionalError(setfile), false);
+  EXPECT_EQ(get<int>(conf->getValueInt(section, "port")), 4711);
+  TResult<string> ret =
+      conf->getValueString(section, "this_key_does_not_exist");
+  EXPECT_EQ(checkAlternativeError(ret), true);
+}
+
+TEST(ConfigHandler, getKeys) {
+  string const configFilePath = "../test/test_config.ini";
+
+  shared_ptr<ConfigHandler> conf = ConfigHandler::getInstance();
+  auto setfile = conf->setConfigFilePath(configFilePath);
+  ASSERT_EQ(checkOptionalError(setfile), false);
+
+  conf->setValue("SomeMoreParams", "overridden", "9");
+  vector<string> expected = {"aRandomParam", "anotherOne", "overridden"};
+  EXPECT_EQ(conf->getKeys("SomeMoreParams"), expected);
+  EXPECT_TRUE(conf->getKeys("this_section_does_not_exist").empty());
+}
@@ -414,3 +414,142 @@ TEST(DataStoreTest, votetest) {
   restr = ds.getPlayingTrack();
   ASSERT_EQ(checkAlternativeError(restr), false);
 }
+
+TEST(DataStoreTest, QueueVersion) {
+  RAMDataStore ds;
+  size_t changes = 0;
+  ds.setChangeCallback([&changes]() { changes++; });
+  BaseTrack tr;
+  tr.trackId = "version_track";
+  tr.addedBy = "version_user";
+
+  User usr;
+  usr.SessionID = "version_sessionID";
+  usr.isAdmin = false;
+  usr.ExpirationDate = time(nullptr) + 10;
+  usr.Name = "version_user";
+  auto res = ds.addUser(usr);
+  ASSERT_EQ(checkOptionalError(res), false);
+
+  // every change of the queues results in a new version, which is announced
+  auto version = ds.getQueueVersion();
+  res = ds.addTrack(tr, QueueType::Normal);
+  ASSERT_EQ(checkOptionalError(res), false);
+  ASSERT_GT(ds.getQueueVersion(), version);
+  ASSERT_EQ(changes, 1);
+
+  // failed changes and reads keep the version
+  version = ds.getQueueVersion();
+  res = ds.addTrack(tr, QueueType::Normal);
+  ASSERT_EQ(checkOptionalError(res), true);
+  auto queue_res = ds.getQueue(QueueType::Normal);
+  ASSERT_EQ(checkAlternativeError(queue_res), false);
+  ASSERT_EQ(ds.getQueueVersion(), version);
+  ASSERT_EQ(changes, 1);
+
+  // votes change the queue as well as the votes of the user
+  auto votesVersion = get<User>(ds.getUser(usr.SessionID)).votesVersion;
+  res = ds.voteTrack(usr.SessionID, tr.trackId, true);
+  ASSERT_EQ(checkOptionalError(res), false);
+  ASSERT_GT(ds.getQueueVersion(), version);
+  ASSERT_GT(get<User>(ds.getUser(usr.SessionID)).votesVersion, votesVersion);
+  ASSERT_EQ(changes, 2);
+
+  // a duplicate vote changes nothing
+  version = ds.getQueueVersion();
+  votesVersion = get<User>(ds.getUser(usr.SessionID)).votesVersion;
+  res = ds.voteTrack(usr.SessionID, tr.trackId, true);
+  ASSERT_EQ(checkOptionalError(res), false);
+  ASSERT_EQ(ds.getQueueVersion(), version);
+  ASSERT_EQ(get<User>(ds.getUser(usr.SessionID)).votesVersion, votesVersion);
+  ASSERT_EQ(changes, 2);
+
+  version = ds.getQueueVersion();
+  res = ds.nextTrack();
+  ASSERT_EQ(checkOptionalError(res), false);
+  ASSERT_GT(ds.getQueueVersion(), version);
+  ASSERT_EQ(changes, 3);
+}
+
+TEST(DataStoreTest, GetQueueRange) {
+  RAMDataStore ds;
+  for (int i = 0; i < 10; i++) {
+    BaseTrack tr;
+    tr.trackId = "range_track" + to_string(i);
+    ds.addTrack(tr, QueueType::Normal);
+  }
+  auto whole = get<Queue>(ds.getQueue(QueueType::Normal));
+
+  for (auto [offset, limit, expected] : {tuple{0, 3, 3},
+                                         tuple{4, 3, 3},
+                                         tuple{8, 3, 2},
+                                         tuple{10, 3, 0},
+                                         tuple{20, 3, 0},
+                                         tuple{0, 0, 0},
+                                         tuple{2, 100, 8}}) {
+    auto res = ds.getQueueRange(QueueType::Normal, offset, limit);
+    ASSERT_EQ(checkAlternativeError(res), false);
+    auto range = get<Queue>(res);
+    ASSERT_EQ(range.tracks.size(), expected) << offset << ", " << limit;
+    ASSERT_EQ(range.totalSize, 10);
+    ASSERT_EQ(range.getTotalSize(), 10);
+    ASSERT_EQ(range.offset, min<size_t>(offset, 10));
+    ASSERT_EQ(range.version, whole.version);
+    for (size_t i = 0; i < range.tracks.size(); i++) {
+      ASSERT_EQ(range.tracks[i].trackId, whole.tracks[offset + i].trackId);
+    }
+  }
+
+  auto res = ds.getQueueRange(QueueType::Admin, 0, 5);
+  ASSERT_EQ(checkAlternativeError(res), false);
+  ASSERT_TRUE(get<Queue>(res).tracks.empty());
+  ASSERT_EQ(get<Queue>(res).totalSize, 0);
+}
+
+TEST(DataStoreTest, VoteTracks) {
+  RAMDataStore ds;
+  BaseTrack tr1, tr2, tr3;
+  tr1.trackId = "batch_track1";
+  tr2.trackId = "batch_track2";
+  tr3.trackId = "batch_track3";
+
+  User usr;
+  usr.SessionID = "batch_sessionID";
+  usr.isAdmin = false;
+  usr.ExpirationDate = time(nullptr) + 10;
+  usr.Name = "batch_user";
+  auto res = ds.addUser(usr);
+  ASSERT_EQ(checkOptionalError(res), false);
+  for (auto const &tr : {tr1, tr2, tr3}) {
+    res = ds.addTrack(tr, QueueType::Normal);
+    ASSERT_EQ(checkOptionalError(res), false);
+  }
+
+  // votes are applied in order, the queue is sorted afterwards
+  auto results = ds.voteTracks(usr.SessionID,
+                               {{tr3.trackId, true},
+                                {tr2.trackId, true},
+                                {tr2.trackId, false},
+                                {"unknown_track", true}});
+  ASSERT_EQ(results.size(), 4);
+  for (auto &result : results) {
+    ASSERT_EQ(checkOptionalError(result), false);
+  }
+  auto queue = get<Queue>(ds.getQueue(QueueType::Normal));
+  ASSERT_EQ(queue.tracks.size(), 3);
+  ASSERT_EQ(queue.tracks[0].trackId, tr3.trackId);
+  ASSERT_EQ(queue.tracks[0].votes, 1);
+  ASSERT_EQ(queue.tracks[1].votes, 0);
+  ASSERT_EQ(queue.tracks[2].votes, 0);
+
+  auto user = get<User>(ds.getUser(usr.SessionID));
+  ASSERT_EQ(user.votes.size(), 2);
+
+  // every vote fails for an unknown user
+  results = ds.voteTracks("unknown_sessionID",
+                          {{tr1.trackId, true}, {tr2.trackId, true}});
+  ASSERT_EQ(results.size(), 2);
+  for (auto &result : results) {
+    ASSERT_EQ(checkOptionalError(result), true);
+  }
+}
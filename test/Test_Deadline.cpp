@@ -0,0 +1,153 @@
+/*****************************************************************************/
+/**
+ * @file    Test_Deadline.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class Deadline
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "DispatchFixture.h"
+#include "MockNetworkListener.h"
+#include "Utils/ConfigHandler.h"
+#include "Utils/Deadline.h"
+#include "json/json.hpp"
+
+using namespace std;
+using namespace std::chrono;
+using namespace literals::chrono_literals;
+using json = nlohmann::json;
+
+/**
+ * @brief Listener whose track queries take some time, like the ones sent to
+ * Spotify, and respect the deadline afterwards.
+ */
+class SlowNetworkListener : public MockNetworkListener {
+ public:
+  TResult<vector<BaseTrack>> queryTracks(string const &,
+                                         size_t const) override {
+    remaining = Deadline::remaining();
+    this_thread::sleep_for(delay);
+    if (auto expired = Deadline::check()) {
+      return expired.value();
+    }
+    count++;
+    return vector<BaseTrack>{};
+  }
+
+  size_t count = 0;
+  milliseconds delay = 0ms;
+  optional<milliseconds> remaining;
+};
+
+class DeadlineFixture : public DispatchFixture<SlowNetworkListener> {
+ protected:
+  ResponseInformation queryTracks(RequestHeaders headers = {}) {
+    RequestInformation request{"/api/v1/queryTracks",
+                               "GET",
+                               "",
+                               {{"pattern", "some pattern"}},
+                               move(headers)};
+    return dispatch(move(request));
+  }
+};
+
+TEST_F(DeadlineFixture, Scope) {
+  EXPECT_FALSE(Deadline::remaining().has_value());
+  EXPECT_FALSE(Deadline::check().has_value());
+  {
+    Deadline::Scope outer(1s);
+    ASSERT_TRUE(Deadline::remaining().has_value());
+    EXPECT_LE(Deadline::remaining().value(), 1000ms);
+    EXPECT_GT(Deadline::remaining().value(), 500ms);
+
+    // inner scopes never extend the deadline
+    {
+      Deadline::Scope inner(1h);
+      EXPECT_LE(Deadline::remaining().value(), 1000ms);
+    }
+    {
+      Deadline::Scope inner(nullopt);
+      EXPECT_LE(Deadline::remaining().value(), 1000ms);
+    }
+    {
+      Deadline::Scope inner(0ms);
+      EXPECT_TRUE(Deadline::isExpired());
+      EXPECT_EQ(Deadline::remaining().value(), 0ms);
+      auto error = Deadline::check();
+      ASSERT_TRUE(error.has_value());
+      EXPECT_EQ(error.value().getErrorCode(), ErrorCode::DeadlineExceeded);
+    }
+    EXPECT_FALSE(Deadline::isExpired());
+  }
+  EXPECT_FALSE(Deadline::remaining().has_value());
+
+  // other threads are not affected
+  Deadline::Scope expired(0ms);
+  thread([]() { EXPECT_FALSE(Deadline::isExpired()); }).join();
+}
+
+TEST_F(DeadlineFixture, Timeouts) {
+  // see section `RequestTimeouts` of the test configuration
+  EXPECT_EQ(Deadline::configuredTimeout("queryTracks"), 50ms);
+  EXPECT_EQ(Deadline::configuredTimeout("generateSession"), 5000ms);
+  EXPECT_FALSE(Deadline::configuredTimeout("events").has_value());
+
+  // the timeouts are read when the server starts, not by each request
+  auto config = ConfigHandler::getInstance();
+  config->setValue("RequestTimeouts", "queryTracks", "0");
+  config->setValue("RequestTimeouts", "default", "700");
+  EXPECT_EQ(Deadline::configuredTimeout("queryTracks"), 50ms);
+  ASSERT_FALSE(Deadline::configure().has_value());
+  EXPECT_FALSE(Deadline::configuredTimeout("queryTracks").has_value());
+  EXPECT_EQ(Deadline::configuredTimeout("generateSession"), 700ms);
+  config->setValue("RequestTimeouts", "queryTracks", "5x");
+  EXPECT_TRUE(Deadline::configure().has_value());
+
+  EXPECT_EQ(Deadline::parseTimeout("250"), 250ms);
+  for (auto value : {"", "0", "-5", "12x", " 12", "99999999999999999999"}) {
+    EXPECT_FALSE(Deadline::parseTimeout(value).has_value()) << value;
+  }
+}
+
+TEST_F(DeadlineFixture, Dispatch) {
+  // the deadline is set while the request is handled only
+  auto response = queryTracks();
+  EXPECT_EQ(response.code, 200);
+  ASSERT_TRUE(listener.remaining.has_value());
+  EXPECT_LE(listener.remaining.value(), 50ms);
+  EXPECT_FALSE(Deadline::remaining().has_value());
+
+  // clients may shorten the timeout, but not extend it
+  queryTracks({{"X-Request-Timeout-Ms", "5"}});
+  EXPECT_LE(listener.remaining.value(), 5ms);
+  queryTracks({{"X-Request-Timeout-Ms", "100000"}});
+  EXPECT_LE(listener.remaining.value(), 50ms);
+
+  listener.delay = 80ms;
+  response = queryTracks();
+  EXPECT_EQ(response.code, 504);
+  EXPECT_EQ(json::parse(response.body)["status"], 504);
+}
+
+TEST_F(DeadlineFixture, Batch) {
+  listener.delay = 30ms;
+  json request = {{"path", "/queryTracks"},
+                  {"method", "GET"},
+                  {"args", {{"pattern", "x"}}}};
+  string body = json({{"requests", {request, request, request}}}).dump();
+
+  // the third request is skipped once the deadline of the batch has passed
+  RequestInformation batch{
+      "/api/v1/batch", "POST", body, {}, {{"X-Request-Timeout-Ms", "50"}}};
+  auto response = dispatch(move(batch));
+  ASSERT_EQ(response.code, 200);
+  auto responses = json::parse(response.body)["responses"];
+  EXPECT_EQ(responses[0]["status"], 200);
+  EXPECT_EQ(responses[1]["status"], 504);
+  EXPECT_EQ(responses[2]["status"], 504);
+  EXPECT_EQ(listener.count, 1);
+}
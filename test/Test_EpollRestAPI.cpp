@@ -0,0 +1,341 @@
+/*****************************************************************************/
+/**
+ * @file    Test_EpollRestAPI.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class EpollRestAPI
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+
+#include "Network/EventStream.h"
+#include "RestAPIFixture.h"
+#include "Utils/ConfigHandler.h"
+#include "Utils/Serializer.h"
+#include "json/json.hpp"
+
+using namespace std;
+using namespace literals::chrono_literals;
+using json = nlohmann::json;
+
+/**
+ * @brief Test cases which depend on the behaviour of `EpollRestAPI`, e.g. on
+ * the responses to malformed requests.
+ */
+class EpollRestAPIFixture : public RestAPIFixture {};
+
+INSTANTIATE_TEST_SUITE_P(Implementations,
+                         EpollRestAPIFixture,
+                         ::testing::Values("epoll"),
+                         RestAPIFixture::implementationName);
+
+TEST_P(EpollRestAPIFixture, KeepAliveAndPipelining) {
+  auto tracks = gen.generateTracks(3);
+  listener.setResponseQueryTracks(tracks);
+  json expectedTracks = {{"tracks", json::array()}};
+  for (auto &&track : tracks) {
+    expectedTracks["tracks"].push_back(Serializer::serialize(track));
+  }
+  auto queueStatus = gen.generateQueueStatus(5, 1, true);
+  listener.setResponseGetCurrentQueues(queueStatus);
+
+  int fd = connectToServer();
+
+  // all requests in a single packet, answered in order
+  sendAll(fd,
+          "GET /api/v1/queryTracks?pattern=some%20pattern&max_entries=3 "
+          "HTTP/1.1\r\nHost: localhost\r\n\r\n"
+          "GET /api/v1/getCurrentQueues?session_id=abc HTTP/1.1\r\n\r\n"
+          "GET /api/v1/unknown HTTP/1.1\r\n\r\n");
+
+  auto response = readResponse(fd);
+  ASSERT_EQ(response.code, 200);
+  EXPECT_NE(response.head.find("Connection: keep-alive"), string::npos);
+  EXPECT_EQ(json::parse(response.body), expectedTracks);
+  string pattern;
+  int maxEntries;
+  listener.getLastParametersQueryTracks(pattern, maxEntries);
+  EXPECT_EQ(pattern, "some pattern");
+  EXPECT_EQ(maxEntries, 3);
+
+  response = readResponse(fd);
+  ASSERT_EQ(response.code, 200);
+  EXPECT_EQ(json::parse(response.body), Serializer::serialize(queueStatus));
+  EXPECT_NE(response.head.find("ETag: "), string::npos);
+
+  response = readResponse(fd);
+  ASSERT_EQ(response.code, 404);
+
+  // the connection stays open, also for requests split into several packets
+  string body = "{\"nickname\": \"somebody\"}";
+  string request =
+      "POST /api/v1/generateSession HTTP/1.1\r\n"
+      "Content-Type: application/json\r\n"
+      "Content-Length: " +
+      to_string(body.size()) + "\r\n\r\n" + body;
+  listener.setResponseGenerateSession("session");
+  sendAll(fd, request.substr(0, 30));
+  this_thread::sleep_for(5ms);
+  sendAll(fd, request.substr(30, 50));
+  this_thread::sleep_for(5ms);
+  sendAll(fd, request.substr(80));
+
+  response = readResponse(fd);
+  ASSERT_EQ(response.code, 200);
+  EXPECT_EQ(json::parse(response.body)["session_id"], "session");
+  EXPECT_EQ(listener.getCountGenerateSession(), 1);
+
+  close(fd);
+}
+
+TEST_P(EpollRestAPIFixture, NoContent) {
+  listener.setResponseGetCurrentQueuesVersion({1, 1, 1});
+  int fd = connectToServer();
+
+  // a 304 has neither a body nor a length, the connection stays usable
+  sendAll(fd, "GET /api/v1/getCurrentQueues?session_id=abc HTTP/1.1\r\n\r\n");
+  auto response = readResponse(fd);
+  ASSERT_EQ(response.code, 200);
+  auto etagStart = response.head.find("ETag: ") + 6;
+  auto etag = response.head.substr(
+      etagStart, response.head.find("\r\n", etagStart) - etagStart);
+
+  sendAll(fd,
+          "GET /api/v1/getCurrentQueues?session_id=abc HTTP/1.1\r\n"
+          "If-None-Match: " +
+              etag + "\r\n\r\n");
+  response = readResponse(fd);
+  ASSERT_EQ(response.code, 304);
+  EXPECT_EQ(response.head.find("Content-Length"), string::npos);
+
+  sendAll(fd, "GET /api/v1/unknown HTTP/1.1\r\n\r\n");
+  EXPECT_EQ(readResponse(fd).code, 404);
+  close(fd);
+}
+
+TEST_P(EpollRestAPIFixture, ConnectionClose) {
+  listener.setResponseQueryTracks(gen.generateTracks(1));
+
+  int fd = connectToServer();
+  sendAll(fd,
+          "GET /api/v1/queryTracks?pattern=a HTTP/1.1\r\n"
+          "Connection: close\r\n\r\n"
+          "GET /api/v1/queryTracks?pattern=b HTTP/1.1\r\n\r\n");
+  auto response = readResponse(fd);
+  ASSERT_EQ(response.code, 200);
+  EXPECT_NE(response.head.find("Connection: close"), string::npos);
+
+  // the second request is not answered
+  EXPECT_FALSE(receive(fd));
+  EXPECT_EQ(listener.getCountQueryTracks(), 1);
+  close(fd);
+}
+
+TEST_P(EpollRestAPIFixture, MalformedRequests) {
+  for (auto [request, code] : {
+           pair{"NONSENSE\r\n\r\n", 400},
+           pair{"POST /api/v1/generateSession HTTP/1.1\r\n"
+                "Content-Length: 2\r\nContent-Length: 0\r\n\r\n{}",
+                400},
+           pair{"GET /api/v1/queryTracks HTTP/2.0\r\n\r\n", 501},
+           pair{"POST /api/v1/generateSession HTTP/1.1\r\n"
+                "Content-Length: 100000000\r\n\r\n",
+                413},
+       }) {
+    int fd = connectToServer();
+    sendAll(fd, request);
+    auto response = readResponse(fd);
+    EXPECT_EQ(response.code, code) << request;
+    EXPECT_FALSE(receive(fd)) << request;
+    close(fd);
+  }
+}
+
+TEST_P(EpollRestAPIFixture, ManyConnections) {
+  listener.setResponseQueryTracks(gen.generateTracks(2));
+
+  // connections are distributed among the event loops
+  vector<int> fds;
+  for (int i = 0; i < 20; i++) {
+    fds.push_back(connectToServer());
+  }
+  for (int round = 0; round < 3; round++) {
+    for (int fd : fds) {
+      sendAll(fd, "GET /api/v1/queryTracks?pattern=x HTTP/1.1\r\n\r\n");
+    }
+    for (int fd : fds) {
+      ASSERT_EQ(readResponse(fd).code, 200);
+    }
+  }
+  for (int fd : fds) {
+    close(fd);
+  }
+  EXPECT_EQ(listener.getCountQueryTracks(), 60);
+}
+
+/**
+ * @brief Serves a static directory, which is created before the server
+ * starts.
+ */
+class EpollRestAPIStaticFixture : public RestAPIFixture {
+ protected:
+  EpollRestAPIStaticFixture() {
+    EXPECT_EQ(system(("rm -rf " + ROOT + " && mkdir -p " + ROOT).c_str()), 0);
+    configOverrides["staticDirectory"] = ROOT;
+  }
+
+  ~EpollRestAPIStaticFixture() override {
+    system(("rm -rf " + ROOT).c_str());
+  }
+
+  static string const ROOT;
+};
+
+string const EpollRestAPIStaticFixture::ROOT = "/tmp/jukebox_test_static";
+
+INSTANTIATE_TEST_SUITE_P(Implementations,
+                         EpollRestAPIStaticFixture,
+                         ::testing::Values("epoll"),
+                         RestAPIFixture::implementationName);
+
+TEST_P(EpollRestAPIStaticFixture, StaticFiles) {
+  string content(3 * 1024 * 1024, 'x');
+  ofstream(ROOT + "/big.js") << content;
+  ofstream(ROOT + "/index.html") << "<html></html>";
+
+  // the file bodies are sent in order with the pipelined responses
+  int fd = connectToServer();
+  sendAll(fd,
+          "GET /big.js HTTP/1.1\r\n\r\n"
+          "HEAD /big.js HTTP/1.1\r\n\r\n"
+          "GET / HTTP/1.1\r\n\r\n"
+          "GET /missing.js HTTP/1.1\r\n\r\n");
+
+  auto response = readResponse(fd);
+  ASSERT_EQ(response.code, 200);
+  EXPECT_EQ(response.body.size(), content.size());
+  EXPECT_EQ(response.body, content);
+  EXPECT_NE(response.head.find("Content-Type: text/javascript"), string::npos);
+
+  // the length of the body, but no body
+  response = readResponse(fd, true);
+  ASSERT_EQ(response.code, 200);
+  EXPECT_NE(response.head.find("Content-Length: " + to_string(content.size())),
+            string::npos);
+
+  response = readResponse(fd);
+  ASSERT_EQ(response.code, 200);
+  EXPECT_EQ(response.body, "<html></html>");
+
+  response = readResponse(fd);
+  ASSERT_EQ(response.code, 404);
+
+  close(fd);
+}
+
+TEST_P(EpollRestAPIFixture, HandlerThreads) {
+  // every admitted request needs a handler (4 + 1 in the test configuration)
+  ConfigHandler::getInstance()->setValue("RestAPI", "handlerThreads", "4");
+  auto created = NetworkAPI::create();
+  ASSERT_TRUE(holds_alternative<unique_ptr<NetworkAPI>>(created));
+  auto result = std::get<unique_ptr<NetworkAPI>>(created)->handleRequests();
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result.value().getErrorCode(), ErrorCode::InvalidValue);
+}
+
+/**
+ * @brief Runs a single event loop, which serves all connections.
+ */
+class EpollRestAPISingleLoopFixture : public RestAPIFixture {
+ protected:
+  EpollRestAPISingleLoopFixture() {
+    configOverrides["workerThreads"] = "1";
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(Implementations,
+                         EpollRestAPISingleLoopFixture,
+                         ::testing::Values("epoll"),
+                         RestAPIFixture::implementationName);
+
+TEST_P(EpollRestAPISingleLoopFixture, SlowRequests) {
+  listener.setResponseQueryTracks(gen.generateTracks(1));
+  listener.setResponseGetCurrentQueues(gen.generateQueueStatus(2, 1, true));
+  listener.setDelayQueryTracks(500ms);
+
+  // a slow request does not hold up the other connections of its loop
+  int slowFd = connectToServer();
+  sendAll(slowFd, "GET /api/v1/queryTracks?pattern=a HTTP/1.1\r\n\r\n");
+  this_thread::sleep_for(20ms);
+
+  auto start = chrono::steady_clock::now();
+  int fd = connectToServer();
+  sendAll(fd, "GET /api/v1/getCurrentQueues?session_id=abc HTTP/1.1\r\n\r\n");
+  EXPECT_EQ(readResponse(fd).code, 200);
+  EXPECT_LT(chrono::steady_clock::now() - start, 300ms);
+  EXPECT_EQ(listener.getCountQueryTracks(), 0);
+
+  // pipelined requests still wait for the preceding ones
+  sendAll(slowFd, "GET /api/v1/unknown HTTP/1.1\r\n\r\n");
+  EXPECT_EQ(readResponse(slowFd).code, 200);
+  EXPECT_EQ(readResponse(slowFd).code, 404);
+  EXPECT_EQ(listener.getCountQueryTracks(), 1);
+
+  // connections closed while their request is handled are dropped
+  sendAll(slowFd, "GET /api/v1/queryTracks?pattern=b HTTP/1.1\r\n\r\n");
+  this_thread::sleep_for(20ms);
+  close(slowFd);
+  this_thread::sleep_for(600ms);
+  EXPECT_EQ(listener.getCountQueryTracks(), 2);
+  sendAll(fd, "GET /api/v1/unknown HTTP/1.1\r\n\r\n");
+  EXPECT_EQ(readResponse(fd).code, 404);
+  close(fd);
+}
+
+TEST_P(EpollRestAPISingleLoopFixture, EventStreams) {
+  listener.setResponseGetCurrentQueues(gen.generateQueueStatus(2, 1, true));
+  listener.setResponseGetCurrentQueuesVersion({1, 1, 1});
+
+  // the streams share the loop with the other connections and the queues of
+  // the same version
+  int streamFds[2];
+  for (int &streamFd : streamFds) {
+    streamFd = connectToServer();
+    sendAll(streamFd, "GET /api/v1/events?session_id=sse HTTP/1.1\r\n\r\n");
+    ASSERT_TRUE(receiveUntil(streamFd, "event: queues\n"));
+    pending.clear();
+  }
+  EXPECT_EQ(listener.getCountGetCurrentQueues(), 1);
+
+  int fd = connectToServer();
+  sendAll(fd, "GET /api/v1/unknown HTTP/1.1\r\n\r\n");
+  EXPECT_EQ(readResponse(fd).code, 404);
+  close(fd);
+
+  listener.setResponseGetCurrentQueuesVersion({2, 1, 1});
+  EventStream::notifyChange();
+  for (int streamFd : streamFds) {
+    ASSERT_TRUE(receiveUntil(streamFd, "event: queues\n"));
+    pending.clear();
+  }
+  EXPECT_EQ(listener.getCountGetCurrentQueues(), 2);
+
+  // stopping the server closes the streams, the listener is not called
+  // afterwards
+  api->stopServer();
+  serverThread.join();
+  for (int streamFd : streamFds) {
+    EXPECT_FALSE(receive(streamFd));
+    close(streamFd);
+  }
+  auto versionCount = listener.getCountGetCurrentQueuesVersion();
+  EventStream::notifyChange();
+  this_thread::sleep_for(50ms);
+  EXPECT_EQ(listener.getCountGetCurrentQueuesVersion(), versionCount);
+}
@@ -0,0 +1,171 @@
+/*****************************************************************************/
+/**
+ * @file    Test_HttpParser.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class HttpParser
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "Network/HttpParser.h"
+
+using namespace std;
+
+static size_t const MAX_SIZE = 1024;
+
+TEST(HttpParser, Request) {
+  string buffer =
+      "GET /api/v1/queryTracks?pattern=a%20b&max_entries=5 HTTP/1.1\r\n"
+      "Host: localhost\r\n"
+      "accept-encoding:  gzip \r\n"
+      "\r\n";
+
+  HttpRequestView request;
+  ASSERT_EQ(HttpParser::parse(buffer, request, MAX_SIZE),
+            HttpParseResult::Complete);
+  EXPECT_EQ(request.method, "GET");
+  EXPECT_EQ(request.path, "/api/v1/queryTracks");
+  EXPECT_EQ(request.query, "pattern=a%20b&max_entries=5");
+  EXPECT_TRUE(request.body.empty());
+  EXPECT_TRUE(request.keepAlive);
+  EXPECT_EQ(request.size, buffer.size());
+  EXPECT_EQ(request.headers.size(), 2);
+  EXPECT_EQ(request.header("Accept-Encoding"), "gzip");
+  EXPECT_EQ(request.header("host"), "localhost");
+  EXPECT_TRUE(request.header("Accept").empty());
+
+  // the views refer to the buffer
+  EXPECT_EQ(request.method.data(), buffer.data());
+}
+
+TEST(HttpParser, Pipelining) {
+  string first =
+      "POST /api/v1/generateSession HTTP/1.1\r\n"
+      "Content-Length: 11\r\n"
+      "\r\n"
+      "{\"a\": \"b\"}\n";
+  string second = "GET /api/v1/getCurrentQueues HTTP/1.1\r\n\r\n";
+  string buffer = first + second;
+
+  HttpRequestView request;
+  ASSERT_EQ(HttpParser::parse(buffer, request, MAX_SIZE),
+            HttpParseResult::Complete);
+  EXPECT_EQ(request.method, "POST");
+  EXPECT_EQ(request.body, "{\"a\": \"b\"}\n");
+  ASSERT_EQ(request.size, first.size());
+
+  ASSERT_EQ(HttpParser::parse(string_view(buffer).substr(request.size),
+                              request,
+                              MAX_SIZE),
+            HttpParseResult::Complete);
+  EXPECT_EQ(request.path, "/api/v1/getCurrentQueues");
+  EXPECT_TRUE(request.query.empty());
+  EXPECT_EQ(request.size, second.size());
+
+  // every prefix of a request is incomplete
+  for (size_t size = 0; size < first.size(); size++) {
+    ASSERT_EQ(HttpParser::parse(first.substr(0, size), request, MAX_SIZE),
+              HttpParseResult::Incomplete)
+        << size;
+  }
+}
+
+TEST(HttpParser, KeepAlive) {
+  HttpRequestView request;
+  for (auto [buffer, keepAlive] : {
+           pair{"GET / HTTP/1.1\r\n\r\n", true},
+           pair{"GET / HTTP/1.1\r\nConnection: close\r\n\r\n", false},
+           pair{"GET / HTTP/1.1\r\nConnection: Upgrade, Close\r\n\r\n", false},
+           pair{"GET / HTTP/1.0\r\n\r\n", false},
+           pair{"GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\n", true},
+       }) {
+    ASSERT_EQ(HttpParser::parse(buffer, request, MAX_SIZE),
+              HttpParseResult::Complete)
+        << buffer;
+    EXPECT_EQ(request.keepAlive, keepAlive) << buffer;
+  }
+}
+
+TEST(HttpParser, Errors) {
+  HttpRequestView request;
+  for (auto [buffer, result] : {
+           pair{"GET\r\n\r\n", HttpParseResult::Invalid},
+           pair{"GET /\r\n\r\n", HttpParseResult::Invalid},
+           pair{"GET api HTTP/1.1\r\n\r\n", HttpParseResult::Invalid},
+           pair{"GET / HTTP/1.1\r\nNo colon\r\n\r\n", HttpParseResult::Invalid},
+           pair{"GET / HTTP/1.1\r\nBad name: x\r\n\r\n",
+                HttpParseResult::Invalid},
+           pair{"GET / HTTP/1.1\r\nContent-Length: -1\r\n\r\n",
+                HttpParseResult::Invalid},
+           pair{"POST / HTTP/1.1\r\nContent-Length: 1\r\n"
+                "content-length: 2\r\n\r\nab",
+                HttpParseResult::Invalid},
+           pair{"GET / HTTP/2.0\r\n\r\n", HttpParseResult::NotImplemented},
+           pair{"POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n",
+                HttpParseResult::NotImplemented},
+           pair{"POST / HTTP/1.1\r\nContent-Length: 2000\r\n\r\n",
+                HttpParseResult::TooLarge},
+       }) {
+    EXPECT_EQ(HttpParser::parse(buffer, request, MAX_SIZE), result) << buffer;
+  }
+
+  // repeated lengths are fine as long as they agree
+  EXPECT_EQ(HttpParser::parse("POST / HTTP/1.1\r\nContent-Length: 2\r\n"
+                              "Content-Length: 2\r\n\r\nab",
+                              request,
+                              MAX_SIZE),
+            HttpParseResult::Complete);
+  EXPECT_EQ(request.body, "ab");
+
+  // headers without end exceeding the limit
+  string endless = "GET / HTTP/1.1\r\nX: " + string(MAX_SIZE, 'x');
+  EXPECT_EQ(HttpParser::parse(endless, request, MAX_SIZE),
+            HttpParseResult::TooLarge);
+}
+
+TEST(HttpParser, Decode) {
+  EXPECT_EQ(HttpParser::decode("a%20b+c"), "a b+c");
+  EXPECT_EQ(HttpParser::decode("a%20b+c", true), "a b c");
+  EXPECT_EQ(HttpParser::decode("%C3%A4%2f"), "\xc3\xa4/");
+  // invalid escapes are kept
+  EXPECT_EQ(HttpParser::decode("100%"), "100%");
+  EXPECT_EQ(HttpParser::decode("%zz%4"), "%zz%4");
+
+  string query = "pattern=a+b%26c&&flag&max_entries=5&flag=x&a%20b=c";
+  EXPECT_EQ(HttpParser::findQueryParameter(query, "pattern"), "a b&c");
+  EXPECT_EQ(HttpParser::findQueryParameter(query, "flag"), "");
+  EXPECT_EQ(HttpParser::findQueryParameter(query, "max_entries"), "5");
+  EXPECT_EQ(HttpParser::findQueryParameter(query, "a b"), "c");
+  EXPECT_EQ(HttpParser::findQueryParameter(query, "max"), nullopt);
+  EXPECT_EQ(HttpParser::findQueryParameter(query, ""), nullopt);
+}
+
+TEST(HttpParser, ResponseHead) {
+  string head;
+  HttpParser::writeResponseHead(
+      head, 200, {{"Content-Type", "application/json"}}, 42, true);
+  EXPECT_EQ(head,
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: application/json\r\n"
+            "Content-Length: 42\r\n"
+            "Connection: keep-alive\r\n"
+            "\r\n");
+
+  // responses without body have no length either
+  for (int code : {204, 304}) {
+    head.clear();
+    HttpParser::writeResponseHead(head, code, {{"ETag", "\"1\""}}, 0, true);
+    EXPECT_EQ(head.find("Content-Length"), string::npos) << head;
+    EXPECT_FALSE(HttpParser::allowsBody(code));
+  }
+  EXPECT_TRUE(HttpParser::allowsBody(200));
+
+  head.clear();
+  HttpParser::writeResponseHead(head, 404, {}, nullopt, false);
+  EXPECT_EQ(head,
+            "HTTP/1.1 404 Not Found\r\n"
+            "Content-Type: text/plain\r\n"
+            "Connection: close\r\n"
+            "\r\n");
+}
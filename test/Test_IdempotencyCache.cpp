@@ -0,0 +1,134 @@
+/*****************************************************************************/
+/**
+ * @file    Test_IdempotencyCache.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class IdempotencyCache
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "DispatchFixture.h"
+#include "Network/IdempotencyCache.h"
+#include "Utils/ConfigHandler.h"
+#include "json/json.hpp"
+
+using namespace std;
+using namespace literals::chrono_literals;
+using json = nlohmann::json;
+using Result = IdempotencyCache::Lookup::Result;
+
+class IdempotencyCacheFixture : public DispatchFixture<> {
+ protected:
+  void SetUp() override {
+    DispatchFixture::SetUp();
+    IdempotencyCache::clear();
+  }
+
+  ResponseInformation addTrack(string const &body, RequestHeaders headers) {
+    RequestInformation request{
+        "/api/v1/addTrackToQueue", "POST", body, {}, move(headers)};
+    return dispatch(move(request));
+  }
+};
+
+TEST_F(IdempotencyCacheFixture, Lookup) {
+  auto first = IdempotencyCache::lookup("POST /addTrackToQueue", "k", "body");
+  ASSERT_EQ(first.result, Result::New);
+  ASSERT_TRUE(first.reservation);
+
+  // retries wait for the first attempt to finish
+  EXPECT_EQ(IdempotencyCache::lookup("POST /addTrackToQueue", "k", "body")
+                .result,
+            Result::InProgress);
+  first.reservation.complete({"{}", 200, {{"X-Some", "value"}}});
+  EXPECT_FALSE(first.reservation);
+
+  auto retry = IdempotencyCache::lookup("POST /addTrackToQueue", "k", "body");
+  ASSERT_EQ(retry.result, Result::Replay);
+  EXPECT_FALSE(retry.reservation);
+  EXPECT_EQ(retry.response.body, "{}");
+  EXPECT_EQ(retry.response.headers["X-Some"], "value");
+
+  // keys belong to a single request of a single endpoint
+  EXPECT_EQ(
+      IdempotencyCache::lookup("POST /addTrackToQueue", "k", "other").result,
+      Result::Mismatch);
+  EXPECT_EQ(IdempotencyCache::lookup("PUT /voteTrack", "k", "body").result,
+            Result::New);
+  EXPECT_EQ(IdempotencyCache::size(), 1);
+}
+
+TEST_F(IdempotencyCacheFixture, Release) {
+  // failed and abandoned attempts may be retried
+  auto failed = IdempotencyCache::lookup("POST /generateSession", "k", "");
+  failed.reservation.complete({"", 502});
+  EXPECT_EQ(IdempotencyCache::size(), 0);
+
+  {
+    auto abandoned = IdempotencyCache::lookup("POST /generateSession", "k", "");
+    EXPECT_EQ(IdempotencyCache::size(), 1);
+  }
+  EXPECT_EQ(IdempotencyCache::size(), 0);
+}
+
+TEST_F(IdempotencyCacheFixture, Bounds) {
+  // see keys `idempotencyCacheSize` and `idempotencyTtlSeconds`
+  for (auto key : {"1", "2", "3", "4", "5"}) {
+    IdempotencyCache::lookup("POST /batch", key, "")
+        .reservation.complete({"", 200});
+  }
+  EXPECT_EQ(IdempotencyCache::size(), 4);
+  EXPECT_EQ(IdempotencyCache::lookup("POST /batch", "1", "").result,
+            Result::New);
+
+  this_thread::sleep_for(1100ms);
+  auto expired = IdempotencyCache::lookup("POST /batch", "2", "");
+  EXPECT_EQ(expired.result, Result::New);
+  EXPECT_EQ(IdempotencyCache::size(), 1);
+}
+
+TEST_F(IdempotencyCacheFixture, Configure) {
+  // the configuration is read when the server starts, not by each request
+  auto config = ConfigHandler::getInstance();
+  config->setValue("RestAPI", "idempotencyCacheSize", "0");
+  EXPECT_TRUE(IdempotencyCache::lookup("POST /batch", "1", "").reservation);
+
+  ASSERT_FALSE(IdempotencyCache::configure().has_value());
+  EXPECT_FALSE(IdempotencyCache::lookup("POST /batch", "2", "").reservation);
+
+  config->setValue("RestAPI", "idempotencyTtlSeconds", "-1");
+  auto error = IdempotencyCache::configure();
+  ASSERT_TRUE(error.has_value());
+  EXPECT_EQ(error.value().getErrorCode(), ErrorCode::InvalidValue);
+}
+
+TEST_F(IdempotencyCacheFixture, Dispatch) {
+  string body =
+      json({{"session_id", "s"}, {"track_id", "spotify:track:1"}}).dump();
+  auto response = addTrack(body, {{"Idempotency-Key", "abc"}});
+  EXPECT_EQ(response.code, 200);
+  EXPECT_EQ(response.headers.count("Idempotent-Replayed"), 0);
+  EXPECT_EQ(listener.getCountAddTrackToQueue(), 1);
+
+  // the retry does not reach the listener
+  response = addTrack(body, {{"Idempotency-Key", "abc"}});
+  EXPECT_EQ(response.code, 200);
+  EXPECT_EQ(response.body, "{}");
+  EXPECT_EQ(response.headers["Idempotent-Replayed"], "true");
+  EXPECT_EQ(listener.getCountAddTrackToQueue(), 1);
+
+  string otherBody =
+      json({{"session_id", "s"}, {"track_id", "spotify:track:2"}}).dump();
+  response = addTrack(otherBody, {{"Idempotency-Key", "abc"}});
+  EXPECT_EQ(response.code, 422);
+  response = addTrack(body, {{"Idempotency-Key", ""}});
+  EXPECT_EQ(response.code, 400);
+
+  // requests without a key are handled each time
+  addTrack(body, {});
+  addTrack(body, {});
+  EXPECT_EQ(listener.getCountAddTrackToQueue(), 3);
+}
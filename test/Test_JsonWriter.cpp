@@ -0,0 +1,82 @@
+/*****************************************************************************/
+/**
+ * @file    Test_JsonWriter.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class JsonWriter
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "TrackGenerator.h"
+#include "Utils/JsonWriter.h"
+#include "Utils/Serializer.h"
+#include "json/json.hpp"
+
+using namespace std;
+using json = nlohmann::json;
+
+TEST(JsonWriter, Structure) {
+  JsonWriter writer;
+  writer.beginObject()
+      .key("array")
+      .beginArray()
+      .value(1)
+      .value(-2)
+      .value(true)
+      .value("str")
+      .beginObject()
+      .endObject()
+      .beginArray()
+      .endArray()
+      .endArray()
+      .key("number")
+      .value(4294967295u)
+      .key("raw")
+      .rawValue("{\"a\":null}")
+      .endObject();
+  ASSERT_EQ(writer.str(),
+            "{\"array\":[1,-2,true,\"str\",{},[]],\"number\":4294967295,"
+            "\"raw\":{\"a\":null}}");
+
+  // the buffer can be moved out and the writer reused
+  auto document = writer.release();
+  ASSERT_FALSE(document.empty());
+  ASSERT_TRUE(writer.str().empty());
+  writer.beginArray().endArray();
+  ASSERT_EQ(writer.str(), "[]");
+  writer.clear();
+  writer.value(false);
+  ASSERT_EQ(writer.str(), "false");
+}
+
+TEST(JsonWriter, Escaping) {
+  string str = "quote\" backslash\\ \b\f\n\r\t \x01\x1f umlaut ä €";
+  JsonWriter writer;
+  writer.value(str);
+  ASSERT_EQ(writer.str(), json(str).dump());
+  ASSERT_EQ(json::parse(writer.str()).get<string>(), str);
+}
+
+TEST(JsonWriter, MatchesSerializer) {
+  TrackGenerator gen;
+
+  auto queueStatus = gen.generateQueueStatus(10, 3, true);
+  queueStatus.normalQueue.tracks[0].title = "special \"title\"\n";
+  queueStatus.normalQueue.tracks[1].userHasVoted = true;
+
+  JsonWriter writer;
+  Serializer::write(writer, queueStatus);
+  ASSERT_EQ(writer.str(), Serializer::serialize(queueStatus).dump());
+
+  queueStatus.currentTrack.reset();
+  writer.clear();
+  Serializer::write(writer, queueStatus);
+  ASSERT_EQ(writer.str(), Serializer::serialize(queueStatus).dump());
+
+  for (auto &&track : gen.generateTracks(5)) {
+    writer.clear();
+    Serializer::write(writer, track);
+    ASSERT_EQ(writer.str(), Serializer::serialize(track).dump());
+  }
+}
@@ -0,0 +1,87 @@
+/*****************************************************************************/
+/**
+ * @file    Test_ListenSocket.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class ListenSocket
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <fstream>
+
+#include "Network/ListenSocket.h"
+
+using namespace std;
+
+static string const SOCKET_PATH = "/tmp/jukebox_test_listen.sock";
+
+static bool connectUnix(string const &path) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  path.copy(address.sun_path, path.size());
+  bool connected =
+      connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) ==
+      0;
+  close(fd);
+  return connected;
+}
+
+TEST(ListenSocket, Unix) {
+  unlink(SOCKET_PATH.c_str());
+
+  auto res = ListenSocket::openUnix(SOCKET_PATH);
+  ASSERT_TRUE(holds_alternative<int>(res));
+  int fd = get<int>(res);
+  EXPECT_TRUE(connectUnix(SOCKET_PATH));
+
+  // a socket in use is not taken over
+  res = ListenSocket::openUnix(SOCKET_PATH);
+  ASSERT_TRUE(holds_alternative<Error>(res));
+  EXPECT_EQ(get<Error>(res).getErrorCode(), ErrorCode::AlreadyExists);
+
+  // a stale socket file is replaced
+  close(fd);
+  struct stat status;
+  ASSERT_EQ(lstat(SOCKET_PATH.c_str(), &status), 0);
+  res = ListenSocket::openUnix(SOCKET_PATH);
+  ASSERT_TRUE(holds_alternative<int>(res));
+  EXPECT_TRUE(connectUnix(SOCKET_PATH));
+
+  ListenSocket::closeUnix(get<int>(res), SOCKET_PATH);
+  EXPECT_NE(lstat(SOCKET_PATH.c_str(), &status), 0);
+}
+
+TEST(ListenSocket, UnixErrors) {
+  // other files are never removed
+  ofstream(SOCKET_PATH) << "data";
+  auto res = ListenSocket::openUnix(SOCKET_PATH);
+  ASSERT_TRUE(holds_alternative<Error>(res));
+  EXPECT_EQ(get<Error>(res).getErrorCode(), ErrorCode::AlreadyExists);
+  unlink(SOCKET_PATH.c_str());
+
+  for (auto const &path : {string(), "/tmp/" + string(200, 'x')}) {
+    res = ListenSocket::openUnix(path);
+    ASSERT_TRUE(holds_alternative<Error>(res));
+    EXPECT_EQ(get<Error>(res).getErrorCode(), ErrorCode::InvalidValue);
+  }
+}
+
+TEST(ListenSocket, Tcp) {
+  // several sockets share a port with SO_REUSEPORT only
+  auto first = ListenSocket::openTcp(8282, true);
+  ASSERT_TRUE(holds_alternative<int>(first));
+  auto second = ListenSocket::openTcp(8282, true);
+  ASSERT_TRUE(holds_alternative<int>(second));
+  auto third = ListenSocket::openTcp(8282, false);
+  ASSERT_TRUE(holds_alternative<Error>(third));
+  EXPECT_EQ(get<Error>(third).getErrorCode(), ErrorCode::NotInitialized);
+
+  close(get<int>(first));
+  close(get<int>(second));
+}
@@ -0,0 +1,103 @@
+/*****************************************************************************/
+/**
+ * @file    Test_MemoryUsage.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class MemoryUsage
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "Datastore/RAMDataStore.h"
+#include "DispatchFixture.h"
+#include "Utils/MemoryUsage.h"
+#include "json/json.hpp"
+
+using namespace std;
+using json = nlohmann::json;
+
+/**
+ * @brief returns the usage of a subsystem, or 0 if it is not registered
+ */
+static size_t usageOf(string const &name) {
+  for (auto const &[subsystem, bytes] : MemoryUsage::subsystems()) {
+    if (subsystem == name) {
+      return bytes;
+    }
+  }
+  return 0;
+}
+
+TEST(MemoryUsage, HeapBytes) {
+  EXPECT_EQ(MemoryUsage::heapBytes(string("short")), 0);
+  string longString(100, 'x');
+  EXPECT_GE(MemoryUsage::heapBytes(longString), 101);
+
+  vector<string> strings{"short", longString};
+  EXPECT_GE(MemoryUsage::heapBytes(strings),
+            2 * sizeof(string) + MemoryUsage::heapBytes(longString));
+}
+
+TEST(MemoryUsage, Registration) {
+  {
+    MemoryUsage::Registration first("test.subsystem", [] { return 100; });
+    MemoryUsage::Registration second("test.subsystem", [] { return 20; });
+    EXPECT_EQ(usageOf("test.subsystem"), 120);
+  }
+  EXPECT_EQ(usageOf("test.subsystem"), 0);
+}
+
+TEST(MemoryUsage, DataStore) {
+  auto before = usageOf("datastore.users");
+  {
+    RAMDataStore datastore;
+    auto empty = usageOf("datastore.users");
+    User user;
+    user.SessionID = string(64, 's');
+    user.Name = "user";
+    user.isAdmin = false;
+    user.ExpirationDate = 0;
+    ASSERT_FALSE(datastore.addUser(user).has_value());
+    EXPECT_GE(usageOf("datastore.users"),
+              empty + sizeof(User) + MemoryUsage::heapBytes(user.SessionID));
+
+    BaseTrack track;
+    track.trackId = "track";
+    track.title = string(64, 't');
+    track.durationMs = 1000;
+    auto queues = usageOf("datastore.queues");
+    ASSERT_FALSE(datastore.addTrack(track, QueueType::Normal).has_value());
+    EXPECT_GE(
+        usageOf("datastore.queues"),
+        queues + sizeof(QueuedTrack) + MemoryUsage::heapBytes(track.title));
+  }
+  EXPECT_EQ(usageOf("datastore.users"), before);
+}
+
+using MemoryUsageEndpoint = DispatchFixture<>;
+
+TEST_F(MemoryUsageEndpoint, Endpoint) {
+  MemoryUsage::Registration registration("test.endpoint", [] { return 42; });
+
+  auto response = dispatch({"/debug/memory", "GET", "", {}, {}});
+  ASSERT_EQ(response.code, 200);
+  auto report = json::parse(response.body);
+  EXPECT_GT(report["process_resident_bytes"].get<size_t>(), 0);
+  size_t total = 0;
+  bool found = false;
+  for (auto const &subsystem : report["subsystems"]) {
+    total += subsystem["bytes"].get<size_t>();
+    if (subsystem["name"] == "test.endpoint") {
+      found = true;
+      EXPECT_EQ(subsystem["bytes"], 42);
+    }
+  }
+  EXPECT_TRUE(found);
+  EXPECT_EQ(report["total_bytes"], total);
+
+  response = dispatch({"/metrics", "GET", "", {}, {}});
+  ASSERT_EQ(response.code, 200);
+  EXPECT_NE(response.body.find(
+                "jukebox_memory_bytes{subsystem=\"test.endpoint\"} 42\n"),
+            string::npos);
+}
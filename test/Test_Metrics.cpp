@@ -0,0 +1,142 @@
+/*****************************************************************************/
+/**
+ * @file    Test_Metrics.cpp
+ * @author  Team Server
+ * @brief   Test implementation for the metrics registry
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "DispatchFixture.h"
+#include "Utils/Metrics.h"
+
+using namespace std;
+
+TEST(Metrics, Counter) {
+  Counter counter;
+  vector<thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&counter] {
+      for (int j = 0; j < 10000; j++) {
+        counter.inc();
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  counter.inc(5);
+  EXPECT_EQ(counter.value(), 40005);
+}
+
+TEST(Metrics, HistogramBuckets) {
+  // each value lies between the limits of its bucket and the previous one
+  for (uint64_t value : {0ull, 1ull, 3ull, 4ull, 5ull, 7ull, 8ull, 1000ull,
+                         1023ull, 1024ull, 123456789ull}) {
+    size_t index = Histogram::bucketIndex(value);
+    EXPECT_LT(value, Histogram::bucketLimit(index)) << value;
+    if (index > 0) {
+      EXPECT_GE(value, Histogram::bucketLimit(index - 1)) << value;
+    }
+  }
+  EXPECT_EQ(Histogram::bucketIndex(uint64_t(1) << 50), Histogram::BUCKETS - 1);
+
+  Histogram histogram;
+  EXPECT_EQ(histogram.quantile(0.5), 0);
+  for (uint64_t value = 1; value <= 1000; value++) {
+    histogram.observe(value);
+  }
+  EXPECT_EQ(histogram.count(), 1000);
+  EXPECT_EQ(histogram.sum(), 500500);
+  EXPECT_NEAR(histogram.quantile(0.5), 500, 125);
+  EXPECT_NEAR(histogram.quantile(0.99), 990, 250);
+  EXPECT_EQ(histogram.countBelowPowerOfTwo(4), 15);
+  EXPECT_EQ(histogram.countBelowPowerOfTwo(10), 1000);
+}
+
+TEST(Metrics, Family) {
+  auto &family =
+      Metrics::counter("test_family_total", "Test family", {"a", "b"});
+  EXPECT_EQ(&Metrics::counter("test_family_total", "Other help"), &family);
+
+  auto &series = family.labels({"x", "y"});
+  series.inc();
+  EXPECT_EQ(&family.labels({"x", "y"}), &series);
+  EXPECT_NE(&family.labels({"xy", ""}), &series);
+
+  // label values beyond the capacity share a single series
+  for (int i = 0; i < 1000; i++) {
+    family.labels({to_string(i), "z"}).inc();
+  }
+  EXPECT_EQ(family.labels({"x", "y"}).value(), 1);
+  EXPECT_EQ(&family.labels({"1000", "z"}), &family.labels({"1001", "z"}));
+}
+
+TEST(Metrics, Serialize) {
+  Metrics::counter("test_serialize_total", "Some \"help\"", {"name"})
+      .labels({"quote\"d"})
+      .inc(3);
+  Metrics::gauge("test_serialize_gauge", "Gauge").get().set(-2);
+  auto &histogram =
+      Metrics::histogram("test_serialize_seconds", "Histogram").get();
+  histogram.observe(10);
+  histogram.observe(2000000);
+
+  string text = Metrics::serialize();
+  EXPECT_NE(text.find("# TYPE test_serialize_total counter\n"
+                      "test_serialize_total{name=\"quote\\\"d\"} 3\n"),
+            string::npos);
+  EXPECT_NE(text.find("test_serialize_gauge -2\n"), string::npos);
+  EXPECT_NE(text.find("# TYPE test_serialize_seconds histogram\n"),
+            string::npos);
+  EXPECT_NE(text.find("test_serialize_seconds_bucket{le=\"8e-06\"} 0\n"),
+            string::npos);
+  EXPECT_NE(text.find("test_serialize_seconds_bucket{le=\"1.6e-05\"} 1\n"),
+            string::npos);
+  EXPECT_NE(text.find("test_serialize_seconds_bucket{le=\"+Inf\"} 2\n"),
+            string::npos);
+  EXPECT_NE(text.find("test_serialize_seconds_sum 2.00001\n"), string::npos);
+  EXPECT_NE(text.find("test_serialize_seconds_count 2\n"), string::npos);
+}
+
+using MetricsEndpoint = DispatchFixture<>;
+
+TEST_F(MetricsEndpoint, Dispatch) {
+  dispatch({"/api/v1/getCurrentQueues",
+            "GET",
+            "",
+            {{"session_id", "metrics"}},
+            {}});
+  dispatch({"/api/v1/removeTrack", "GET", "", {}, {}});
+  dispatch({"/some/random/path", "BREW", "", {}, {}});
+
+  auto response = dispatch({"/metrics", "GET", "", {}, {}});
+  ASSERT_EQ(response.code, 200);
+  EXPECT_EQ(response.headers["Content-Type"],
+            "text/plain; version=0.0.4; charset=utf-8");
+
+  // paths of unknown endpoints and unknown methods add no series
+  auto const &text = response.body;
+  EXPECT_NE(text.find("jukebox_http_requests_total{endpoint=\""
+                      "/getCurrentQueues\",method=\"GET\",code=\"200\"}"),
+            string::npos);
+  EXPECT_NE(text.find("jukebox_http_requests_total{endpoint=\"/removeTrack\""
+                      ",method=\"GET\",code=\"405\"}"),
+            string::npos);
+  EXPECT_NE(text.find("jukebox_http_requests_total{endpoint=\"unknown\","
+                      "method=\"other\",code=\"404\"}"),
+            string::npos);
+  EXPECT_EQ(text.find("/some/random/path"), string::npos);
+  EXPECT_NE(text.find("jukebox_http_request_duration_seconds_count{"
+                      "endpoint=\"/getCurrentQueues\"}"),
+            string::npos);
+  // scrapes count towards the budget of monitoring requests only
+  EXPECT_NE(text.find("jukebox_http_requests_in_flight 0\n"), string::npos);
+
+  // the endpoint is not part of the versioned API
+  response = dispatch({"/api/v1/metrics", "GET", "", {}, {}});
+  EXPECT_EQ(response.code, 404);
+}
@@ -0,0 +1,95 @@
+/*****************************************************************************/
+/**
+ * @file    Test_ProfiledMutex.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class ProfiledMutex
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+#include "DispatchFixture.h"
+#include "Utils/ProfiledMutex.h"
+#include "json/json.hpp"
+
+using namespace std;
+using namespace literals::chrono_literals;
+using json = nlohmann::json;
+
+TEST(ProfiledMutex, Uncontended) {
+  ProfiledMutex<mutex> mtx("Test.uncontended");
+  for (int i = 0; i < 32; i++) {
+    lock_guard<ProfiledMutex<mutex>> lock(mtx);
+  }
+  auto const &stats = LockProfiler::stats("Test.uncontended");
+  EXPECT_EQ(stats.acquisitions.load(), 32);
+  EXPECT_EQ(stats.contentions.load(), 0);
+  EXPECT_EQ(stats.holdSamples.load(),
+            32 / LockProfiler::HOLD_SAMPLE_INTERVAL);
+}
+
+TEST(ProfiledMutex, Contended) {
+  ProfiledMutex<mutex> mtx("Test.contended");
+  unique_lock lock(mtx);
+  thread waiter([&mtx] { lock_guard<ProfiledMutex<mutex>> waiting(mtx); });
+  this_thread::sleep_for(20ms);
+  lock.unlock();
+  waiter.join();
+
+  auto const &stats = LockProfiler::stats("Test.contended");
+  EXPECT_EQ(stats.acquisitions.load(), 2);
+  EXPECT_EQ(stats.contentions.load(), 1);
+  EXPECT_GE(stats.maxWaitNs.load(), 10000000);
+  // the first acquisition is sampled
+  EXPECT_EQ(stats.holdSamples.load(), 1);
+  EXPECT_GE(stats.maxHoldNs.load(), 10000000);
+}
+
+TEST(ProfiledMutex, RecursiveAndShared) {
+  ProfiledMutex<recursive_mutex> recursive("Test.recursive");
+  {
+    unique_lock outer(recursive);
+    unique_lock inner(recursive);
+  }
+  // a new mutex of the same name shares the statistics
+  ProfiledMutex<recursive_mutex> other("Test.recursive");
+  { unique_lock lock(other); }
+  auto const &recursiveStats = LockProfiler::stats("Test.recursive");
+  EXPECT_EQ(recursiveStats.acquisitions.load(), 3);
+  EXPECT_EQ(recursiveStats.holdSamples.load(), 1);
+
+  ProfiledMutex<shared_mutex> shared("Test.shared");
+  {
+    shared_lock first(shared);
+    shared_lock second(shared);
+    EXPECT_FALSE(shared.try_lock());
+  }
+  { unique_lock lock(shared); }
+  auto const &sharedStats = LockProfiler::stats("Test.shared");
+  EXPECT_EQ(sharedStats.acquisitions.load(), 3);
+  EXPECT_EQ(sharedStats.contentions.load(), 0);
+}
+
+using ProfiledMutexEndpoint = DispatchFixture<>;
+
+TEST_F(ProfiledMutexEndpoint, Endpoint) {
+  ProfiledMutex<mutex> mtx("Test.endpoint");
+  { lock_guard<ProfiledMutex<mutex>> lock(mtx); }
+
+  auto response = dispatch({"/debug/locks", "GET", "", {}, {}});
+  ASSERT_EQ(response.code, 200);
+  auto report = json::parse(response.body);
+  bool found = false;
+  for (auto const &lock : report["locks"]) {
+    if (lock["name"] == "Test.endpoint") {
+      found = true;
+      EXPECT_EQ(lock["acquisitions"], 1);
+      EXPECT_EQ(lock["contentions"], 0);
+    }
+  }
+  EXPECT_TRUE(found);
+}
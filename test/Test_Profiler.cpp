@@ -0,0 +1,132 @@
+/*****************************************************************************/
+/**
+ * @file    Test_Profiler.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class Profiler
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "DispatchFixture.h"
+#include "Utils/Profiler.h"
+
+using namespace std;
+using namespace literals::chrono_literals;
+
+// not static, so the profiler finds their names among the exported symbols
+__attribute__((noinline)) double profilerTestBurnCpu() {
+  double sum = 0;
+  for (int i = 0; i < 100000; i++) {
+    sum += sqrt(static_cast<double>(i));
+  }
+  return sum;
+}
+
+__attribute__((noinline)) size_t profilerTestAllocate() {
+  vector<vector<char>> buffers;
+  for (int i = 0; i < 64; i++) {
+    buffers.emplace_back(16 * 1024);
+  }
+  return buffers.size();
+}
+
+/**
+ * @brief Runs a function in a loop on another thread until it is destroyed.
+ */
+class Workload {
+ public:
+  template <class Function>
+  explicit Workload(Function function)
+      : mThread([this, function] {
+          while (!mStop) {
+            mSink = mSink + function();
+          }
+        }) {
+  }
+  ~Workload() {
+    mStop = true;
+    mThread.join();
+  }
+
+ private:
+  atomic<bool> mStop{false};
+  atomic<double> mSink{0};
+  thread mThread;
+};
+
+TEST(Profiler, Cpu) {
+  Workload workload(profilerTestBurnCpu);
+  auto result = Profiler::profileCpu(1s);
+  ASSERT_TRUE(holds_alternative<Profiler::Profile>(result));
+  auto const &profile = get<Profiler::Profile>(result);
+  EXPECT_GT(profile.samples, 0);
+  EXPECT_EQ(profile.dropped, 0);
+  EXPECT_NE(profile.folded.find("profilerTestBurnCpu()"), string::npos);
+  // one stack per line, followed by its number of samples
+  EXPECT_EQ(profile.folded.back(), '\n');
+  EXPECT_NE(profile.folded.find(';'), string::npos);
+}
+
+TEST(Profiler, Heap) {
+  Workload workload(profilerTestAllocate);
+  auto result = Profiler::profileHeap(1s);
+  ASSERT_TRUE(holds_alternative<Profiler::Profile>(result));
+  auto const &profile = get<Profiler::Profile>(result);
+  EXPECT_GT(profile.samples, 0);
+  auto pos = profile.folded.find("profilerTestAllocate() ");
+  ASSERT_NE(pos, string::npos);
+  // the weight is at least one sample interval of bytes
+  auto weight = stoull(profile.folded.substr(pos + 23));
+  EXPECT_GE(weight, Profiler::HEAP_SAMPLE_BYTES);
+}
+
+TEST(Profiler, OneProfileAtATime) {
+  thread first([] { Profiler::profileHeap(1s); });
+  this_thread::sleep_for(200ms);
+  auto result = Profiler::profileCpu(1s);
+  first.join();
+  ASSERT_TRUE(holds_alternative<Error>(result));
+  EXPECT_EQ(get<Error>(result).getErrorCode(), ErrorCode::ServiceUnavailable);
+}
+
+using ProfilerEndpoint = DispatchFixture<>;
+
+TEST_F(ProfilerEndpoint, Endpoint) {
+  auto profile = [this](string path, RequestArgs args) {
+    return dispatch({move(path), "GET", "", move(args), {}});
+  };
+
+  // admins only
+  listener.setResponseAuthorizeAdmin(
+      Error(ErrorCode::AccessDenied, "User is not an admin."));
+  auto response = profile("/debug/profile/cpu", {{"session_id", "user"}});
+  EXPECT_EQ(response.code, 403);
+  ASSERT_TRUE(listener.hasParametersAuthorizeAdmin());
+  TSessionID sid;
+  listener.getLastParametersAuthorizeAdmin(sid);
+  EXPECT_EQ(sid, "user");
+
+  response = profile("/debug/profile/cpu", {});
+  EXPECT_EQ(response.code, 422);
+  response = profile("/debug/profile/heap",
+                     {{"session_id", "admin"}, {"seconds", "0"}});
+  EXPECT_EQ(response.code, 400);
+  response = profile("/debug/profile/heap",
+                     {{"session_id", "admin"}, {"seconds", "99999999999"}});
+  EXPECT_EQ(response.code, 400);
+  EXPECT_EQ(listener.getCountAuthorizeAdmin(), 1);
+
+  listener.setResponseAuthorizeAdmin(nullopt);
+  Workload workload(profilerTestBurnCpu);
+  response = profile("/debug/profile/cpu",
+                     {{"session_id", "admin"}, {"seconds", "1"}});
+  ASSERT_EQ(response.code, 200);
+  EXPECT_NE(response.body.find("profilerTestBurnCpu()"), string::npos);
+  EXPECT_NE(response.headers["X-Profile-Samples"], "0");
+}
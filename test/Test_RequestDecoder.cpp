@@ -0,0 +1,101 @@
+/*****************************************************************************/
+/**
+ * @file    Test_RequestDecoder.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class RequestDecoder
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "Network/RequestDecoder.h"
+
+using namespace std;
+
+static string decodeError(string const &body) {
+  string session_id;
+  int vote = 0;
+  optional<string> nickname;
+  auto err = RequestDecoder()
+                 .requiredString("session_id", session_id)
+                 .requiredInt("vote", vote)
+                 .optionalString("nickname", nickname)
+                 .decode(body);
+  return err.has_value() ? err.value().getErrorMessage() : "";
+}
+
+TEST(RequestDecoder, ExtractsFields) {
+  string session_id;
+  int vote = 0;
+  optional<string> nickname;
+  optional<string> password;
+
+  string body =
+      " {\"other\": [1, {\"x\": null}, \"y\"], \"vote\": -42,\n"
+      "\"session_id\":\"a\\\"b\\\\c\\n\\u00e4\\ud83c\\udfb5\",\t"
+      "\"nickname\": \"Hans ä\"} ";
+  auto err = RequestDecoder()
+                 .requiredString("session_id", session_id)
+                 .requiredInt("vote", vote)
+                 .optionalString("nickname", nickname)
+                 .optionalString("password", password)
+                 .decode(body);
+  ASSERT_FALSE(err.has_value());
+  ASSERT_EQ(session_id, "a\"b\\c\nä\xF0\x9F\x8E\xB5");
+  ASSERT_EQ(vote, -42);
+  ASSERT_EQ(nickname, "Hans ä");
+  ASSERT_FALSE(password.has_value());
+
+  // duplicate keys: the last value is used
+  err = RequestDecoder()
+            .requiredString("session_id", session_id)
+            .requiredInt("vote", vote)
+            .decode("{\"session_id\":\"1\",\"vote\":1,\"session_id\":\"2\"}");
+  ASSERT_FALSE(err.has_value());
+  ASSERT_EQ(session_id, "2");
+}
+
+TEST(RequestDecoder, InvalidJson) {
+  vector<string> bodies = {
+      "", " ", "{", "{\"session_id\":\"x\"", "{\"a\" 1}", "{\"a\":1,}",
+      "[1,]", "{'a':1}", "password=1234", "{\"a\":01}", "{\"a\":1.}",
+      "{\"a\":tru}", "{\"a\":\"\\x\"}", "{\"a\":\"\\ud83c\"}",
+      "{\"a\":\"\xC3\"}", "{\"a\":\"\x80\"}", "{\"a\":\"line\nbreak\"}",
+      "{} {}"};
+  // too deeply nested
+  bodies.push_back(string(100, '[') + string(100, ']'));
+
+  for (auto const &body : bodies) {
+    ASSERT_EQ(decodeError(body), "Failed to parse body") << body;
+  }
+}
+
+TEST(RequestDecoder, FieldErrors) {
+  ASSERT_EQ(decodeError("{}"), "Field 'session_id' not found");
+  ASSERT_EQ(decodeError("[\"session_id\"]"), "Field 'session_id' not found");
+  ASSERT_EQ(decodeError("\"string\""), "Field 'session_id' not found");
+  ASSERT_EQ(decodeError("{\"session_id\":\"x\"}"), "Field 'vote' not found");
+
+  ASSERT_EQ(decodeError("{\"session_id\":1,\"vote\":1}"),
+            "Value of 'session_id' must be a string");
+  ASSERT_EQ(decodeError("{\"session_id\":\"x\",\"vote\":\"1\"}"),
+            "Value of 'vote' must be an integer");
+  ASSERT_EQ(decodeError("{\"session_id\":\"x\",\"vote\":1.5}"),
+            "Value of 'vote' must be an integer");
+  ASSERT_EQ(decodeError("{\"session_id\":\"x\",\"vote\":1e3}"),
+            "Value of 'vote' must be an integer");
+  ASSERT_EQ(decodeError("{\"session_id\":\"x\",\"vote\":99999999999}"),
+            "Value of 'vote' must be an integer");
+  ASSERT_EQ(decodeError("{\"session_id\":\"x\",\"vote\":1,\"nickname\":{}}"),
+            "Value of 'nickname' must be a string");
+
+  // the first erroneous field in binding order is reported
+  ASSERT_EQ(decodeError("{\"nickname\":1,\"vote\":true}"),
+            "Field 'session_id' not found");
+  ASSERT_EQ(decodeError("{\"nickname\":1,\"vote\":true,\"session_id\":\"\"}"),
+            "Value of 'vote' must be an integer");
+
+  ASSERT_EQ(decodeError("{\"session_id\":\"\",\"vote\":0}"), "");
+}
@@ -1,16 +1,25 @@
 #include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <chrono>
+#include <future>
 #include <iostream>
 #include <memory>
+#include <thread>
 
-#include "Network/RestAPI.h"
+#include "Network/EventStream.h"
+#include "DispatchFixture.h"
+#include "Network/RestEndpointHandlers.h"
 #include "NetworkListenerHelper.h"
 #include "RestAPIFixture.h"
+#include "Utils/ConfigHandler.h"
 #include "Utils/Serializer.h"
 #include "json/json.hpp"
 #include "restclient-cpp/restclient.h"
 
 using namespace std;
+using namespace std::chrono_literals;
 using json = nlohmann::json;
 
 /**
@@ -25,10 +34,15 @@ using json = nlohmann::json;
  * - A method to set the response data for the next calls.
  */
 
+INSTANTIATE_TEST_SUITE_P(Implementations,
+                         RestAPIFixture,
+                         ::testing::Values("libhttpserver", "epoll"),
+                         RestAPIFixture::implementationName);
+
 //
 // generateSession
 //
-TEST_F(RestAPIFixture, generateSession_goodCases) {
+TEST_P(RestAPIFixture, generateSession_goodCases) {
   ASSERT_FALSE(listener.hasParametersGenerateSession());
   ASSERT_EQ(listener.getCountGenerateSession(), 0);
 
@@ -61,7 +75,7 @@ TEST_F(RestAPIFixture, generateSession_goodCases) {
   testGenerateSession(this, sid, expPw, expNickname, 4);
 }
 
-TEST_F(RestAPIFixture, generateSession_badCases) {
+TEST_P(RestAPIFixture, generateSession_badCases) {
   ASSERT_FALSE(listener.hasParametersGenerateSession());
   ASSERT_EQ(listener.getCountGenerateSession(), 0);
 
@@ -72,7 +86,8 @@ TEST_F(RestAPIFixture, generateSession_badCases) {
 
   // Wrong method
   resp = this->put("/generateSession", "empty").value();
-  ASSERT_EQ(resp.code, 404);
+  ASSERT_EQ(resp.code, 405);
+  ASSERT_EQ(resp.headers["Allow"], "POST");
   ASSERT_EQ(listener.getCountGenerateSession(), 0);
   ASSERT_FALSE(listener.hasParametersGenerateSession());
 
@@ -120,7 +135,7 @@ TEST_F(RestAPIFixture, generateSession_badCases) {
 //
 // queryTracks
 //
-TEST_F(RestAPIFixture, queryTracks_goodCases) {
+TEST_P(RestAPIFixture, queryTracks_goodCases) {
   ASSERT_FALSE(listener.hasParametersQueryTracks());
   ASSERT_EQ(listener.getCountQueryTracks(), 0);
 
@@ -153,10 +168,32 @@ TEST_F(RestAPIFixture, queryTracks_goodCases) {
   testQueryTracks(this, pattern, maxEntries, 5);
 }
 
+TEST_P(RestAPIFixture, queryTracks_emptyParameter) {
+  int fd = connectToServer();
+
+  // an empty parameter is passed on, unlike a missing one
+  sendAll(fd,
+          "GET /api/v1/queryTracks?pattern=&max_entries=3 HTTP/1.1\r\n\r\n");
+  auto response = readResponse(fd);
+  EXPECT_EQ(response.code, 200);
+  ASSERT_EQ(listener.getCountQueryTracks(), 1);
+  string pattern;
+  int maxEntries;
+  listener.getLastParametersQueryTracks(pattern, maxEntries);
+  EXPECT_EQ(pattern, "");
+  EXPECT_EQ(maxEntries, 3);
+
+  sendAll(fd, "GET /api/v1/queryTracks?max_entries=3 HTTP/1.1\r\n\r\n");
+  response = readResponse(fd);
+  EXPECT_EQ(response.code, 422);
+  EXPECT_EQ(listener.getCountQueryTracks(), 1);
+  close(fd);
+}
+
 //
 // getCurrentQueues
 //
-TEST_F(RestAPIFixture, getCurrentQueues_goodCases) {
+TEST_P(RestAPIFixture, getCurrentQueues_goodCases) {
   ASSERT_FALSE(listener.hasParametersGetCurrentQueues());
   ASSERT_EQ(listener.getCountGetCurrentQueues(), 0);
 
@@ -208,10 +245,219 @@ TEST_F(RestAPIFixture, getCurrentQueues_goodCases) {
   testGetCurrentQueues(this, sid, normalNr, adminNr, playbackTrack, 6);
 }
 
+TEST_P(RestAPIFixture, getCurrentQueues_conditionalRequests) {
+  map<string, string> parameters{{{"session_id", "etag"}}};
+  listener.setResponseGetCurrentQueues(gen.generateQueueStatus(3, 1, true));
+  listener.setResponseGetCurrentQueuesVersion({1, 2, 3});
+
+  // an unconditional request always returns the queues along with an ETag
+  auto resp = this->get("/getCurrentQueues", parameters).value();
+  ASSERT_EQ(resp.code, 200);
+  ASSERT_EQ(listener.getCountGetCurrentQueues(), 1);
+  ASSERT_EQ(resp.headers.count("ETag"), 1);
+  auto etag = resp.headers["ETag"];
+  ASSERT_FALSE(etag.empty());
+
+  // unchanged version: the queues are not collected at all
+  resp = this->get("/getCurrentQueues", parameters, {{"If-None-Match", etag}})
+             .value();
+  ASSERT_EQ(resp.code, 304);
+  ASSERT_TRUE(resp.body.empty());
+  ASSERT_EQ(resp.headers["ETag"], etag);
+  ASSERT_EQ(listener.getCountGetCurrentQueues(), 1);
+
+  // weak tags and lists of tags are accepted as well
+  resp = this->get("/getCurrentQueues",
+                   parameters,
+                   {{"If-None-Match", "\"other\", W/" + etag}})
+             .value();
+  ASSERT_EQ(resp.code, 304);
+  ASSERT_EQ(listener.getCountGetCurrentQueues(), 1);
+
+  // the tag depends on the session since the votes are user specific
+  resp = this->get("/getCurrentQueues",
+                   {{"session_id", "other"}},
+                   {{"If-None-Match", etag}})
+             .value();
+  ASSERT_EQ(resp.code, 200);
+  ASSERT_EQ(listener.getCountGetCurrentQueues(), 2);
+
+  // each version component invalidates the tag
+  for (auto version : {QueueStatusVersion{2, 2, 3},
+                       QueueStatusVersion{1, 3, 3},
+                       QueueStatusVersion{1, 2, 4}}) {
+    listener.setResponseGetCurrentQueuesVersion(version);
+    resp =
+        this->get("/getCurrentQueues", parameters, {{"If-None-Match", etag}})
+            .value();
+    ASSERT_EQ(resp.code, 200);
+    ASSERT_NE(resp.headers["ETag"], etag);
+  }
+  ASSERT_EQ(listener.getCountGetCurrentQueues(), 5);
+}
+
+TEST_P(RestAPIFixture, getCurrentQueues_ranges) {
+  auto queueStatus = gen.generateQueueStatus(30, 2, true);
+  listener.setResponseGetCurrentQueues(queueStatus);
+
+  for (auto [offset, limit, first, size] : {tuple{"", "10", 0, 10},
+                                            tuple{"5", "10", 5, 10},
+                                            tuple{"25", "10", 25, 5},
+                                            tuple{"40", "10", 30, 0},
+                                            tuple{"20", "", 20, 10}}) {
+    map<string, string> parameters{{"session_id", "range"}};
+    if (*offset) {
+      parameters["offset"] = offset;
+    }
+    if (*limit) {
+      parameters["limit"] = limit;
+    }
+    auto resp = this->get("/getCurrentQueues", parameters).value();
+    ASSERT_EQ(resp.code, 200);
+
+    auto body = json::parse(resp.body);
+    ASSERT_EQ(body["normal_queue_total"], 30);
+    ASSERT_EQ(body["admin_queue_total"], 2);
+    ASSERT_EQ(body["admin_queue"].size(), 2);
+    ASSERT_EQ(body["normal_queue"].size(), size);
+    for (int i = 0; i < size; i++) {
+      ASSERT_EQ(body["normal_queue"][i]["track_id"],
+                queueStatus.normalQueue.tracks[first + i].trackId);
+    }
+  }
+
+  // each range has its own entity tag
+  auto resp = this->get("/getCurrentQueues",
+                        {{"session_id", "range"}, {"limit", "10"}})
+                  .value();
+  auto etag = resp.headers["ETag"];
+  resp = this->get("/getCurrentQueues",
+                   {{"session_id", "range"}, {"limit", "20"}},
+                   {{"If-None-Match", etag}})
+             .value();
+  ASSERT_EQ(resp.code, 200);
+  ASSERT_EQ(json::parse(resp.body)["normal_queue"].size(), 20);
+}
+
+TEST_P(RestAPIFixture, getCurrentQueues_badRanges) {
+  listener.setResponseGetCurrentQueues(gen.generateQueueStatus(3, 0, false));
+
+  for (auto [offset, limit] : {pair{"-1", "10"},
+                               pair{"0", "-10"},
+                               pair{"abc", "10"},
+                               pair{"0", "1x"}}) {
+    auto resp = this->get("/getCurrentQueues",
+                          {{"session_id", "range"},
+                           {"offset", offset},
+                           {"limit", limit}})
+                    .value();
+    ASSERT_NE(resp.code, 200) << offset << ", " << limit;
+  }
+
+  // values beyond the range of an int are rejected, not failing internally
+  for (auto parameter : {"offset", "limit"}) {
+    auto resp = this->get("/getCurrentQueues",
+                          {{"session_id", "range"},
+                           {parameter, "99999999999"}})
+                    .value();
+    ASSERT_EQ(resp.code, 400) << parameter;
+    ASSERT_EQ(json::parse(resp.body)["error"],
+              "Parameter '" + string(parameter) + "' is out of range");
+  }
+}
+
+TEST_P(RestAPIFixture, fields) {
+  auto tracks = gen.generateTracks(3);
+  listener.setResponseQueryTracks(tracks);
+  auto resp = this->get("/queryTracks",
+                        {{"pattern", "test"}, {"fields", "track_id,title"}})
+                  .value();
+  ASSERT_EQ(resp.code, 200);
+  auto body = json::parse(resp.body);
+  ASSERT_EQ(body["tracks"].size(), 3);
+  for (size_t i = 0; i < tracks.size(); i++) {
+    json expected = {{"title", tracks[i].title},
+                     {"track_id", tracks[i].trackId}};
+    ASSERT_EQ(body["tracks"][i], expected);
+  }
+
+  auto queueStatus = gen.generateQueueStatus(10, 2, true);
+  listener.setResponseGetCurrentQueues(queueStatus);
+  resp = this->get("/getCurrentQueues",
+                   {{"session_id", "fields"}, {"fields", "votes"}})
+             .value();
+  ASSERT_EQ(resp.code, 200);
+  body = json::parse(resp.body);
+  ASSERT_EQ(body["normal_queue"].size(), 10);
+  ASSERT_EQ(body["normal_queue"][0],
+            json({{"votes", queueStatus.normalQueue.tracks[0].votes}}));
+  ASSERT_EQ(body["currently_playing"], json::object());
+  ASSERT_EQ(body["normal_queue_total"], 10);
+
+  // each selection of fields has its own entity tag
+  auto etag = resp.headers["ETag"];
+  resp = this->get("/getCurrentQueues",
+                   {{"session_id", "fields"}},
+                   {{"If-None-Match", etag}})
+             .value();
+  ASSERT_EQ(resp.code, 200);
+
+  for (auto fields : {"", "votes,unknown"}) {
+    resp = this->get("/getCurrentQueues",
+                     {{"session_id", "fields"}, {"fields", fields}})
+               .value();
+    ASSERT_EQ(resp.code, 400) << fields;
+    resp = this->get("/queryTracks", {{"pattern", "a"}, {"fields", fields}})
+               .value();
+    ASSERT_EQ(resp.code, 400) << fields;
+  }
+}
+
+TEST_P(RestAPIFixture, getCurrentQueues_binaryFormats) {
+  map<string, string> parameters{{{"session_id", "binary"}}};
+  auto queueStatus = gen.generateQueueStatus(20, 5, true);
+  listener.setResponseGetCurrentQueues(queueStatus);
+  listener.setResponseGetCurrentQueuesVersion({1, 2, 3});
+  auto expected = Serializer::serialize(queueStatus);
+
+  auto resp = this->get("/getCurrentQueues",
+                        parameters,
+                        {{"Accept", "application/msgpack"}})
+                  .value();
+  ASSERT_EQ(resp.code, 200);
+  ASSERT_EQ(resp.headers["Content-Type"], "application/msgpack");
+  ASSERT_EQ(json::from_msgpack(resp.body), expected);
+  auto msgpackETag = resp.headers["ETag"];
+
+  resp = this->get("/getCurrentQueues",
+                   parameters,
+                   {{"Accept", "application/cbor"}})
+             .value();
+  ASSERT_EQ(resp.code, 200);
+  ASSERT_EQ(resp.headers["Content-Type"], "application/cbor");
+  ASSERT_EQ(json::from_cbor(resp.body), expected);
+  ASSERT_NE(resp.headers["ETag"], msgpackETag);
+
+  // each format has its own entity tag
+  resp = this->get("/getCurrentQueues",
+                   parameters,
+                   {{"Accept", "application/json"},
+                    {"If-None-Match", msgpackETag}})
+             .value();
+  ASSERT_EQ(resp.code, 200);
+  ASSERT_EQ(json::parse(resp.body), expected);
+
+  // errors are encoded as well
+  resp = this->get("/getCurrentQueues", {}, {{"Accept", "application/msgpack"}})
+             .value();
+  ASSERT_EQ(resp.code, 422);
+  ASSERT_EQ(json::from_msgpack(resp.body)["status"], 422);
+}
+
 //
 // addTrackToQueue
 //
-TEST_F(RestAPIFixture, addTrackToQueue_goodCases) {
+TEST_P(RestAPIFixture, addTrackToQueue_goodCases) {
   ASSERT_FALSE(listener.hasParametersAddTrackToQueue());
   ASSERT_EQ(listener.getCountAddTrackToQueue(), 0);
 
@@ -253,7 +499,7 @@ TEST_F(RestAPIFixture, addTrackToQueue_goodCases) {
 //
 // voteTrack
 //
-TEST_F(RestAPIFixture, voteTrack_goodCases) {
+TEST_P(RestAPIFixture, voteTrack_goodCases) {
   ASSERT_FALSE(listener.hasParametersVoteTrack());
   ASSERT_EQ(listener.getCountVoteTrack(), 0);
 
@@ -289,7 +535,7 @@ TEST_F(RestAPIFixture, voteTrack_goodCases) {
 //
 // controlPlayer
 //
-TEST_F(RestAPIFixture, controlPlayer_goodCases) {
+TEST_P(RestAPIFixture, controlPlayer_goodCases) {
   ASSERT_FALSE(listener.hasParametersControlPlayer());
   ASSERT_EQ(listener.getCountControlPlayer(), 0);
 
@@ -330,7 +576,7 @@ TEST_F(RestAPIFixture, controlPlayer_goodCases) {
 //
 // moveTrack
 //
-TEST_F(RestAPIFixture, moveTrack_goodCases) {
+TEST_P(RestAPIFixture, moveTrack_goodCases) {
   ASSERT_FALSE(listener.hasParametersMoveTrack());
   ASSERT_EQ(listener.getCountMoveTrack(), 0);
 
@@ -362,3 +608,348 @@ TEST_F(RestAPIFixture, moveTrack_goodCases) {
   queueType = QueueType::Admin;
   testMoveTrack(this, sid, trkid, queueType, 4);
 }
+
+//
+// events
+//
+static string readEvent(ResponseInformation const &resp) {
+  // read until the end of an event (or comment)
+  string event;
+  char buffer[64];
+  while (event.size() < 2 || event.substr(event.size() - 2) != "\n\n") {
+    auto size = resp.stream->produce(buffer, sizeof(buffer));
+    if (size < 0) {
+      break;
+    }
+    event.append(buffer, size);
+  }
+  return event;
+}
+
+TEST_P(RestAPIFixture, events_goodCases) {
+  RequestInformation infos{"/events", "GET", "", {{"session_id", "sse"}}, {}};
+  auto queueStatus = gen.generateQueueStatus(2, 1, true);
+  listener.setResponseGetCurrentQueues(queueStatus);
+  listener.setResponseGetCurrentQueuesVersion({1, 1, 1});
+
+  auto resp = eventsHandler(&listener, infos);
+  ASSERT_EQ(resp.code, 200);
+  ASSERT_TRUE(resp.stream);
+  ASSERT_EQ(resp.headers["Content-Type"], "text/event-stream");
+
+  // the current state is sent right away
+  auto event = readEvent(resp);
+  ASSERT_EQ(event.rfind("retry: ", 0), 0);
+  auto expQueues = "event: queues\ndata: " +
+                   Serializer::serialize(queueStatus).dump() + "\n\n";
+  ASSERT_NE(event.find(expQueues), string::npos);
+  ASSERT_EQ(listener.getCountGetCurrentQueues(), 1);
+
+  // playback changes only send (and collect) the current track
+  listener.setResponseGetCurrentQueuesVersion({1, 2, 1});
+  EventStream::notifyChange();
+  event = readEvent(resp);
+  ASSERT_EQ(event.rfind("event: playback\ndata: ", 0), 0);
+  ASSERT_NE(event.find("currently_playing"), string::npos);
+  ASSERT_EQ(event.find("normal_queue"), string::npos);
+  ASSERT_EQ(listener.getCountGetCurrentQueues(), 1);
+  ASSERT_EQ(listener.getCountGetCurrentPlayback(), 1);
+
+  // several changes are coalesced into a single event
+  listener.setResponseGetCurrentQueuesVersion({2, 2, 1});
+  listener.setResponseGetCurrentQueuesVersion({3, 3, 2});
+  EventStream::notifyChange();
+  EventStream::notifyChange();
+  event = readEvent(resp);
+  ASSERT_EQ(event, expQueues);
+  ASSERT_EQ(listener.getCountGetCurrentQueues(), 2);
+  ASSERT_EQ(listener.getCountGetVotedTracks(), 2);
+
+  // closed streams end
+  EventStream::closeAll();
+  char buffer[16];
+  ASSERT_EQ(resp.stream->produce(buffer, sizeof(buffer)), -1);
+  string polled;
+  ASSERT_FALSE(resp.stream->poll(polled));
+}
+
+TEST_P(RestAPIFixture, events_sharedQueues) {
+  RequestInformation infos{"/events", "GET", "", {{"session_id", "sse"}}, {}};
+  auto queueStatus = gen.generateQueueStatus(3, 1, true);
+  for (auto &track : queueStatus.normalQueue.tracks) {
+    track.userHasVoted = false;
+  }
+  listener.setResponseGetCurrentQueues(queueStatus);
+  listener.setResponseGetCurrentQueuesVersion({1, 1, 1});
+
+  // the queues are collected once per version for all streams
+  auto first = eventsHandler(&listener, infos);
+  auto second = eventsHandler(&listener, infos);
+  ASSERT_EQ(first.code, 200);
+  ASSERT_EQ(second.code, 200);
+  auto expQueues = "event: queues\ndata: " +
+                   Serializer::serialize(queueStatus).dump() + "\n\n";
+  ASSERT_NE(readEvent(first).find(expQueues), string::npos);
+  ASSERT_NE(readEvent(second).find(expQueues), string::npos);
+  ASSERT_EQ(listener.getCountGetCurrentQueues(), 1);
+
+  // votes are inserted per stream
+  queueStatus.normalQueue.tracks[1].userHasVoted = true;
+  listener.setResponseGetCurrentQueues(queueStatus);
+  listener.setResponseGetCurrentQueuesVersion({1, 1, 2});
+  EventStream::notifyChange();
+  expQueues = "event: queues\ndata: " +
+              Serializer::serialize(queueStatus).dump() + "\n\n";
+  ASSERT_EQ(readEvent(first), expQueues);
+  ASSERT_EQ(readEvent(second), expQueues);
+  ASSERT_EQ(listener.getCountGetCurrentQueues(), 1);
+
+  // events which were not taken are replaced by newer ones
+  listener.setResponseGetCurrentQueuesVersion({1, 2, 2});
+  EventStream::notifyChange();
+  ASSERT_EQ(readEvent(first).rfind("event: playback\n", 0), 0);
+  listener.setResponseGetCurrentQueuesVersion({2, 3, 2});
+  EventStream::notifyChange();
+  this_thread::sleep_for(100ms);
+  ASSERT_EQ(readEvent(first), expQueues);
+  ASSERT_EQ(readEvent(second), expQueues);
+  ASSERT_EQ(listener.getCountGetCurrentQueues(), 2);
+}
+
+TEST_P(RestAPIFixture, events_http) {
+  auto queueStatus = gen.generateQueueStatus(2, 1, true);
+  listener.setResponseGetCurrentQueues(queueStatus);
+  listener.setResponseGetCurrentQueuesVersion({1, 1, 1});
+
+  int fd = connectToServer();
+  sendAll(fd, "GET /api/v1/events?session_id=sse HTTP/1.1\r\n\r\n");
+
+  // the current state is sent right away
+  ASSERT_TRUE(receiveUntil(fd, "event: queues\n"));
+  EXPECT_EQ(pending.rfind("HTTP/1.1 200", 0), 0);
+  EXPECT_NE(pending.find("Content-Type: text/event-stream"), string::npos);
+  pending.clear();
+
+  // changes are pushed as soon as they are announced
+  listener.setResponseGetCurrentQueuesVersion({1, 2, 1});
+  EventStream::notifyChange();
+  ASSERT_TRUE(receiveUntil(fd, "event: playback\n"));
+  EXPECT_EQ(pending.find("event: queues"), string::npos);
+  close(fd);
+}
+
+TEST_P(RestAPIFixture, events_badCases) {
+  // missing session
+  RequestInformation infos{"/events", "GET", "", {}, {}};
+  auto resp = eventsHandler(&listener, infos);
+  ASSERT_EQ(resp.code, 422);
+  ASSERT_FALSE(resp.stream);
+
+  // too many subscribers (the limit of the test configuration is 2)
+  infos.args.set("session_id", "sse");
+  auto first = eventsHandler(&listener, infos);
+  ASSERT_EQ(first.code, 200);
+  auto second = eventsHandler(&listener, infos);
+  ASSERT_EQ(second.code, 200);
+  resp = eventsHandler(&listener, infos);
+  ASSERT_EQ(resp.code, 503);
+  ASSERT_FALSE(resp.stream);
+
+  // closing a stream frees its slot
+  first = ResponseInformation{};
+  resp = eventsHandler(&listener, infos);
+  ASSERT_EQ(resp.code, 200);
+}
+
+/**
+ * @brief Runs libhttpserver with a pool of worker threads.
+ */
+class RestAPIPoolFixture : public RestAPIFixture {
+ protected:
+  RestAPIPoolFixture() {
+    configOverrides["threadingMode"] = "pool";
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(Implementations,
+                         RestAPIPoolFixture,
+                         ::testing::Values("libhttpserver"),
+                         RestAPIFixture::implementationName);
+
+TEST_P(RestAPIPoolFixture, events_poolMode) {
+  listener.setResponseGetCurrentQueues(gen.generateQueueStatus(2, 1, true));
+  listener.setResponseGetCurrentQueuesVersion({1, 1, 1});
+
+  // more subscribers than worker threads (2 in the test configuration), which
+  // would block all of them
+  vector<future<optional<RestClient::Response>>> subscribers;
+  for (int i = 0; i < 3; i++) {
+    subscribers.push_back(async(launch::async, [this]() {
+      return this->get("/events", {{"session_id", "sse"}});
+    }));
+  }
+
+  // other requests are still answered
+  auto resp = this->get("/getCurrentQueues", {{"session_id", "sse"}}).value();
+  ASSERT_EQ(resp.code, 200);
+
+  // streams are rejected in pool mode
+  for (auto &subscriber : subscribers) {
+    ASSERT_EQ(subscriber.wait_for(5s), future_status::ready);
+    ASSERT_EQ(subscriber.get().value().code, 503);
+  }
+}
+
+//
+// batch
+//
+TEST_P(RestAPIFixture, batch_goodCases) {
+  listener.setResponseGetCurrentQueues(gen.generateQueueStatus(3, 1, true));
+
+  json requestBody = {
+      {"requests",
+       {{{"method", "PUT"},
+         {"path", "/voteTrack"},
+         {"body", {{"session_id", "batch"}, {"track_id", "1"}, {"vote", 1}}}},
+        {{"method", "PUT"},
+         {"path", "/voteTrack"},
+         {"body", {{"session_id", "batch"}, {"track_id", "2"}, {"vote", 0}}}},
+        {{"method", "GET"},
+         {"path", "/getCurrentQueues"},
+         {"args", {{"session_id", "batch"}}}}}}};
+  // the request refers to its body
+  string body = requestBody.dump();
+  RequestInformation infos{"/batch", "POST", body, {}, {}};
+  auto resp = batchHandler(&listener, infos);
+  ASSERT_EQ(resp.code, 200);
+
+  // the results are in the same order as the requests
+  json responseBody = json::parse(resp.body);
+  ASSERT_EQ(responseBody["responses"].size(), 3);
+  ASSERT_EQ(responseBody["responses"][0]["status"], 200);
+  ASSERT_EQ(responseBody["responses"][0]["body"], json::object());
+  ASSERT_EQ(responseBody["responses"][1]["status"], 200);
+  ASSERT_EQ(responseBody["responses"][2]["status"], 200);
+  ASSERT_EQ(responseBody["responses"][2]["body"]["normal_queue"].size(), 3);
+
+  ASSERT_EQ(listener.getCountVoteTrack(), 2);
+  ASSERT_EQ(listener.getCountGetCurrentQueues(), 1);
+  TSessionID sid;
+  TTrackID trkid;
+  TVote vote;
+  listener.getLastParametersVoteTrack(sid, trkid, vote);
+  ASSERT_EQ(sid, "batch");
+  ASSERT_EQ(trkid, "2");
+  ASSERT_EQ(vote, false);
+
+  // an empty batch
+  infos.body = "{\"requests\":[]}";
+  resp = batchHandler(&listener, infos);
+  ASSERT_EQ(resp.code, 200);
+  ASSERT_EQ(resp.body, "{\"responses\":[]}");
+}
+
+TEST_P(RestAPIFixture, batch_badCases) {
+  RequestInformation infos{"/batch", "POST", "", {}, {}};
+
+  // invalid batches
+  for (string body : {"", "[]", "{}", "{\"requests\":{}}"}) {
+    infos.body = body;
+    auto resp = batchHandler(&listener, infos);
+    ASSERT_EQ(resp.code, 422) << body;
+  }
+
+  // too many requests
+  json requestBody = {{"requests", json::array()}};
+  for (int i = 0; i < 33; i++) {
+    requestBody["requests"].push_back(
+        {{"method", "GET"}, {"path", "/getCurrentQueues"}});
+  }
+  string body = requestBody.dump();
+  infos.body = body;
+  ASSERT_EQ(batchHandler(&listener, infos).code, 400);
+  ASSERT_EQ(listener.getCountGetCurrentQueues(), 0);
+
+  // the limit is read when the server starts
+  ConfigHandler::getInstance()->setValue("RestAPI", "maxBatchSize", "33");
+  ASSERT_EQ(batchHandler(&listener, infos).code, 400);
+  ASSERT_FALSE(configureEndpointHandlers().has_value());
+  ASSERT_EQ(batchHandler(&listener, infos).code, 200);
+  loadTestConfig();
+
+  // erroneous requests fail on their own
+  requestBody = {
+      {"requests",
+       {{{"path", "/voteTrack"}},
+        {{"method", "GET"}, {"path", "/unknown"}},
+        {{"method", "GET"}, {"path", "/voteTrack"}},
+        {{"method", "GET"}, {"path", "/events"}},
+        {{"method", "POST"}, {"path", "/batch"}},
+        {{"method", "PUT"}, {"path", "/voteTrack"}, {"body", {{"vote", 1}}}},
+        {{"method", "PUT"},
+         {"path", "/voteTrack"},
+         {"body", {{"session_id", "s"}, {"track_id", "1"}, {"vote", 1}}}}}}};
+  body = requestBody.dump();
+  infos.body = body;
+  auto resp = batchHandler(&listener, infos);
+  ASSERT_EQ(resp.code, 200);
+  json responses = json::parse(resp.body)["responses"];
+  ASSERT_EQ(responses.size(), 7);
+  ASSERT_EQ(responses[0]["status"], 422);
+  ASSERT_EQ(responses[1]["status"], 404);
+  ASSERT_EQ(responses[2]["status"], 405);
+  ASSERT_EQ(responses[3]["status"], 422);
+  ASSERT_EQ(responses[4]["status"], 422);
+  ASSERT_EQ(responses[5]["status"], 422);
+  ASSERT_EQ(responses[5]["body"]["error"], "Field 'session_id' not found");
+  ASSERT_EQ(responses[6]["status"], 200);
+  ASSERT_EQ(listener.getCountVoteTrack(), 1);
+}
+
+//
+// Unix domain socket
+//
+
+static string const UNIX_SOCKET_PATH = "/tmp/jukebox_test_rest.sock";
+
+/**
+ * @brief Runs the server on the TCP port and a Unix domain socket.
+ */
+class RestAPIUnixFixture : public RestAPIFixture {
+ protected:
+  RestAPIUnixFixture() {
+    configOverrides["unixSocket"] = UNIX_SOCKET_PATH;
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(Implementations,
+                         RestAPIUnixFixture,
+                         ::testing::Values("libhttpserver", "epoll"),
+                         RestAPIFixture::implementationName);
+
+TEST_P(RestAPIUnixFixture, unixSocket) {
+  string const request =
+      "GET /api/v1/queryTracks?pattern=a HTTP/1.1\r\n\r\n";
+
+  // both sockets serve requests
+  for (int fd : {connectToUnixSocket(UNIX_SOCKET_PATH), connectToServer()}) {
+    sendAll(fd, request);
+    EXPECT_EQ(readResponse(fd).code, 200);
+    close(fd);
+  }
+  EXPECT_EQ(listener.getCountQueryTracks(), 2);
+
+  // stopping the server removes the socket file
+  api->stopServer();
+  serverThread.join();
+  struct stat status;
+  EXPECT_NE(lstat(UNIX_SOCKET_PATH.c_str(), &status), 0);
+
+  // and the server can listen at the same path again
+  serverThread = thread{[this]() { api->handleRequests(); }};
+  this_thread::sleep_for(10ms);
+  int fd = connectToUnixSocket(UNIX_SOCKET_PATH);
+  sendAll(fd, request);
+  EXPECT_EQ(readResponse(fd).code, 200);
+  close(fd);
+}
@@ -0,0 +1,170 @@
+/*****************************************************************************/
+/**
+ * @file    Test_RestRouter.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class RestRouter
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "Network/RestRouter.h"
+
+using namespace std;
+
+static ResponseInformation const getTracks(NetworkListener *,
+                                           RequestInformation const &) {
+  return ResponseInformation{"getTracks"};
+}
+
+static ResponseInformation const addTrack(NetworkListener *,
+                                          RequestInformation const &) {
+  return ResponseInformation{"addTrack"};
+}
+
+static ResponseInformation const getTrack(NetworkListener *,
+                                          RequestInformation const &) {
+  return ResponseInformation{"getTrack"};
+}
+
+static ResponseInformation const getTrackLatest(NetworkListener *,
+                                                RequestInformation const &) {
+  return ResponseInformation{"getTrackLatest"};
+}
+
+static ResponseInformation const getStatus(NetworkListener *,
+                                           RequestInformation const &) {
+  return ResponseInformation{"getStatus"};
+}
+
+static constexpr RestRouter ROUTER(array<Route, 5>{{
+    {"/tracks", HttpMethod::Get, getTracks},              //
+    {"/tracks", HttpMethod::Post, addTrack},              //
+    {"/tracks/{track_id}", HttpMethod::Get, getTrack},    //
+    {"/tracks/latest", HttpMethod::Get, getTrackLatest},  //
+    {"/status", HttpMethod::Get, getStatus, 2, 3}         //
+}});
+
+// the table is built at compile time
+static_assert(ROUTER.match("/api/v1/tracks", "GET").handler == getTracks);
+static_assert(ROUTER.match("/api/v1/tracks", "PUT").result ==
+              RouteMatch::Result::MethodNotAllowed);
+
+TEST(RestRouter, MatchesPathAndMethod) {
+  auto route = ROUTER.match("/api/v1/tracks", "GET");
+  ASSERT_EQ(route.result, RouteMatch::Result::Found);
+  EXPECT_EQ(route.handler, getTracks);
+  EXPECT_EQ(route.version, 1u);
+  EXPECT_EQ(route.path, "/tracks");
+  EXPECT_TRUE(route.parameterName.empty());
+
+  route = ROUTER.match("/api/v1/tracks", "POST");
+  ASSERT_EQ(route.result, RouteMatch::Result::Found);
+  EXPECT_EQ(route.handler, addTrack);
+}
+
+TEST(RestRouter, NotFound) {
+  for (auto path : {"", "/", "/api", "/api/v1", "/api/v1/", "/api/v/tracks",
+                    "/api/vx/tracks", "/api/v1tracks", "/api/v1/track",
+                    "/api/v1/tracks/", "/api/v1/tracks/a/b", "/api/v1/Tracks",
+                    "/tracks", "/api/v1/status/abc"}) {
+    EXPECT_EQ(ROUTER.match(path, "GET").result, RouteMatch::Result::NotFound)
+        << path;
+  }
+}
+
+TEST(RestRouter, MethodNotAllowed) {
+  auto route = ROUTER.match("/api/v1/tracks", "DELETE");
+  ASSERT_EQ(route.result, RouteMatch::Result::MethodNotAllowed);
+  EXPECT_EQ(route.handler, nullptr);
+  EXPECT_EQ(allowedMethodsHeader(route.allowedMethods), "GET, POST");
+
+  route = ROUTER.match("/api/v1/tracks/abc", "POST");
+  ASSERT_EQ(route.result, RouteMatch::Result::MethodNotAllowed);
+  EXPECT_EQ(allowedMethodsHeader(route.allowedMethods), "GET");
+
+  route = ROUTER.match("/api/v1/tracks", "BREW");
+  ASSERT_EQ(route.result, RouteMatch::Result::MethodNotAllowed);
+  EXPECT_EQ(allowedMethodsHeader(route.allowedMethods), "GET, POST");
+}
+
+TEST(RestRouter, PathParameter) {
+  auto route = ROUTER.match("/api/v1/tracks/4uLU6hMCjMI75M1A2tKUQC", "GET");
+  ASSERT_EQ(route.result, RouteMatch::Result::Found);
+  EXPECT_EQ(route.handler, getTrack);
+  EXPECT_EQ(route.parameterName, "track_id");
+  EXPECT_EQ(route.parameterValue, "4uLU6hMCjMI75M1A2tKUQC");
+
+  // literal paths take precedence
+  route = ROUTER.match("/api/v1/tracks/latest", "GET");
+  ASSERT_EQ(route.result, RouteMatch::Result::Found);
+  EXPECT_EQ(route.handler, getTrackLatest);
+  EXPECT_TRUE(route.parameterName.empty());
+}
+
+TEST(RestRouter, Versions) {
+  EXPECT_EQ(ROUTER.match("/api/v1/status", "GET").result,
+            RouteMatch::Result::NotFound);
+  EXPECT_EQ(ROUTER.match("/api/v4/status", "GET").result,
+            RouteMatch::Result::NotFound);
+  EXPECT_EQ(ROUTER.match("/api/v2/tracks", "GET").result,
+            RouteMatch::Result::NotFound);
+
+  auto route = ROUTER.match("/api/v3/status", "GET");
+  ASSERT_EQ(route.result, RouteMatch::Result::Found);
+  EXPECT_EQ(route.handler, getStatus);
+  EXPECT_EQ(route.version, 3u);
+}
+
+static constexpr RestRouter LARGE_ROUTER(array<Route, 10>{{
+    {"/generateSession", HttpMethod::Post, addTrack},   //
+    {"/queryTracks", HttpMethod::Get, getTracks},       //
+    {"/getCurrentQueues", HttpMethod::Get, getTracks},  //
+    {"/addTrackToQueue", HttpMethod::Post, addTrack},   //
+    {"/voteTrack", HttpMethod::Put, getTrack},          //
+    {"/controlPlayer", HttpMethod::Put, getTrack},      //
+    {"/moveTrack", HttpMethod::Put, getTrack},          //
+    {"/removeTrack", HttpMethod::Delete, getTrack},     //
+    {"/events", HttpMethod::Get, getTracks},            //
+    {"/batch", HttpMethod::Post, addTrack}              //
+}});
+
+// the first seed collides for this table, so the slots are built again
+static_assert(LARGE_ROUTER.seed() > 0);
+
+TEST(RestRouter, OnlyDeclaredMethodsMatch) {
+  // a seed retry must not leave stale entries in the table
+  for (auto path : {"/api/v1/generateSession",
+                    "/api/v1/queryTracks",
+                    "/api/v1/getCurrentQueues",
+                    "/api/v1/addTrackToQueue",
+                    "/api/v1/voteTrack",
+                    "/api/v1/controlPlayer",
+                    "/api/v1/moveTrack",
+                    "/api/v1/removeTrack",
+                    "/api/v1/events",
+                    "/api/v1/batch"}) {
+    size_t found = 0;
+    for (auto method : {"GET", "POST", "PUT", "DELETE", "PATCH"}) {
+      auto route = LARGE_ROUTER.match(path, method);
+      if (route.result == RouteMatch::Result::Found) {
+        found++;
+      } else {
+        EXPECT_EQ(route.result, RouteMatch::Result::MethodNotAllowed)
+            << path << " " << method;
+      }
+    }
+    EXPECT_EQ(found, 1u) << path;
+  }
+}
+
+TEST(RestRouter, RelativePath) {
+  // paths of batch items do not carry the versioned base path
+  auto route = ROUTER.match("/tracks/latest", 1, "GET");
+  ASSERT_EQ(route.result, RouteMatch::Result::Found);
+  EXPECT_EQ(route.handler, getTrackLatest);
+  EXPECT_EQ(route.version, 1u);
+
+  EXPECT_EQ(ROUTER.match("tracks", 1, "GET").result,
+            RouteMatch::Result::NotFound);
+}
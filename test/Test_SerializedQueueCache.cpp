@@ -0,0 +1,189 @@
+/*****************************************************************************/
+/**
+ * @file    Test_SerializedQueueCache.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class SerializedQueueCache
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "Gunzip.h"
+#include "Network/SerializedQueueCache.h"
+#include "TrackGenerator.h"
+#include "Utils/Serializer.h"
+
+using namespace std;
+
+static void setVotes(QueueStatus &queueStatus, int seed) {
+  for (size_t i = 0; i < queueStatus.normalQueue.tracks.size(); i++) {
+    queueStatus.normalQueue.tracks[i].userHasVoted = ((i + seed) % 3 == 0);
+  }
+}
+
+TEST(SerializedQueueCache, MatchesSerializer) {
+  TrackGenerator gen;
+
+  for (auto [normalNr, adminNr, playback] :
+       {tuple{0, 0, false}, tuple{1, 0, true}, tuple{0, 1, false},
+        tuple{20, 5, true}}) {
+    auto queueStatus = gen.generateQueueStatus(normalNr, adminNr, playback);
+    setVotes(queueStatus, 0);
+
+    // unversioned queues are serialized on every call
+    ASSERT_EQ(SerializedQueueCache::serialize(queueStatus),
+              Serializer::serialize(queueStatus).dump());
+  }
+}
+
+TEST(SerializedQueueCache, VotesPerUser) {
+  TrackGenerator gen;
+  auto queueStatus = gen.generateQueueStatus(10, 2, true);
+  queueStatus.normalQueue.version = 42;
+  queueStatus.adminQueue.version = 42;
+
+  // the same version is shared between users with different votes
+  for (int user = 0; user < 3; user++) {
+    setVotes(queueStatus, user);
+    ASSERT_EQ(SerializedQueueCache::serialize(queueStatus),
+              Serializer::serialize(queueStatus).dump());
+  }
+
+  // the votes may be passed separately from the queue of another user
+  auto otherStatus = queueStatus;
+  setVotes(otherStatus, 0);
+  vector<bool> votes;
+  for (auto const &track : queueStatus.normalQueue.tracks) {
+    votes.push_back(track.userHasVoted);
+  }
+  ASSERT_EQ(SerializedQueueCache::serialize(otherStatus, votes),
+            Serializer::serialize(queueStatus).dump());
+
+  // a new version replaces the cached queue
+  auto newQueueStatus = gen.generateQueueStatus(4, 3, false);
+  newQueueStatus.normalQueue.version = 43;
+  newQueueStatus.adminQueue.version = 43;
+  setVotes(newQueueStatus, 1);
+  ASSERT_EQ(SerializedQueueCache::serialize(newQueueStatus),
+            Serializer::serialize(newQueueStatus).dump());
+}
+
+TEST(SerializedQueueCache, Ranges) {
+  TrackGenerator gen;
+  auto whole = gen.generateQueueStatus(30, 2, true);
+  whole.normalQueue.version = 200;
+  whole.adminQueue.version = 200;
+  setVotes(whole, 0);
+
+  // more ranges of the same version than are kept, requested repeatedly
+  for (int round = 0; round < 2; round++) {
+    for (size_t offset : {0, 5, 10, 20, 25, 30}) {
+      auto queueStatus = whole;
+      auto &queue = queueStatus.normalQueue;
+      queue.offset = offset;
+      queue.totalSize = queue.tracks.size();
+      queue.tracks.erase(queue.tracks.begin(), queue.tracks.begin() + offset);
+      queue.tracks.resize(min<size_t>(queue.tracks.size(), 10));
+
+      auto expected = Serializer::serialize(queueStatus);
+      ASSERT_EQ(expected["normal_queue_total"], 30);
+      ASSERT_EQ(SerializedQueueCache::serialize(queueStatus), expected.dump())
+          << offset;
+      ASSERT_EQ(gunzip(SerializedQueueCache::serializeGzip(queueStatus, 6)),
+                expected.dump())
+          << offset;
+    }
+  }
+
+  // the whole queue is cached besides its ranges
+  ASSERT_EQ(SerializedQueueCache::serialize(whole),
+            Serializer::serialize(whole).dump());
+}
+
+TEST(SerializedQueueCache, BinaryFormats) {
+  TrackGenerator gen;
+
+  // array sizes with differently sized headers
+  for (auto normalNr : {0, 1, 15, 16, 23, 24, 300}) {
+    auto queueStatus = gen.generateQueueStatus(normalNr, 2, normalNr > 1);
+    queueStatus.normalQueue.version = 100 + normalNr;
+    queueStatus.adminQueue.version = 100 + normalNr;
+
+    // the encoded pieces are shared between users with different votes
+    for (int user = 0; user < 2; user++) {
+      setVotes(queueStatus, user);
+      auto expected = Serializer::serialize(queueStatus);
+      for (auto format : {BodyFormat::MessagePack, BodyFormat::Cbor}) {
+        ASSERT_EQ(SerializedQueueCache::serialize(queueStatus, format),
+                  BodyCodec::encode(expected, format))
+            << normalNr << " tracks, format " << BodyCodec::mediaType(format);
+      }
+      ASSERT_EQ(SerializedQueueCache::serialize(queueStatus), expected.dump());
+    }
+  }
+}
+
+TEST(SerializedQueueCache, Gzip) {
+  TrackGenerator gen;
+  auto queueStatus = gen.generateQueueStatus(50, 3, true);
+  queueStatus.normalQueue.version = 44;
+  queueStatus.adminQueue.version = 44;
+
+  // the compressed pieces are shared between users with different votes
+  for (int user = 0; user < 3; user++) {
+    setVotes(queueStatus, user);
+    auto compressed = SerializedQueueCache::serializeGzip(queueStatus, 6);
+    ASSERT_EQ(gunzip(compressed), Serializer::serialize(queueStatus).dump());
+  }
+
+  // single votes at the borders of the compressed chunks
+  for (size_t vote : {0, 14, 15, 16, 17, 31, 49}) {
+    for (auto &track : queueStatus.normalQueue.tracks) {
+      track.userHasVoted = false;
+    }
+    queueStatus.normalQueue.tracks[vote].userHasVoted = true;
+    auto compressed = SerializedQueueCache::serializeGzip(queueStatus, 6);
+    ASSERT_EQ(gunzip(compressed), Serializer::serialize(queueStatus).dump())
+        << vote;
+  }
+
+  // unversioned queues
+  for (auto [normalNr, adminNr, playback] :
+       {tuple{0, 0, false}, tuple{1, 0, true}, tuple{20, 5, true}}) {
+    queueStatus = gen.generateQueueStatus(normalNr, adminNr, playback);
+    setVotes(queueStatus, 0);
+    auto compressed = SerializedQueueCache::serializeGzip(queueStatus, 1);
+    ASSERT_EQ(gunzip(compressed), Serializer::serialize(queueStatus).dump());
+  }
+}
+
+TEST(SerializedQueueCache, Fields) {
+  TrackGenerator gen;
+  auto queueStatus = gen.generateQueueStatus(40, 3, true);
+  queueStatus.normalQueue.version = 45;
+  queueStatus.adminQueue.version = 45;
+
+  // with and without the per user vote flags
+  for (auto list : {"title,votes", "current_vote", "track_id,current_vote"}) {
+    auto fields = get<TrackFieldMask>(TrackFieldMask::parse(list));
+    for (int user = 0; user < 2; user++) {
+      setVotes(queueStatus, user);
+      auto expected = Serializer::serialize(queueStatus, fields);
+      auto serialized = SerializedQueueCache::serialize(
+          queueStatus, BodyFormat::Json, fields);
+      ASSERT_EQ(serialized, expected.dump()) << list;
+      for (auto format : {BodyFormat::MessagePack, BodyFormat::Cbor}) {
+        ASSERT_EQ(SerializedQueueCache::serialize(queueStatus, format, fields),
+                  BodyCodec::encode(expected, format))
+            << list;
+      }
+      auto compressed =
+          SerializedQueueCache::serializeGzip(queueStatus, 6, fields);
+      ASSERT_EQ(gunzip(compressed), expected.dump()) << list;
+    }
+  }
+
+  // the selections are cached separately
+  ASSERT_EQ(SerializedQueueCache::serialize(queueStatus),
+            Serializer::serialize(queueStatus).dump());
+}
@@ -0,0 +1,77 @@
+/*****************************************************************************/
+/**
+ * @file    Test_SimpleScheduler.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class SimpleScheduler
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "Datastore/RAMDataStore.h"
+#include "MockMusicBackend.h"
+#include "Utils/SimpleScheduler.h"
+
+using namespace std;
+using namespace std::chrono;
+
+/**
+ * @brief Waits until the scheduler has polled the playback `count` times and
+ * updated its version afterwards.
+ */
+static void waitForPolls(MockMusicBackend &backend, size_t count) {
+  auto timeout = steady_clock::now() + seconds(10);
+  while (backend.getCountGetCurrentPlayback() < count) {
+    ASSERT_LT(steady_clock::now(), timeout);
+    this_thread::sleep_for(milliseconds(10));
+  }
+  // the version is updated right after the poll
+  this_thread::sleep_for(milliseconds(100));
+}
+
+TEST(SimpleScheduler, PlaybackVersionIgnoresProgress) {
+  RAMDataStore dataStore;
+  MockMusicBackend backend;
+
+  // a track played on the player directly, the queues stay empty
+  PlaybackTrack track;
+  track.trackId = "track";
+  track.progressMs = 0;
+  track.isPlaying = true;
+  backend.setCurrentPlayback(track);
+
+  SimpleScheduler scheduler(&dataStore, &backend);
+  atomic<size_t> changes = 0;
+  scheduler.setChangeCallback([&changes]() { changes++; });
+  scheduler.start();
+  waitForPolls(backend, 1);
+  auto version = scheduler.getPlaybackVersion();
+  auto announcedChanges = changes.load();
+  EXPECT_GT(announcedChanges, 0);
+  auto firstPlayback =
+      get<optional<PlaybackTrack>>(scheduler.getLastPlayback());
+  ASSERT_TRUE(firstPlayback.has_value());
+
+  // the progress advances, but the version (and hence the ETag of
+  // getCurrentQueues) stays the same, so polling clients get 304
+  waitForPolls(backend, 3);
+  EXPECT_EQ(scheduler.getPlaybackVersion(), version);
+  EXPECT_EQ(changes, announcedChanges);
+  auto playback = get<optional<PlaybackTrack>>(scheduler.getLastPlayback());
+  ASSERT_TRUE(playback.has_value());
+  EXPECT_GT(playback->progressMs, firstPlayback->progressMs);
+
+  // clients compute the progress from the start of the track, which does
+  // not move while the track plays
+  EXPECT_NEAR(playback->startedAtMs, firstPlayback->startedAtMs, 500);
+
+  // pausing the track is a change of the playback
+  backend.pause();
+  waitForPolls(backend, 4);
+  EXPECT_NE(scheduler.getPlaybackVersion(), version);
+  EXPECT_GT(changes, announcedChanges);
+}
@@ -0,0 +1,108 @@
+/*****************************************************************************/
+/**
+ * @file    Test_SpotifyCallBudget.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class SpotifyCallBudget
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "DispatchFixture.h"
+#include "Spotify/SpotifyCallBudget.h"
+#include "Utils/ConfigHandler.h"
+#include "json/json.hpp"
+
+using namespace std;
+using namespace std::chrono;
+using namespace SpotifyApi;
+using json = nlohmann::json;
+
+class SpotifyCallBudgetTest : public DispatchFixture<> {
+ protected:
+  void SetUp() override {
+    DispatchFixture::SetUp();
+    SpotifyCallBudget::reset();
+    ASSERT_FALSE(SpotifyCallBudget::configure().has_value());
+  }
+
+  /**
+   * @brief returns the entry of a caller in the report
+   */
+  static json callerReport(json const &report, string const &name) {
+    for (auto const &caller : report["callers"]) {
+      if (caller["name"] == name) {
+        return caller;
+      }
+    }
+    return json();
+  }
+};
+
+TEST_F(SpotifyCallBudgetTest, CallerScope) {
+  EXPECT_EQ(SpotifyCallBudget::currentCaller(), SpotifyCaller::Other);
+  {
+    SpotifyCallBudget::CallerScope outer(SpotifyCaller::SetPlayback);
+    {
+      SpotifyCallBudget::CallerScope inner(SpotifyCaller::TokenRefresh);
+      EXPECT_EQ(SpotifyCallBudget::currentCaller(),
+                SpotifyCaller::TokenRefresh);
+    }
+    EXPECT_EQ(SpotifyCallBudget::currentCaller(), SpotifyCaller::SetPlayback);
+  }
+  EXPECT_EQ(SpotifyCallBudget::currentCaller(), SpotifyCaller::Other);
+}
+
+TEST_F(SpotifyCallBudgetTest, Report) {
+  {
+    SpotifyCallBudget::CallerScope caller(SpotifyCaller::SchedulerPoll);
+    SpotifyCallBudget::record("200", milliseconds(100));
+    SpotifyCallBudget::record("200", milliseconds(120));
+    SpotifyCallBudget::record("429", milliseconds(5));
+  }
+  {
+    SpotifyCallBudget::CallerScope caller(SpotifyCaller::Search);
+    SpotifyCallBudget::record("timeout", milliseconds(3000));
+  }
+  EXPECT_EQ(SpotifyCallBudget::callsThisMinute(), 4);
+
+  auto report = json::parse(SpotifyCallBudget::report());
+  EXPECT_EQ(report["budget_per_minute"], 3);
+  EXPECT_EQ(report["calls_current_minute"], 4);
+
+  auto poll = callerReport(report, "schedulerPoll");
+  EXPECT_EQ(poll["total"], 3);
+  EXPECT_EQ(poll["calls_current_minute"], 3);
+  ASSERT_EQ(poll["calls_per_minute"].size(),
+            SpotifyCallBudget::WINDOW_MINUTES);
+  EXPECT_EQ(poll["calls_per_minute"].back(), 3);
+  EXPECT_EQ(poll["statuses"]["200"], 2);
+  EXPECT_EQ(poll["statuses"]["429"], 1);
+  EXPECT_GE(poll["latency_us"]["p50"].get<uint64_t>(), 100000);
+
+  auto search = callerReport(report, "search");
+  EXPECT_EQ(search["total"], 1);
+  EXPECT_EQ(search["statuses"]["timeout"], 1);
+  EXPECT_EQ(callerReport(report, "volume")["total"], 0);
+}
+
+TEST_F(SpotifyCallBudgetTest, Configure) {
+  // the budget is read when the backend is initialized, not on each call
+  auto config = ConfigHandler::getInstance();
+  config->setValue("Spotify", "callBudgetPerMinute", "0");
+  EXPECT_EQ(json::parse(SpotifyCallBudget::report())["budget_per_minute"], 3);
+  ASSERT_FALSE(SpotifyCallBudget::configure().has_value());
+  EXPECT_EQ(json::parse(SpotifyCallBudget::report())["budget_per_minute"], 0);
+
+  config->setValue("Spotify", "callBudgetPerMinute", "-1");
+  EXPECT_TRUE(SpotifyCallBudget::configure().has_value());
+}
+
+TEST_F(SpotifyCallBudgetTest, Endpoint) {
+  SpotifyCallBudget::record("200", milliseconds(1));
+
+  auto response = dispatch({"/debug/spotify", "GET", "", {}, {}});
+  ASSERT_EQ(response.code, 200);
+  auto report = json::parse(response.body);
+  EXPECT_EQ(callerReport(report, "other")["total"], 1);
+}
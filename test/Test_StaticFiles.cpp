@@ -0,0 +1,208 @@
+/*****************************************************************************/
+/**
+ * @file    Test_StaticFiles.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class StaticFiles
+ */
+/*****************************************************************************/
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+
+#include "DispatchFixture.h"
+#include "Network/StaticFiles.h"
+#include "Utils/ConfigHandler.h"
+
+using namespace std;
+
+/**
+ * @brief Creates a static directory and serves it.
+ */
+class StaticFilesFixture : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    loadTestConfig();
+
+    auto command = "rm -rf " + ROOT + " && mkdir -p " + ROOT + "/sub";
+    ASSERT_EQ(system(command.c_str()), 0);
+    writeFile("index.html", "<html></html>");
+    writeFile("sub/index.html", "<html>sub</html>");
+    writeFile(".secret", "secret");
+    writeFile("app.js", "console.log('app');");
+    writeFile("app.js.gz", "gzip variant");
+    writeFile("app.js.br", "brotli variant");
+    writeFile("style.css", "body {}");
+    writeFile("style.css.gz", "outdated gzip variant");
+
+    // the variant of the stylesheet is older than the stylesheet itself
+    timespec times[2] = {{0, UTIME_OMIT}, {1000, 0}};
+    ASSERT_EQ(
+        utimensat(AT_FDCWD, (ROOT + "/style.css.gz").c_str(), times, 0), 0);
+
+    ConfigHandler::getInstance()->setValue("RestAPI", "staticDirectory", ROOT);
+    ASSERT_FALSE(StaticFiles::configure().has_value());
+  }
+
+  void TearDown() override {
+    system(("rm -rf " + ROOT).c_str());
+    loadTestConfig();
+  }
+
+  static void writeFile(string const &name, string const &content) {
+    ofstream(ROOT + "/" + name) << content;
+  }
+
+  /**
+   * @brief Reads the body of a file response.
+   */
+  static string readBody(ResponseInformation const &response) {
+    EXPECT_TRUE(response.file);
+    if (!response.file) {
+      return "";
+    }
+    string body(response.file->size, '\0');
+    EXPECT_EQ(pread(response.file->fd, &body[0], body.size(), 0), body.size());
+    return body;
+  }
+
+  static optional<ResponseInformation> get(string const &path,
+                                           RequestHeaders headers = {}) {
+    RequestInformation request{path, "GET", "", {}, move(headers)};
+    return StaticFiles::serve(request);
+  }
+
+  static string const ROOT;
+};
+
+string const StaticFilesFixture::ROOT = "/tmp/jukebox_test_static";
+
+TEST_F(StaticFilesFixture, Serve) {
+  auto response = get("/");
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(response->code, 200);
+  EXPECT_EQ(readBody(response.value()), "<html></html>");
+  EXPECT_EQ(response->headers["Content-Type"], "text/html; charset=utf-8");
+  EXPECT_EQ(response->headers["Cache-Control"], "no-cache");
+  EXPECT_EQ(response->headers.count("Vary"), 0);
+
+  response = get("/sub//index.html");
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(readBody(response.value()), "<html>sub</html>");
+
+  response = get("/app.js");
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(readBody(response.value()), "console.log('app');");
+  EXPECT_EQ(response->headers["Content-Type"],
+            "text/javascript; charset=utf-8");
+  EXPECT_EQ(response->headers["Cache-Control"], "public, max-age=600");
+  EXPECT_EQ(response->headers["Vary"], "Accept-Encoding");
+  EXPECT_EQ(response->headers.count("Content-Encoding"), 0);
+
+  // the same file is shared by all responses while it is unchanged
+  auto etag = response->headers["ETag"];
+  auto again = get("/app.js");
+  ASSERT_TRUE(again.has_value());
+  EXPECT_EQ(again->file, response->file);
+  EXPECT_EQ(again->headers["ETag"], etag);
+
+  // HEAD requests get the same response
+  RequestInformation head{"/app.js", "HEAD", "", {}, {}};
+  auto headResponse = StaticFiles::serve(head);
+  ASSERT_TRUE(headResponse.has_value());
+  EXPECT_EQ(headResponse->file, response->file);
+}
+
+TEST_F(StaticFilesFixture, Precompressed) {
+  auto response = get("/app.js", {{"Accept-Encoding", "gzip, br"}});
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(readBody(response.value()), "brotli variant");
+  EXPECT_EQ(response->headers["Content-Encoding"], "br");
+  auto brotliETag = response->headers["ETag"];
+
+  response = get("/app.js", {{"Accept-Encoding", "gzip"}});
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(readBody(response.value()), "gzip variant");
+  EXPECT_EQ(response->headers["Content-Encoding"], "gzip");
+
+  // each variant has an entity tag of its own
+  auto identity = get("/app.js");
+  ASSERT_TRUE(identity.has_value());
+  EXPECT_NE(response->headers["ETag"], identity->headers["ETag"]);
+  EXPECT_NE(response->headers["ETag"], brotliETag);
+
+  // outdated variants are ignored
+  response = get("/style.css", {{"Accept-Encoding", "gzip"}});
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(readBody(response.value()), "body {}");
+  EXPECT_EQ(response->headers.count("Content-Encoding"), 0);
+}
+
+TEST_F(StaticFilesFixture, ConditionalAndChanged) {
+  auto response = get("/app.js");
+  ASSERT_TRUE(response.has_value());
+  auto etag = response->headers["ETag"];
+
+  auto notModified = get("/app.js", {{"If-None-Match", "\"x\", " + etag}});
+  ASSERT_TRUE(notModified.has_value());
+  EXPECT_EQ(notModified->code, 304);
+  EXPECT_FALSE(notModified->file);
+
+  // a changed file is reopened
+  writeFile("app.js", "console.log('changed');");
+  auto changed = get("/app.js", {{"If-None-Match", etag}});
+  ASSERT_TRUE(changed.has_value());
+  EXPECT_EQ(changed->code, 200);
+  EXPECT_NE(changed->headers["ETag"], etag);
+  EXPECT_EQ(readBody(changed.value()), "console.log('changed');");
+}
+
+TEST_F(StaticFilesFixture, NotServed) {
+  for (string path : {"/missing.js",
+                      "/sub",
+                      "/.secret",
+                      "/../etc/passwd",
+                      "/sub/../.secret",
+                      "/api/v1/unknown",
+                      "relative"}) {
+    EXPECT_FALSE(get(path).has_value()) << path;
+  }
+
+  RequestInformation post{"/app.js", "POST", "", {}, {}};
+  EXPECT_FALSE(StaticFiles::serve(post).has_value());
+}
+
+TEST_F(StaticFilesFixture, Configure) {
+  // the directory is resolved when the server starts
+  auto config = ConfigHandler::getInstance();
+  config->setValue("RestAPI", "staticDirectory", ROOT + "/sub/..");
+  config->setValue("RestAPI", "staticMaxAgeSeconds", "60");
+  ASSERT_FALSE(StaticFiles::configure().has_value());
+  auto response = get("/app.js");
+  ASSERT_TRUE(response.has_value());
+  EXPECT_EQ(response->headers["Cache-Control"], "public, max-age=60");
+
+  for (auto [key, value] : {pair{"staticDirectory", ROOT + "/missing"},
+                            pair{"staticDirectory", ROOT + "/app.js"},
+                            pair{"staticMaxAgeSeconds", string("-1")}}) {
+    loadTestConfig();
+    config->setValue("RestAPI", key, value);
+    EXPECT_TRUE(StaticFiles::configure().has_value()) << key << "=" << value;
+  }
+
+  // serving files is disabled by default
+  loadTestConfig();
+  EXPECT_FALSE(get("/app.js").has_value());
+}
+
+TEST(StaticFiles, MediaType) {
+  EXPECT_EQ(StaticFiles::mediaType("/a/b.CSS"), "text/css; charset=utf-8");
+  EXPECT_EQ(StaticFiles::mediaType("/font.woff2"), "font/woff2");
+  EXPECT_EQ(StaticFiles::mediaType("/a.b/file"), "application/octet-stream");
+  EXPECT_EQ(StaticFiles::mediaType("/file.unknown"),
+            "application/octet-stream");
+}
@@ -0,0 +1,107 @@
+/*****************************************************************************/
+/**
+ * @file    Test_Tracing.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class Tracing
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "DispatchFixture.h"
+#include "Utils/Tracing.h"
+#include "json/json.hpp"
+
+using namespace std;
+using json = nlohmann::json;
+
+TEST(Tracing, ChromeTrace) {
+  Tracing::clear();
+  {
+    Tracing::Span outer("Test.outer");
+    Tracing::Span inner("Test.inner");
+  }
+  thread([] { Tracing::Span span("Test.thread"); }).join();
+
+  auto trace = json::parse(Tracing::chromeTrace());
+  auto const &events = trace["traceEvents"];
+  ASSERT_EQ(events.size(), 3);
+
+  // spans of exited threads are kept, and come first
+  EXPECT_EQ(events[0]["name"], "Test.thread");
+  // inner spans finish first
+  EXPECT_EQ(events[1]["name"], "Test.inner");
+  EXPECT_EQ(events[2]["name"], "Test.outer");
+  EXPECT_EQ(events[2]["cat"], "Test");
+  EXPECT_EQ(events[2]["ph"], "X");
+  EXPECT_NE(events[0]["tid"], events[1]["tid"]);
+  EXPECT_EQ(events[1]["tid"], events[2]["tid"]);
+  EXPECT_LE(events[2]["ts"].get<double>(), events[1]["ts"].get<double>());
+  EXPECT_GE(events[2]["dur"].get<double>(), events[1]["dur"].get<double>());
+}
+
+TEST(Tracing, RingBuffer) {
+  Tracing::clear();
+  for (size_t i = 0; i < Tracing::BUFFER_CAPACITY + 10; i++) {
+    Tracing::Span span(i < 10 ? "Test.old" : "Test.new");
+  }
+  auto trace = json::parse(Tracing::chromeTrace());
+  auto const &events = trace["traceEvents"];
+  ASSERT_EQ(events.size(), Tracing::BUFFER_CAPACITY);
+  for (auto const &event : events) {
+    EXPECT_EQ(event["name"], "Test.new");
+  }
+}
+
+TEST(Tracing, ConcurrentDump) {
+  Tracing::clear();
+  atomic<bool> done = false;
+  thread writer([&done] {
+    while (!done) {
+      Tracing::Span span("Test.concurrent");
+    }
+  });
+  for (int i = 0; i < 100; i++) {
+    auto trace = json::parse(Tracing::chromeTrace());
+    for (auto const &event : trace["traceEvents"]) {
+      ASSERT_EQ(event["name"], "Test.concurrent");
+    }
+  }
+  done = true;
+  writer.join();
+}
+
+TEST(Tracing, ServerTiming) {
+  Tracing::Request request;
+  { Tracing::Span span("Test.a"); }
+  { Tracing::Span span("Test.b"); }
+  { Tracing::Span span("Test.a"); }
+
+  auto header = request.serverTiming();
+  EXPECT_EQ(header.find("Test.a;dur="), 0);
+  EXPECT_EQ(header.find("Test.a;", 1), string::npos);
+  EXPECT_NE(header.find(", Test.b;dur="), string::npos);
+  EXPECT_NE(header.find(", total;dur="), string::npos);
+}
+
+using TracingEndpoint = DispatchFixture<>;
+
+TEST_F(TracingEndpoint, Dispatch) {
+  auto response = dispatch({"/api/v1/getCurrentQueues", "GET", "", {}, {}});
+  auto const &timing = response.headers["Server-Timing"];
+  EXPECT_NE(timing.find("RestRequestHandler.handle;dur="), string::npos);
+  EXPECT_NE(timing.find("total;dur="), string::npos);
+
+  response = dispatch({"/debug/trace", "GET", "", {}, {}});
+  ASSERT_EQ(response.code, 200);
+  EXPECT_EQ(response.headers["Content-Type"], "application/json");
+  auto trace = json::parse(response.body);
+  bool found = false;
+  for (auto const &event : trace["traceEvents"]) {
+    found = found || event["name"] == "RestRequestHandler.handle";
+  }
+  EXPECT_TRUE(found);
+}
@@ -0,0 +1,82 @@
+/*****************************************************************************/
+/**
+ * @file    Test_TrackFields.cpp
+ * @author  Team Server
+ * @brief   Test implementation for class TrackFieldMask
+ */
+/*****************************************************************************/
+
+#include <gtest/gtest.h>
+
+#include "TrackGenerator.h"
+#include "Utils/JsonWriter.h"
+#include "Utils/Serializer.h"
+#include "Utils/TrackFields.h"
+
+using namespace std;
+using json = nlohmann::json;
+
+static TrackFieldMask parseMask(string_view list) {
+  auto result = TrackFieldMask::parse(list);
+  EXPECT_TRUE(holds_alternative<TrackFieldMask>(result)) << list;
+  return holds_alternative<TrackFieldMask>(result)
+             ? get<TrackFieldMask>(result)
+             : TrackFieldMask();
+}
+
+TEST(TrackFields, Parse) {
+  TrackFieldMask all;
+  ASSERT_TRUE(all.hasAll());
+
+  auto mask = parseMask("title, votes,track_id");
+  EXPECT_FALSE(mask.hasAll());
+  EXPECT_TRUE(mask.has(TrackField::Title));
+  EXPECT_TRUE(mask.has(TrackField::Votes));
+  EXPECT_TRUE(mask.has(TrackField::TrackId));
+  EXPECT_FALSE(mask.has(TrackField::Album));
+  EXPECT_FALSE(mask.has(TrackField::CurrentVote));
+
+  // order and duplicates do not matter
+  EXPECT_EQ(parseMask("votes,title,track_id,title"), mask);
+
+  // all names are known
+  string allNames;
+  for (int i = 0; i < static_cast<int>(TrackField::Count); i++) {
+    allNames += string(TrackFieldMask::name(static_cast<TrackField>(i))) + ",";
+  }
+  EXPECT_TRUE(parseMask(allNames).hasAll());
+
+  for (auto list : {"", ",", " , ", "title,unknown", "Title"}) {
+    auto result = TrackFieldMask::parse(list);
+    ASSERT_TRUE(holds_alternative<Error>(result)) << list;
+    EXPECT_EQ(get<Error>(result).getErrorCode(), ErrorCode::InvalidValue);
+  }
+}
+
+TEST(TrackFields, Projection) {
+  TrackGenerator gen;
+  auto queueStatus = gen.generateQueueStatus(5, 2, true);
+  queueStatus.normalQueue.tracks[1].userHasVoted = true;
+
+  for (auto list : {"title", "votes,current_vote", "playing,track_id",
+                    "album,artist,duration,icon_uri,added_by,playing_for"}) {
+    auto fields = parseMask(list);
+    auto document = Serializer::serialize(queueStatus, fields);
+
+    // only the selected fields are serialized
+    for (auto &&track : document["normal_queue"]) {
+      for (auto &&[key, value] : track.items()) {
+        EXPECT_NE(string_view(list).find(key), string_view::npos) << key;
+      }
+    }
+    EXPECT_EQ(document["normal_queue"][0].contains("title"),
+              fields.has(TrackField::Title));
+    EXPECT_EQ(document["currently_playing"].contains("playing"),
+              fields.has(TrackField::Playing));
+
+    // the streaming serialization yields the same document
+    JsonWriter writer;
+    Serializer::write(writer, queueStatus, fields);
+    EXPECT_EQ(writer.str(), document.dump()) << list;
+  }
+}
@@ -0,0 +1,13 @@
+#include "DispatchFixture.h"
+
+#include "Utils/ConfigHandler.h"
+
+using namespace std;
+
+void loadTestConfig() {
+  static string const configFilePath = "../test/test_config.ini";
+  auto res = ConfigHandler::getInstance()->setConfigFilePath(configFilePath);
+  ASSERT_FALSE(res.has_value());
+  res = RestRequestHandler::configure();
+  ASSERT_FALSE(res.has_value());
+}
@@ -0,0 +1,45 @@
+/*****************************************************************************/
+/**
+ * @file    DispatchFixture.h
+ * @author  Team Server
+ * @brief   Definition of a test fixture for requests dispatched without a
+ *          server
+ */
+/*****************************************************************************/
+
+#ifndef _DISPATCH_FIXTURE_H_
+#define _DISPATCH_FIXTURE_H_
+
+#include <gtest/gtest.h>
+
+#include "MockNetworkListener.h"
+#include "Network/RestRequestHandler.h"
+
+/**
+ * @brief Loads the test configuration (`test/test_config.ini`).
+ * @details Values overridden by earlier test cases are dropped. The
+ * configuration of the request handler is read again, like at the start of a
+ * server.
+ */
+void loadTestConfig();
+
+/**
+ * @brief Dispatches requests like the servers do, to a listener of the given
+ * type.
+ */
+template <class Listener = MockNetworkListener>
+class DispatchFixture : public ::testing::Test {
+ public:
+  ResponseInformation dispatch(RequestInformation request) {
+    return RestRequestHandler::decodeAndDispatch(&listener, std::move(request));
+  }
+
+  Listener listener;
+
+ protected:
+  void SetUp() override {
+    loadTestConfig();
+  }
+};
+
+#endif /* _DISPATCH_FIXTURE_H_ */
@@ -1,21 +1,34 @@
 #include "RestAPIFixture.h"
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
 #include <chrono>
 #include <iostream>
 #include <thread>
 
+#include "DispatchFixture.h"
 #include "Utils/ConfigHandler.h"
 
 using namespace std;
 using namespace literals::chrono_literals;
 
 void RestAPIFixture::SetUp() {
-  static string const configFilePath = "../test/test_config.ini";
-  auto res = ConfigHandler::getInstance()->setConfigFilePath(configFilePath);
-  ASSERT_FALSE(res.has_value());
+  loadTestConfig();
+  auto config = ConfigHandler::getInstance();
+  config->setValue("RestAPI", "implementation", GetParam());
+  for (auto &&kv : configOverrides) {
+    config->setValue("RestAPI", kv.first, kv.second);
+  }
 
-  api.setListener(&listener);
-  serverThread = thread{[this]() { api.handleRequests(); }};
+  auto created = NetworkAPI::create();
+  ASSERT_TRUE(holds_alternative<unique_ptr<NetworkAPI>>(created));
+  api = move(std::get<unique_ptr<NetworkAPI>>(created));
+  api->setListener(&listener);
+  serverThread = thread{[this]() { api->handleRequests(); }};
 
   // let the server start properly before firing requests
   this_thread::sleep_for(10ms);
@@ -23,7 +36,7 @@ void RestAPIFixture::SetUp() {
 
 void RestAPIFixture::TearDown() {
   if (serverThread.joinable()) {
-    api.stopServer();
+    api->stopServer();
     serverThread.join();
   }
 }
@@ -79,10 +92,104 @@ optional<RestClient::Response> RestAPIFixture::put(string const &endpoint,
 }
 
 optional<RestClient::Response> RestAPIFixture::get(
-    string const &endpoint, map<string, string> const &queryParameters) {
+    string const &endpoint,
+    map<string, string> const &queryParameters,
+    RestClient::HeaderFields const &headers) {
   auto url = getRequestUrl(endpoint, queryParameters);
   if (!url.has_value()) {
     return nullopt;
   }
-  return RestClient::get(url.value());
+  if (headers.empty()) {
+    return RestClient::get(url.value());
+  }
+
+  // the simple API does not support custom request headers
+  RestClient::Connection conn("");
+  conn.SetHeaders(headers);
+  return conn.get(url.value());
+}
+
+/**
+ * @brief Lets failing test cases not wait for a response forever.
+ */
+static void setReceiveTimeout(int fd) {
+  timeval timeout = {10, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+}
+
+int RestAPIFixture::connectToServer() {
+  auto port = ConfigHandler::getInstance()->getValueInt("RestAPI", "port");
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(static_cast<uint16_t>(std::get<int>(port)));
+  inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+  EXPECT_EQ(
+      connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)), 0);
+  setReceiveTimeout(fd);
+  return fd;
+}
+
+int RestAPIFixture::connectToUnixSocket(string const &path) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  path.copy(address.sun_path, path.size());
+  EXPECT_EQ(
+      connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)), 0);
+  setReceiveTimeout(fd);
+  return fd;
+}
+
+void RestAPIFixture::sendAll(int fd, string const &data) {
+  ASSERT_EQ(send(fd, data.data(), data.size(), 0), data.size());
+}
+
+RawResponse RestAPIFixture::readResponse(int fd, bool headOnly) {
+  RawResponse response;
+  while (pending.find("\r\n\r\n") == string::npos) {
+    if (!receive(fd)) {
+      return response;
+    }
+  }
+  auto headEnd = pending.find("\r\n\r\n") + 4;
+  response.head = pending.substr(0, headEnd);
+  response.code = stoi(response.head.substr(9, 3));
+
+  auto lengthPos = response.head.find("Content-Length: ");
+  size_t length = (lengthPos == string::npos || headOnly)
+                      ? 0
+                      : stoul(response.head.substr(lengthPos + 16));
+  while (pending.size() < headEnd + length) {
+    if (!receive(fd)) {
+      return response;
+    }
+  }
+  response.body = pending.substr(headEnd, length);
+  pending.erase(0, headEnd + length);
+  return response;
+}
+
+bool RestAPIFixture::receive(int fd) {
+  char buffer[4096];
+  auto received = recv(fd, buffer, sizeof(buffer), 0);
+  if (received <= 0) {
+    return false;
+  }
+  pending.append(buffer, received);
+  return true;
+}
+
+bool RestAPIFixture::receiveUntil(int fd, string const &text) {
+  while (pending.find(text) == string::npos) {
+    if (!receive(fd)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+string RestAPIFixture::implementationName(
+    ::testing::TestParamInfo<string> const &info) {
+  return info.param;
 }
@@ -11,14 +11,32 @@
 
 #include <gtest/gtest.h>
 
+#include <map>
+#include <memory>
 #include <thread>
 
 #include "MockNetworkListener.h"
-#include "Network/RestAPI.h"
+#include "NetworkAPI.h"
 #include "TrackGenerator.h"
+#include "restclient-cpp/connection.h"
 #include "restclient-cpp/restclient.h"
 
-class RestAPIFixture : public ::testing::Test {
+/**
+ * @brief Response read from a plain socket.
+ */
+struct RawResponse {
+  int code = 0;
+  std::string head;
+  std::string body;
+};
+
+/**
+ * @brief Runs the server implementation given as parameter (see key
+ * `implementation` of the configuration) with the test configuration.
+ * @details Derived fixtures override values of the section `RestAPI` with
+ * `configOverrides`, which are applied before the server starts.
+ */
+class RestAPIFixture : public ::testing::TestWithParam<std::string> {
  public:
   std::optional<RestClient::Response> post(std::string const &endpoint,
                                            std::string const &body);
@@ -26,7 +44,36 @@ class RestAPIFixture : public ::testing::Test {
                                           std::string const &body);
   std::optional<RestClient::Response> get(
       std::string const &endpoint,
-      std::map<std::string, std::string> const &queryParameters);
+      std::map<std::string, std::string> const &queryParameters,
+      RestClient::HeaderFields const &headers = {});
+
+  //
+  // HTTP over a plain socket, to control keep-alive and pipelining
+  //
+  int connectToServer();
+  int connectToUnixSocket(std::string const &path);
+  static void sendAll(int fd, std::string const &data);
+
+  /**
+   * @brief Reads the next response from the connection.
+   * @details Bytes following the response are kept for the next call.
+   * @param headOnly The response has no body (e.g. to a HEAD request).
+   */
+  RawResponse readResponse(int fd, bool headOnly = false);
+  bool receive(int fd);
+
+  /**
+   * @brief Receives until `pending` contains the given text, e.g. an event of
+   * an event stream.
+   * @return `false` if the connection was closed (or timed out) before.
+   */
+  bool receiveUntil(int fd, std::string const &text);
+
+  /**
+   * @brief Names the instances of the test cases after the implementation.
+   */
+  static std::string implementationName(
+      ::testing::TestParamInfo<std::string> const &info);
 
   MockNetworkListener listener;
   TrackGenerator gen;
@@ -35,8 +82,10 @@ class RestAPIFixture : public ::testing::Test {
   void SetUp() override;
   void TearDown() override;
 
-  RestAPI api;
+  std::map<std::string, std::string> configOverrides;
+  std::unique_ptr<NetworkAPI> api;
   std::thread serverThread;
+  std::string pending;
 };
 
 #endif /* _REST_API_FIXTURE_H_ */
@@ -0,0 +1,51 @@
+/*****************************************************************************/
+/**
+ * @file    Gunzip.h
+ * @author  Team Server
+ * @brief   Decompression of gzip files in tests
+ */
+/*****************************************************************************/
+
+#ifndef _GUNZIP_H_
+#define _GUNZIP_H_
+
+#include <zlib.h>
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Decompresses a gzip file.
+ * @return The decompressed data, `std::nullopt` if the file is invalid or
+ * followed by trailing data.
+ */
+inline std::optional<std::string> gunzip(std::string_view compressed) {
+  z_stream stream = {};
+  // 16: expect a gzip header and trailer
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+    return std::nullopt;
+  }
+  stream.next_in =
+      reinterpret_cast<Bytef *>(const_cast<char *>(compressed.data()));
+  stream.avail_in = static_cast<uInt>(compressed.size());
+
+  std::string result;
+  char buffer[4096];
+  int ret;
+  do {
+    stream.next_out = reinterpret_cast<Bytef *>(buffer);
+    stream.avail_out = sizeof(buffer);
+    ret = inflate(&stream, Z_NO_FLUSH);
+    result.append(buffer, sizeof(buffer) - stream.avail_out);
+  } while (ret == Z_OK);
+  bool complete = (ret == Z_STREAM_END && stream.avail_in == 0);
+  inflateEnd(&stream);
+
+  if (!complete) {
+    return std::nullopt;
+  }
+  return result;
+}
+
+#endif /* _GUNZIP_H_ */
@@ -91,7 +91,9 @@ void testGetCurrentQueues(RestAPIFixture *fixture,
   json expResponseBody = {
       {"currently_playing", json::object()},  //
       {"normal_queue", json::array()},        //
-      {"admin_queue", json::array()}          //
+      {"normal_queue_total", normalNr},       //
+      {"admin_queue", json::array()},         //
+      {"admin_queue_total", adminNr}          //
   };
 
   if (expQueueStatus.currentTrack.has_value()) {
@@ -81,6 +81,7 @@ PlaybackTrack TrackGenerator::generatePlaybackTrack() const {
 
   track.progressMs = rand();
   track.isPlaying = rand();
+  track.startedAtMs = rand();
 
   return track;
 }
@@ -0,0 +1,96 @@
+/*****************************************************************************/
+/**
+ * @file    MockMusicBackend.h
+ * @author  Team Server
+ * @brief   Definition of a mock MusicBackend for testing purposes
+ */
+/*****************************************************************************/
+
+#ifndef _MOCK_MUSIC_BACKEND_H_
+#define _MOCK_MUSIC_BACKEND_H_
+
+#include <mutex>
+
+#include "MusicBackend.h"
+
+/**
+ * @brief Music backend whose playback is set by the test cases.
+ * @details The progress of a playing track advances by `PROGRESS_PER_POLL`
+ * with every poll of the playback, like the one of a real player.
+ */
+class MockMusicBackend : public MusicBackend {
+ public:
+  static int const PROGRESS_PER_POLL = 1000;
+
+  TResultOpt initBackend() override {
+    return std::nullopt;
+  }
+
+  TResult<std::vector<BaseTrack>> queryTracks(std::string const &,
+                                              size_t const) override {
+    return std::vector<BaseTrack>();
+  }
+
+  TResultOpt setPlayback(BaseTrack const &) override {
+    return std::nullopt;
+  }
+
+  TResult<std::optional<PlaybackTrack>> getCurrentPlayback() override {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mPolls++;
+    if (mPlayback.has_value() && mPlayback->isPlaying) {
+      mPlayback->progressMs += PROGRESS_PER_POLL;
+    }
+    return mPlayback;
+  }
+
+  TResultOpt pause() override {
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mPlayback.has_value()) {
+      mPlayback->isPlaying = false;
+    }
+    return std::nullopt;
+  }
+
+  TResultOpt play() override {
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (mPlayback.has_value()) {
+      mPlayback->isPlaying = true;
+    }
+    return std::nullopt;
+  }
+
+  TResult<size_t> getVolume() override {
+    return size_t(50);
+  }
+
+  TResultOpt setVolume(size_t const) override {
+    return std::nullopt;
+  }
+
+  TResult<BaseTrack> createBaseTrack(TTrackID const &trackID) override {
+    BaseTrack track;
+    track.trackId = trackID;
+    return track;
+  }
+
+  //
+  // Access functions for the test cases
+  //
+  void setCurrentPlayback(std::optional<PlaybackTrack> const &playback) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mPlayback = playback;
+  }
+
+  size_t getCountGetCurrentPlayback() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    return mPolls;
+  }
+
+ private:
+  std::mutex mMutex;
+  std::optional<PlaybackTrack> mPlayback;
+  size_t mPolls = 0;
+};
+
+#endif /* _MOCK_MUSIC_BACKEND_H_ */
@@ -1,5 +1,6 @@
 #include "MockNetworkListener.h"
 
+#include <thread>
 #include <tuple>
 
 using namespace std;
@@ -8,11 +9,16 @@ MockNetworkListener::MockNetworkListener()
     : mGenerateSessionCount(0),
       mQueryTracksCount(0),
       mGetCurrentQueuesCount(0),
+      mGetCurrentPlaybackCount(0),
+      mGetVotedTracksCount(0),
+      mGetCurrentQueuesVersionCount(0),
+      mGetCurrentQueuesVersionResponse(QueueStatusVersion{0, 0, 0}),
       mAddTrackToQueueCount(0),
       mVoteTrackCount(0),
       mControlPlayerCount(0),
       mRemoveTrackCount(0),
-      mMoveTrackCount(0) {
+      mMoveTrackCount(0),
+      mAuthorizeAdminCount(0) {
 }
 
 //
@@ -21,6 +27,7 @@ MockNetworkListener::MockNetworkListener()
 
 TResult<TSessionID> MockNetworkListener::generateSession(
     optional<TPassword> const &pw, optional<string> const &nickname) {
+  unique_lock<mutex> lock(mMutex);
   mGenerateSessionParameters = tuple{pw, nickname};
   mGenerateSessionCount++;
   return mGenerateSessionResponse;
@@ -28,6 +35,8 @@ TResult<TSessionID> MockNetworkListener::generateSession(
 
 TResult<vector<BaseTrack>> MockNetworkListener::queryTracks(
     string const &searchPattern, size_t const nrOfEntries) {
+  this_thread::sleep_for(mQueryTracksDelay.load());
+  unique_lock<mutex> lock(mMutex);
   mQueryTracksParameters = tuple{searchPattern, nrOfEntries};
   mQueryTracksCount++;
   return mQueryTracksResponse;
@@ -35,14 +44,50 @@ TResult<vector<BaseTrack>> MockNetworkListener::queryTracks(
 
 TResult<QueueStatus> MockNetworkListener::getCurrentQueues(
     TSessionID const &sid) {
+  unique_lock<mutex> lock(mMutex);
   mGetCurrentQueuesParameters = sid;
   mGetCurrentQueuesCount++;
   return mGetCurrentQueuesResponse;
 }
 
+TResult<optional<PlaybackTrack>> MockNetworkListener::getCurrentPlayback(
+    TSessionID const &) {
+  unique_lock<mutex> lock(mMutex);
+  mGetCurrentPlaybackCount++;
+  if (holds_alternative<Error>(mGetCurrentQueuesResponse)) {
+    return get<Error>(mGetCurrentQueuesResponse);
+  }
+  return get<QueueStatus>(mGetCurrentQueuesResponse).currentTrack;
+}
+
+TResult<vector<TTrackID>> MockNetworkListener::getVotedTracks(
+    TSessionID const &) {
+  unique_lock<mutex> lock(mMutex);
+  mGetVotedTracksCount++;
+  if (holds_alternative<Error>(mGetCurrentQueuesResponse)) {
+    return get<Error>(mGetCurrentQueuesResponse);
+  }
+  vector<TTrackID> votedTracks;
+  for (auto const &track :
+       get<QueueStatus>(mGetCurrentQueuesResponse).normalQueue.tracks) {
+    if (track.userHasVoted) {
+      votedTracks.push_back(track.trackId);
+    }
+  }
+  return votedTracks;
+}
+
+TResult<QueueStatusVersion> MockNetworkListener::getCurrentQueuesVersion(
+    TSessionID const &) {
+  unique_lock<mutex> lock(mMutex);
+  mGetCurrentQueuesVersionCount++;
+  return mGetCurrentQueuesVersionResponse;
+}
+
 TResultOpt MockNetworkListener::addTrackToQueue(TSessionID const &sid,
                                                 TTrackID const &trkid,
                                                 QueueType type) {
+  unique_lock<mutex> lock(mMutex);
   mAddTrackToQueueParameters = tuple{sid, trkid, type};
   mAddTrackToQueueCount++;
   return {};
@@ -51,6 +96,7 @@ TResultOpt MockNetworkListener::addTrackToQueue(TSessionID const &sid,
 TResultOpt MockNetworkListener::voteTrack(TSessionID const &sid,
                                           TTrackID const &trkid,
                                           TVote vote) {
+  unique_lock<mutex> lock(mMutex);
   mVoteTrackParameters = tuple{sid, trkid, vote};
   mVoteTrackCount++;
   return {};
@@ -58,6 +104,7 @@ TResultOpt MockNetworkListener::voteTrack(TSessionID const &sid,
 
 TResultOpt MockNetworkListener::controlPlayer(TSessionID const &sid,
                                               PlayerAction action) {
+  unique_lock<mutex> lock(mMutex);
   mControlPlayerParameters = tuple{sid, action};
   mControlPlayerCount++;
   return {};
@@ -65,6 +112,7 @@ TResultOpt MockNetworkListener::controlPlayer(TSessionID const &sid,
 
 TResultOpt MockNetworkListener::removeTrack(TSessionID const &sid,
                                             TTrackID const &trkid) {
+  unique_lock<mutex> lock(mMutex);
   mRemoveTrackParameters = tuple{sid, trkid};
   mRemoveTrackCount++;
   return {};
@@ -73,143 +121,224 @@ TResultOpt MockNetworkListener::removeTrack(TSessionID const &sid,
 TResultOpt MockNetworkListener::moveTrack(TSessionID const &sid,
                                           TTrackID const &trkid,
                                           QueueType type) {
+  unique_lock<mutex> lock(mMutex);
   mMoveTrackParameters = tuple{sid, trkid, type};
   mMoveTrackCount++;
   return {};
 }
 
+TResultOpt MockNetworkListener::authorizeAdmin(TSessionID const &sid) {
+  unique_lock<mutex> lock(mMutex);
+  mAuthorizeAdminParameters = sid;
+  mAuthorizeAdminCount++;
+  return mAuthorizeAdminResponse;
+}
+
 //
 // Access functions for the test cases
 //
 
 // generateSession
 bool MockNetworkListener::hasParametersGenerateSession() {
+  unique_lock<mutex> lock(mMutex);
   return mGenerateSessionParameters.has_value();
 }
 
 void MockNetworkListener::getLastParametersGenerateSession(
     optional<TPassword> &pw, optional<string> &nickname) {
+  unique_lock<mutex> lock(mMutex);
   tie(pw, nickname) = mGenerateSessionParameters.value();
   mGenerateSessionParameters = nullopt;
 }
 
 size_t MockNetworkListener::getCountGenerateSession() {
+  unique_lock<mutex> lock(mMutex);
   return mGenerateSessionCount;
 }
 void MockNetworkListener::setResponseGenerateSession(TSessionID const &resp) {
+  unique_lock<mutex> lock(mMutex);
   mGenerateSessionResponse = resp;
 }
 
 // queryTracks
 bool MockNetworkListener::hasParametersQueryTracks() {
+  unique_lock<mutex> lock(mMutex);
   return mQueryTracksParameters.has_value();
 }
 
 void MockNetworkListener::getLastParametersQueryTracks(string &pattern,
                                                        int &maxEntries) {
+  unique_lock<mutex> lock(mMutex);
   tie(pattern, maxEntries) = mQueryTracksParameters.value();
   mQueryTracksParameters = nullopt;
 }
 
 size_t MockNetworkListener::getCountQueryTracks() {
+  unique_lock<mutex> lock(mMutex);
   return mQueryTracksCount;
 }
 void MockNetworkListener::setResponseQueryTracks(
     vector<BaseTrack> const &tracks) {
+  unique_lock<mutex> lock(mMutex);
   mQueryTracksResponse = tracks;
 }
+void MockNetworkListener::setDelayQueryTracks(chrono::milliseconds delay) {
+  mQueryTracksDelay = delay;
+}
 
 // getCurrentQueues
 bool MockNetworkListener::hasParametersGetCurrentQueues() {
+  unique_lock<mutex> lock(mMutex);
   return mGetCurrentQueuesParameters.has_value();
 }
 
 void MockNetworkListener::getLastParametersGetCurrentQueues(TSessionID &sid) {
+  unique_lock<mutex> lock(mMutex);
   sid = mGetCurrentQueuesParameters.value();
   mGetCurrentQueuesParameters = nullopt;
 }
 
 size_t MockNetworkListener::getCountGetCurrentQueues() {
+  unique_lock<mutex> lock(mMutex);
   return mGetCurrentQueuesCount;
 }
 void MockNetworkListener::setResponseGetCurrentQueues(
     QueueStatus const &queueStatus) {
+  unique_lock<mutex> lock(mMutex);
   mGetCurrentQueuesResponse = queueStatus;
 }
 
+// getCurrentPlayback and getVotedTracks
+size_t MockNetworkListener::getCountGetCurrentPlayback() {
+  unique_lock<mutex> lock(mMutex);
+  return mGetCurrentPlaybackCount;
+}
+size_t MockNetworkListener::getCountGetVotedTracks() {
+  unique_lock<mutex> lock(mMutex);
+  return mGetVotedTracksCount;
+}
+
+// getCurrentQueuesVersion
+size_t MockNetworkListener::getCountGetCurrentQueuesVersion() {
+  unique_lock<mutex> lock(mMutex);
+  return mGetCurrentQueuesVersionCount;
+}
+void MockNetworkListener::setResponseGetCurrentQueuesVersion(
+    QueueStatusVersion const &version) {
+  unique_lock<mutex> lock(mMutex);
+  mGetCurrentQueuesVersionResponse = version;
+}
+
 // addTrackToQueue
 bool MockNetworkListener::hasParametersAddTrackToQueue() {
+  unique_lock<mutex> lock(mMutex);
   return mAddTrackToQueueParameters.has_value();
 }
 
 void MockNetworkListener::getLastParametersAddTrackToQueue(
     TSessionID &sid, TTrackID &trkid, QueueType &queueType) {
+  unique_lock<mutex> lock(mMutex);
   tie(sid, trkid, queueType) = mAddTrackToQueueParameters.value();
   mAddTrackToQueueParameters = nullopt;
 }
 
 size_t MockNetworkListener::getCountAddTrackToQueue() {
+  unique_lock<mutex> lock(mMutex);
   return mAddTrackToQueueCount;
 }
 
 // voteTrack
 bool MockNetworkListener::hasParametersVoteTrack() {
+  unique_lock<mutex> lock(mMutex);
   return mVoteTrackParameters.has_value();
 }
 
 void MockNetworkListener::getLastParametersVoteTrack(TSessionID &sid,
                                                      TTrackID &trkid,
                                                      TVote &vote) {
+  unique_lock<mutex> lock(mMutex);
   tie(sid, trkid, vote) = mVoteTrackParameters.value();
   mVoteTrackParameters = nullopt;
 }
 
 size_t MockNetworkListener::getCountVoteTrack() {
+  unique_lock<mutex> lock(mMutex);
   return mVoteTrackCount;
 }
 
 // controlPlayer
 bool MockNetworkListener::hasParametersControlPlayer() {
+  unique_lock<mutex> lock(mMutex);
   return mControlPlayerParameters.has_value();
 }
 
 void MockNetworkListener::getLastParametersControlPlayer(TSessionID &sid,
                                                          PlayerAction &action) {
+  unique_lock<mutex> lock(mMutex);
   tie(sid, action) = mControlPlayerParameters.value();
   mControlPlayerParameters = nullopt;
 }
 
 size_t MockNetworkListener::getCountControlPlayer() {
+  unique_lock<mutex> lock(mMutex);
   return mControlPlayerCount;
 }
 
 // moveTrack
 bool MockNetworkListener::hasParametersMoveTrack() {
+  unique_lock<mutex> lock(mMutex);
   return mMoveTrackParameters.has_value();
 }
 
 void MockNetworkListener::getLastParametersMoveTrack(TSessionID &sid,
                                                      TTrackID &trkid,
                                                      QueueType &queueType) {
+  unique_lock<mutex> lock(mMutex);
   tie(sid, trkid, queueType) = mMoveTrackParameters.value();
   mMoveTrackParameters = nullopt;
 }
 
 size_t MockNetworkListener::getCountMoveTrack() {
+  unique_lock<mutex> lock(mMutex);
   return mMoveTrackCount;
 }
 
 // removeTrack
 bool MockNetworkListener::hasParametersRemoveTrack() {
+  unique_lock<mutex> lock(mMutex);
   return mRemoveTrackParameters.has_value();
 }
 
 void MockNetworkListener::getLastParametersRemoveTrack(TSessionID &sid,
                                                        TTrackID &trkid) {
+  unique_lock<mutex> lock(mMutex);
   tie(sid, trkid) = mRemoveTrackParameters.value();
   mRemoveTrackParameters = nullopt;
 }
 
 size_t MockNetworkListener::getCountRemoveTrack() {
+  unique_lock<mutex> lock(mMutex);
   return mRemoveTrackCount;
 }
+
+// authorizeAdmin
+bool MockNetworkListener::hasParametersAuthorizeAdmin() {
+  unique_lock<mutex> lock(mMutex);
+  return mAuthorizeAdminParameters.has_value();
+}
+
+void MockNetworkListener::getLastParametersAuthorizeAdmin(TSessionID &sid) {
+  unique_lock<mutex> lock(mMutex);
+  sid = mAuthorizeAdminParameters.value();
+  mAuthorizeAdminParameters = nullopt;
+}
+
+size_t MockNetworkListener::getCountAuthorizeAdmin() {
+  unique_lock<mutex> lock(mMutex);
+  return mAuthorizeAdminCount;
+}
+
+void MockNetworkListener::setResponseAuthorizeAdmin(TResultOpt const &result) {
+  unique_lock<mutex> lock(mMutex);
+  mAuthorizeAdminResponse = result;
+}
@@ -9,6 +9,9 @@
 #ifndef _MOCK_NETWORK_LISTENER_H_
 #define _MOCK_NETWORK_LISTENER_H_
 
+#include <atomic>
+#include <chrono>
+#include <mutex>
 #include <tuple>
 
 #include "NetworkListener.h"
@@ -38,6 +41,15 @@ class MockNetworkListener : public NetworkListener {
 
   TResult<QueueStatus> getCurrentQueues(TSessionID const &sid) override;
 
+  TResult<std::optional<PlaybackTrack>> getCurrentPlayback(
+      TSessionID const &sid) override;
+
+  TResult<std::vector<TTrackID>> getVotedTracks(
+      TSessionID const &sid) override;
+
+  TResult<QueueStatusVersion> getCurrentQueuesVersion(
+      TSessionID const &sid) override;
+
   TResultOpt addTrackToQueue(TSessionID const &sid,
                              TTrackID const &trkid,
                              QueueType type) override;
@@ -54,6 +66,8 @@ class MockNetworkListener : public NetworkListener {
                        TTrackID const &trkid,
                        QueueType type) override;
 
+  TResultOpt authorizeAdmin(TSessionID const &sid) override;
+
   //
   // Access functions for the test cases
   //
@@ -70,6 +84,7 @@ class MockNetworkListener : public NetworkListener {
   void getLastParametersQueryTracks(std::string &pattern, int &maxEntries);
   size_t getCountQueryTracks();
   void setResponseQueryTracks(std::vector<BaseTrack> const &tracks);
+  void setDelayQueryTracks(std::chrono::milliseconds delay);
 
   // getCurrentQueues
   bool hasParametersGetCurrentQueues();
@@ -77,6 +92,15 @@ class MockNetworkListener : public NetworkListener {
   size_t getCountGetCurrentQueues();
   void setResponseGetCurrentQueues(QueueStatus const &queueStatus);
 
+  // getCurrentPlayback and getVotedTracks (answered from the response of
+  // getCurrentQueues)
+  size_t getCountGetCurrentPlayback();
+  size_t getCountGetVotedTracks();
+
+  // getCurrentQueuesVersion
+  size_t getCountGetCurrentQueuesVersion();
+  void setResponseGetCurrentQueuesVersion(QueueStatusVersion const &version);
+
   // addTrackToQueue
   bool hasParametersAddTrackToQueue();
   void getLastParametersAddTrackToQueue(TSessionID &sid,
@@ -108,6 +132,12 @@ class MockNetworkListener : public NetworkListener {
   void getLastParametersRemoveTrack(TSessionID &sid, TTrackID &trkid);
   size_t getCountRemoveTrack();
 
+  // authorizeAdmin
+  bool hasParametersAuthorizeAdmin();
+  void getLastParametersAuthorizeAdmin(TSessionID &sid);
+  size_t getCountAuthorizeAdmin();
+  void setResponseAuthorizeAdmin(TResultOpt const &result);
+
   //
   // Store the parameter sets, responses and call counts for each request.
   //
@@ -115,6 +145,9 @@ class MockNetworkListener : public NetworkListener {
   // is optional, so you can signal that the method hasn't been called.
   //
  private:
+  // requests are handled concurrently by the servers
+  std::mutex mMutex;
+
   // generateSession
   std::optional<
       std::tuple<std::optional<TPassword>, std::optional<std::string>>>
@@ -126,12 +159,22 @@ class MockNetworkListener : public NetworkListener {
   std::optional<std::tuple<std::string, size_t>> mQueryTracksParameters;
   size_t mQueryTracksCount;
   TResult<std::vector<BaseTrack>> mQueryTracksResponse;
+  std::atomic<std::chrono::milliseconds> mQueryTracksDelay{
+      std::chrono::milliseconds(0)};
 
   // getCurrentQueues
   std::optional<std::string> mGetCurrentQueuesParameters;
   size_t mGetCurrentQueuesCount;
   TResult<QueueStatus> mGetCurrentQueuesResponse;
 
+  // getCurrentPlayback and getVotedTracks
+  size_t mGetCurrentPlaybackCount;
+  size_t mGetVotedTracksCount;
+
+  // getCurrentQueuesVersion
+  size_t mGetCurrentQueuesVersionCount;
+  TResult<QueueStatusVersion> mGetCurrentQueuesVersionResponse;
+
   // addTrackToQueue
   std::optional<std::tuple<TSessionID, TTrackID, QueueType>>
       mAddTrackToQueueParameters;
@@ -153,6 +196,11 @@ class MockNetworkListener : public NetworkListener {
   std::optional<std::tuple<TSessionID, TTrackID, QueueType>>
       mMoveTrackParameters;
   size_t mMoveTrackCount;
+
+  // authorizeAdmin
+  std::optional<TSessionID> mAuthorizeAdminParameters;
+  size_t mAuthorizeAdminCount;
+  TResultOpt mAuthorizeAdminResponse;
 };
 
 #endif /* _MOCK_NETWORK_LISTENER_H_ */